@@ -0,0 +1,77 @@
+# -*- coding: utf-8 -*-
+"""Measures the cost of animating many sprites.
+
+Gives every sprite an 8 frame walk cycle at a slightly different speed and
+times one frame of animation done two ways: choosing each sprite's frame
+in Python and writing its ``src_rect``, and a single ``Animator.update``.
+The average time per frame is printed for each.
+
+Usage: python benchmarks/animation.py [sprites] [frames]
+"""
+import sys
+import time
+
+import pyasge
+
+SPRITES = int(sys.argv[1]) if len(sys.argv) > 1 else 10_000
+FRAMES = int(sys.argv[2]) if len(sys.argv) > 2 else 200
+FRAME_TIME = 1 / 60
+CELL = 32
+CELLS = 8
+CELL_TIME = 0.1
+
+
+class AnimationBenchmark(pyasge.ASGEGame):
+    def __init__(self, settings):
+        pyasge.ASGEGame.__init__(self, settings)
+        self.sprites = [pyasge.Sprite() for _ in range(SPRITES)]
+        self.speeds = [0.8 + (i % 5) * 0.1 for i in range(SPRITES)]
+
+        self.results = [("python", self.python()), ("Animator", self.animator())]
+        self.signal_exit()
+
+    def python(self):
+        clocks = [0.0] * SPRITES
+        started = time.perf_counter()
+        for _ in range(FRAMES):
+            for i, sprite in enumerate(self.sprites):
+                clocks[i] += FRAME_TIME * self.speeds[i]
+                cell = int(clocks[i] / CELL_TIME) % CELLS
+                sprite.src_rect[0] = cell * CELL
+                sprite.src_rect[2] = CELL
+                sprite.src_rect[3] = CELL
+        return (time.perf_counter() - started) / FRAMES
+
+    def animator(self):
+        walk = pyasge.AnimationClip.from_grid(CELL, CELL, columns=CELLS, count=CELLS, duration=CELL_TIME)
+        animator = pyasge.Animator()
+        for sprite, speed in zip(self.sprites, self.speeds):
+            animator.play(sprite, walk, speed=speed)
+
+        started = time.perf_counter()
+        for _ in range(FRAMES):
+            animator.update(FRAME_TIME)
+        return (time.perf_counter() - started) / FRAMES
+
+    def update(self, game_time: pyasge.GameTime) -> None:
+        pass
+
+    def render(self, game_time: pyasge.GameTime) -> None:
+        pass
+
+
+def main():
+    settings = pyasge.GameSettings()
+    settings.window_width = 640
+    settings.window_height = 480
+
+    game = AnimationBenchmark(settings)
+    game.run()
+
+    print(f"{SPRITES} sprites, {FRAMES} frames")
+    for name, seconds in game.results:
+        print(f"{name:<10} {seconds * 1e3:>8.3f} ms per frame")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,49 @@
+# -*- coding: utf-8 -*-
+"""Measures the cost of finding overlapping objects with a SpatialGrid.
+
+Moves 20,000 boxes of 8 to 32 pixels around a 4096x4096 world and, each
+frame, rebuilds a ``pyasge.SpatialGrid`` from them and collects every
+overlapping pair. The average build and pair times are printed.
+
+Usage: python benchmarks/broadphase.py [objects] [frames]
+"""
+import sys
+import time
+
+import numpy as np
+
+import pyasge
+
+OBJECTS = int(sys.argv[1]) if len(sys.argv) > 1 else 20_000
+FRAMES = int(sys.argv[2]) if len(sys.argv) > 2 else 200
+WORLD = 4096.0
+CELL = 32.0
+
+
+def main():
+    rng = np.random.default_rng(1)
+    boxes = np.empty((OBJECTS, 4), dtype=np.float32)
+    boxes[:, :2] = rng.uniform(0, WORLD, (OBJECTS, 2))
+    boxes[:, 2:] = rng.uniform(8, 32, (OBJECTS, 2))
+    velocities = rng.uniform(-2, 2, (OBJECTS, 2)).astype(np.float32)
+
+    grid = pyasge.SpatialGrid(CELL)
+    build_time = pair_time = 0.0
+    pairs = 0
+    for _ in range(FRAMES):
+        boxes[:, :2] = (boxes[:, :2] + velocities) % WORLD
+
+        started = time.perf_counter()
+        grid.build(boxes)
+        built = time.perf_counter()
+        pairs += len(grid.pairs())
+        build_time += built - started
+        pair_time += time.perf_counter() - built
+
+    print(f"{OBJECTS} objects, {CELL:g} unit cells, {FRAMES} frames")
+    print(f"build {build_time / FRAMES * 1e3:.3f} ms, pairs {pair_time / FRAMES * 1e3:.3f} ms, "
+          f"{pairs / FRAMES:.0f} pairs per frame, {grid.entries} entries")
+
+
+if __name__ == "__main__":
+    main()
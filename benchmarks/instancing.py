@@ -0,0 +1,105 @@
+# -*- coding: utf-8 -*-
+"""Measures the CPU cost of drawing many moving sprites with instancing.
+
+Renders 100,000 spinning sprites sharing one texture three ways: one
+``Renderer.render`` call per sprite, the same calls through the deferred
+queue with its instanced path for long runs, and a ``pyasge.SpriteBatch``.
+The sprites turn a little every frame so nothing can be cached. The average
+frame time and the time spent in the draw calls are printed per 100,000
+sprites, along with the draw and instance counts from the frame stats.
+
+Under a software rasteriser such as Mesa's llvmpipe the GPU work runs on
+the CPU too, so the frame times include it.
+
+Usage: python benchmarks/instancing.py [sprites] [frames]
+"""
+import random
+import sys
+import time
+
+import pyasge
+
+SPRITES = int(sys.argv[1]) if len(sys.argv) > 1 else 100_000
+FRAMES = int(sys.argv[2]) if len(sys.argv) > 2 else 120
+MODES = ["render", "queued", "batch"]
+
+
+class InstancingBenchmark(pyasge.ASGEGame):
+    def __init__(self, settings):
+        pyasge.ASGEGame.__init__(self, settings)
+        random.seed(1)
+        texture = self.renderer.createNonCachedTexture(16, 16, pyasge.Texture.Format.RGBA, None)
+
+        self.sprites = []
+        for _ in range(SPRITES):
+            sprite = pyasge.Sprite()
+            sprite.attach(texture)
+            sprite.x = random.uniform(0, settings.window_width)
+            sprite.y = random.uniform(0, settings.window_height)
+            sprite.scale = random.uniform(0.25, 1.0)
+            self.sprites.append(sprite)
+        self.batch = pyasge.SpriteBatch(self.renderer, self.sprites)
+
+        self.mode = 0
+        self.frame = 0
+        self.results = []
+        self.start_mode()
+
+    def start_mode(self):
+        self.renderer.deferred_rendering = MODES[self.mode] == "queued"
+        self.draw_time = 0.0
+        self.draws = 0
+        self.started = time.perf_counter()
+
+    def update(self, game_time: pyasge.GameTime) -> None:
+        for sprite in self.sprites[::100]:
+            sprite.rotation += 0.05
+
+    def render(self, game_time: pyasge.GameTime) -> None:
+        if self.frame > 0:
+            stats = self.renderer.frame_stats
+            self.draws += stats.instanced_draws
+
+        started = time.perf_counter()
+        if MODES[self.mode] == "batch":
+            self.batch.render()
+        else:
+            for sprite in self.sprites:
+                self.renderer.render(sprite)
+            self.renderer.flush()
+        self.draw_time += time.perf_counter() - started
+
+        self.frame += 1
+        if self.frame <= FRAMES:
+            return
+
+        per = 100_000 / SPRITES
+        elapsed = time.perf_counter() - self.started
+        self.results.append((MODES[self.mode], elapsed / self.frame * 1e3 * per,
+                             self.draw_time / self.frame * 1e3 * per, self.draws / FRAMES))
+        self.mode += 1
+        self.frame = 0
+        if self.mode == len(MODES):
+            self.signal_exit()
+        else:
+            self.start_mode()
+
+
+def main():
+    settings = pyasge.GameSettings()
+    settings.window_width = 1024
+    settings.window_height = 768
+    settings.vsync = pyasge.Vsync.DISABLED
+    settings.fps_limit = 1000
+
+    game = InstancingBenchmark(settings)
+    game.run()
+
+    print(f"{SPRITES} sprites, {FRAMES} frames, times per 100k sprites")
+    print(f"{'mode':<8} {'frame ms':>10} {'draw ms':>10} {'instanced draws':>16}")
+    for name, frame_ms, draw_ms, draws in game.results:
+        print(f"{name:<8} {frame_ms:>10.2f} {draw_ms:>10.2f} {draws:>16.1f}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,84 @@
+# -*- coding: utf-8 -*-
+"""Measures the cost of simulating and drawing a large particle emitter.
+
+Fills a ``pyasge.ParticleEmitter`` with 200,000 spinning particles falling
+under gravity, spawning as many each second as die, and times its
+``update`` and ``render`` calls each frame. Run with ``--single`` to keep
+the emitter on the calling thread. The average time of each per frame is
+printed, along with the vertex data streamed and any waits on the GPU.
+
+Usage: python benchmarks/particles.py [particles] [frames] [--single]
+"""
+import sys
+import time
+
+import pyasge
+
+ARGS = [arg for arg in sys.argv[1:] if not arg.startswith("--")]
+PARTICLES = int(ARGS[0]) if len(ARGS) > 0 else 200_000
+FRAMES = int(ARGS[1]) if len(ARGS) > 1 else 600
+LIFETIME = (2.0, 4.0)
+
+
+class ParticleBenchmark(pyasge.ASGEGame):
+    def __init__(self, settings):
+        pyasge.ASGEGame.__init__(self, settings)
+        self.emitter = pyasge.ParticleEmitter(self.renderer, int(PARTICLES * 1.1))
+        self.emitter.threaded = "--single" not in sys.argv
+        self.emitter.x, self.emitter.y = 512, 384
+        self.emitter.shape = pyasge.ParticleEmitter.Shape.CIRCLE
+        self.emitter.extent = (64, 64)
+        self.emitter.lifetime = LIFETIME
+        self.emitter.speed = (50, 250)
+        self.emitter.spin = (-3, 3)
+        self.emitter.gravity = (0, 120)
+        self.emitter.size = (6, 1)
+        self.emitter.colours = (pyasge.COLOURS.YELLOW, pyasge.COLOURS.RED)
+        self.emitter.rate = PARTICLES / sum(LIFETIME) * 2
+        self.emitter.seed(1)
+        self.emitter.emit(PARTICLES)
+
+        self.update_time = 0.0
+        self.render_time = 0.0
+        self.streamed = 0
+        self.waits = 0
+        self.frames = 0
+
+    def update(self, game_time: pyasge.GameTime) -> None:
+        started = time.perf_counter()
+        self.emitter.update(1 / 60)
+        self.update_time += time.perf_counter() - started
+
+    def render(self, game_time: pyasge.GameTime) -> None:
+        if self.frames > 0:
+            stats = self.renderer.frame_stats
+            self.streamed += stats.stream_bytes
+            self.waits += stats.stream_waits
+
+        started = time.perf_counter()
+        self.emitter.render()
+        self.render_time += time.perf_counter() - started
+
+        self.frames += 1
+        if self.frames == FRAMES:
+            self.signal_exit()
+
+
+def main():
+    settings = pyasge.GameSettings()
+    settings.window_width = 1024
+    settings.window_height = 768
+    settings.vsync = pyasge.Vsync.DISABLED
+
+    game = ParticleBenchmark(settings)
+    game.run()
+
+    frames = max(game.frames, 1)
+    print(f"{len(game.emitter)} live particles, {'threaded' if game.emitter.threaded else 'single thread'}, "
+          f"{frames} frames")
+    print(f"update {game.update_time / frames * 1e3:.3f} ms, render {game.render_time / frames * 1e3:.3f} ms per frame")
+    print(f"streamed {game.streamed / max(frames - 1, 1) / 2**20:.2f} MB per frame, {game.waits} waits on the GPU")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,65 @@
+# -*- coding: utf-8 -*-
+"""Measures the cost of pathfinding on a large grid.
+
+Builds a 512x512 grid with scattered walls and times single path queries,
+the same queries batched through ``NavGrid.find_paths`` on the worker pool,
+and a flow field to one goal. Grids where every open cell costs the same
+are searched with jump points; a second run with varied costs uses A*.
+
+Usage: python benchmarks/pathfinding.py [queries]
+"""
+import sys
+import time
+
+import numpy as np
+
+import pyasge
+
+QUERIES = int(sys.argv[1]) if len(sys.argv) > 1 else 1_000
+SIZE = 512
+
+
+def make_costs(rng, varied):
+    costs = rng.uniform(1, 4, (SIZE, SIZE)).astype(np.float32) if varied else np.ones((SIZE, SIZE), np.float32)
+    for _ in range(400):
+        column, row = rng.integers(0, SIZE, 2)
+        if rng.random() < 0.5:
+            costs[row, column:column + rng.integers(8, 64)] = 0
+        else:
+            costs[row:row + rng.integers(8, 64), column] = 0
+    return costs
+
+
+def run(name, grid, starts, goals):
+    started = time.perf_counter()
+    single = [grid.find_path(tuple(s), tuple(g)) for s, g in zip(starts, goals)]
+    single_ms = (time.perf_counter() - started) * 1e3
+
+    started = time.perf_counter()
+    batched = grid.find_paths(starts, goals)
+    batched_ms = (time.perf_counter() - started) * 1e3
+
+    started = time.perf_counter()
+    grid.flow_field(goals[:1])
+    flow_ms = (time.perf_counter() - started) * 1e3
+
+    found = sum(len(path) > 0 for path in batched)
+    assert found == sum(len(path) > 0 for path in single)
+    print(f"{name:<10} {single_ms:>10.1f} {batched_ms:>10.1f} {flow_ms:>10.1f} {found:>8}")
+
+
+def main():
+    rng = np.random.default_rng(1)
+    print(f"{SIZE}x{SIZE} grid, {QUERIES} queries")
+    print(f"{'costs':<10} {'single ms':>10} {'batched ms':>10} {'flow ms':>10} {'found':>8}")
+    for name, varied in (("uniform", False), ("varied", True)):
+        costs = make_costs(rng, varied)
+        grid = pyasge.NavGrid(costs)
+        open_cells = np.argwhere(costs > 0)[:, ::-1].astype(np.int32)
+        starts = open_cells[rng.integers(0, len(open_cells), QUERIES)]
+        goals = open_cells[rng.integers(0, len(open_cells), QUERIES)]
+        run(name, grid, starts, goals)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,111 @@
+# -*- coding: utf-8 -*-
+"""Measures the cost of sorting the deferred render queue.
+
+Renders 100,000 sprites spread over a handful of textures and z-orders. Each
+frame 1% of the sprites are given a new z-order, which is typical of scenes
+where most objects stay on their layer. The scene is run with the queue
+disabled, with a full radix sort every frame and with incremental sorting,
+and the average sort time and batch count for each mode are printed.
+
+Usage: python benchmarks/render_queue.py [sprites] [frames]
+"""
+import random
+import sys
+import time
+
+import pyasge
+
+SPRITES = int(sys.argv[1]) if len(sys.argv) > 1 else 100_000
+FRAMES = int(sys.argv[2]) if len(sys.argv) > 2 else 120
+CHURN = 0.01
+TEXTURES = 8
+LAYERS = 16
+
+MODES = [
+    ("immediate", False, False),
+    ("radix", True, False),
+    ("incremental", True, True),
+]
+
+
+class RenderQueueBenchmark(pyasge.ASGEGame):
+    def __init__(self, settings):
+        pyasge.ASGEGame.__init__(self, settings)
+        random.seed(1)
+
+        textures = [
+            self.renderer.createNonCachedTexture(16, 16, pyasge.Texture.Format.RGBA, None)
+            for _ in range(TEXTURES)
+        ]
+
+        self.sprites = []
+        for _ in range(SPRITES):
+            sprite = pyasge.Sprite()
+            sprite.attach(random.choice(textures))
+            sprite.x = random.uniform(0, settings.window_width)
+            sprite.y = random.uniform(0, settings.window_height)
+            sprite.z_order = random.randrange(LAYERS)
+            self.sprites.append(sprite)
+
+        self.mode = 0
+        self.frame = 0
+        self.results = []
+        self.apply_mode()
+
+    def apply_mode(self):
+        _, deferred, incremental = MODES[self.mode]
+        self.renderer.deferred_rendering = deferred
+        self.renderer.incremental_sorting = incremental
+        self.sort_time = 0.0
+        self.batches = 0
+        self.started = time.perf_counter()
+
+    def update(self, game_time: pyasge.GameTime) -> None:
+        for sprite in random.sample(self.sprites, int(SPRITES * CHURN)):
+            sprite.z_order = random.randrange(LAYERS)
+
+    def render(self, game_time: pyasge.GameTime) -> None:
+        # the stats describe the previous frame, so skip the first of each mode
+        if self.frame > 0:
+            stats = self.renderer.frame_stats
+            self.sort_time += stats.queue_sort_time
+            self.batches += stats.queue_batches
+
+        for sprite in self.sprites:
+            self.renderer.render(sprite)
+
+        self.frame += 1
+        if self.frame <= FRAMES:
+            return
+
+        name = MODES[self.mode][0]
+        elapsed = time.perf_counter() - self.started
+        self.results.append(
+            (name, elapsed / self.frame * 1e3, self.sort_time / FRAMES * 1e3, self.batches / FRAMES))
+
+        self.mode += 1
+        self.frame = 0
+        if self.mode == len(MODES):
+            self.signal_exit()
+        else:
+            self.apply_mode()
+
+
+def main():
+    settings = pyasge.GameSettings()
+    settings.window_width = 1024
+    settings.window_height = 768
+    settings.vsync = pyasge.Vsync.DISABLED
+    settings.fps_limit = 1000
+
+    game = RenderQueueBenchmark(settings)
+    game.run()
+
+    print(f"{SPRITES} sprites, {CHURN:.0%} z-order churn per frame, {FRAMES} frames")
+    print(f"{'mode':<12} {'frame ms':>10} {'sort ms':>10} {'batches':>10}")
+    for name, frame_ms, sort_ms, batches in game.results:
+        print(f"{name:<12} {frame_ms:>10.2f} {sort_ms:>10.3f} {batches:>10.1f}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,61 @@
+# -*- coding: utf-8 -*-
+"""Measures the cost of turning sprites into quad vertices.
+
+Creates sprites with random positions, sizes, scales, rotations and flip
+flags, then generates their vertices with every kernel the processor
+supports via ``pyasge.sprite_vertices``. The best time per frame for each
+kernel is printed, along with whether it matched the scalar kernel bit for
+bit.
+
+Usage: python benchmarks/sprite_vertices.py [sprites] [frames]
+"""
+import sys
+import time
+
+import numpy as np
+
+import pyasge
+
+SPRITES = int(sys.argv[1]) if len(sys.argv) > 1 else 100_000
+FRAMES = int(sys.argv[2]) if len(sys.argv) > 2 else 50
+FLIPS = [
+    pyasge.Sprite.FlipFlags.NORMAL,
+    pyasge.Sprite.FlipFlags.FLIP_X,
+    pyasge.Sprite.FlipFlags.FLIP_Y,
+    pyasge.Sprite.FlipFlags.FLIP_XY,
+]
+
+
+def make_sprites(rng):
+    sprites = []
+    for x, y, size, scale, rotation, flip in zip(
+            rng.uniform(0, 4096, SPRITES), rng.uniform(0, 4096, SPRITES), rng.uniform(8, 64, SPRITES),
+            rng.uniform(0.5, 2, SPRITES), rng.uniform(-np.pi, np.pi, SPRITES), rng.integers(0, 4, SPRITES)):
+        sprite = pyasge.Sprite()
+        sprite.x, sprite.y = float(x), float(y)
+        sprite.width = sprite.height = float(size)
+        sprite.scale = float(scale)
+        sprite.rotation = float(rotation)
+        sprite.flip_flags = FLIPS[flip]
+        sprites.append(sprite)
+    return sprites
+
+
+def main():
+    sprites = make_sprites(np.random.default_rng(1))
+    reference = pyasge.sprite_vertices(sprites, "scalar").view(np.uint32)
+
+    print(f"{SPRITES} sprites, best of {FRAMES} frames")
+    print(f"{'kernel':<8} {'ms':>8} {'ns/sprite':>10} {'exact':>6}")
+    for kernel in pyasge.vertex_kernels():
+        best = float("inf")
+        for _ in range(FRAMES):
+            started = time.perf_counter()
+            vertices = pyasge.sprite_vertices(sprites, kernel)
+            best = min(best, time.perf_counter() - started)
+        exact = np.array_equal(vertices.view(np.uint32), reference)
+        print(f"{kernel:<8} {best * 1e3:>8.3f} {best / SPRITES * 1e9:>10.1f} {str(exact):>6}")
+
+
+if __name__ == "__main__":
+    main()
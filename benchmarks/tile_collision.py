@@ -0,0 +1,89 @@
+# -*- coding: utf-8 -*-
+"""Measures the cost of resolving bodies against a tile map.
+
+Scatters agents over a 512x512 map of 16 pixel tiles with a solid floor
+every few rows and solid blocks in between. Each fixed update every agent
+falls and walks left or right, and ``TileMap.move_many`` resolves them all
+against the solid tiles. The average time per update is printed.
+
+Usage: python benchmarks/tile_collision.py [agents] [updates]
+"""
+import sys
+import time
+
+import numpy as np
+
+import pyasge
+
+AGENTS = int(sys.argv[1]) if len(sys.argv) > 1 else 2_000
+UPDATES = int(sys.argv[2]) if len(sys.argv) > 2 else 1_000
+SIZE = 512
+TILE = 16
+GRAVITY = 900.0
+SPEED = 120.0
+
+
+class TileCollisionBenchmark(pyasge.ASGEGame):
+    def __init__(self, settings):
+        pyasge.ASGEGame.__init__(self, settings)
+        rng = np.random.default_rng(1)
+
+        self.map = pyasge.TileMap(self.renderer, SIZE, SIZE, TILE, TILE)
+        solid = self.map.add_tile(pyasge.Tile())
+        self.map.tileset.set_solid(solid)
+
+        cells = np.zeros((SIZE, SIZE), dtype=np.uint16)
+        cells[7::8, :] = solid
+        cells[rng.random((SIZE, SIZE)) < 0.02] = solid
+        self.map.set_tiles(cells)
+
+        self.boxes = np.zeros((AGENTS, 4), dtype=np.float32)
+        self.boxes[:, 0] = rng.uniform(0, SIZE * TILE, AGENTS)
+        self.boxes[:, 1] = rng.uniform(0, SIZE * TILE, AGENTS)
+        self.boxes[:, 2:] = (12, 20)
+        self.velocities = np.zeros((AGENTS, 2), dtype=np.float32)
+        self.velocities[:, 0] = rng.choice([-SPEED, SPEED], AGENTS)
+
+        self.elapsed = 0.0
+        self.updates = 0
+
+    def fixed_update(self, game_time: pyasge.GameTime) -> None:
+        dt = game_time.fixed_timestep
+        self.velocities[:, 1] += GRAVITY * dt
+
+        started = time.perf_counter()
+        positions, contacts = self.map.move_many(self.boxes, self.velocities * dt)
+        self.elapsed += time.perf_counter() - started
+
+        self.boxes[:, :2] = positions
+        self.velocities[(contacts & int(pyasge.TileMap.Contact.BOTTOM)) != 0, 1] = 0
+        turned = (contacts & int(pyasge.TileMap.Contact.LEFT | pyasge.TileMap.Contact.RIGHT)) != 0
+        self.velocities[turned, 0] *= -1
+
+        self.updates += 1
+        if self.updates == UPDATES:
+            self.signal_exit()
+
+    def update(self, game_time: pyasge.GameTime) -> None:
+        pass
+
+    def render(self, game_time: pyasge.GameTime) -> None:
+        pass
+
+
+def main():
+    settings = pyasge.GameSettings()
+    settings.window_width = 640
+    settings.window_height = 480
+    settings.vsync = pyasge.Vsync.DISABLED
+    settings.fixed_ts = 1000 // 60
+
+    game = TileCollisionBenchmark(settings)
+    game.run()
+
+    print(f"{AGENTS} agents, {game.updates} fixed updates")
+    print(f"move_many {game.elapsed / max(game.updates, 1) * 1e3:.3f} ms per update")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,115 @@
+# -*- coding: utf-8 -*-
+"""Measures the memory used per tile by a level.
+
+Builds a level of columns x rows cells drawn from a small palette of tiles
+twice: once as nested lists holding a ``pyasge.Tile`` per cell, the way
+levels were stored before tile maps, and once as a ``pyasge.TileMap`` whose
+cells hold 2 byte ids into a shared ``pyasge.TileSet``. The growth in
+resident memory for each layout is printed in bytes per tile, along with the
+size the tile map reports for its cells.
+
+Usage: python benchmarks/tile_memory.py [columns] [rows]
+"""
+import gc
+import os
+import sys
+
+import numpy as np
+
+import pyasge
+
+COLUMNS = int(sys.argv[1]) if len(sys.argv) > 1 else 1024
+ROWS = int(sys.argv[2]) if len(sys.argv) > 2 else 1024
+PALETTE = 64
+TILE_SIZE = 16
+
+
+def resident_bytes():
+    try:
+        import psutil
+        return psutil.Process().memory_info().rss
+    except ImportError:
+        pass
+
+    try:
+        with open("/proc/self/statm") as statm:
+            return int(statm.read().split()[1]) * os.sysconf("SC_PAGE_SIZE")
+    except OSError:
+        import resource
+        # peak rather than current, but only ever grows during the benchmark
+        return resource.getrusage(resource.RUSAGE_SELF).ru_maxrss * 1024
+
+
+class TileMemoryBenchmark(pyasge.ASGEGame):
+    def __init__(self, settings):
+        pyasge.ASGEGame.__init__(self, settings)
+        texture = self.renderer.createNonCachedTexture(
+            TILE_SIZE * PALETTE, TILE_SIZE, pyasge.Texture.Format.RGBA, None)
+
+        rng = np.random.default_rng(1)
+        layout = rng.integers(0, PALETTE, size=(ROWS, COLUMNS))
+
+        self.results = [
+            ("Tile per cell", self.measure(lambda: self.tile_lists(texture, layout))),
+            ("TileMap", self.measure(lambda: self.tile_map(texture, layout))),
+        ]
+        self.signal_exit()
+
+    @staticmethod
+    def measure(build):
+        gc.collect()
+        before = resident_bytes()
+        level = build()
+        gc.collect()
+        used = resident_bytes() - before
+        extra = level.memory if isinstance(level, pyasge.TileMap) else None
+        del level
+        return used, extra
+
+    @staticmethod
+    def make_tile(texture, index):
+        tile = pyasge.Tile()
+        tile.texture = texture
+        tile.src_rect = [index * TILE_SIZE, 0, TILE_SIZE, TILE_SIZE]
+        tile.width = TILE_SIZE
+        tile.height = TILE_SIZE
+        return tile
+
+    def tile_lists(self, texture, layout):
+        return [[self.make_tile(texture, index) for index in row] for row in layout.tolist()]
+
+    def tile_map(self, texture, layout):
+        tileset = pyasge.TileSet()
+        first = tileset.add(self.make_tile(texture, 0))
+        for index in range(1, PALETTE):
+            tileset.add(self.make_tile(texture, index))
+
+        level = pyasge.TileMap(self.renderer, COLUMNS, ROWS, TILE_SIZE, TILE_SIZE, tileset=tileset)
+        level.set_tiles((layout + first).astype(np.uint16))
+        return level
+
+    def update(self, game_time: pyasge.GameTime) -> None:
+        pass
+
+    def render(self, game_time: pyasge.GameTime) -> None:
+        pass
+
+
+def main():
+    settings = pyasge.GameSettings()
+    settings.window_width = 640
+    settings.window_height = 480
+
+    game = TileMemoryBenchmark(settings)
+    game.run()
+
+    tiles = COLUMNS * ROWS
+    print(f"{COLUMNS}x{ROWS} cells, {PALETTE} distinct tiles")
+    print(f"{'layout':<14} {'rss MB':>10} {'bytes/tile':>12} {'cells MB':>10}")
+    for name, (used, cells) in game.results:
+        cells_mb = f"{cells / 2**20:>10.2f}" if cells is not None else f"{'-':>10}"
+        print(f"{name:<14} {used / 2**20:>10.2f} {used / tiles:>12.1f} {cells_mb}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,75 @@
+# -*- coding: utf-8 -*-
+"""Measures the cost of stepping thousands of tweens each frame.
+
+Creates 5,000 sprites and moves each one back and forth along a quadratic
+curve, first with a lerp and property sets per sprite in Python, then with
+one ``pyasge.Tweener`` stepped once per frame. The average time per frame
+for each is printed.
+
+Usage: python benchmarks/tweens.py [tweens] [frames]
+"""
+import sys
+import time
+
+import pyasge
+
+TWEENS = int(sys.argv[1]) if len(sys.argv) > 1 else 5_000
+FRAMES = int(sys.argv[2]) if len(sys.argv) > 2 else 600
+DURATION = 0.5
+STEP = 1 / 60
+
+
+class TweenBenchmark(pyasge.ASGEGame):
+    def __init__(self, settings):
+        pyasge.ASGEGame.__init__(self, settings)
+        self.sprites = [pyasge.Sprite() for _ in range(TWEENS)]
+        self.results = [("python lerp", self.python_lerps()), ("Tweener", self.tweener())]
+        self.signal_exit()
+
+    def python_lerps(self):
+        elapsed = 0.0
+        started = time.perf_counter()
+        for _ in range(FRAMES):
+            elapsed += STEP
+            t = (elapsed % DURATION) / DURATION
+            if int(elapsed / DURATION) % 2:
+                t = 1 - t
+            eased = 1 - (1 - t) * (1 - t)
+            for index, sprite in enumerate(self.sprites):
+                sprite.x = index + 100 * eased
+                sprite.y = 50 * eased
+        return time.perf_counter() - started
+
+    def tweener(self):
+        tweens = pyasge.Tweener()
+        for sprite in self.sprites:
+            tweens.to(sprite, "x", 100, DURATION, ease=pyasge.Ease.QUAD_OUT, repeats=-1, yoyo=True, relative=True)
+            tweens.to(sprite, "y", 50, DURATION, ease=pyasge.Ease.QUAD_OUT, repeats=-1, yoyo=True)
+
+        started = time.perf_counter()
+        for _ in range(FRAMES):
+            tweens.update(STEP)
+        return time.perf_counter() - started
+
+    def update(self, game_time: pyasge.GameTime) -> None:
+        pass
+
+    def render(self, game_time: pyasge.GameTime) -> None:
+        pass
+
+
+def main():
+    settings = pyasge.GameSettings()
+    settings.window_width = 640
+    settings.window_height = 480
+
+    game = TweenBenchmark(settings)
+    game.run()
+
+    print(f"{TWEENS} sprites, 2 properties each, {FRAMES} frames")
+    for name, elapsed in game.results:
+        print(f"{name:<12} {elapsed / FRAMES * 1e3:>8.3f} ms per frame")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,78 @@
+# -*- coding: utf-8 -*-
+"""Measures the cost of reading the world bounds of many sprites.
+
+Creates rotated and scaled sprites and times three ways of getting their
+corners: calling ``Sprite.getWorldBounds`` per sprite, a first
+``pyasge.world_bounds`` call which fills the bounds cache, and later calls
+where only a tenth of the sprites have moved. ``pyasge.world_aabbs`` is
+timed under the same conditions.
+
+Usage: python benchmarks/world_bounds.py [sprites] [repeats]
+"""
+import sys
+import time
+
+import numpy as np
+
+import pyasge
+
+SPRITES = int(sys.argv[1]) if len(sys.argv) > 1 else 20_000
+REPEATS = int(sys.argv[2]) if len(sys.argv) > 2 else 50
+
+
+class WorldBoundsBenchmark(pyasge.ASGEGame):
+    def __init__(self, settings):
+        pyasge.ASGEGame.__init__(self, settings)
+        rng = np.random.default_rng(1)
+        self.sprites = []
+        for x, y, rotation in zip(rng.uniform(0, 4096, SPRITES), rng.uniform(0, 4096, SPRITES),
+                                  rng.uniform(0, 6.28, SPRITES)):
+            sprite = pyasge.Sprite()
+            sprite.width = 32
+            sprite.height = 24
+            sprite.x = float(x)
+            sprite.y = float(y)
+            sprite.rotation = float(rotation)
+            self.sprites.append(sprite)
+
+        self.results = [
+            ("getWorldBounds", self.time(lambda: [s.getWorldBounds() for s in self.sprites], moving=False)),
+            ("world_bounds cold", self.time(lambda: pyasge.world_bounds(self.sprites), moving=False, repeats=1)),
+            ("world_bounds 10% moved", self.time(lambda: pyasge.world_bounds(self.sprites), moving=True)),
+            ("world_aabbs 10% moved", self.time(lambda: pyasge.world_aabbs(self.sprites), moving=True)),
+        ]
+        self.signal_exit()
+
+    def time(self, query, moving, repeats=REPEATS):
+        elapsed = 0.0
+        for _ in range(repeats):
+            if moving:
+                for sprite in self.sprites[::10]:
+                    sprite.x += 1.0
+            started = time.perf_counter()
+            query()
+            elapsed += time.perf_counter() - started
+        return elapsed / repeats
+
+    def update(self, game_time: pyasge.GameTime) -> None:
+        pass
+
+    def render(self, game_time: pyasge.GameTime) -> None:
+        pass
+
+
+def main():
+    settings = pyasge.GameSettings()
+    settings.window_width = 640
+    settings.window_height = 480
+
+    game = WorldBoundsBenchmark(settings)
+    game.run()
+
+    print(f"{SPRITES} sprites")
+    for name, seconds in game.results:
+        print(f"{name:<24} {seconds * 1e3:>8.3f} ms")
+
+
+if __name__ == "__main__":
+    main()
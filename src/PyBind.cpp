@@ -22,9 +22,12 @@ namespace py = pybind11;
 
 void initGamesettings(py::module_&);
 void initGametime(py::module_&);
+void initAnimation(py::module_&);
 void initCamera(py::module&);
+void initCollisionMask(py::module_&);
 void initColours(py::module&);
 void initFont(py::module&);
+void initFrameStats(py::module_&);
 void initGame(py::module_&);
 void initGamepad(py::module&);
 void initInput(py::module_&);
@@ -32,17 +35,31 @@ void initInputEvents(py::module&);
 void initKeyMacros(py::module&);
 void initLogger(py::module&);
 void initMouseMacros(py::module&);
+void initNavGrid(py::module_&);
+void initParticleEmitter(py::module_&);
 void initPixelBuffer(py::module&);
 void initPoint2D(py::module_&);
+void initPostProcessChain(py::module_&);
 void initResolution(py::module&);
 void initRenderTarget(py::module&);
+void initRenderTargetPool(py::module_&);
 void initRenderer(py::module_&);
 void initShader(py::module&);
+void initShaderCache(py::module&);
+void initSightGrid(py::module_&);
+void initSpatialGrid(py::module_&);
 void initSprite(py::module_ &);
 void initSpritebounds(py::module&);
+void initSpriteBatch(py::module_&);
+void initStaticBatch(py::module_&);
 void initText(py::module&);
 void initTexture2D(py::module&);
 void initTile(py::module&);
+void initTiledMap(py::module_&);
+void initTileMap(py::module_&);
+void initTileSet(py::module_&);
+void initTweener(py::module_&);
+void initUniformBlock(py::module&);
 void initValue(py::module&);
 void initViewPort(py::module&);
 
@@ -66,14 +83,31 @@ PYBIND11_MODULE(pyasge, module)
   initText(module);
   initPixelBuffer(module);
   initRenderTarget(module);
+  initRenderTargetPool(module);
   initViewPort(module);
   initCamera(module);
   initShader(module);
+  initShaderCache(module);
+  initFrameStats(module);
+  initUniformBlock(module);
   initSprite(module);
   initInput(module);
   initTile(module);
   initResolution(module);
   initRenderer(module);
+  initStaticBatch(module);
+  initSpriteBatch(module);
+  initTileSet(module);
+  initTileMap(module);
+  initTiledMap(module);
+  initNavGrid(module);
+  initSightGrid(module);
+  initSpatialGrid(module);
+  initCollisionMask(module);
+  initAnimation(module);
+  initTweener(module);
+  initParticleEmitter(module);
+  initPostProcessChain(module);
   initGame(module);
 
 #ifdef VERSION_INFO
@@ -0,0 +1,422 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include <Engine/GameTime.hpp>
+#include <Engine/Logger.hpp>
+#include <Engine/OpenGL/GLSprite.hpp>
+#include <algorithm>
+#include <memory>
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <unordered_map>
+#include <vector>
+#include "extensions/Animation.hpp"
+
+namespace py = pybind11;
+
+namespace
+{
+  using Floats = py::array_t<float, py::array::c_style | py::array::forcecast>;
+  using Clip   = pyasge::AnimationClip;
+
+  /// Keeps the Python sprites being animated alive while the animator points at them.
+  class PyAnimator : public pyasge::Animator
+  {
+   public:
+    std::unordered_map<const ASGE::Sprite*, py::object> owners;
+  };
+
+  std::shared_ptr<Clip> makeClip(const Floats& rects, const Floats& durations, Clip::Loop loop, std::string name)
+  {
+    if (rects.ndim() != 2 || rects.shape(1) != 4)
+    {
+      throw py::value_error("rects must be an array of shape (N, 4)");
+    }
+
+    const auto count = static_cast<std::size_t>(rects.shape(0));
+    const auto times = static_cast<std::size_t>(durations.size());
+    if (times != 1 && times != count)
+    {
+      throw py::value_error("durations must be a single value or one per frame");
+    }
+
+    std::vector<Clip::Frame> frames(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      std::copy(rects.data() + i * 4, rects.data() + i * 4 + 4, frames[i].rect.begin());
+      frames[i].duration = durations.data()[times == 1 ? 0 : i];
+    }
+    return std::make_shared<Clip>(std::move(name), std::move(frames), loop);
+  }
+
+  ASGE::GLSprite& spriteOf(const py::object& sprite)
+  {
+    return sprite.cast<ASGE::GLSprite&>();
+  }
+}
+
+void initAnimation(py::module_& module)
+{
+  py::class_<Clip, std::shared_ptr<Clip>> clip(
+    module, "AnimationClip", py::is_final(),
+    R"(
+    A sequence of source rectangles, each shown for a set time.
+
+    Clips describe an animation without playing it, so one clip can be
+    shared by every sprite showing it. They are played on sprites by an
+    :class:`Animator`, which sets each sprite's ``src_rect`` as the clip's
+    frames change. Clips can be built from rectangles, from a grid of
+    equally sized frames, or read from a sprite sheet exported by Aseprite
+    or TexturePacker as JSON.
+
+    Example
+    -------
+    >>> clips = pyasge.AnimationClip.load_sheet("/data/hero.json")
+    >>> self.hero = pyasge.Sprite()
+    >>> self.hero.loadTexture(clips["run"].image)
+    >>> self.hero.width = 32
+    >>> self.hero.height = 32
+    >>> self.animator = pyasge.Animator()
+    >>> self.animator.play(self.hero, clips["run"])
+  )");
+
+  py::enum_<Clip::Loop>(clip, "Loop", "How a clip carries on after its last frame.")
+    .value("ONCE", Clip::Loop::ONCE, "Stops on the last frame.")
+    .value("LOOP", Clip::Loop::LOOP, "Starts again from the first frame.")
+    .value("PING_PONG", Clip::Loop::PING_PONG, "Plays backwards to the first frame, then forwards again.");
+
+  clip
+    .def(
+      py::init(&makeClip),
+      py::arg("rects"),
+      py::arg("durations") = 0.1F,
+      py::arg("loop")      = Clip::Loop::LOOP,
+      py::arg("name")      = "",
+      R"(
+      Creates a clip from the source rectangle of each frame.
+
+      :param rects: A float array of shape (N, 4) with each frame's (x, y, width, height) in the texture, in pixels.
+      :param durations: The seconds each frame is shown for, either one value for every frame or one per frame.
+      :param loop: What happens after the last frame.
+      :param name: A name for the clip.
+    )")
+
+    .def_static(
+      "from_grid",
+      [](float frame_width, float frame_height, int columns, int count, int first, float duration, Clip::Loop loop,
+         std::string name)
+      {
+        if (columns <= 0 || count < 0 || first < 0)
+        {
+          throw py::value_error("columns must be positive, and count and first not negative");
+        }
+
+        std::vector<Clip::Frame> frames(static_cast<std::size_t>(count));
+        for (int i = 0; i < count; ++i)
+        {
+          const int cell = first + i;
+          frames[i].rect = { static_cast<float>(cell % columns) * frame_width,
+                             static_cast<float>(cell / columns) * frame_height,
+                             frame_width,
+                             frame_height };
+          frames[i].duration = duration;
+        }
+        return std::make_shared<Clip>(std::move(name), std::move(frames), loop);
+      },
+      py::arg("frame_width"),
+      py::arg("frame_height"),
+      py::arg("columns"),
+      py::arg("count"),
+      py::arg("first")    = 0,
+      py::arg("duration") = 0.1F,
+      py::arg("loop")     = Clip::Loop::LOOP,
+      py::arg("name")     = "",
+      R"(
+      Creates a clip from consecutive cells of a sheet laid out in a grid.
+
+      Cells are numbered from the top left, left to right then top to bottom.
+
+      :param frame_width: The width of each cell in pixels.
+      :param frame_height: The height of each cell in pixels.
+      :param columns: The number of cells in each row of the sheet.
+      :param count: The number of frames in the clip.
+      :param first: The cell of the first frame.
+      :param duration: The seconds each frame is shown for.
+      :param loop: What happens after the last frame.
+      :param name: A name for the clip.
+
+      Example
+      -------
+      >>> walk = pyasge.AnimationClip.from_grid(32, 32, columns=8, count=6, first=8, duration=0.08)
+    )")
+
+    .def_static(
+      "load_sheet",
+      [](const std::string& path, float frame_duration)
+      {
+        std::string error;
+        auto loaded = Clip::loadSheet(path, frame_duration, error);
+        py::dict clips;
+        if (!loaded)
+        {
+          Logging::ERRORS("Unable to load sprite sheet: " + error);
+          return clips;
+        }
+
+        for (auto& loaded_clip : *loaded)
+        {
+          const auto name      = loaded_clip.name();
+          clips[py::str(name)] = std::make_shared<Clip>(std::move(loaded_clip));
+        }
+        return clips;
+      },
+      py::arg("path"),
+      py::arg("frame_duration") = 0.1F,
+      R"(
+      Reads the clips in a sprite sheet exported as JSON by Aseprite or TexturePacker.
+
+      Both the hash and array layouts are read. Aseprite sheets give a clip
+      for each tag, with its direction, or a single clip named after the
+      file if there are no tags. TexturePacker sheets give a clip for each
+      of their animations, or otherwise one for each set of frames whose
+      names only differ by a trailing number, such as ``walk_01.png`` and
+      ``walk_02.png``. Frames packed rotated can't be shown and are
+      rejected.
+
+      :param path: The JSON file, on disk or in the ASGE file system.
+      :param frame_duration: The seconds each frame is shown for when the sheet doesn't say.
+      :returns: The clips by name, each with :attr:`image` set to the sheet's image. Empty if the sheet could not be read.
+      :rtype: dict[str, AnimationClip]
+    )")
+
+    .def_property_readonly("name", &Clip::name, "The clip's name.")
+    .def_property_readonly("loop", &Clip::loop, "What happens after the last frame.")
+    .def_property_readonly(
+      "image",
+      static_cast<const std::string& (Clip::*)() const noexcept>(&Clip::image),
+      "The path of the image the frames were cut from, or empty if not known.")
+    .def_property_readonly(
+      "duration", &Clip::duration, "The seconds taken to play the clip once, or there and back for ping-pong clips.")
+
+    .def("__len__", [](const Clip& self) { return self.frames().size(); })
+
+    .def_property_readonly(
+      "rects",
+      [](const Clip& self)
+      {
+        py::array_t<float> rects({ static_cast<py::ssize_t>(self.frames().size()), py::ssize_t{ 4 } });
+        auto* out = rects.mutable_data();
+        for (const auto& frame : self.frames())
+        {
+          out = std::copy(frame.rect.begin(), frame.rect.end(), out);
+        }
+        return rects;
+      },
+      "A copy of each frame's (x, y, width, height), as a float32 array of shape (N, 4).")
+
+    .def_property_readonly(
+      "durations",
+      [](const Clip& self)
+      {
+        py::array_t<float> durations(static_cast<py::ssize_t>(self.frames().size()));
+        auto* out = durations.mutable_data();
+        for (const auto& frame : self.frames())
+        {
+          *out++ = frame.duration;
+        }
+        return durations;
+      },
+      "A copy of the seconds each frame is shown for.");
+
+  py::class_<PyAnimator>(
+    module, "Animator", py::is_final(),
+    R"(
+    Plays animation clips on many sprites in one call per frame.
+
+    Choosing a frame and writing ``src_rect`` from Python for every
+    animated sprite costs several attribute accesses per sprite per frame.
+    An animator keeps each sprite's clip, speed and play time natively, and
+    :meth:`update` advances them all together, only touching the sprites
+    whose frame has changed.
+
+    Each sprite plays one clip at a time; playing another replaces it. The
+    animator holds a reference to each sprite it animates until the sprite
+    is stopped.
+
+    Example
+    -------
+    >>> self.animator = pyasge.Animator()
+    >>> walk = pyasge.AnimationClip.from_grid(32, 32, columns=8, count=8)
+    >>> for enemy in self.enemies:
+    >>>   self.animator.play(enemy, walk, speed=random.uniform(0.8, 1.2))
+    >>>
+    >>> def update(self, game_time: pyasge.GameTime) -> None:
+    >>>   self.animator.update(game_time)
+    >>>   for sprite in self.animator.finished:
+    >>>     self.explosions.remove(sprite)
+  )")
+
+    .def(py::init<>())
+
+    .def(
+      "play",
+      [](PyAnimator& self, const py::object& sprite, std::shared_ptr<Clip> played, float speed, bool restart)
+      {
+        auto& target = spriteOf(sprite);
+        self.play(target, std::move(played), speed, restart);
+        if (self.find(target) != nullptr)
+        {
+          self.owners[&target] = sprite;
+        }
+        else
+        {
+          self.owners.erase(&target);
+        }
+      },
+      py::arg("sprite"),
+      py::arg("clip"),
+      py::arg("speed")   = 1.0F,
+      py::arg("restart") = true,
+      R"(
+      Starts playing a clip on a sprite.
+
+      The sprite's ``src_rect`` is set to the first frame straight away.
+      Playing a clip without frames stops the sprite.
+
+      :param sprite: The sprite to animate.
+      :param clip: The clip to play.
+      :param speed: How fast to play the clip, where 2 is twice as fast. Negative speeds are treated as 0.
+      :param restart: When False, a sprite already playing this clip carries on from where it is.
+    )")
+
+    .def(
+      "stop",
+      [](PyAnimator& self, const py::object& sprite)
+      {
+        auto& target = spriteOf(sprite);
+        self.owners.erase(&target);
+        return self.stop(target);
+      },
+      py::arg("sprite"),
+      "Stops animating a sprite, leaving it on its current frame. Returns False if it wasn't animated.")
+
+    .def(
+      "clear",
+      [](PyAnimator& self)
+      {
+        self.clear();
+        self.owners.clear();
+      },
+      "Stops animating every sprite.")
+
+    .def(
+      "pause",
+      [](PyAnimator& self, const py::object& sprite, bool paused)
+      {
+        if (auto* track = self.find(spriteOf(sprite)))
+        {
+          track->paused = paused;
+        }
+      },
+      py::arg("sprite"),
+      py::arg("paused") = true,
+      "Pauses or resumes a sprite's clip.")
+
+    .def(
+      "set_speed",
+      [](PyAnimator& self, const py::object& sprite, float speed)
+      {
+        if (auto* track = self.find(spriteOf(sprite)))
+        {
+          track->speed = std::max(speed, 0.0F);
+        }
+      },
+      py::arg("sprite"),
+      py::arg("speed"),
+      "Changes how fast a sprite's clip plays.")
+
+    .def(
+      "is_playing",
+      [](const PyAnimator& self, const py::object& sprite)
+      {
+        const auto* track = self.find(spriteOf(sprite));
+        return track != nullptr && !track->paused && !track->finished;
+      },
+      py::arg("sprite"),
+      "Whether a sprite has a clip that is neither paused nor finished.")
+
+    .def(
+      "frame",
+      [](const PyAnimator& self, const py::object& sprite)
+      {
+        const auto* track = self.find(spriteOf(sprite));
+        return track != nullptr ? static_cast<int>(track->frame) : -1;
+      },
+      py::arg("sprite"),
+      "The index of the frame a sprite is showing, or -1 if it isn't animated.")
+
+    .def(
+      "clip",
+      [](const PyAnimator& self, const py::object& sprite)
+      {
+        const auto* track = self.find(spriteOf(sprite));
+        return track != nullptr ? std::const_pointer_cast<Clip>(track->clip) : nullptr;
+      },
+      py::arg("sprite"),
+      "The clip a sprite is playing, or None.")
+
+    .def(
+      "update",
+      [](PyAnimator& self, const ASGE::GameTime& game_time) { self.update(game_time.deltaInSecs()); },
+      py::arg("game_time"),
+      R"(
+      Advances every clip by the frame time and updates the sprites whose frame changed.
+
+      :param game_time: The game time passed to ``update``.
+    )")
+
+    .def(
+      "update",
+      [](PyAnimator& self, double seconds) { self.update(seconds); },
+      py::arg("seconds"),
+      "Advances every clip by a number of seconds.")
+
+    .def_property_readonly(
+      "finished",
+      [](const PyAnimator& self)
+      {
+        py::list sprites;
+        for (const auto* sprite : self.finished())
+        {
+          // sprites stopped since the update are left out
+          auto owner = self.owners.find(sprite);
+          if (owner != self.owners.end())
+          {
+            sprites.append(owner->second);
+          }
+        }
+        return sprites;
+      },
+      R"(
+      The sprites whose clips played to their end during the last :meth:`update`.
+
+      Only clips that play once finish. They stay on their last frame until stopped or given another clip.
+
+      :type: list[Sprite]
+    )")
+
+    .def("__len__", &PyAnimator::size);
+}
@@ -0,0 +1,294 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include <Engine/OpenGL/GLPixelBuffer.hpp>
+#include <Engine/OpenGL/GLSprite.hpp>
+#include <Engine/OpenGL/GLTexture.hpp>
+#include <algorithm>
+#include <memory>
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <string>
+#include <vector>
+#include "extensions/CollisionMask.hpp"
+
+namespace py = pybind11;
+
+namespace
+{
+  using Bytes = py::array_t<std::uint8_t, py::array::c_style | py::array::forcecast>;
+  using Ints  = py::array_t<std::int32_t, py::array::c_style | py::array::forcecast>;
+  using Mask  = std::shared_ptr<const pyasge::CollisionMask>;
+
+  /// Builds a mask from the alpha of a texture's pixels and registers it for the texture.
+  Mask build(ASGE::GLTexture& texture, std::uint8_t threshold)
+  {
+    auto* buffer = dynamic_cast<ASGE::GLPixelBuffer*>(texture.getPixelBuffer());
+    if (buffer == nullptr)
+    {
+      throw py::value_error("the texture's pixels could not be read");
+    }
+
+    // only the monochrome alpha and RGBA formats carry an alpha channel, and it comes last
+    const auto channels = static_cast<int>(buffer->pixelFormat());
+    const int alpha     = channels == 2 || channels == 4 ? channels - 1 : -1;
+    auto mask           = std::make_shared<const pyasge::CollisionMask>(pyasge::CollisionMask::fromPixels(
+      reinterpret_cast<const std::uint8_t*>(buffer->getPixelData()),
+      static_cast<int>(buffer->getWidth()),
+      static_cast<int>(buffer->getHeight()),
+      channels,
+      alpha,
+      threshold));
+    pyasge::CollisionMask::assign(texture, mask);
+    return mask;
+  }
+
+  /// The mask registered for a sprite's texture, built on first use. Null for untextured sprites.
+  Mask maskFor(const ASGE::GLSprite& sprite)
+  {
+    auto* texture = dynamic_cast<ASGE::GLTexture*>(sprite.getTexture());
+    if (texture == nullptr)
+    {
+      return nullptr;
+    }
+
+    auto mask = pyasge::CollisionMask::find(*texture);
+    return mask != nullptr ? mask : build(*texture, 1);
+  }
+
+  std::shared_ptr<pyasge::CollisionMask> writable(Mask mask)
+  {
+    // masks are never modified once built, the holder is only non-const for pybind
+    return std::const_pointer_cast<pyasge::CollisionMask>(std::move(mask));
+  }
+}
+
+void initCollisionMask(py::module_& module)
+{
+  py::class_<pyasge::CollisionMask, std::shared_ptr<pyasge::CollisionMask>>(
+    module, "CollisionMask", py::is_final(),
+    R"(
+    A 1 bit per pixel mask of the solid pixels in a texture.
+
+    Pixel perfect hit tests need a texture's alpha, which lives on the GPU.
+    A collision mask copies it once, thresholded to a single bit per pixel
+    and packed 64 pixels to a word, so overlap tests can compare whole
+    words rather than individual pixels. Building the mask for a texture
+    also registers it, and :func:`sprite_mask_overlap` then uses it for any
+    sprite drawn with that texture.
+
+    Build masks when loading textures. A sprite whose texture has no mask
+    has one built from its alpha on first use, which stalls on a download
+    from the GPU.
+
+    Rows are indexed from the top of the texture, and row ``y`` as an
+    integer has bit ``x`` set where pixel ``(x, y)`` is solid.
+
+    Example
+    -------
+    >>> self.ship_texture = self.renderer.loadTexture("/data/ship.png")
+    >>> pyasge.CollisionMask(self.ship_texture)
+    >>>
+    >>> def fixed_update(self, game_time: pyasge.GameTime) -> None:
+    >>>   self.grid.build(self.ships)
+    >>>   pairs = self.grid.pairs()
+    >>>   hits = pairs[pyasge.sprite_mask_overlaps(self.ships, pairs)]
+  )")
+
+    .def(
+      py::init([](ASGE::GLTexture& texture, std::uint8_t threshold) { return writable(build(texture, threshold)); }),
+      py::arg("texture"),
+      py::arg("threshold") = 1,
+      R"(
+      Builds the mask for a texture from its alpha channel and registers it.
+
+      Textures without an alpha channel are solid everywhere. Building a
+      new mask for a texture replaces the one registered before.
+
+      :param texture: The texture to read. Its pixels are downloaded from the GPU.
+      :param threshold: The lowest alpha counted as solid.
+    )")
+
+    .def(
+      py::init(
+        [](const Bytes& alpha, std::uint8_t threshold)
+        {
+          if (alpha.ndim() != 2)
+          {
+            throw py::value_error("alpha must be a 2D array of shape (rows, columns)");
+          }
+          return std::make_shared<pyasge::CollisionMask>(pyasge::CollisionMask::fromPixels(
+            alpha.data(), static_cast<int>(alpha.shape(1)), static_cast<int>(alpha.shape(0)), 1, 0, threshold));
+        }),
+      py::arg("alpha"),
+      py::arg("threshold") = 1,
+      R"(
+      Builds a mask from an array of alpha values, without registering it.
+
+      :param alpha: A uint8 array of shape (rows, columns).
+      :param threshold: The lowest alpha counted as solid.
+    )")
+
+    .def_static(
+      "of",
+      [](const ASGE::GLTexture& texture) { return writable(pyasge::CollisionMask::find(texture)); },
+      py::arg("texture"),
+      "Returns the mask registered for a texture, or None.")
+
+    .def_static(
+      "forget",
+      [](const ASGE::GLTexture& texture) { pyasge::CollisionMask::forget(texture); },
+      py::arg("texture"),
+      "Removes the mask registered for a texture. Textures forget their mask themselves when freed.")
+
+    .def_property_readonly("width", &pyasge::CollisionMask::width, "The width of the mask in pixels.")
+    .def_property_readonly("height", &pyasge::CollisionMask::height, "The height of the mask in pixels.")
+    .def_property_readonly("count", &pyasge::CollisionMask::count, "The number of solid pixels.")
+    .def_property_readonly("memory", &pyasge::CollisionMask::memory, "The bytes used by the mask.")
+
+    .def(
+      "__getitem__",
+      [](const pyasge::CollisionMask& self, const std::pair<int, int>& pixel)
+      {
+        if (pixel.first < 0 || pixel.second < 0 || pixel.first >= self.width() || pixel.second >= self.height())
+        {
+          throw py::index_error(
+            "pixel (" + std::to_string(pixel.first) + ", " + std::to_string(pixel.second) + ") is outside the mask");
+        }
+        return self.test(pixel.first, pixel.second);
+      },
+      py::arg("pixel"),
+      "Whether the pixel at (x, y) is solid.")
+
+    .def(
+      "row",
+      [](const pyasge::CollisionMask& self, int y)
+      {
+        if (y < 0 || y >= self.height())
+        {
+          throw py::index_error("row " + std::to_string(y) + " is outside the mask");
+        }
+        const auto* words = self.row(y);
+        const auto bytes  = py::bytes(
+          reinterpret_cast<const char*>(words), self.stride() * sizeof(pyasge::CollisionMask::Word));
+        return py::int_(py::module_::import("builtins").attr("int").attr("from_bytes")(bytes, "little"));
+      },
+      py::arg("y"),
+      R"(
+      Returns a row of the mask as an integer bitset.
+
+      :param y: The row, counted from the top of the texture.
+      :returns: An integer with bit ``x`` set where pixel ``(x, y)`` is solid.
+    )")
+
+    .def_property_readonly(
+      "words",
+      [](const pyasge::CollisionMask& self)
+      {
+        const auto rows    = static_cast<py::ssize_t>(self.height());
+        const auto columns = static_cast<py::ssize_t>(self.stride());
+        py::array_t<std::uint64_t> words({ rows, columns });
+        std::copy(self.row(0), self.row(0) + rows * columns, words.mutable_data());
+        return words;
+      },
+      R"(
+      A copy of the packed rows, with bit ``x % 64`` of word ``x // 64`` set where pixel x of the row is solid.
+
+      :type: numpy.ndarray[numpy.uint64] of shape (height, ceil(width / 64))
+    )");
+
+  module.def(
+    "sprite_mask_overlap",
+    [](const ASGE::GLSprite& a, const ASGE::GLSprite& b)
+    {
+      const auto mask_a = maskFor(a);
+      const auto mask_b = maskFor(b);
+      return mask_a != nullptr && mask_b != nullptr && pyasge::spriteMasksOverlap(a, *mask_a, b, *mask_b);
+    },
+    py::arg("a"),
+    py::arg("b"),
+    R"(
+    Tests whether the solid pixels of two sprites overlap.
+
+    The sprites are compared as drawn, respecting their position, size,
+    scale, rotation, flip flags and source rectangle, using the
+    :class:`CollisionMask` registered for each sprite's texture. Sprites
+    whose bounds do not overlap are rejected straight away, but the test is
+    still far dearer than a box test, so it is best kept for pairs that a
+    :class:`SpatialGrid` or box check has already found overlapping.
+
+    :param a: The first sprite.
+    :param b: The second sprite.
+    :returns: True if any pixel is solid in both sprites. Sprites without a texture never overlap.
+
+    Example
+    -------
+    >>> if pyasge.sprite_mask_overlap(self.player, self.spikes):
+    >>>   self.player_hit()
+  )");
+
+  module.def(
+    "sprite_mask_overlaps",
+    [](const std::vector<ASGE::GLSprite*>& sprites, const Ints& pairs)
+    {
+      if (pairs.ndim() != 2 || pairs.shape(1) != 2)
+      {
+        throw py::value_error("pairs must be an array of shape (N, 2)");
+      }
+
+      const auto count = static_cast<std::size_t>(sprites.size());
+      const auto* ids  = pairs.data();
+      std::vector<Mask> masks(count);
+      for (py::ssize_t i = 0; i < pairs.size(); ++i)
+      {
+        const auto id = static_cast<std::size_t>(ids[i]);
+        if (ids[i] < 0 || id >= count)
+        {
+          throw py::index_error("sprite " + std::to_string(ids[i]) + " is not in the list");
+        }
+        if (masks[id] == nullptr)
+        {
+          masks[id] = maskFor(*sprites[id]);
+        }
+      }
+
+      py::array_t<bool> hits(pairs.shape(0));
+      auto* out = hits.mutable_data();
+      {
+        py::gil_scoped_release release;
+        for (py::ssize_t i = 0; i < pairs.shape(0); ++i)
+        {
+          const auto a = ids[i * 2];
+          const auto b = ids[i * 2 + 1];
+          out[i]       = masks[a] != nullptr && masks[b] != nullptr &&
+                   pyasge::spriteMasksOverlap(*sprites[a], *masks[a], *sprites[b], *masks[b]);
+        }
+      }
+      return hits;
+    },
+    py::arg("sprites"),
+    py::arg("pairs"),
+    R"(
+    Tests many pairs of sprites with :func:`sprite_mask_overlap`.
+
+    Made for the pairs returned by :meth:`SpatialGrid.pairs`, so that only
+    the sprites the broadphase found close together pay for a pixel test.
+
+    :param sprites: The sprites the pairs index into.
+    :param pairs: An int32 array of shape (N, 2) of indices into ``sprites``.
+    :returns: A bool array of length N, True where the pair's solid pixels overlap.
+  )");
+}
@@ -0,0 +1,124 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include <pybind11/pybind11.h>
+#include <string>
+#include "extensions/FrameStats.hpp"
+
+namespace py = pybind11;
+
+void initFrameStats(py::module_& module)
+{
+  py::class_<pyasge::FrameStats>(
+    module, "FrameStats", py::is_final(),
+    R"(
+    Counters describing the work done by the renderer during a frame.
+
+    The renderer collects these while the game's render function runs. Use
+    :attr:`Renderer.frame_stats` to read the counters for the most recently
+    completed frame.
+
+    Example
+    -------
+    >>> stats = self.renderer.frame_stats
+    >>> print(f"{stats.state_changes_skipped} redundant state changes")
+  )")
+
+    .def_readonly("frame", &pyasge::FrameStats::frame, "The frame the counters were collected in.")
+
+    .def_readonly(
+      "state_changes_issued",
+      &pyasge::FrameStats::state_changes_issued,
+      "The number of shader, target, viewport, projection and filter changes sent to the renderer.")
+
+    .def_readonly(
+      "state_changes_skipped",
+      &pyasge::FrameStats::state_changes_skipped,
+      "The number of state changes dropped because the requested state was already set.")
+
+    .def_readonly(
+      "queued",
+      &pyasge::FrameStats::queued,
+      "The number of draws submitted through the deferred render queue.")
+
+    .def_readonly(
+      "queue_batches",
+      &pyasge::FrameStats::queue_batches,
+      "The number of runs of queued draws sharing a shader and texture.")
+
+    .def_readonly(
+      "queue_repaired",
+      &pyasge::FrameStats::queue_repaired,
+      "The number of draws moved when incrementally sorting the render queue.")
+
+    .def_readonly(
+      "queue_sort_time",
+      &pyasge::FrameStats::queue_sort_time,
+      "The time spent sorting the render queue, in seconds.")
+
+    .def_readonly(
+      "resolves_issued",
+      &pyasge::FrameStats::resolves_issued,
+      "The number of render target attachments resolved.")
+
+    .def_readonly(
+      "resolves_skipped",
+      &pyasge::FrameStats::resolves_skipped,
+      "The number of resolves skipped because nothing was drawn since the last one.")
+
+    .def_readonly(
+      "native_draws",
+      &pyasge::FrameStats::native_draws,
+      "The number of draw calls made directly by pyasge, such as when rendering a static batch.")
+
+    .def_readonly(
+      "native_quads",
+      &pyasge::FrameStats::native_quads,
+      "The number of quads drawn by those calls.")
+
+    .def_readonly(
+      "instanced_draws",
+      &pyasge::FrameStats::instanced_draws,
+      "The number of instanced draw calls made for sprite batches and long runs of queued sprites.")
+
+    .def_readonly(
+      "instances",
+      &pyasge::FrameStats::instances,
+      "The number of sprites drawn by instanced draw calls.")
+
+    .def_readonly(
+      "stream_bytes",
+      &pyasge::FrameStats::stream_bytes,
+      "The number of bytes of vertex and instance data streamed to the GPU for particles and sprite batches.")
+
+    .def_readonly(
+      "stream_waits",
+      &pyasge::FrameStats::stream_waits,
+      "The number of times streaming had to wait for the GPU to finish with data from an earlier frame.")
+
+    .def_readonly(
+      "stream_wait_time",
+      &pyasge::FrameStats::stream_wait_time,
+      "The time spent waiting on the GPU before streaming, in seconds.")
+
+    .def("__repr__", [](const pyasge::FrameStats& self)
+    {
+      return "<pyasge.FrameStats frame=" + std::to_string(self.frame) +
+             " issued=" + std::to_string(self.state_changes_issued) +
+             " skipped=" + std::to_string(self.state_changes_skipped) +
+             " queued=" + std::to_string(self.queued) +
+             " batches=" + std::to_string(self.queue_batches) + ">";
+    });
+}
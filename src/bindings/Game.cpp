@@ -15,10 +15,12 @@
 #include <Engine/Game.hpp>
 #include <Engine/GameSettings.hpp>
 #include <Engine/OGLGame.hpp>
+#include <Engine/OpenGL/GLRenderer.hpp>
 #include <Engine/OpenGL/GLSprite.hpp>
 #include <Engine/Sprite.hpp>
 #include <pybind11/pybind11.h>
 #include <string>
+#include "extensions/RenderContext.hpp"
 namespace py = pybind11;
 
 #include <pybind11/functional.h>
@@ -38,7 +40,12 @@ class ASGEGame :
 
   ASGEGame() : ASGE::OGLGame(ASGE::GameSettings{}){};
   explicit ASGEGame(const ASGE::GameSettings& settings) : ASGE::OGLGame(settings){};
-  ~ASGEGame() override = default;
+  ~ASGEGame() override
+  {
+    // extension GL resources must go before the window and its context
+    pyasge::RenderContext::release(dynamic_cast<ASGE::GLRenderer*>(renderer.get()));
+  }
+
   void init(){};
   void update(const ASGE::GameTime& us) override
   {
@@ -52,9 +59,30 @@ class ASGEGame :
 
   void render(const ASGE::GameTime& us) override
   {
-    PYBIND11_OVERRIDE_PURE(void, ASGE::OGLGame, render, us);
+    auto* gl_renderer = dynamic_cast<ASGE::GLRenderer*>(renderer.get());
+    if (gl_renderer == nullptr)
+    {
+      renderScene(us);
+      return;
+    }
+
+    // frames are closed even if the python render raises
+    auto context = pyasge::RenderContext::get(*gl_renderer);
+    struct FrameScope
+    {
+      pyasge::RenderContext& context;
+      ~FrameScope() { context.endFrame(); }
+    } scope{ *context };
+
+    context->beginFrame(us, inputs.get());
+    renderScene(us);
   }
 
+ private:
+  void renderScene(const ASGE::GameTime& us)
+  {
+    PYBIND11_OVERRIDE_PURE_NAME(void, ASGE::OGLGame, "render", render, us);
+  }
 };
 
 
@@ -0,0 +1,299 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <string>
+#include <vector>
+#include "extensions/NavGrid.hpp"
+#include "extensions/ThreadPool.hpp"
+#include "extensions/TileMap.hpp"
+
+namespace py = pybind11;
+
+namespace
+{
+  using Cell   = pyasge::NavGrid::Cell;
+  using Cells  = py::array_t<std::int32_t, py::array::c_style | py::array::forcecast>;
+  using Floats = py::array_t<float, py::array::c_style | py::array::forcecast>;
+
+  /// Searches reuse their scratch space on each thread, pool workers included.
+  pyasge::NavGrid::Search& scratch()
+  {
+    thread_local pyasge::NavGrid::Search search;
+    return search;
+  }
+
+  void checkCell(const pyasge::NavGrid& self, const Cell& cell)
+  {
+    if (!self.contains(cell.first, cell.second))
+    {
+      throw py::index_error("cell (" + std::to_string(cell.first) + ", " + std::to_string(cell.second) +
+                            ") is outside of the grid");
+    }
+  }
+
+  void checkCosts(const pyasge::NavGrid& self, const Floats& costs)
+  {
+    if (costs.ndim() != 2 || costs.shape(0) != self.rows() || costs.shape(1) != self.columns())
+    {
+      throw py::value_error("costs must be a 2D array of shape (rows, columns)");
+    }
+  }
+
+  std::vector<Cell> toCells(const Cells& array, const char* name)
+  {
+    if (array.ndim() != 2 || array.shape(1) != 2)
+    {
+      throw py::value_error(std::string(name) + " must be an array of shape (N, 2)");
+    }
+
+    std::vector<Cell> cells(static_cast<std::size_t>(array.shape(0)));
+    const auto* data = array.data();
+    for (std::size_t i = 0; i < cells.size(); ++i)
+    {
+      cells[i] = { data[i * 2], data[i * 2 + 1] };
+    }
+    return cells;
+  }
+
+  py::array_t<std::int32_t> toArray(const std::vector<Cell>& path)
+  {
+    py::array_t<std::int32_t> array({ static_cast<py::ssize_t>(path.size()), py::ssize_t{ 2 } });
+    auto* data = array.mutable_data();
+    for (const auto& [column, row] : path)
+    {
+      *data++ = column;
+      *data++ = row;
+    }
+    return array;
+  }
+}
+
+void initNavGrid(py::module_& module)
+{
+  py::class_<pyasge::NavGrid>(
+    module, "NavGrid", py::is_final(),
+    R"(
+    A grid of movement costs for finding paths and flow fields.
+
+    Each cell holds the cost of stepping into it. A cost of 0 or less, or
+    ``inf``, blocks the cell. Units may move to the 4 neighbouring cells,
+    or with ``diagonal`` set to all 8, though never diagonally past the
+    corner of a blocked cell.
+
+    :meth:`find_path` finds a single path using A*, or jump point search
+    when every open cell costs the same, which is much faster on large open
+    maps. :meth:`find_paths` runs many queries at once across a pool of
+    worker threads with the GIL released, and :meth:`flow_field` computes,
+    in one pass, the direction every cell should move in to reach the
+    nearest of a set of goals, which suits crowds heading to one place.
+
+    Cells are given and returned as (column, row) pairs. Paths come back
+    as NumPy arrays, so converting them to world positions is a single
+    expression.
+
+    Example
+    -------
+    >>> self.nav = pyasge.NavGrid.from_tile_map(self.map)
+    >>> path = self.nav.find_path((1, 1), (40, 25))
+    >>> waypoints = (path + 0.5) * self.map.tile_width
+    >>>
+    >>> directions, distances = self.nav.flow_field([(20, 20)])
+    >>> cells = (positions // self.map.tile_width).astype(int)
+    >>> velocities = directions[cells[:, 1], cells[:, 0]] * speed
+  )")
+
+    .def(
+      py::init(
+        [](const Floats& costs, bool diagonal)
+        {
+          if (costs.ndim() != 2)
+          {
+            throw py::value_error("costs must be a 2D array of rows");
+          }
+          return new pyasge::NavGrid(
+            static_cast<int>(costs.shape(1)), static_cast<int>(costs.shape(0)), costs.data(), diagonal);
+        }),
+      py::arg("costs"),
+      py::arg("diagonal") = true,
+      R"(
+      Creates a grid from an array of costs.
+
+      :param costs: A 2D array of costs indexed by [row, column].
+      :param diagonal: Whether units may move diagonally.
+    )")
+
+    .def_static(
+      "from_tile_map",
+      [](const pyasge::TileMap& map, bool diagonal) { return new pyasge::NavGrid(map, diagonal); },
+      py::arg("tile_map"),
+      py::arg("diagonal") = true,
+      py::return_value_policy::take_ownership,
+      R"(
+      Creates a grid the size of a tile map, blocking its solid tiles.
+
+      Every other cell costs 1. The grid is a copy, so it doesn't follow
+      later changes to the map.
+
+      :param tile_map: The map to copy.
+      :param diagonal: Whether units may move diagonally.
+      :type: pyasge.NavGrid
+    )")
+
+    .def(
+      "__getitem__",
+      [](const pyasge::NavGrid& self, const Cell& cell)
+      {
+        checkCell(self, cell);
+        return self.cost(cell.first, cell.second);
+      },
+      py::arg("cell"),
+      "Returns the cost of the cell at (column, row).")
+
+    .def(
+      "__setitem__",
+      [](pyasge::NavGrid& self, const Cell& cell, float cost)
+      {
+        checkCell(self, cell);
+        self.setCost(cell.first, cell.second, cost);
+      },
+      py::arg("cell"),
+      py::arg("cost"),
+      "Sets the cost of the cell at (column, row).")
+
+    .def_property(
+      "costs",
+      [](const pyasge::NavGrid& self)
+      {
+        py::array_t<float> costs({ self.rows(), self.columns() });
+        self.copy(costs.mutable_data());
+        return costs;
+      },
+      [](pyasge::NavGrid& self, const Floats& costs)
+      {
+        checkCosts(self, costs);
+        self.assign(costs.data());
+      },
+      R"(
+      The cost of every cell.
+
+      :getter: Returns a copy of the costs indexed by [row, column].
+      :setter: Replaces every cost. The array's shape must match the grid's.
+      :type: numpy.ndarray[numpy.float32]
+    )")
+
+    .def(
+      "find_path",
+      [](const pyasge::NavGrid& self, const Cell& start, const Cell& goal)
+      {
+        std::vector<Cell> path;
+        {
+          py::gil_scoped_release release;
+          self.findPath(start, goal, path, scratch());
+        }
+        return toArray(path);
+      },
+      py::arg("start"),
+      py::arg("goal"),
+      R"(
+      Finds the cheapest path between two cells.
+
+      :param start: The (column, row) to start from.
+      :param goal: The (column, row) to reach.
+      :returns: An int32 array of shape (N, 2) holding every cell from start to goal, or with no rows when there is no path.
+      :type: numpy.ndarray[numpy.int32]
+    )")
+
+    .def(
+      "find_paths",
+      [](const pyasge::NavGrid& self, const Cells& starts, const Cells& goals)
+      {
+        const auto from = toCells(starts, "starts");
+        const auto to   = toCells(goals, "goals");
+        if (from.size() != to.size())
+        {
+          throw py::value_error("starts and goals must have the same number of rows");
+        }
+
+        std::vector<std::vector<Cell>> paths(from.size());
+        {
+          py::gil_scoped_release release;
+          pyasge::ThreadPool::instance().parallelFor(
+            paths.size(),
+            4,
+            [&](std::size_t begin, std::size_t end, std::size_t /*slot*/)
+            {
+              for (auto i = begin; i < end; ++i)
+              {
+                self.findPath(from[i], to[i], paths[i], scratch());
+              }
+            });
+        }
+
+        py::list results;
+        for (const auto& path : paths)
+        {
+          results.append(toArray(path));
+        }
+        return results;
+      },
+      py::arg("starts"),
+      py::arg("goals"),
+      R"(
+      Finds a path for each pair of start and goal cells, in parallel.
+
+      The searches run on a pool of worker threads with the GIL released,
+      so other Python threads keep running until they finish.
+
+      :param starts: An int32 array of shape (N, 2) of cells to start from.
+      :param goals: An int32 array of shape (N, 2) of cells to reach.
+      :returns: A list of N paths, each as returned by :meth:`find_path`.
+      :type: list[numpy.ndarray[numpy.int32]]
+
+      Example
+      -------
+      >>> paths = self.nav.find_paths(enemy_cells, numpy.tile(player_cell, (len(enemy_cells), 1)))
+    )")
+
+    .def(
+      "flow_field",
+      [](const pyasge::NavGrid& self, const Cells& goals)
+      {
+        const auto targets = toCells(goals, "goals");
+        py::array_t<float> directions({ self.rows(), self.columns(), 2 });
+        py::array_t<float> distances({ self.rows(), self.columns() });
+        auto* direction = directions.mutable_data();
+        auto* distance  = distances.mutable_data();
+        {
+          py::gil_scoped_release release;
+          self.flowField(targets, distance, direction);
+        }
+        return py::make_tuple(directions, distances);
+      },
+      py::arg("goals"),
+      R"(
+      Finds the way to the nearest goal from every cell at once.
+
+      :param goals: An int32 array of shape (N, 2) of goal cells.
+      :returns: A float32 array of shape (rows, columns, 2) holding, for each cell, the unit (x, y) direction of its next step, and a float32 array of shape (rows, columns) holding the cost of reaching a goal. Goals and cells that can't reach one have no direction, and the latter an infinite cost.
+      :type: tuple[numpy.ndarray[numpy.float32], numpy.ndarray[numpy.float32]]
+    )")
+
+    .def_property_readonly("columns", &pyasge::NavGrid::columns, "The width of the grid in cells.")
+    .def_property_readonly("rows", &pyasge::NavGrid::rows, "The height of the grid in cells.")
+    .def_property_readonly("diagonal", &pyasge::NavGrid::diagonal, "Whether units may move diagonally.");
+}
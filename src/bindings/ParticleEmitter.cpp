@@ -0,0 +1,358 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include <Engine/Colours.hpp>
+#include <Engine/GameTime.hpp>
+#include <Engine/OpenGL/GLRenderer.hpp>
+#include <Engine/OpenGL/GLTexture.hpp>
+#include <array>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <utility>
+#include "extensions/ParticleEmitter.hpp"
+
+namespace py = pybind11;
+
+namespace
+{
+  using pyasge::ParticleEmitter;
+  using Pair = std::pair<float, float>;
+
+  /// Keeps the emitter's texture alive while it is drawn with.
+  class PyParticleEmitter : public ParticleEmitter
+  {
+   public:
+    using ParticleEmitter::ParticleEmitter;
+    py::object texture_owner;
+  };
+
+  Pair toPair(const ParticleEmitter::Range& range)
+  {
+    return { range.min, range.max };
+  }
+
+  ParticleEmitter::Range toRange(const Pair& pair)
+  {
+    return { pair.first, pair.second };
+  }
+}
+
+void initParticleEmitter(py::module_& module)
+{
+  py::class_<PyParticleEmitter> emitter(
+    module, "ParticleEmitter", py::is_final(),
+    R"(
+    A pool of particles simulated and drawn natively.
+
+    Particles are spawned around the emitter's position in a :class:`Shape`,
+    given a random lifetime, speed, direction and spin from the configured
+    ranges, and are then pulled by gravity and slowed by drag. Their size,
+    colour and opacity move from their start to their end values over their
+    life. Use a texture, or a region of an atlas with :attr:`src_rect`, to
+    draw them; without one they are drawn as solid squares.
+
+    The particles are stored as plain arrays of floats and updated in a
+    tight native loop, split across worker threads for large emitters, and
+    every live particle is drawn with a single call. Particles are placed in
+    the world when they spawn, so moving the emitter leaves the existing
+    ones behind, as a trail would.
+
+    Emitters draw straight away rather than being batched by the renderer,
+    so an emitter appears above anything already drawn and beneath any
+    sprite rendered in the same frame.
+
+    Example
+    -------
+    >>> self.sparks = pyasge.ParticleEmitter(self.renderer, 20000)
+    >>> self.sparks.texture = self.renderer.loadTexture("/data/spark.png")
+    >>> self.sparks.shape = pyasge.ParticleEmitter.Shape.CIRCLE
+    >>> self.sparks.extent = (8, 8)
+    >>> self.sparks.lifetime = (0.4, 0.9)
+    >>> self.sparks.speed = (120, 320)
+    >>> self.sparks.gravity = (0, 600)
+    >>> self.sparks.size = (6, 1)
+    >>> self.sparks.colours = (pyasge.COLOURS.YELLOW, pyasge.COLOURS.RED)
+    >>> self.sparks.additive = True
+    >>> self.sparks.emitting = False
+    >>>
+    >>> def explode(self, x, y):
+    >>>   self.sparks.x, self.sparks.y = x, y
+    >>>   self.sparks.emit(500)
+    >>>
+    >>> def update(self, game_time: pyasge.GameTime) -> None:
+    >>>   self.sparks.update(game_time)
+    >>>
+    >>> def render(self, game_time: pyasge.GameTime) -> None:
+    >>>   self.sparks.render()
+  )");
+
+  py::enum_<ParticleEmitter::Shape>(emitter, "Shape", "The area new particles are spawned in.")
+    .value("POINT", ParticleEmitter::Shape::POINT, "At the emitter's position.")
+    .value("CIRCLE", ParticleEmitter::Shape::CIRCLE, "Anywhere inside a circle with a radius of extent[0].")
+    .value("RING", ParticleEmitter::Shape::RING, "On the edge of a circle with a radius of extent[0].")
+    .value(
+      "RECTANGLE", ParticleEmitter::Shape::RECTANGLE,
+      "Anywhere inside a rectangle, extent[0] wide and extent[1] high, centred on the emitter.")
+    .value("LINE", ParticleEmitter::Shape::LINE, "Along a horizontal line extent[0] long, centred on the emitter.");
+
+  emitter
+    .def(
+      py::init<ASGE::GLRenderer&, std::size_t>(),
+      py::arg("renderer"),
+      py::arg("capacity") = 10000,
+      R"(
+      Creates an empty emitter.
+
+      :param renderer: The renderer the particles are drawn with.
+      :param capacity: The most particles alive at once. Particles that would exceed it are not spawned.
+    )")
+
+    .def(
+      "emit",
+      &PyParticleEmitter::emit,
+      py::arg("count"),
+      R"(
+      Spawns a burst of particles straight away.
+
+      :param count: The number of particles to spawn.
+      :returns: The number spawned, fewer than asked for when the emitter is full.
+    )")
+
+    .def(
+      "update",
+      [](PyParticleEmitter& self, const ASGE::GameTime& game_time)
+      {
+        self.update(static_cast<float>(game_time.deltaInSecs()));
+      },
+      py::arg("game_time"),
+      R"(
+      Advances the particles by the frame time.
+
+      Particles are moved, those that have reached the end of their life
+      are removed, and then new particles are spawned at :attr:`rate`.
+
+      :param game_time: The game time passed to ``update``.
+    )")
+
+    .def(
+      "update",
+      &PyParticleEmitter::update,
+      py::arg("seconds"),
+      "Advances the particles by a number of seconds.")
+
+    .def(
+      "render",
+      &PyParticleEmitter::render,
+      R"(
+      Draws every live particle with one call, using the current camera view and viewport.
+
+      :returns: True if anything was drawn.
+      :type: bool
+    )")
+
+    .def("clear", &PyParticleEmitter::clear, "Removes every particle.")
+
+    .def(
+      "seed",
+      &PyParticleEmitter::seed,
+      py::arg("value"),
+      "Seeds the random numbers particles are spawned with, so effects can be repeated exactly.")
+
+    .def("__len__", &PyParticleEmitter::size)
+
+    .def_property_readonly("capacity", &PyParticleEmitter::capacity, "The most particles alive at once.")
+
+    .def_readwrite("x", &PyParticleEmitter::x, "The x position new particles are spawned around.")
+    .def_readwrite("y", &PyParticleEmitter::y, "The y position new particles are spawned around.")
+
+    .def_readwrite(
+      "emitting",
+      &PyParticleEmitter::emitting,
+      "Whether :meth:`update` spawns particles at :attr:`rate`. Bursts from :meth:`emit` are unaffected.")
+
+    .def_readwrite(
+      "additive",
+      &PyParticleEmitter::additive,
+      "Whether particles add to the colour beneath them, brightening it, rather than blending over it.")
+
+    .def_readwrite(
+      "threaded",
+      &PyParticleEmitter::threaded,
+      "Whether updates of tens of thousands of particles are split across worker threads.")
+
+    .def_property(
+      "texture",
+      [](const PyParticleEmitter& self) { return self.texture_owner; },
+      [](PyParticleEmitter& self, py::object texture)
+      {
+        self.setTexture(texture.is_none() ? nullptr : texture.cast<ASGE::GLTexture*>());
+        self.texture_owner = std::move(texture);
+      },
+      R"(
+      The texture particles are drawn with, or None to draw solid squares.
+
+      :type: pyasge.Texture
+    )")
+
+    .def_property(
+      "src_rect",
+      [](const PyParticleEmitter& self) { return self.src_rect; },
+      [](PyParticleEmitter& self, const std::array<float, 4>& rect) { self.src_rect = rect; },
+      R"(
+      The region of the texture to draw, as x, y, width and height in pixels.
+
+      A rectangle without an area draws the whole texture.
+
+      :type: list[float]
+    )")
+
+    .def_property(
+      "shape",
+      [](const PyParticleEmitter& self) { return self.settings().shape; },
+      [](PyParticleEmitter& self, ParticleEmitter::Shape shape) { self.settings().shape = shape; },
+      "The :class:`Shape` new particles are spawned in.")
+
+    .def_property(
+      "extent",
+      [](const PyParticleEmitter& self) { return self.settings().extent; },
+      [](PyParticleEmitter& self, const std::array<float, 2>& extent) { self.settings().extent = extent; },
+      R"(
+      The size of the spawn shape: a radius, or a width and height.
+
+      :type: tuple[float, float]
+    )")
+
+    .def_property(
+      "rate",
+      [](const PyParticleEmitter& self) { return self.settings().rate; },
+      [](PyParticleEmitter& self, float rate) { self.settings().rate = rate; },
+      "The number of particles spawned per second while emitting.")
+
+    .def_property(
+      "lifetime",
+      [](const PyParticleEmitter& self) { return toPair(self.settings().lifetime); },
+      [](PyParticleEmitter& self, const Pair& range) { self.settings().lifetime = toRange(range); },
+      R"(
+      The shortest and longest time, in seconds, a particle lives for.
+
+      :type: tuple[float, float]
+    )")
+
+    .def_property(
+      "speed",
+      [](const PyParticleEmitter& self) { return toPair(self.settings().speed); },
+      [](PyParticleEmitter& self, const Pair& range) { self.settings().speed = toRange(range); },
+      R"(
+      The slowest and fastest speed, in units per second, particles spawn with.
+
+      :type: tuple[float, float]
+    )")
+
+    .def_property(
+      "direction",
+      [](const PyParticleEmitter& self) { return self.settings().direction; },
+      [](PyParticleEmitter& self, float radians) { self.settings().direction = radians; },
+      "The direction particles travel in, in radians clockwise from the x axis.")
+
+    .def_property(
+      "spread",
+      [](const PyParticleEmitter& self) { return self.settings().spread; },
+      [](PyParticleEmitter& self, float radians) { self.settings().spread = radians; },
+      "The arc, in radians and centred on :attr:`direction`, particles travel within. Defaults to every direction.")
+
+    .def_property(
+      "rotation",
+      [](const PyParticleEmitter& self) { return toPair(self.settings().rotation); },
+      [](PyParticleEmitter& self, const Pair& range) { self.settings().rotation = toRange(range); },
+      R"(
+      The range of angles, in radians, particles spawn at.
+
+      :type: tuple[float, float]
+    )")
+
+    .def_property(
+      "spin",
+      [](const PyParticleEmitter& self) { return toPair(self.settings().spin); },
+      [](PyParticleEmitter& self, const Pair& range) { self.settings().spin = toRange(range); },
+      R"(
+      The range of speeds, in radians per second, particles turn at.
+
+      :type: tuple[float, float]
+    )")
+
+    .def_property(
+      "gravity",
+      [](const PyParticleEmitter& self) { return self.settings().gravity; },
+      [](PyParticleEmitter& self, const std::array<float, 2>& gravity) { self.settings().gravity = gravity; },
+      R"(
+      The acceleration, in units per second squared, applied to every particle.
+
+      :type: tuple[float, float]
+    )")
+
+    .def_property(
+      "drag",
+      [](const PyParticleEmitter& self) { return self.settings().drag; },
+      [](PyParticleEmitter& self, float drag) { self.settings().drag = drag; },
+      "The fraction of their velocity particles lose each second.")
+
+    .def_property(
+      "size",
+      [](const PyParticleEmitter& self) { return self.settings().size; },
+      [](PyParticleEmitter& self, const std::array<float, 2>& size) { self.settings().size = size; },
+      R"(
+      The width of a particle when it spawns and when it dies.
+
+      Particles keep the proportions of the region of the texture they
+      draw, so their height follows from it. Untextured particles are square.
+
+      :type: tuple[float, float]
+    )")
+
+    .def_property(
+      "colours",
+      [](const PyParticleEmitter& self)
+      {
+        const auto& start = self.settings().colour_start;
+        const auto& end   = self.settings().colour_end;
+        return std::make_pair(ASGE::Colour(start[0], start[1], start[2]), ASGE::Colour(end[0], end[1], end[2]));
+      },
+      [](PyParticleEmitter& self, const std::pair<ASGE::Colour, ASGE::Colour>& colours)
+      {
+        auto& settings        = self.settings();
+        settings.colour_start = { colours.first.r, colours.first.g, colours.first.b, settings.colour_start[3] };
+        settings.colour_end   = { colours.second.r, colours.second.g, colours.second.b, settings.colour_end[3] };
+      },
+      R"(
+      The tint of a particle when it spawns and when it dies.
+
+      :type: tuple[pyasge.Colour, pyasge.Colour]
+    )")
+
+    .def_property(
+      "opacity",
+      [](const PyParticleEmitter& self)
+      { return std::make_pair(self.settings().colour_start[3], self.settings().colour_end[3]); },
+      [](PyParticleEmitter& self, const Pair& opacity)
+      {
+        self.settings().colour_start[3] = opacity.first;
+        self.settings().colour_end[3]   = opacity.second;
+      },
+      R"(
+      The opacity of a particle when it spawns and when it dies. Defaults to fading out.
+
+      :type: tuple[float, float]
+    )");
+}
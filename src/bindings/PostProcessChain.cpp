@@ -0,0 +1,153 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include <Engine/OpenGL/GLRenderTarget.hpp>
+#include <Engine/OpenGL/GLRenderer.hpp>
+#include <Engine/OpenGL/GLShader.hpp>
+#include <Engine/OpenGL/GLTexture.hpp>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include "extensions/PostProcessChain.hpp"
+
+namespace py = pybind11;
+
+void initPostProcessChain(py::module_& module)
+{
+  py::class_<pyasge::PostProcessChain>(
+    module, "PostProcessChain", py::is_final(),
+    R"(
+    Applies a sequence of shader passes to the rendered scene.
+
+    Effects such as bloom or blur are made of several passes, each drawing
+    the previous pass's output through a pixel shader. The chain manages the
+    intermediate render targets for you: each pass renders into a target
+    sized by its scale factor relative to the chain's input, so a pass with a
+    scale of 0.5 or 0.25 runs at a half or quarter of the resolution. Targets
+    are taken from the renderer's :class:`RenderTargetPool` and returned as
+    soon as the next pass has used them, so passes of the same size ping-pong
+    between two targets. The final pass always draws at the output's size.
+
+    Render the scene between :meth:`begin` and :meth:`end`, or run the chain
+    over an existing texture using :meth:`apply`.
+
+    Example
+    -------
+    >>> self.bloom = pyasge.PostProcessChain(self.renderer)
+    >>> self.bloom.add_pass(self.renderer.loadPixelShader("/data/shaders/bright.frag"), 0.5)
+    >>> self.bloom.add_pass(self.renderer.loadPixelShader("/data/shaders/blur_h.frag"), 0.25)
+    >>> self.bloom.add_pass(self.renderer.loadPixelShader("/data/shaders/blur_v.frag"), 0.25)
+    >>> self.bloom.add_pass(self.renderer.loadPixelShader("/data/shaders/tonemap.frag"))
+    >>>
+    >>> def render(self, game_time: pyasge.GameTime) -> None:
+    >>>   self.bloom.begin()
+    >>>   self.renderer.render(self.background)
+    >>>   self.renderer.render(self.player)
+    >>>   self.bloom.end()
+  )")
+
+    .def(
+      py::init<ASGE::GLRenderer&, ASGE::Texture2D::Format>(),
+      py::arg("renderer"),
+      py::arg("format") = ASGE::Texture2D::Format::RGBA,
+      py::keep_alive<1, 2>(),
+      R"(
+      Creates an empty chain.
+
+      :param renderer: The renderer the chain draws with.
+      :param format: The format of the chain's intermediate targets.
+    )")
+
+    .def(
+      "add_pass",
+      [](pyasge::PostProcessChain& self, ASGE::SHADER_LIB::GLShader* shader, float scale)
+      {
+        if (!self.add(shader, scale))
+        {
+          throw py::value_error("scale must lie between 1/64 and 4");
+        }
+      },
+      py::arg("shader"),
+      py::arg("scale") = 1.0F,
+      py::keep_alive<1, 2>(),
+      R"(
+      Appends a pass to the chain.
+
+      :param shader: The pixel shader used to draw the previous pass's output.
+      :param scale: The size of the pass's target relative to the chain's input, from 1/64 to 4.
+      :raises ValueError: If the scale is out of range.
+    )")
+
+    .def_property_readonly(
+      "passes",
+      [](const pyasge::PostProcessChain& self)
+      {
+        py::list passes;
+        for (const auto& pass : self.passes())
+        {
+          passes.append(py::make_tuple(py::cast(pass.shader, py::return_value_policy::reference), pass.scale));
+        }
+        return passes;
+      },
+      R"(
+      The chain's passes in the order they are run.
+
+      :getter: Returns a list of (shader, scale) tuples.
+      :type: list[tuple[pyasge.Shader, float]]
+    )")
+
+    .def("clear", &pyasge::PostProcessChain::clear, "Removes every pass from the chain.")
+
+    .def(
+      "begin",
+      &pyasge::PostProcessChain::begin,
+      R"(
+      Redirects rendering into the chain's input target.
+
+      The input is the size of the current viewport and uses the current
+      camera view, so the scene renders exactly as it would on screen.
+
+      :returns: True if rendering has been redirected.
+      :type: bool
+    )")
+
+    .def(
+      "end",
+      &pyasge::PostProcessChain::end,
+      py::arg("target") = nullptr,
+      R"(
+      Runs the chain over everything rendered since :meth:`begin`.
+
+      :param target: The render target to draw the result into, or None for the screen.
+      :returns: True if the chain ran.
+      :type: bool
+    )")
+
+    .def(
+      "apply",
+      &pyasge::PostProcessChain::run,
+      py::arg("texture"),
+      py::arg("target") = nullptr,
+      R"(
+      Runs the chain over a texture.
+
+      Pass scales are relative to the size of the texture. When drawing to
+      the screen, the result covers the current camera view.
+
+      :param texture: The texture given to the first pass.
+      :param target: The render target to draw the result into, or None for the screen.
+      :returns: True if the chain ran.
+      :type: bool
+    )");
+}
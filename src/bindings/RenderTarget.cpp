@@ -17,11 +17,26 @@
 #include <Engine/OpenGL/GLTexture.hpp>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include "extensions/TargetTracker.hpp"
 namespace py = pybind11;
 
+namespace
+{
+  /// Targets owned by python are forgotten by the tracker when destroyed, so
+  /// a new target allocated at the same address does not inherit its state.
+  struct RenderTargetDeleter
+  {
+    void operator()(ASGE::GLRenderTarget* target) const
+    {
+      pyasge::TargetTracker::instance().forget(target);
+      delete target;
+    }
+  };
+}
+
 void initRenderTarget(py::module_& module)
 {
-  py::class_<ASGE::GLRenderTarget>(
+  py::class_<ASGE::GLRenderTarget, std::unique_ptr<ASGE::GLRenderTarget, RenderTargetDeleter>>(
     module, "RenderTarget", py::is_final(),
     R"(
     An offscreen render target.
@@ -84,7 +99,10 @@ void initRenderTarget(py::module_& module)
 
           Warning
           -------
-          You need to call resolve to sample the buffers correctly.
+          You need to call resolve to sample the buffers correctly. Resolving
+          a target that has not been bound or drawn into since its last
+          resolve does nothing, so it is cheap to resolve every frame. Set
+          :attr:`auto_resolve` to have it done when the texture is drawn.
 
           Example
           -------
@@ -105,7 +123,7 @@ void initRenderTarget(py::module_& module)
       .def(
           "resolve",
           [](ASGE::GLRenderTarget &self, int index) {
-            return self.resolve(static_cast<unsigned int>(index));
+            return pyasge::TargetTracker::instance().resolve(self, static_cast<unsigned int>(index));
           },
           py::return_value_policy::reference_internal, R"(
           Resolves the MSAA texture at specified index.
@@ -115,6 +133,10 @@ void initRenderTarget(py::module_& module)
           multiple color attachments, this function allows the user to specify
           which attachment to specifically update.
 
+          The attachment is only blitted if the target has been bound or
+          drawn into since it was last resolved, otherwise the existing
+          texture is returned as is.
+
           :param index: The index of the attachment to resolve. A count of 1 is index 0.
           :returns: A handle to the resultant updated textures.
           :type: Texture
@@ -127,7 +149,8 @@ void initRenderTarget(py::module_& module)
       .def(
           "resolve",
           [](ASGE::GLRenderTarget &self) {
-            auto &resolved = self.resolve();
+            pyasge::TargetTracker::instance().resolveAll(self);
+            auto &resolved = self.getResolved();
 
             std::vector<ASGE::GLTexture *> list;
             list.reserve(resolved.size());
@@ -143,7 +166,8 @@ void initRenderTarget(py::module_& module)
           "blited" in to a standard 2D texture. As render targets may have
           multiple color attachments, this function loops through all
           attachments and resolves them into textured that can then be used in
-          normal samplers in the fragment shader.
+          normal samplers in the fragment shader. Nothing is blitted if every
+          attachment is already up to date.
 
           :returns: A list of all the resultant updated texture.
           :type: list[Texture]
@@ -151,5 +175,27 @@ void initRenderTarget(py::module_& module)
           .. warning:: You need to call resolve to sample the buffers correctly.
 
           .. seealso:: :class:`Texture`
+      )")
+
+      .def_property(
+          "auto_resolve",
+          [](const ASGE::GLRenderTarget &self) { return pyasge::TargetTracker::instance().autoResolve(&self); },
+          [](ASGE::GLRenderTarget &self, bool enable) { pyasge::TargetTracker::instance().setAutoResolve(&self, enable); },
+          R"(
+          Resolves the target automatically when one of its textures is drawn.
+
+          When enabled, rendering a sprite or texture that samples one of the
+          target's :attr:`buffers` resolves that attachment first, but only if
+          the target was bound or drawn into since it was last resolved. This
+          suits targets that change rarely, such as a UI layer, as they no
+          longer need resolving by hand every frame.
+
+          :type: bool
+
+          Example
+          -------
+            >>> self.ui_target.auto_resolve = True
+            >>> self.ui_sprite.attach(self.ui_target.buffers[0])
+            >>> self.renderer.render(self.ui_sprite)
       )");
 }
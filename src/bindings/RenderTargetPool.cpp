@@ -0,0 +1,109 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include <pybind11/pybind11.h>
+#include "extensions/RenderTargetPool.hpp"
+
+namespace py = pybind11;
+
+void initRenderTargetPool(py::module_& module)
+{
+  py::class_<pyasge::RenderTargetPool>(
+    module, "RenderTargetPool", py::is_final(),
+    R"(
+    Reuses render targets between passes and across frames.
+
+    Creating a :class:`RenderTarget` allocates a frame buffer and its
+    textures, so effects that create and drop intermediate targets cause
+    allocation spikes and fragment video memory. Targets acquired through
+    :meth:`Renderer.acquire_target` are returned to the renderer's pool when
+    released and handed out again to the next request with the same size
+    and format. Released targets that go unused for :attr:`trim_frames`
+    frames are destroyed, unless python still holds a reference to them.
+
+    Example
+    -------
+    >>> pool = self.renderer.target_pool
+    >>> print(f"{pool.hit_rate:.0%} hits, {pool.memory / 2**20:.1f} MiB held")
+  )")
+
+    .def_property(
+      "trim_frames",
+      &pyasge::RenderTargetPool::trimFrames,
+      &pyasge::RenderTargetPool::setTrimFrames,
+      R"(
+      The number of frames since its release that a target is kept for before being destroyed.
+
+      :type: int
+    )")
+
+    .def_property_readonly(
+      "hits",
+      [](const pyasge::RenderTargetPool& self) { return self.statistics().hits; },
+      "The number of requests served by a pooled target.")
+
+    .def_property_readonly(
+      "misses",
+      [](const pyasge::RenderTargetPool& self) { return self.statistics().misses; },
+      "The number of requests that had to create a new target.")
+
+    .def_property_readonly(
+      "hit_rate",
+      [](const pyasge::RenderTargetPool& self)
+      {
+        const auto& stats   = self.statistics();
+        const auto requests = stats.hits + stats.misses;
+        return requests > 0 ? static_cast<double>(stats.hits) / static_cast<double>(requests) : 0.0;
+      },
+      "The fraction of requests served by a pooled target.")
+
+    .def_property_readonly(
+      "trimmed",
+      [](const pyasge::RenderTargetPool& self) { return self.statistics().trimmed; },
+      "The number of targets destroyed after going unused.")
+
+    .def_property_readonly(
+      "targets",
+      [](const pyasge::RenderTargetPool& self) { return self.statistics().targets; },
+      "The number of targets owned by the pool, whether acquired or not.")
+
+    .def_property_readonly(
+      "in_use",
+      [](const pyasge::RenderTargetPool& self) { return self.statistics().in_use; },
+      "The number of targets currently acquired.")
+
+    .def_property_readonly(
+      "memory",
+      [](const pyasge::RenderTargetPool& self) { return self.statistics().bytes; },
+      R"(
+      The estimated video memory held by the pool's targets, in bytes.
+
+      Each target is counted as a multisampled colour attachment and the
+      texture it resolves into. The number of samples is chosen by the driver,
+      so the multisampled attachment is counted as a single sample.
+
+      :type: int
+    )")
+
+    .def(
+      "clear",
+      &pyasge::RenderTargetPool::clear,
+      R"(
+      Destroys every target that is neither acquired nor still referenced from python.
+
+      :returns: The number of targets destroyed.
+      :type: int
+    )");
+}
@@ -4,11 +4,177 @@
 #include <Engine/OpenGL/GLRenderer.hpp>
 #include <Engine/OpenGL/GLSprite.hpp>
 #include <Engine/Renderer.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
 #include <filesystem>
+#include <memory>
+#include <fstream>
+#include <optional>
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <sstream>
+#include "extensions/RenderContext.hpp"
+#include "extensions/StaticBatch.hpp"
+#include "extensions/TargetTracker.hpp"
 namespace py = pybind11;
 
+namespace {
+  /// Returns the renderer's context if it is mid-frame. Outside of a frame
+  /// the engine's state is not known, so requests are always forwarded.
+  pyasge::RenderContext* activeContext(ASGE::GLRenderer& renderer)
+  {
+    auto* context = pyasge::RenderContext::active();
+    return context != nullptr && &context->renderer() == &renderer ? context : nullptr;
+  }
+
+  /// Checks a state change against the state cache. Changes that need to be
+  /// forwarded first flush any queued draws, as those were made using the
+  /// previous state.
+  template <typename Request>
+  bool requestState(ASGE::GLRenderer& renderer, Request&& request)
+  {
+    auto* context = activeContext(renderer);
+    if (context == nullptr)
+    {
+      return true;
+    }
+
+    if (!request(context->stateCache()))
+    {
+      return false;
+    }
+
+    context->flushQueue();
+    return true;
+  }
+
+  /// Returns the queue draws should be added to, or nullptr to draw them now.
+  pyasge::RenderQueue* renderQueue(ASGE::GLRenderer& renderer)
+  {
+    auto* context = activeContext(renderer);
+    return context != nullptr && context->deferred() ? &context->renderQueue() : nullptr;
+  }
+
+  /// Keeps FrameData in step with a camera or viewport the engine has just been given.
+  void refreshView(ASGE::GLRenderer& renderer)
+  {
+    if (auto* context = activeContext(renderer))
+    {
+      context->refreshView();
+    }
+  }
+
+  /// Records a draw handed straight to the engine, which may still be holding
+  /// it in a batch when the queue is flushed.
+  void engineDrew(ASGE::GLRenderer& renderer)
+  {
+    if (auto* context = activeContext(renderer))
+    {
+      context->engineDrew();
+    }
+  }
+
+  /// Records a draw into the bound render target, first resolving the texture
+  /// being drawn if it belongs to an auto-resolving target.
+  void track(const ASGE::Texture2D* texture)
+  {
+    auto& tracker = pyasge::TargetTracker::instance();
+    tracker.sampled(texture);
+    tracker.drawn();
+  }
+
+  /// Pooled targets are handed to python by reference, so the pool must not
+  /// destroy one while its wrapper is still alive.
+  bool wrapped(const ASGE::GLRenderTarget* target)
+  {
+    static const auto* type = py::detail::get_type_info(typeid(ASGE::GLRenderTarget));
+    return type != nullptr && py::detail::get_object_handle(target, type) != nullptr;
+  }
+
+  /// Returns the python object owning item, so a queued draw can keep it alive.
+  template <typename T>
+  py::object anchor(const T& item)
+  {
+    return py::cast(&item, py::return_value_policy::reference);
+  }
+
+  void resetState(ASGE::GLRenderer& renderer)
+  {
+    if (auto* context = activeContext(renderer))
+    {
+      context->flushQueue();
+      context->stateCache().invalidate();
+    }
+  }
+
+  ASGE::SHADER_LIB::GLShader* connectBlocks(ASGE::GLRenderer& renderer, ASGE::SHADER_LIB::Shader* shader)
+  {
+    auto* gl_shader = dynamic_cast<ASGE::SHADER_LIB::GLShader*>(shader);
+    if (gl_shader != nullptr)
+    {
+      pyasge::RenderContext::get(renderer)->uniformBlocks().attach(gl_shader->getShaderID());
+    }
+    return gl_shader;
+  }
+
+  std::optional<std::string> readSource(const std::string& path)
+  {
+    const std::filesystem::path FS_PATH(path);
+    if (std::filesystem::exists(FS_PATH))
+    {
+      std::ifstream file(FS_PATH, std::ios::binary);
+      return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    // try asge IO now
+    ASGE::FILEIO::File file;
+    if (file.open(path))
+    {
+      ASGE::FILEIO::IOBuffer buffer = file.read();
+      return std::string(reinterpret_cast<const char*>(buffer.as_unsigned_char()), buffer.length);
+    }
+
+    return std::nullopt;
+  }
+
+  ASGE::SHADER_LIB::GLShader* initPixelShader(ASGE::GLRenderer& renderer, const std::string& source, bool shared)
+  {
+    auto* shader = pyasge::RenderContext::get(renderer)->shaderCache().pixelShader(
+      source,
+      [&renderer](const std::string& src)
+      { return dynamic_cast<ASGE::SHADER_LIB::GLShader*>(renderer.initPixelShader(src)); },
+      shared);
+    return connectBlocks(renderer, shader);
+  }
+
+  ASGE::SHADER_LIB::GLShader* loadPixelShader(ASGE::GLRenderer& renderer, const std::string& path, bool shared)
+  {
+    if (auto source = readSource(path))
+    {
+      return initPixelShader(renderer, *source, shared);
+    }
+    return connectBlocks(renderer, renderer.initPixelShaderFromFile(path));
+  }
+
+  /// Warmed shaders are shared, so later shared loads return them, and their
+  /// binaries are written for every other load to restore from.
+  py::dict warmShaders(ASGE::GLRenderer& renderer, const std::vector<std::string>& manifest)
+  {
+    // the shaders belong to the renderer, so each keeps it alive like any other it returns
+    const auto parent = py::cast(&renderer, py::return_value_policy::reference);
+    py::dict shaders;
+    for (const auto& path : manifest)
+    {
+      shaders[py::str(path)] =
+        py::cast(loadPixelShader(renderer, path, true), py::return_value_policy::reference_internal, parent);
+    }
+    return shaders;
+  }
+}
+
 void initRenderer(py::module_ &module) {
   py::class_<ASGE::GLRenderer>(
     module,
@@ -92,27 +258,67 @@ void initRenderer(py::module_ &module) {
 
     .def(
       "render",
-      [](ASGE::GLRenderer& self, const ASGE::GLSprite& sprite) { self.render(sprite); },
+      [](ASGE::GLRenderer& self, const ASGE::GLSprite& sprite)
+      {
+        track(sprite.getTexture());
+        if (auto* queue = renderQueue(self))
+        {
+          queue->push(sprite, anchor(sprite));
+          return;
+        }
+        engineDrew(self);
+        self.render(sprite);
+      },
       py::arg("sprite"))
 
     .def(
       "render",
-      [](ASGE::GLRenderer& self, const ASGE::Tile& tile, float x, float y) { self.render(tile, {x, y}); },
+      [](ASGE::GLRenderer& self, const ASGE::Tile& tile, float x, float y)
+      {
+        track(tile.texture);
+        if (auto* queue = renderQueue(self))
+        {
+          queue->push(tile, x, y, anchor(tile));
+          return;
+        }
+        engineDrew(self);
+        self.render(tile, {x, y});
+      },
       py::arg("tile"),
       py::arg("x"),
       py::arg("y"))
 
     .def(
       "render",
-      [](ASGE::GLRenderer& self, const ASGE::Text& text) { self.render(text); },
+      [](ASGE::GLRenderer& self, const ASGE::Text& text)
+      {
+        track(nullptr);
+        if (auto* queue = renderQueue(self))
+        {
+          queue->push(text, anchor(text));
+          return;
+        }
+        engineDrew(self);
+        self.render(text);
+      },
       py::arg("text"))
 
     .def(
       "render",
       [](ASGE::GLRenderer& self, ASGE::GLTexture& texture, int x, int y, int16_t z)
       {
-          self.ASGE::Renderer::render(
-          texture, {static_cast<float>(x),static_cast<float>(y)}, z);
+        track(&texture);
+        if (auto* queue = renderQueue(self))
+        {
+          const auto width  = static_cast<float>(texture.getWidth());
+          const auto height = static_cast<float>(texture.getHeight());
+          queue->push(
+            texture, {0, 0, width, height},
+            {static_cast<float>(x), static_cast<float>(y), width, height}, z, anchor(texture));
+          return;
+        }
+        engineDrew(self);
+        self.ASGE::Renderer::render(texture, {static_cast<float>(x), static_cast<float>(y)}, z);
       },
       py::arg("texture"),
       py::arg("x"),
@@ -123,10 +329,20 @@ void initRenderer(py::module_ &module) {
         "render",
         [](ASGE::GLRenderer& self, ASGE::GLTexture& texture, int x, int y, int width, int height, int16_t z)
         {
+          track(&texture);
+          const std::array<float, 4> rect = {
+            0, 0, static_cast<float>(texture.getWidth()), static_cast<float>(texture.getHeight())};
+          if (auto* queue = renderQueue(self))
+          {
+            queue->push(
+              texture, rect,
+              {static_cast<float>(x), static_cast<float>(y), static_cast<float>(width), static_cast<float>(height)},
+              z, anchor(texture));
+            return;
+          }
+          engineDrew(self);
           self.render(
-          texture,
-          {0, 0, static_cast<float>(texture.getWidth()), static_cast<float>(texture.getHeight())},
-          ASGE::Point2D{static_cast<float>(x),static_cast<float>(y)}, width, height, z);
+          texture, rect, ASGE::Point2D{static_cast<float>(x),static_cast<float>(y)}, width, height, z);
         },
         py::arg("texture"),
         py::arg("x"),
@@ -139,10 +355,20 @@ void initRenderer(py::module_ &module) {
         "render",
         [](ASGE::GLRenderer& self, ASGE::GLTexture& texture, const py::list& rect, int x, int y, int width, int height, int16_t z)
         {
+          track(&texture);
+          const std::array<float, 4> src = {
+            rect[0].cast<float>(), rect[1].cast<float>(), rect[2].cast<float>(), rect[3].cast<float>()};
+          if (auto* queue = renderQueue(self))
+          {
+            queue->push(
+              texture, src,
+              {static_cast<float>(x), static_cast<float>(y), static_cast<float>(width), static_cast<float>(height)},
+              z, anchor(texture));
+            return;
+          }
+          engineDrew(self);
           self.render(
-          texture,
-          {rect[0].cast<float>(), rect[1].cast<float>(), rect[2].cast<float>(), rect[3].cast<float>()},
-          ASGE::Point2D{static_cast<float>(x),static_cast<float>(y)}, width, height, z);
+          texture, src, ASGE::Point2D{static_cast<float>(x),static_cast<float>(y)}, width, height, z);
         },
         py::arg("texture"),
         py::arg("rect"),
@@ -154,7 +380,15 @@ void initRenderer(py::module_ &module) {
 
     .def(
       "setProjectionMatrix",
-      py::overload_cast<float, float, float, float>(&ASGE::GLRenderer::setProjectionMatrix),
+      [](ASGE::GLRenderer& self, float x, float y, float width, float height)
+      {
+        if (requestState(
+              self, [&](auto& cache) { return cache.projection({ x, x + width, y, y + height }); }))
+        {
+          self.setProjectionMatrix(x, y, width, height);
+          refreshView(self);
+        }
+      },
       py::arg("x"),
       py::arg("y"),
       py::arg("width"),
@@ -162,24 +396,49 @@ void initRenderer(py::module_ &module) {
 
     .def(
       "setProjectionMatrix",
-      py::overload_cast<const ASGE::Camera::CameraView&>(&ASGE::GLRenderer::setProjectionMatrix),
+      [](ASGE::GLRenderer& self, const ASGE::Camera::CameraView& view)
+      {
+        if (requestState(
+              self, [&](auto& cache)
+              { return cache.projection({ view.min_x, view.max_x, view.min_y, view.max_y }); }))
+        {
+          self.setProjectionMatrix(view);
+          refreshView(self);
+        }
+      },
       py::arg("camera_view"))
 
     .def(
       "setRenderTarget",
       [](ASGE::GLRenderer& self, ASGE::GLRenderTarget* target)
-      { self.setRenderTarget(target); },
+      {
+        if (requestState(self, [&](auto& cache) { return cache.target(target); }))
+        {
+          self.setRenderTarget(target);
+          pyasge::TargetTracker::instance().bind(target);
+          refreshView(self);
+        }
+      },
       "Sets a render target to use for rendering.")
 
     .def(
       "initPixelShader",
-      [](ASGE::GLRenderer& self, const std::string& source)
-      { return dynamic_cast<ASGE::SHADER_LIB::GLShader*>(self.initPixelShader(source)); },
+      [](ASGE::GLRenderer& self, const std::string& source, bool shared)
+      { return initPixelShader(self, source, shared); },
       py::return_value_policy::reference_internal,
       py::arg("shader_source"),
+      py::arg("shared") = false,
       R"(
       Initialises a pixel shader from a str.
 
+      Every call returns a new shader with its own uniform values. Shaders
+      compiled before, in this run or a previous one, are restored from the
+      shader cache's binaries rather than compiled again.
+
+      :param shader_source: The GLSL source of the shader.
+      :param shared: Return the existing shader compiled from the same source,
+                     if there is one, rather than a new one. Uniform values set
+                     on a shared shader affect everything using it.
       :returns: The initialised pixel shader.
       :type: pyasge.Shader
 
@@ -207,16 +466,368 @@ void initRenderer(py::module_ &module) {
 
     .def(
       "loadPixelShader",
-      [](ASGE::GLRenderer& self, const std::string& path)
-      { return dynamic_cast<ASGE::SHADER_LIB::GLShader*>(self.initPixelShaderFromFile(path)); },
+      [](ASGE::GLRenderer& self, const std::string& path, bool shared)
+      { return loadPixelShader(self, path, shared); },
+      py::return_value_policy::reference_internal,
+      py::arg("path"),
+      py::arg("shared") = false,
+      R"(
+      Loads and initialises a pixel shader from a local file.
+
+      As with :meth:`initPixelShader`, each load returns a new shader restored
+      from the shader cache where possible, unless ``shared`` is set, in which
+      case loading the same source again returns the same shader.
+    )")
+
+    .def(
+      "warm_shaders",
+      &warmShaders,
+      py::arg("manifest"),
+      R"(
+      Compiles every pixel shader listed in a manifest up front.
+
+      Compiling shaders the first time they are needed mid-game causes
+      noticeable hitches, especially on software rasterisers. Warming them
+      at load time moves that cost to a loading screen. The warmed shaders
+      are shared, so later calls to ``loadPixelShader`` with ``shared=True``
+      return them, while other loads restore a new copy from their binary.
+
+      :param manifest: The paths of the pixel shaders to compile.
+      :returns: A dict mapping each path to its shader, or None if it failed.
+      :type: dict[str, pyasge.Shader]
+
+      Example
+      -------
+      >>> self.renderer.warm_shaders(["/data/shaders/red.frag", "/data/shaders/alpha.frag"])
+      >>> self.red = self.renderer.loadPixelShader("/data/shaders/red.frag", shared=True)  # no compile
+    )")
+
+    .def(
+      "warm_shaders",
+      [](ASGE::GLRenderer& self, const std::string& manifest_path)
+      {
+        auto manifest = readSource(manifest_path);
+        if (!manifest)
+        {
+          throw std::runtime_error("Unable to read shader manifest " + manifest_path);
+        }
+
+        // one path per line, blank lines and # comments are skipped
+        std::vector<std::string> paths;
+        std::istringstream lines(*manifest);
+        for (std::string line; std::getline(lines, line);)
+        {
+          line.erase(0, line.find_first_not_of(" \t\r"));
+          line.erase(line.find_last_not_of(" \t\r") + 1);
+          if (!line.empty() && line.front() != '#')
+          {
+            paths.emplace_back(std::move(line));
+          }
+        }
+
+        return warmShaders(self, paths);
+      },
+      py::arg("manifest_path"),
+      R"(
+      Compiles every pixel shader listed in a manifest file.
+
+      The manifest is a plain text file containing one shader path per line.
+      Blank lines and lines starting with ``#`` are ignored.
+
+      :param manifest_path: The manifest file to read.
+      :returns: A dict mapping each path to its shader, or None if it failed.
+      :type: dict[str, pyasge.Shader]
+    )")
+
+    .def_property(
+      "deferred_rendering",
+      [](ASGE::GLRenderer& self) { return pyasge::RenderContext::get(self)->deferred(); },
+      [](ASGE::GLRenderer& self, bool enable) { pyasge::RenderContext::get(self)->setDeferred(enable); },
+      R"(
+      Controls whether draws made during a frame are sorted before submission.
+
+      The renderer starts a new batch every time consecutive draws use a
+      different texture or shader, so the order sprites are rendered in
+      decides how many draw calls are made. When deferred rendering is
+      enabled, draws are queued instead and sorted by z-order, shader and
+      texture before being submitted. Within a z-order, draws are grouped by
+      state rather than by the order they were rendered in python.
+
+      The queue is submitted at the end of the game's render function, when
+      calling :meth:`flush`, and before the render target, viewport,
+      projection or shader are changed.
+
+      :getter: Returns True if draws are being queued.
+      :setter: Enables or disables the render queue. Disabling it submits anything queued.
+      :type: bool
+
+      Warning
+      -------
+      Queued draws are submitted using their state at the time of flushing.
+      To draw the same sprite more than once in a frame, for example at
+      different positions, call :meth:`flush` after each render.
+
+      Example
+      -------
+      >>> self.renderer.deferred_rendering = True
+      >>> for enemy in self.enemies:
+      >>>   self.renderer.render(enemy.sprite)
+      >>> print(self.renderer.frame_stats.queue_batches)
+    )")
+
+    .def_property(
+      "incremental_sorting",
+      [](ASGE::GLRenderer& self) { return pyasge::RenderContext::get(self)->renderQueue().incremental(); },
+      [](ASGE::GLRenderer& self, bool enable)
+      { pyasge::RenderContext::get(self)->renderQueue().setIncremental(enable); },
+      R"(
+      Controls whether the render queue reuses the previous frame's order.
+
+      Scenes tend to render mostly the same sprites in the same order every
+      frame. When enabled, the deferred render queue starts from the order
+      it produced last frame and only moves the draws that are now out of
+      place. This is close to linear when few sprites changed z-order,
+      shader or texture. Frames that differ too much are fully sorted
+      instead, so the draw order is identical in either mode. Enabled by
+      default.
+
+      :getter: Returns True if incremental sorting is used.
+      :setter: Enables or disables incremental sorting.
+      :type: bool
+
+      See Also
+      --------
+      deferred_rendering
+    )")
+
+    .def_property(
+      "instancing_threshold",
+      [](ASGE::GLRenderer& self) { return pyasge::RenderContext::get(self)->renderQueue().instancingThreshold(); },
+      [](ASGE::GLRenderer& self, std::size_t sprites)
+      { pyasge::RenderContext::get(self)->renderQueue().setInstancingThreshold(sprites); },
+      R"(
+      The length of a run of queued sprites that is drawn with instancing.
+
+      When deferred rendering is enabled, a run of at least this many
+      sprites sharing a texture and without a pixel shader is drawn with a
+      single instanced call. Each sprite is uploaded as one compact record
+      and expanded into a quad on the GPU, rather than being turned into
+      four vertices on the CPU. Instanced runs are drawn straight away, so
+      this only applies until the first draw of the frame that goes through
+      the renderer as normal. Defaults to 1024, and 0 disables it.
+
+      :getter: Returns the number of sprites.
+      :setter: Sets the number of sprites.
+      :type: int
+
+      See Also
+      --------
+      deferred_rendering, SpriteBatch
+    )")
+
+    .def_property(
+      "compact_vertices",
+      [](ASGE::GLRenderer& self) { return pyasge::RenderContext::get(self)->compactVertices(); },
+      [](ASGE::GLRenderer& self, bool enable) { pyasge::RenderContext::get(self)->setCompactVertices(enable); },
+      R"(
+      Controls whether natively drawn quads are uploaded in a compact vertex format.
+
+      Static batches and tile maps upload their quads once and draw them every
+      frame. With compact vertices the tint is packed as RGBA8 and texture
+      coordinates as 16 bit normalised integers, halving each vertex to 16
+      bytes. Where every quad of an upload lies within 256 units of the
+      centre of their bounds, such as a tile map chunk, positions are also
+      stored as half floats relative to that centre, leaving 12 bytes per
+      vertex. Uploads with texture coordinates or tints outside [0, 1] are
+      kept at full precision, as are particle emitters and sprite batches,
+      which are rebuilt every frame. Shaders receive the same ``VertexData``
+      inputs either way. Defaults to True, and only affects quads uploaded
+      after changing it.
+
+      :getter: Returns True if compact vertices are used.
+      :setter: Enables or disables compact vertices.
+      :type: bool
+    )")
+
+    .def(
+      "flush",
+      [](ASGE::GLRenderer& self) { return pyasge::RenderContext::get(self)->flushQueue(); },
+      R"(
+      Submits any queued draws to the renderer.
+
+      :returns: The number of draws submitted.
+      :type: int
+    )")
+
+    .def(
+      "acquire_target",
+      [](ASGE::GLRenderer& self, float width, float height, ASGE::Texture2D::Format format)
+      {
+        auto context = pyasge::RenderContext::get(self);
+        auto& pool   = context->targetPool();
+        pool.setReferenced(&wrapped);
+        return pool.acquire(
+          self, static_cast<int>(std::lround(width)), static_cast<int>(std::lround(height)), format,
+          context->frameCount());
+      },
+      py::return_value_policy::reference_internal,
+      py::arg("width"),
+      py::arg("height"),
+      py::arg("format") = ASGE::Texture2D::Format::RGBA,
+      R"(
+      Acquires a render target from the renderer's pool.
+
+      A released target with the same size and format is reused if one is
+      available, otherwise a new target with a single attachment is created.
+      The pool owns the target, and may hand it out again once it has been
+      released. It is never destroyed while python still refers to it, but
+      drawing into it after releasing it may overwrite another user's work.
+
+      :param width: The width of the target in pixels.
+      :param height: The height of the target in pixels.
+      :param format: The format of the target's attachment.
+      :returns: A render target that is reserved until it is released.
+      :type: pyasge.RenderTarget
+
+      Example
+      -------
+      >>> target = self.renderer.acquire_target(1024 / 2, 768 / 2, pyasge.Texture.Format.RGB)
+      >>> self.renderer.setRenderTarget(target)
+      >>> self.renderer.render(self.scene)
+      >>> self.renderer.setRenderTarget(None)
+      >>> self.blur.attach(target.resolve(0))
+      >>> self.renderer.render(self.blur)
+      >>> self.renderer.release_target(target)
+
+      See Also
+      --------
+      RenderTargetPool
+    )")
+
+    .def(
+      "release_target",
+      [](ASGE::GLRenderer& self, const ASGE::GLRenderTarget* target)
+      {
+        auto context = pyasge::RenderContext::get(self);
+        return context->targetPool().release(target, context->frameCount());
+      },
+      py::arg("target"),
+      R"(
+      Returns an acquired render target to the renderer's pool.
+
+      The target may be handed out again by the very next request, even
+      within the same frame, so release it once its textures have been
+      drawn.
+
+      :returns: True if the target was acquired from the pool and is now released.
+      :type: bool
+    )")
+
+    .def_property_readonly(
+      "target_pool",
+      [](ASGE::GLRenderer& self) -> pyasge::RenderTargetPool&
+      { return pyasge::RenderContext::get(self)->targetPool(); },
+      py::return_value_policy::reference_internal,
+      R"(
+      The renderer's render target pool.
+
+      :getter: Returns the pool used by :meth:`acquire_target`.
+      :type: pyasge.RenderTargetPool
+    )")
+
+    .def(
+      "build_static_batch",
+      [](ASGE::GLRenderer& self, const py::iterable& items)
+      {
+        auto batch = std::make_unique<pyasge::StaticBatch>(self);
+        for (const auto& item : items)
+        {
+          if (py::isinstance<ASGE::GLSprite>(item))
+          {
+            batch->add(item.cast<const ASGE::GLSprite&>(), py::reinterpret_borrow<py::object>(item));
+            continue;
+          }
+
+          auto tile = item.cast<py::tuple>();
+          if (tile.size() != 3)
+          {
+            throw py::value_error("static batch items must be sprites or (tile, x, y) tuples");
+          }
+          batch->add(
+            tile[0].cast<const ASGE::Tile&>(), tile[1].cast<float>(), tile[2].cast<float>(),
+            py::reinterpret_borrow<py::object>(tile[0]));
+        }
+
+        batch->build();
+        return batch;
+      },
+      py::arg("items"),
+      R"(
+      Bakes sprites and tiles that never move into a static batch.
+
+      The items are transformed, sorted by z-order and texture and uploaded
+      to the GPU once. Rendering the batch then draws everything with one
+      call per texture, under whichever camera view is current, without any
+      of the per-frame work done by :meth:`render`.
+
+      :param items: Sprites, and tiles given as (tile, x, y) tuples.
+      :returns: The built batch.
+      :type: pyasge.StaticBatch
+
+      Example
+      -------
+      >>> self.scenery = self.renderer.build_static_batch(
+      >>>   [self.background, *self.props, *[(tile, x * 64, y * 64) for x, y, tile in self.level]])
+      >>>
+      >>> def render(self, game_time: pyasge.GameTime) -> None:
+      >>>   self.scenery.render()
+      >>>   self.renderer.render(self.player)
+
+      See Also
+      --------
+      StaticBatch
+    )")
+
+    .def_property_readonly(
+      "frame_stats",
+      [](ASGE::GLRenderer& self) { return pyasge::RenderContext::get(self)->lastFrameStats(); },
+      R"(
+      Counters for the most recently completed frame.
+
+      Renderer state setters, such as :meth:`setRenderTarget`, :meth:`setViewport`,
+      :meth:`setProjectionMatrix` and :attr:`shader`, are filtered during a
+      frame so that requesting the state that is already set does nothing.
+      The returned stats show how many requests were forwarded and how many
+      were skipped. Requests made outside of the game's render function are
+      always forwarded and are not counted.
+
+      :getter: Returns a copy of the previous frame's counters.
+      :type: pyasge.FrameStats
+    )")
+
+    .def_property_readonly(
+      "shader_cache",
+      [](ASGE::GLRenderer& self) -> pyasge::ShaderCache&
+      { return pyasge::RenderContext::get(self)->shaderCache(); },
       py::return_value_policy::reference_internal,
-      "Loads and initialises a pixel shader from a local file.")
+      R"(
+      The renderer's shader cache.
+
+      :getter: Returns the cache used to avoid recompiling shaders.
+      :type: pyasge.ShaderCache
+    )")
 
     .def_property(
       "shader",
       [](ASGE::GLRenderer& self) { return self.getActiveShader(); },
       [](ASGE::GLRenderer& self, ASGE::SHADER_LIB::GLShader* shader)
-      { self.setActiveShader(shader); },
+      {
+        if (requestState(self, [&](auto& cache) { return cache.shader(shader); }))
+        {
+          connectBlocks(self, shader);
+          self.setActiveShader(shader);
+        }
+      },
       R"(
       The renderer's currently assigned shader.
 
@@ -231,9 +842,92 @@ void initRenderer(py::module_ &module) {
       >>> self.renderer.render(self.sprite)
     )")
 
+    .def(
+      "add_uniform_block",
+      [](ASGE::GLRenderer& self, std::shared_ptr<pyasge::UniformBlock> block)
+      { pyasge::RenderContext::get(self)->uniformBlocks().add(std::move(block)); },
+      py::arg("block"),
+      R"(
+      Registers a uniform block with the renderer.
+
+      Once registered the block's contents are uploaded once per frame and
+      every pixel shader declaring a block of the same name, whether loaded
+      before or after registration, is connected to it.
+
+      :param block: The uniform block to share between shaders.
+      :type block: pyasge.UniformBlock
+
+      Example
+      -------
+      >>> self.lighting = pyasge.UniformBlock("Lighting", 32)
+      >>> self.renderer.add_uniform_block(self.lighting)
+    )")
+
+    .def(
+      "remove_uniform_block",
+      [](ASGE::GLRenderer& self, const pyasge::UniformBlock& block)
+      { return pyasge::RenderContext::get(self)->uniformBlocks().remove(&block); },
+      py::arg("block"),
+      R"(
+      Unregisters a uniform block from the renderer.
+
+      :returns: True if the block was registered and has been removed.
+    )")
+
+    .def_property_readonly(
+      "frame_data",
+      [](ASGE::GLRenderer& self)
+      {
+        const auto& frame = pyasge::RenderContext::get(self)->uniformBlocks().frameData();
+        py::array_t<float> out({ 5, 4 });
+        std::memcpy(out.mutable_data(), &frame, sizeof(frame));
+        return out;
+      },
+      R"(
+      A copy of the values uploaded to the ``FrameData`` uniform block this frame.
+
+      The renderer updates a std140 uniform block named ``FrameData`` once per
+      frame. Any pixel shader that declares it receives the game time, window
+      and base resolutions, the applied camera view and viewport, and the
+      mouse cursor position without having to set individual uniforms.
+
+      :getter: Returns the rows time, resolution, view, viewport and mouse.
+      :type: numpy.ndarray[numpy.float32]
+
+      .. code-block:: c
+
+        layout (std140) uniform FrameData
+        {
+            vec4 time;        // elapsed, frame delta, fixed step, frame count
+            vec4 resolution;  // window width & height, base width & height
+            vec4 view;        // camera min_x, max_x, min_y, max_y
+            vec4 viewport;    // viewport x, y, width & height
+            vec4 mouse;       // cursor xy in pixels, cursor xy normalised
+        };
+
+        void main()
+        {
+            float pulse = 0.5 + 0.5 * sin(time.x);
+            fragColor = vec4(fs_in.rgba.rgb * pulse, 1.0) * texture(image, fs_in.uvs);
+        }
+    )")
+
     .def(
       "setViewport",
-      &ASGE::GLRenderer::setViewport,
+      [](ASGE::GLRenderer& self, const ASGE::Viewport& viewport)
+      {
+        if (requestState(
+              self, [&](auto& cache)
+              {
+                return cache.viewport({ static_cast<float>(viewport.x), static_cast<float>(viewport.y),
+                                        static_cast<float>(viewport.w), static_cast<float>(viewport.h) });
+              }))
+        {
+          self.setViewport(viewport);
+          refreshView(self);
+        }
+      },
+      py::arg("viewport"),
       R"(
       The viewport that maps to the rendered window.
 
@@ -290,7 +984,11 @@ void initRenderer(py::module_ &module) {
 
     .def(
         "setBaseResolution",
-        &ASGE::GLRenderer::setBaseResolution,
+        [](ASGE::GLRenderer& self, int width, int height, ASGE::Resolution::Policy policy)
+        {
+          resetState(self);
+          self.setBaseResolution(width, height, policy);
+        },
         py::arg("width"), py::arg("height"), py::arg("policy"), R"(
         The base design resolution of the game.
 
@@ -301,7 +999,12 @@ void initRenderer(py::module_ &module) {
 
     .def(
         "setResolutionPolicy",
-        &ASGE::GLRenderer::setResolutionPolicy, py::arg("policy"), R"(
+        [](ASGE::GLRenderer& self, ASGE::Resolution::Policy policy)
+        {
+          resetState(self);
+          self.setResolutionPolicy(policy);
+        },
+        py::arg("policy"), R"(
         Sets the resolution policy to use.
 
         The resolution policy controls how the game's view will be mapped to the window
@@ -384,4 +1087,44 @@ void initRenderer(py::module_ &module) {
       ----
       If the font file can not be loaded successfully, None will be returned.
     )");
+
+  module.def(
+    "queue_order",
+    [](const std::vector<std::uint64_t>& keys, const std::optional<std::vector<std::uint32_t>>& previous) {
+      std::vector<std::uint32_t> repaired;
+      if (previous && previous->size() == keys.size())
+      {
+        std::vector<bool> seen(keys.size(), false);
+        for (const auto index : *previous)
+        {
+          if (index >= keys.size() || seen[index])
+          {
+            throw py::value_error("previous must hold each index of keys exactly once");
+          }
+          seen[index] = true;
+        }
+        repaired = *previous;
+      }
+
+      const auto order = pyasge::RenderQueue::order(keys, repaired);
+      py::array_t<std::uint32_t> result(static_cast<py::ssize_t>(order.size()));
+      std::copy(order.begin(), order.end(), result.mutable_data());
+      return result;
+    },
+    py::arg("keys"),
+    py::arg("previous") = py::none(),
+    R"(
+      Orders packed draw keys the way a deferred flush submits them.
+
+      Keys are sorted as the render queue sorts them, so draws sharing a key
+      keep their order. Given the order a previous call returned for the
+      same number of keys, that order is repaired as an incremental flush
+      would, rather than the keys being sorted from scratch. Either way the
+      result is the same, so this is mainly of use for testing.
+
+      :param keys: The packed (z-order, shader, texture) key of each draw.
+      :param previous: The order returned for the previous set of keys.
+      :returns: The indices of the keys in submission order.
+      :type: numpy.ndarray[numpy.uint32]
+    )");
 }
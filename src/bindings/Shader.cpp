@@ -15,8 +15,10 @@ void initShader(py::module_ & module)
     shader is fixed and not easily adjustable, which means the inputs in to the
     fragment shaders remain consistent. At present only uniform mapping is
     provided, the addition of extra samplers within the pixel shader is not
-    supported. Provided below is a working fragment shader that can be loaded
-    and used to render a custom alpha channel effect.
+    supported. Values shared by many shaders can be provided using uniform
+    blocks instead, including the renderer managed ``FrameData`` block. Provided
+    below is a working fragment shader that can be loaded and used to render a
+    custom alpha channel effect.
 
     Example
     -------
@@ -0,0 +1,105 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include "extensions/ShaderCache.hpp"
+
+namespace py = pybind11;
+
+void initShaderCache(py::module_& module)
+{
+  py::class_<pyasge::ShaderCache>(
+    module, "ShaderCache", py::is_final(),
+    R"(
+    Avoids recompiling shaders, both during a run and between runs.
+
+    Pixel shaders loaded through the renderer, and the shader programs built
+    internally by PyASGE, are stored on disk as driver binaries, keyed by a
+    hash of their source and the GPU driver's vendor, renderer and version
+    strings. Pixel shaders are linked against the engine's own vertex
+    stage, so their keys also include the engine's version. Loading a
+    shader compiled before restores it from its binary
+    instead of compiling it. If the driver rejects a stored binary, for
+    example after a driver update, it is discarded and compiled from source
+    again. Binaries need OpenGL 4.1 or the ARB_get_program_binary extension.
+
+    Pixel shaders loaded with ``shared=True`` are also reused within a run,
+    so requesting the same source twice returns the same shader.
+
+    Setting the cache directory also points the Mesa and NVIDIA driver caches
+    at it, which is where the engine's own shader compilations are stored.
+    Drivers only read this setting when the window is created, so set it
+    before constructing the game. This is particularly useful on CI machines
+    where the default cache locations are not preserved between runs.
+
+    Example
+    -------
+    >>> pyasge.ShaderCache.directory = "./.cache/shaders"
+    >>> game = MyASGEGame(settings)
+    >>> print(game.renderer.shader_cache.binary_hits)
+  )")
+
+    .def_property_static(
+      "directory",
+      [](const py::object&) { return pyasge::ShaderCache::directory().string(); },
+      [](const py::object&, const std::string& path) { pyasge::ShaderCache::setDirectory(path); },
+      R"(
+      The directory used to store shader binaries.
+
+      :getter: Returns the cache directory. Defaults to a folder in the temp directory.
+      :setter: Changes the cache directory. Set this before creating the game.
+      :type: str
+    )")
+
+    .def_property_static(
+      "enabled",
+      [](const py::object&) { return pyasge::ShaderCache::enabled(); },
+      [](const py::object&, bool enable) { pyasge::ShaderCache::setEnabled(enable); },
+      R"(
+      Controls whether shader binaries are read from and written to disk.
+
+      :type: bool
+    )")
+
+    .def_property_readonly(
+      "binary_hits",
+      [](const pyasge::ShaderCache& self) { return self.statistics().binary_hits; },
+      "The number of shader programs restored from a stored binary.")
+
+    .def_property_readonly(
+      "binary_misses",
+      [](const pyasge::ShaderCache& self) { return self.statistics().binary_misses; },
+      "The number of shader programs compiled from source.")
+
+    .def_property_readonly(
+      "binary_rejected",
+      [](const pyasge::ShaderCache& self) { return self.statistics().binary_rejected; },
+      "The number of stored binaries the driver refused to load.")
+
+    .def_property_readonly(
+      "source_hits",
+      [](const pyasge::ShaderCache& self) { return self.statistics().source_hits; },
+      "The number of shared pixel shader requests served by an existing shader.")
+
+    .def(
+      "clear",
+      &pyasge::ShaderCache::clear,
+      R"(
+      Deletes every shader binary stored in the cache directory.
+
+      :returns: The number of binaries removed.
+      :type: int
+    )");
+}
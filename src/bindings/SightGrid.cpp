@@ -0,0 +1,313 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include <Engine/OpenGL/GLPixelBuffer.hpp>
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <string>
+#include "extensions/SightGrid.hpp"
+#include "extensions/TileMap.hpp"
+
+namespace py = pybind11;
+
+namespace
+{
+  using Cell  = pyasge::SightGrid::Cell;
+  using Bytes = py::array_t<std::uint8_t, py::array::c_style | py::array::forcecast>;
+  using Cells = py::array_t<std::int32_t, py::array::c_style | py::array::forcecast>;
+
+  void checkCell(const pyasge::SightGrid& self, const Cell& cell)
+  {
+    if (!self.contains(cell.first, cell.second))
+    {
+      throw py::index_error("cell (" + std::to_string(cell.first) + ", " + std::to_string(cell.second) +
+                            ") is outside of the grid");
+    }
+  }
+
+  void checkOpaque(const pyasge::SightGrid& self, const Bytes& opaque)
+  {
+    if (opaque.ndim() != 2 || opaque.shape(0) != self.rows() || opaque.shape(1) != self.columns())
+    {
+      throw py::value_error("opaque must be a 2D array of shape (rows, columns)");
+    }
+  }
+
+  py::ssize_t checkCells(const Cells& cells, const char* message)
+  {
+    if (cells.ndim() != 2 || cells.shape(1) != 2)
+    {
+      throw py::value_error(message);
+    }
+    return cells.shape(0);
+  }
+
+  py::array_t<bool> stateMask(const pyasge::SightGrid& self, std::uint8_t lowest)
+  {
+    py::array_t<bool> mask({ self.rows(), self.columns() });
+    auto* out = mask.mutable_data();
+    for (const auto state : self.states())
+    {
+      *out++ = state >= lowest;
+    }
+    return mask;
+  }
+}
+
+void initSightGrid(py::module_& module)
+{
+  py::class_<pyasge::SightGrid>(
+    module, "SightGrid", py::is_final(),
+    R"(
+    A grid of cells that block sight, for line of sight and fog of war.
+
+    :meth:`field_of_view` finds every cell a viewer can see using recursive
+    shadowcasting, which visits each cell in range at most once. Walls at
+    the edge of the view are visible. The grid remembers the cells seen
+    since it was created or :meth:`forget` was called, so each cell is
+    either visible, explored or hidden, and :meth:`write_fog` writes those
+    states into a :class:`PixelBuffer` so that a fog texture is updated
+    without a Python loop over its cells.
+
+    :meth:`line_of_sight` traces a Bresenham line between two cells, and
+    :meth:`line_of_sight_many` traces a whole array of them.
+
+    Example
+    -------
+    >>> self.sight = pyasge.SightGrid.from_tile_map(self.map)
+    >>> self.fog = self.renderer.createNonCachedTexture(
+    >>>   self.map.columns, self.map.rows, pyasge.Texture.Format.RGBA, None)
+    >>>
+    >>> def update(self, game_time: pyasge.GameTime) -> None:
+    >>>   self.sight.field_of_view(self.player_cell, 8)
+    >>>   self.sight.write_fog(self.fog.buffer, channel=3)
+  )")
+
+    .def(
+      py::init(
+        [](const Bytes& opaque)
+        {
+          if (opaque.ndim() != 2)
+          {
+            throw py::value_error("opaque must be a 2D array of rows");
+          }
+          return new pyasge::SightGrid(
+            static_cast<int>(opaque.shape(1)), static_cast<int>(opaque.shape(0)), opaque.data());
+        }),
+      py::arg("opaque"),
+      R"(
+      Creates a grid from an array marking the cells that block sight.
+
+      :param opaque: A 2D array indexed by [row, column], non-zero where a cell blocks sight.
+    )")
+
+    .def_static(
+      "from_tile_map",
+      [](const pyasge::TileMap& map) { return new pyasge::SightGrid(map); },
+      py::arg("tile_map"),
+      py::return_value_policy::take_ownership,
+      R"(
+      Creates a grid the size of a tile map, where its solid tiles block sight.
+
+      The grid is a copy, so it doesn't follow later changes to the map.
+
+      :param tile_map: The map to copy.
+      :type: pyasge.SightGrid
+    )")
+
+    .def(
+      "__getitem__",
+      [](const pyasge::SightGrid& self, const Cell& cell)
+      {
+        checkCell(self, cell);
+        return self.opaque(cell.first, cell.second);
+      },
+      py::arg("cell"),
+      "Returns whether the cell at (column, row) blocks sight.")
+
+    .def(
+      "__setitem__",
+      [](pyasge::SightGrid& self, const Cell& cell, bool opaque)
+      {
+        checkCell(self, cell);
+        self.setOpaque(cell.first, cell.second, opaque);
+      },
+      py::arg("cell"),
+      py::arg("opaque"),
+      "Sets whether the cell at (column, row) blocks sight, such as when a door opens.")
+
+    .def_property(
+      "opaque",
+      [](const pyasge::SightGrid& self)
+      {
+        py::array_t<bool> opaque({ self.rows(), self.columns() });
+        self.copy(reinterpret_cast<std::uint8_t*>(opaque.mutable_data()));
+        return opaque;
+      },
+      [](pyasge::SightGrid& self, const Bytes& opaque)
+      {
+        checkOpaque(self, opaque);
+        self.assign(opaque.data());
+      },
+      R"(
+      The cells that block sight.
+
+      :getter: Returns a copy indexed by [row, column].
+      :setter: Replaces every cell. The array's shape must match the grid's.
+      :type: numpy.ndarray[bool]
+    )")
+
+    .def(
+      "line_of_sight",
+      &pyasge::SightGrid::lineOfSight,
+      py::arg("start"),
+      py::arg("end"),
+      R"(
+      Checks whether anything blocks sight between two cells.
+
+      Only the cells strictly between the two are tested, so a wall can be
+      seen when nothing stands in front of it.
+
+      :param start: The (column, row) looking.
+      :param end: The (column, row) looked at.
+      :returns: False if a cell on the line blocks sight or either cell is outside the grid.
+      :type: bool
+    )")
+
+    .def(
+      "line_of_sight_many",
+      [](const pyasge::SightGrid& self, const Cells& starts, const Cells& ends)
+      {
+        const auto count = checkCells(starts, "starts must be an array of shape (N, 2)");
+        if (checkCells(ends, "ends must be an array of shape (N, 2)") != count)
+        {
+          throw py::value_error("starts and ends must have the same number of rows");
+        }
+
+        py::array_t<bool> visible(count);
+        auto* out     = visible.mutable_data();
+        const auto* a = starts.data();
+        const auto* b = ends.data();
+        for (py::ssize_t i = 0; i < count; ++i)
+        {
+          out[i] = self.lineOfSight({ a[i * 2], a[i * 2 + 1] }, { b[i * 2], b[i * 2 + 1] });
+        }
+        return visible;
+      },
+      py::arg("starts"),
+      py::arg("ends"),
+      R"(
+      Checks the line of sight between each pair of cells, as :meth:`line_of_sight` does.
+
+      :param starts: An int32 array of shape (N, 2) of cells looking.
+      :param ends: An int32 array of shape (N, 2) of cells looked at.
+      :returns: An array of N booleans.
+      :type: numpy.ndarray[bool]
+    )")
+
+    .def(
+      "field_of_view",
+      [](pyasge::SightGrid& self, const Cell& origin, int radius, bool accumulate)
+      {
+        self.fieldOfView(origin, radius, accumulate);
+        return stateMask(self, pyasge::SightGrid::VISIBLE);
+      },
+      py::arg("origin"),
+      py::arg("radius") = 0,
+      py::arg("accumulate") = false,
+      R"(
+      Finds the cells visible from a cell.
+
+      Cells previously visible become explored. Pass ``accumulate`` to add
+      to the current view instead, such as for each member of a party.
+
+      :param origin: The (column, row) of the viewer.
+      :param radius: How far the viewer can see in cells, or 0 for no limit.
+      :param accumulate: Whether to keep the cells already visible.
+      :returns: The visible cells indexed by [row, column].
+      :type: numpy.ndarray[bool]
+    )")
+
+    .def_property_readonly(
+      "visible",
+      [](const pyasge::SightGrid& self) { return stateMask(self, pyasge::SightGrid::VISIBLE); },
+      R"(
+      The cells visible in the current view, indexed by [row, column].
+
+      :type: numpy.ndarray[bool]
+    )")
+
+    .def_property_readonly(
+      "explored",
+      [](const pyasge::SightGrid& self) { return stateMask(self, pyasge::SightGrid::EXPLORED); },
+      R"(
+      The cells that have been visible since the grid was created or last forgot them, indexed by [row, column].
+
+      :type: numpy.ndarray[bool]
+    )")
+
+    .def("forget", &pyasge::SightGrid::forget, "Marks every cell as hidden, clearing the view and explored cells.")
+
+    .def(
+      "write_fog",
+      [](const pyasge::SightGrid& self, ASGE::GLPixelBuffer& buffer, std::uint8_t visible, std::uint8_t explored,
+         std::uint8_t hidden, int channel, bool upload)
+      {
+        const auto format = static_cast<int>(buffer.pixelFormat());
+        if (channel >= format)
+        {
+          throw py::value_error("the pixel buffer has " + std::to_string(format) + " channels");
+        }
+
+        const std::uint8_t values[3] = { hidden, explored, visible };
+        self.writeStates(
+          reinterpret_cast<std::uint8_t*>(buffer.getPixelData()),
+          static_cast<int>(buffer.getWidth()),
+          static_cast<int>(buffer.getHeight()),
+          format,
+          channel,
+          values);
+
+        if (upload)
+        {
+          buffer.upload(0);
+        }
+      },
+      py::arg("buffer"),
+      py::arg("visible") = 0,
+      py::arg("explored") = 160,
+      py::arg("hidden") = 255,
+      py::arg("channel") = -1,
+      py::arg("upload") = true,
+      R"(
+      Writes the state of each cell into a pixel buffer, one pixel per cell.
+
+      Cell (column, row) is written to the pixel at the same position in
+      the buffer's data, and cells beyond the buffer are skipped. By default
+      the values suit a fog texture's alpha: clear where visible, dimmed
+      where explored and opaque where hidden.
+
+      :param buffer: The pixel buffer to write into, such as ``texture.buffer``.
+      :param visible: The byte written for visible cells.
+      :param explored: The byte written for explored cells that aren't visible.
+      :param hidden: The byte written for cells never seen.
+      :param channel: The channel of each pixel to write, or -1 for all of them.
+      :param upload: Whether to upload the buffer to its texture afterwards.
+    )")
+
+    .def_property_readonly("columns", &pyasge::SightGrid::columns, "The width of the grid in cells.")
+    .def_property_readonly("rows", &pyasge::SightGrid::rows, "The height of the grid in cells.");
+}
@@ -0,0 +1,218 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include <Engine/OpenGL/GLSprite.hpp>
+#include <algorithm>
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <vector>
+#include "extensions/BoundsCache.hpp"
+#include "extensions/SpatialGrid.hpp"
+
+namespace py = pybind11;
+
+namespace
+{
+  using Floats = py::array_t<float, py::array::c_style | py::array::forcecast>;
+
+  py::array_t<std::int32_t> toArray(const std::vector<std::int32_t>& values, py::ssize_t columns)
+  {
+    const auto rows = static_cast<py::ssize_t>(values.size()) / columns;
+    auto array      = columns == 1 ? py::array_t<std::int32_t>(rows) : py::array_t<std::int32_t>({ rows, columns });
+    std::copy(values.begin(), values.end(), array.mutable_data());
+    return array;
+  }
+
+  std::vector<std::int32_t> query(const pyasge::SpatialGrid& self, const pyasge::SpatialGrid::Box& box)
+  {
+    std::vector<std::int32_t> found;
+    self.query(box, found);
+    std::sort(found.begin(), found.end());
+    return found;
+  }
+}
+
+void initSpatialGrid(py::module_& module)
+{
+  py::class_<pyasge::SpatialGrid>(
+    module, "SpatialGrid", py::is_final(),
+    R"(
+    A uniform hash grid for finding overlapping boxes.
+
+    Testing every pair of objects for overlap costs O(n²). A spatial grid
+    instead enters each object's bounding box into the square cells it
+    touches, so only objects sharing a cell are tested, and queries only
+    look at the cells they cover. The grid is rebuilt from scratch each
+    frame, which suits objects that move, and large builds are spread
+    across worker threads.
+
+    Objects are numbered by their position in the list or array the grid
+    was built from. A cell size around the size of a typical object works
+    well.
+    Objects covering more than 1024 cells, or with infinite or NaN
+    coordinates, are kept aside and tested against every query instead.
+
+    Example
+    -------
+    >>> self.grid = pyasge.SpatialGrid(64)
+    >>>
+    >>> def fixed_update(self, game_time: pyasge.GameTime) -> None:
+    >>>   self.grid.build(self.enemies)
+    >>>   for a, b in self.grid.pairs():
+    >>>     self.resolve(self.enemies[a], self.enemies[b])
+    >>>   hits = self.grid.query_rect(*self.player_attack_box)
+  )")
+
+    .def(py::init<float>(), py::arg("cell_size") = 64.0F, "Creates an empty grid.")
+
+    .def(
+      "build",
+      [](pyasge::SpatialGrid& self, const std::vector<ASGE::GLSprite*>& sprites)
+      {
+        // boxes come back as (x, y, width, height) and are widened to corners in place
+        const std::vector<const ASGE::Sprite*> items(sprites.begin(), sprites.end());
+        std::vector<pyasge::SpatialGrid::Box> boxes(items.size());
+        pyasge::BoundsCache::instance().boxes(items.data(), items.size(), &boxes.data()->min_x);
+        for (auto& box : boxes)
+        {
+          box.max_x += box.min_x;
+          box.max_y += box.min_y;
+        }
+
+        py::gil_scoped_release release;
+        self.build(std::move(boxes));
+      },
+      py::arg("sprites"),
+      R"(
+      Rebuilds the grid from the world bounds of a list of sprites.
+
+      Rotated sprites are entered using the box enclosing their corners,
+      as returned by :func:`world_aabbs`.
+
+      :param sprites: The sprites, numbered by their position in the list.
+    )")
+
+    .def(
+      "build",
+      [](pyasge::SpatialGrid& self, const Floats& boxes)
+      {
+        if (boxes.ndim() != 2 || boxes.shape(1) != 4)
+        {
+          throw py::value_error("boxes must be an array of shape (N, 4)");
+        }
+
+        std::vector<pyasge::SpatialGrid::Box> items(static_cast<std::size_t>(boxes.shape(0)));
+        const auto* box = boxes.data();
+        for (auto& item : items)
+        {
+          item = { box[0], box[1], box[0] + box[2], box[1] + box[3] };
+          box += 4;
+        }
+
+        py::gil_scoped_release release;
+        self.build(std::move(items));
+      },
+      py::arg("boxes"),
+      R"(
+      Rebuilds the grid from an array of boxes.
+
+      :param boxes: A float32 array of shape (N, 4) holding (x, y, width, height) boxes.
+    )")
+
+    .def(
+      "query_rect",
+      [](const pyasge::SpatialGrid& self, float x, float y, float width, float height)
+      { return toArray(query(self, { x, y, x + width, y + height }), 1); },
+      py::arg("x"),
+      py::arg("y"),
+      py::arg("width"),
+      py::arg("height"),
+      R"(
+      Finds the objects overlapping a rectangle.
+
+      :returns: The sorted numbers of the objects.
+      :type: numpy.ndarray[numpy.int32]
+    )")
+
+    .def(
+      "query_point",
+      [](const pyasge::SpatialGrid& self, float x, float y)
+      {
+        std::vector<std::int32_t> found;
+        self.query(x, y, found);
+        std::sort(found.begin(), found.end());
+        return toArray(found, 1);
+      },
+      py::arg("x"),
+      py::arg("y"),
+      R"(
+      Finds the objects containing a point.
+
+      :returns: The sorted numbers of the objects.
+      :type: numpy.ndarray[numpy.int32]
+    )")
+
+    .def(
+      "pairs",
+      [](const pyasge::SpatialGrid& self)
+      {
+        std::vector<std::int32_t> found;
+        {
+          py::gil_scoped_release release;
+          self.pairs(found);
+        }
+        return toArray(found, 2);
+      },
+      R"(
+      Finds every pair of overlapping objects.
+
+      Each pair is listed once, as (i, j) with i < j. Objects whose edges
+      only touch don't overlap.
+
+      :returns: An int32 array of shape (N, 2).
+      :type: numpy.ndarray[numpy.int32]
+    )")
+
+    .def("__len__", &pyasge::SpatialGrid::size)
+
+    .def_property(
+      "cell_size",
+      &pyasge::SpatialGrid::cellSize,
+      &pyasge::SpatialGrid::setCellSize,
+      R"(
+      The width and height of a cell in world units.
+
+      Changing it rebuilds the grid.
+
+      :type: float
+    )")
+
+    .def_property_readonly(
+      "entries",
+      [](const pyasge::SpatialGrid& self) { return self.statistics().entries; },
+      "The number of cell entries made by the last build, one for each cell each object touches.")
+
+    .def_property_readonly(
+      "max_bucket",
+      [](const pyasge::SpatialGrid& self) { return self.statistics().max_entries; },
+      "The number of entries in the fullest bucket after the last build.")
+
+    .def_property_readonly(
+      "oversize",
+      [](const pyasge::SpatialGrid& self) { return self.statistics().oversize; },
+      "The number of objects too large, or with coordinates too far out, to enter into cells. "
+      "They are tested against every query directly.");
+}
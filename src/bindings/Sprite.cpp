@@ -13,10 +13,12 @@
 */
 
 #include <Engine/OpenGL/GLSprite.hpp>
+#include <Engine/OpenGL/GLTexture.hpp>
 #include <Engine/Sprite.hpp>
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/operators.h>
+#include "extensions/RenderContext.hpp"
 
 namespace py = pybind11;
 using namespace pybind11::literals;
@@ -557,7 +559,13 @@ void initSprite(py::module_ &module) {
   asge_sprite.def(
       "setMagFilter",
       [](ASGE::GLSprite &self, ASGE::Texture2D::MagFilter filter) {
-        self.setMagFilter(filter);
+        auto* context = pyasge::RenderContext::active();
+        auto* texture = dynamic_cast<ASGE::GLTexture *>(self.getTexture());
+        if (context == nullptr || texture == nullptr ||
+            context->stateCache().magFilter(texture->getID(), static_cast<int>(filter)))
+        {
+          self.setMagFilter(filter);
+        }
       }, py::arg("magfilter"), R"(
       Sets the magnification filter on the attached texture.
 
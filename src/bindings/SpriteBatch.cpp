@@ -0,0 +1,135 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include <Engine/OpenGL/GLRenderer.hpp>
+#include <Engine/OpenGL/GLSprite.hpp>
+#include <pybind11/pybind11.h>
+#include "extensions/SpriteBatch.hpp"
+
+namespace py = pybind11;
+
+void initSpriteBatch(py::module_& module)
+{
+  py::class_<pyasge::SpriteBatch>(
+    module, "SpriteBatch", py::is_final(),
+    R"(
+    A list of sprites drawn together using instancing.
+
+    Rendering a sprite normally turns it into four vertices on the CPU. A
+    sprite batch instead uploads one compact record per sprite, its
+    position, scaled and rotated axes, texture rectangle and packed colour,
+    and the quad is expanded on the GPU. Sprites are read as they are each
+    time the batch is rendered, so the batch suits large groups of sprites
+    that move every frame, such as bullets or crowds. Scenery that never
+    changes is cheaper still in a :class:`StaticBatch`.
+
+    Sprites are drawn in the order they were added, with one draw call per
+    run of sprites sharing a texture. They are drawn with the standard
+    sprite shader, so pixel shaders set on them are not applied. Sprites
+    without a texture are skipped.
+
+    Batches draw straight away rather than being batched by the renderer,
+    so a batch appears beneath any sprite rendered in the same frame.
+
+    Example
+    -------
+    >>> self.bullets = pyasge.SpriteBatch(self.renderer)
+    >>> for bullet in self.bullet_sprites:
+    >>>   self.bullets.add(bullet)
+    >>>
+    >>> def render(self, game_time: pyasge.GameTime) -> None:
+    >>>   self.bullets.render()
+  )")
+
+    .def(
+      py::init(
+        [](ASGE::GLRenderer& renderer, const py::iterable& sprites)
+        {
+          auto batch = std::make_unique<pyasge::SpriteBatch>(renderer);
+          for (const auto& sprite : sprites)
+          {
+            batch->add(sprite.cast<const ASGE::GLSprite&>(), py::reinterpret_borrow<py::object>(sprite));
+          }
+          return batch;
+        }),
+      py::arg("renderer"),
+      py::arg("sprites") = py::list(),
+      R"(
+      Creates a batch.
+
+      :param renderer: The renderer the batch draws with.
+      :param sprites: Sprites to add to the batch straight away.
+    )")
+
+    .def(
+      "add",
+      [](pyasge::SpriteBatch& self, const py::object& sprite)
+      { return self.add(sprite.cast<const ASGE::GLSprite&>(), sprite); },
+      py::arg("sprite"),
+      R"(
+      Adds a sprite to the end of the batch.
+
+      :returns: False if the sprite is already in the batch.
+      :type: bool
+    )")
+
+    .def(
+      "remove",
+      [](pyasge::SpriteBatch& self, const ASGE::GLSprite& sprite) { return self.remove(sprite); },
+      py::arg("sprite"),
+      R"(
+      Removes a sprite from the batch, keeping the order of the others.
+
+      :returns: False if the sprite is not in the batch.
+      :type: bool
+    )")
+
+    .def("clear", &pyasge::SpriteBatch::clear, "Removes every sprite from the batch.")
+
+    .def(
+      "render",
+      &pyasge::SpriteBatch::render,
+      py::call_guard<py::gil_scoped_release>(),
+      R"(
+      Draws every sprite in the batch using the current camera view and viewport.
+
+      :returns: The number of draw calls made.
+      :type: int
+    )")
+
+    .def("__len__", &pyasge::SpriteBatch::size)
+
+    .def(
+      "__contains__",
+      [](const pyasge::SpriteBatch& self, const ASGE::GLSprite& sprite) { return self.contains(sprite); })
+
+    .def_property_readonly(
+      "instances",
+      &pyasge::SpriteBatch::instances,
+      R"(
+      The number of sprites drawn by the last render.
+
+      :type: int
+    )")
+
+    .def_property_readonly(
+      "draws",
+      &pyasge::SpriteBatch::draws,
+      R"(
+      The number of draw calls made by the last render, one per run of sprites sharing a texture.
+
+      :type: int
+    )");
+}
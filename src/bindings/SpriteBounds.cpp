@@ -12,9 +12,19 @@
   SOFTWARE.
 */
 
+#include <Engine/OpenGL/GLSprite.hpp>
 #include <Engine/SpriteBounds.hpp>
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <cstring>
+#include <optional>
 #include <sstream>
+#include <string>
+#include <vector>
+#include "extensions/BoundsCache.hpp"
+#include "extensions/Quads.hpp"
+#include "extensions/SpriteVertices.hpp"
 namespace py = pybind11;
 
 void initSpritebounds(py::module& module)
@@ -38,4 +48,176 @@ void initSpritebounds(py::module& module)
 
        return ss.str();
      });
+
+  module.def(
+    "world_bounds",
+    [](const std::vector<ASGE::GLSprite*>& sprites) {
+      const std::vector<const ASGE::Sprite*> items(sprites.begin(), sprites.end());
+      py::array_t<float> corners({ static_cast<py::ssize_t>(items.size()), py::ssize_t{ 4 }, py::ssize_t{ 2 } });
+      pyasge::BoundsCache::instance().corners(items.data(), items.size(), corners.mutable_data());
+      return corners;
+    },
+    py::arg("sprites"),
+    R"(
+      Retrieves the world space corners of many sprites at once.
+
+      Equivalent to calling :meth:`Sprite.getWorldBounds` on each sprite, but
+      without creating a :class:`SpriteBounds` per sprite. Each sprite's
+      corners are cached along with its position, size, scale and rotation,
+      and are only recomputed once one of those changes, so querying the
+      same sprites again in a frame is nearly free. Those that have changed
+      are recomputed together, several at a time, by the kernels behind
+      :func:`sprite_vertices`, and agree with :meth:`Sprite.getWorldBounds`
+      to within float rounding.
+
+      :param sprites: The sprites to measure.
+      :returns: A float32 array of shape (N, 4, 2) holding the top left, top right, bottom right and bottom left corners.
+      :type: numpy.ndarray[numpy.float32]
+
+      Example
+      -------
+      >>> corners = pyasge.world_bounds(self.asteroids)
+      >>> centres = corners.mean(axis=1)
+  )");
+
+  module.def(
+    "world_aabbs",
+    [](const std::vector<ASGE::GLSprite*>& sprites) {
+      const std::vector<const ASGE::Sprite*> items(sprites.begin(), sprites.end());
+      py::array_t<float> boxes({ static_cast<py::ssize_t>(items.size()), py::ssize_t{ 4 } });
+      pyasge::BoundsCache::instance().boxes(items.data(), items.size(), boxes.mutable_data());
+      return boxes;
+    },
+    py::arg("sprites"),
+    R"(
+      Retrieves the axis aligned box around each of many sprites.
+
+      Boxes enclose the sprites' world space corners, so rotated sprites
+      get the smallest box containing them. They use the same cache as
+      :func:`world_bounds`, and are laid out as :class:`SpatialGrid` and
+      :meth:`TileMap.move_many` expect.
+
+      :param sprites: The sprites to measure.
+      :returns: A float32 array of shape (N, 4) holding (x, y, width, height) boxes.
+      :type: numpy.ndarray[numpy.float32]
+  )");
+
+  module.def(
+    "vertex_kernels",
+    []() {
+      std::vector<std::string> names;
+      for (auto kernel : { pyasge::VertexKernel::SCALAR, pyasge::VertexKernel::SSE4, pyasge::VertexKernel::AVX2,
+                           pyasge::VertexKernel::NEON })
+      {
+        if (pyasge::vertexKernelSupported(kernel))
+        {
+          names.emplace_back(pyasge::vertexKernelName(kernel));
+        }
+      }
+      return names;
+    },
+    R"(
+      Lists the sprite vertex kernels the processor supports.
+
+      Kernels are named after the instruction set they use: ``"scalar"``
+      is always present, and ``"sse4"``, ``"avx2"`` or ``"neon"`` follow
+      where the processor has them. The widest is used when drawing.
+
+      :returns: The names of the supported kernels, narrowest first.
+      :type: list[str]
+  )");
+
+  module.def(
+    "sprite_vertices",
+    [](const std::vector<ASGE::GLSprite*>& sprites, const std::optional<std::string>& kernel) {
+      const std::vector<const ASGE::Sprite*> items(sprites.begin(), sprites.end());
+      py::array_t<float> vertices(
+        { static_cast<py::ssize_t>(items.size()), py::ssize_t{ 4 }, py::ssize_t{ 8 } });
+      auto* quads = reinterpret_cast<pyasge::Quad*>(vertices.mutable_data());
+      if (!kernel)
+      {
+        pyasge::spriteQuads(items.data(), items.size(), quads);
+        return vertices;
+      }
+
+      for (auto candidate : { pyasge::VertexKernel::SCALAR, pyasge::VertexKernel::SSE4, pyasge::VertexKernel::AVX2,
+                              pyasge::VertexKernel::NEON })
+      {
+        if (*kernel == pyasge::vertexKernelName(candidate))
+        {
+          if (!pyasge::vertexKernelSupported(candidate))
+          {
+            throw py::value_error("The " + *kernel + " vertex kernel is not supported by this processor");
+          }
+          pyasge::spriteQuads(items.data(), items.size(), quads, candidate);
+          return vertices;
+        }
+      }
+      throw py::value_error("Unknown vertex kernel " + *kernel);
+    },
+    py::arg("sprites"), py::arg("kernel") = py::none(),
+    R"(
+      Generates the vertices of many sprites' quads at once.
+
+      These are the vertices drawn for the sprites by a
+      :class:`StaticBatch`, or by a :class:`SpriteBatch` where instancing
+      is unavailable. Sprites are transformed several at a time using the
+      widest SIMD instructions the processor supports, chosen when the
+      module loads. Every kernel gives exactly the same result as the
+      scalar one, so a kernel can be named to compare or time them.
+      Sprites without a texture are given zero texture coordinates.
+
+      :param sprites: The sprites to generate vertices for.
+      :param kernel: One of :func:`vertex_kernels`, or None for the widest.
+      :returns: A float32 array of shape (N, 4, 8) holding, for the top left, top right, bottom right and bottom left corners, the position, texture coordinates and tint of each vertex.
+      :type: numpy.ndarray[numpy.float32]
+      :raises ValueError: If the kernel is unknown or not supported.
+
+      Example
+      -------
+      >>> scalar = pyasge.sprite_vertices(sprites, "scalar")
+      >>> for kernel in pyasge.vertex_kernels():
+      ...     assert (pyasge.sprite_vertices(sprites, kernel).view("u4") == scalar.view("u4")).all()
+  )");
+
+  module.def(
+    "pack_vertices",
+    [](const py::array_t<float, py::array::c_style | py::array::forcecast>& vertices, bool compact) {
+      if (vertices.ndim() != 3 || vertices.shape(1) != 4 || vertices.shape(2) != 8)
+      {
+        throw py::value_error("vertices must be an array of shape (N, 4, 8)");
+      }
+
+      std::vector<pyasge::Quad> quads(static_cast<std::size_t>(vertices.shape(0)));
+      std::memcpy(quads.data(), vertices.data(), quads.size() * sizeof(pyasge::Quad));
+      pyasge::PackedQuads packed;
+      pyasge::packQuads(quads, compact, packed);
+
+      const auto size = static_cast<py::ssize_t>(pyasge::vertexSize(packed.format));
+      py::array_t<std::uint8_t> bytes({ static_cast<py::ssize_t>(quads.size() * 4), size });
+      const auto* source = packed.format == pyasge::VertexFormat::FULL
+                             ? reinterpret_cast<const std::uint8_t*>(quads.data())
+                             : packed.bytes.data();
+      std::memcpy(bytes.mutable_data(), source, static_cast<std::size_t>(bytes.size()));
+
+      const char* format = packed.format == pyasge::VertexFormat::HALF      ? "half"
+                           : packed.format == pyasge::VertexFormat::COMPACT ? "compact"
+                                                                            : "full";
+      return py::make_tuple(format, py::make_tuple(packed.origin_x, packed.origin_y), bytes);
+    },
+    py::arg("vertices"), py::arg("compact") = true,
+    R"(
+      Packs quad vertices into the format static batches and tile maps upload.
+
+      Shows how :attr:`Renderer.compact_vertices` would store a set of
+      quads, such as those returned by :func:`sprite_vertices`. Compact
+      vertices keep float positions with unorm16 texture coordinates and an
+      RGBA8 tint. Half vertices store positions as half floats relative to
+      the origin instead. Full vertices are the floats as given.
+
+      :param vertices: A float32 array of shape (N, 4, 8), laid out as :func:`sprite_vertices` returns.
+      :param compact: Whether compact formats may be used.
+      :returns: The format chosen, ``"full"``, ``"compact"`` or ``"half"``, the (x, y) origin of half positions, and a uint8 array holding each vertex's bytes as uploaded.
+      :type: tuple[str, tuple[float, float], numpy.ndarray[numpy.uint8]]
+  )");
 }
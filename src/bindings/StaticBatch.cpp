@@ -0,0 +1,119 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include <Engine/OpenGL/GLSprite.hpp>
+#include <pybind11/pybind11.h>
+#include "extensions/StaticBatch.hpp"
+
+namespace py = pybind11;
+
+void initStaticBatch(py::module_& module)
+{
+  py::class_<pyasge::StaticBatch>(
+    module, "StaticBatch", py::is_final(),
+    R"(
+    Scenery baked into a GPU buffer and drawn with a handful of calls.
+
+    Built using :meth:`Renderer.build_static_batch`. The batch stores its
+    quads in a static vertex buffer, ordered by z-order and texture, so
+    rendering it costs one draw per texture regardless of how many sprites
+    it holds. The camera view is applied when the batch is rendered, so a
+    batch can be scrolled over freely without being rebuilt.
+
+    Sprites and tiles are baked as they were when the batch was built.
+    Changing one afterwards has no effect until it is passed to
+    :meth:`update`, which rewrites just its quad, or the batch is rebuilt.
+    Changing a texture or z-order rebuilds the whole batch, as the quad
+    moves within the buffer.
+
+    Batches draw straight away rather than being batched by the renderer,
+    so a batch appears beneath any sprite rendered in the same frame. Render
+    batches first, as backgrounds.
+
+    Example
+    -------
+    >>> self.scenery = self.renderer.build_static_batch([self.sky, *self.hills, *self.trees])
+    >>>
+    >>> def update(self, game_time: pyasge.GameTime) -> None:
+    >>>   self.trees[0].colour = pyasge.COLOURS.RED
+    >>>   self.scenery.update(self.trees[0])
+    >>>
+    >>> def render(self, game_time: pyasge.GameTime) -> None:
+    >>>   self.scenery.render()
+  )")
+
+    .def(
+      "render",
+      &pyasge::StaticBatch::render,
+      R"(
+      Draws the batch using the current camera view and viewport.
+
+      :returns: True if anything was drawn.
+      :type: bool
+    )")
+
+    .def(
+      "rebuild",
+      &pyasge::StaticBatch::build,
+      "Re-bakes every sprite and tile in the batch, picking up any changes made to them.")
+
+    .def(
+      "update",
+      py::overload_cast<const ASGE::Sprite&>(&pyasge::StaticBatch::update),
+      py::arg("sprite"),
+      R"(
+      Re-bakes a single sprite.
+
+      :param sprite: A sprite in the batch.
+      :returns: True if the sprite belongs to the batch.
+      :type: bool
+    )")
+
+    .def(
+      "update",
+      py::overload_cast<std::size_t>(&pyasge::StaticBatch::update),
+      py::arg("index"),
+      R"(
+      Re-bakes a single item, such as a tile, by its position in the list the batch was built from.
+
+      :param index: The item's position.
+      :returns: True if the index is in range.
+      :type: bool
+    )")
+
+    .def("__len__", &pyasge::StaticBatch::size)
+
+    .def_property_readonly(
+      "quads",
+      &pyasge::StaticBatch::quads,
+      R"(
+      The number of quads baked into the batch.
+
+      Sprites without a texture are not drawn and are not counted.
+
+      :getter: Returns the number of quads.
+      :type: int
+    )")
+
+    .def_property_readonly(
+      "draws",
+      &pyasge::StaticBatch::draws,
+      R"(
+      The number of draw calls needed to render the batch.
+
+      :getter: Returns one per run of quads sharing a texture.
+      :type: int
+    )");
+}
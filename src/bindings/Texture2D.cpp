@@ -17,13 +17,30 @@
 #include <magic_enum.hpp>
 #include <pybind11/attr.h>
 #include <pybind11/pybind11.h>
+#include "extensions/CollisionMask.hpp"
+#include "extensions/RenderContext.hpp"
 namespace py = pybind11;
+
+namespace
+{
+  /// Textures owned by python drop their collision mask when destroyed, so
+  /// a new texture allocated at the same address does not inherit it.
+  struct TextureDeleter
+  {
+    void operator()(ASGE::GLTexture* texture) const
+    {
+      pyasge::CollisionMask::forget(*texture);
+      delete texture;
+    }
+  };
+}
+
 void initTexture2D(py::module_& module)
 {
   // ----------------------------------------------------
   // ASGE GLTexture
   // ----------------------------------------------------
-  py::class_<ASGE::GLTexture> texture(
+  py::class_<ASGE::GLTexture, std::unique_ptr<ASGE::GLTexture, TextureDeleter>> texture(
     module, "Texture", py::is_final(), "A texture which can attach to the GPU");
 
   py::enum_<ASGE::Texture2D::Format>(
@@ -130,7 +147,14 @@ void initTexture2D(py::module_& module)
 
   texture.def(
     "setMagFilter",
-    [](ASGE::GLTexture& self, ASGE::Texture2D::MagFilter filter) { self.updateMagFilter(filter); },
+    [](ASGE::GLTexture& self, ASGE::Texture2D::MagFilter filter)
+    {
+      auto* context = pyasge::RenderContext::active();
+      if (context == nullptr || context->stateCache().magFilter(self.getID(), static_cast<int>(filter)))
+      {
+        self.updateMagFilter(filter);
+      }
+    },
     py::arg("filter"),
     R"(
         Updates the magnification filter.
@@ -0,0 +1,551 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include <Engine/OpenGL/GLRenderer.hpp>
+#include <algorithm>
+#include <optional>
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <string>
+#include "extensions/TileCollider.hpp"
+#include "extensions/TileMap.hpp"
+#include "extensions/TileSet.hpp"
+
+namespace py = pybind11;
+
+namespace
+{
+  using Cell   = std::pair<int, int>;
+  using Floats = py::array_t<float, py::array::c_style | py::array::forcecast>;
+
+  void checkCell(const pyasge::TileMap& self, const Cell& cell)
+  {
+    if (!self.contains(cell.first, cell.second))
+    {
+      throw py::index_error("cell (" + std::to_string(cell.first) + ", " + std::to_string(cell.second) +
+                            ") is outside of the map");
+    }
+  }
+
+  py::ssize_t checkRows(const Floats& array, py::ssize_t columns, const char* message)
+  {
+    if (array.ndim() != 2 || array.shape(1) != columns)
+    {
+      throw py::value_error(message);
+    }
+    return array.shape(0);
+  }
+}
+
+void initTileMap(py::module_& module)
+{
+  py::class_<pyasge::TileMap> tile_map(
+    module, "TileMap", py::is_final(),
+    R"(
+    A large grid of tiles, drawn in cached chunks.
+
+    Rendering every tile of a map with :meth:`Renderer.render` rebuilds
+    each tile's quad every frame. A tile map instead splits the grid into
+    square chunks and bakes each chunk's tiles into a vertex buffer on the
+    GPU. A chunk is only rebuilt after one of its cells changes, and only
+    the chunks overlapping the camera view are drawn, so editing a single
+    tile costs one chunk and the size of the map barely matters.
+
+    Cells hold 2 byte tile ids from the map's :class:`TileSet`. Each
+    distinct tile, its texture, source rectangle, size, tint, opacity and
+    rotation, is added to the tileset once, using :meth:`add_tile` or the
+    tileset directly, and the returned id is written into the cells that
+    show it. An id of 0 leaves a cell empty. Tiles are drawn with their
+    top left corner at the cell's corner, so tiles larger than the map's
+    tile size overlap the cells below and to the right of them.
+
+    Like :class:`StaticBatch`, the map draws immediately rather than being
+    batched by the renderer, so it appears beneath any sprite rendered in
+    the same frame.
+
+    Tiles flagged solid in the tileset, using :meth:`TileSet.set_solid`,
+    can be collided with. :meth:`is_solid` and :meth:`overlaps_solid` test
+    points and boxes, and :meth:`move` sweeps a box through the map,
+    stopping it against solid cells while letting it slide along them.
+    Their ``_many`` variants run over NumPy arrays of bodies at once.
+
+    Example
+    -------
+    >>> self.map = pyasge.TileMap(self.renderer, 1000, 1000, 32, 32)
+    >>> grass = pyasge.Tile()
+    >>> grass.texture = self.renderer.loadTexture("/data/tiles.png")
+    >>> grass.src_rect = [0, 0, 32, 32]
+    >>> grass.width = 32
+    >>> grass.height = 32
+    >>> self.map.set_tiles(numpy.full((1000, 1000), self.map.add_tile(grass), dtype=numpy.uint16))
+    >>>
+    >>> def render(self, game_time: pyasge.GameTime) -> None:
+    >>>   self.renderer.setViewport(pyasge.Viewport(0, 0, 1024, 768))
+    >>>   self.renderer.setProjectionMatrix(self.camera.view)
+    >>>   self.map.render()
+  )");
+
+  py::enum_<pyasge::TileCollider::Contact>(
+    tile_map, "Contact", py::arithmetic(),
+    R"(
+    The sides of a box stopped by solid tiles during :meth:`TileMap.move`.
+
+    Moves return a combination of these flags, which can be tested with ``&``.
+    With y pointing down the screen, ``BOTTOM`` means the box landed on a floor.
+  )")
+    .value("NONE", pyasge::TileCollider::Contact::NONE, "The box moved freely.")
+    .value("LEFT", pyasge::TileCollider::Contact::LEFT, "The box's left side hit a tile.")
+    .value("RIGHT", pyasge::TileCollider::Contact::RIGHT, "The box's right side hit a tile.")
+    .value("TOP", pyasge::TileCollider::Contact::TOP, "The box's top hit a tile.")
+    .value("BOTTOM", pyasge::TileCollider::Contact::BOTTOM, "The box's bottom hit a tile.");
+
+  tile_map
+    .def(
+      py::init<ASGE::GLRenderer&, int, int, float, float, int, std::shared_ptr<pyasge::TileSet>>(),
+      py::arg("renderer"),
+      py::arg("columns"),
+      py::arg("rows"),
+      py::arg("tile_width"),
+      py::arg("tile_height"),
+      py::arg("chunk_size") = 32,
+      py::arg("tileset") = nullptr,
+      py::keep_alive<1, 2>(),
+      R"(
+      Creates an empty map.
+
+      :param renderer: The renderer the map draws with.
+      :param columns: The width of the map in tiles.
+      :param rows: The height of the map in tiles.
+      :param tile_width: The width of a cell in world units.
+      :param tile_height: The height of a cell in world units.
+      :param chunk_size: The width and height of a chunk in tiles, between 1 and 256.
+      :param tileset: The tileset the map's ids refer to, or None to create a new one.
+    )")
+
+    .def_property_readonly(
+      "tileset",
+      &pyasge::TileMap::tileSet,
+      R"(
+      The tileset the map's ids refer to.
+
+      :type: pyasge.TileSet
+    )")
+
+    .def(
+      "add_tile",
+      [](pyasge::TileMap& self, const ASGE::Tile& tile)
+      {
+        const auto id = self.tileSet()->add(tile);
+        if (id == 0)
+        {
+          throw py::value_error("a tileset holds at most 65535 tiles");
+        }
+        return id;
+      },
+      py::arg("tile"),
+      R"(
+      Adds a tile to the map's tileset.
+
+      The tile is copied, so changing it afterwards does not affect the map.
+      Use :meth:`set_tile` to replace it.
+
+      :param tile: The tile to register.
+      :returns: The id to write into cells showing the tile.
+      :type: int
+    )")
+
+    .def(
+      "set_tile",
+      [](pyasge::TileMap& self, std::uint16_t id, const ASGE::Tile& tile) { return self.tileSet()->set(id, tile); },
+      py::arg("id"),
+      py::arg("tile"),
+      R"(
+      Replaces a tile in the map's tileset, updating every cell that shows it.
+
+      As any chunk may use the tile, every chunk of every map sharing the
+      tileset is rebuilt when next drawn.
+
+      :param id: The id returned by :meth:`add_tile`.
+      :param tile: The tile's new appearance.
+      :returns: True if the id is registered.
+      :type: bool
+    )")
+
+    .def(
+      "get_tile",
+      [](const pyasge::TileMap& self, std::uint16_t id)
+      {
+        const auto* tile = self.tileSet()->get(id);
+        return tile != nullptr ? std::optional<ASGE::Tile>(*tile) : std::nullopt;
+      },
+      py::arg("id"),
+      R"(
+      Returns a copy of a registered tile, or None if the id is not registered.
+    )")
+
+    .def(
+      "__getitem__",
+      [](const pyasge::TileMap& self, const Cell& cell)
+      {
+        checkCell(self, cell);
+        return self.get(cell.first, cell.second);
+      },
+      py::arg("cell"),
+      "Returns the id in the cell at (column, row).")
+
+    .def(
+      "tile_at",
+      [](const pyasge::TileMap& self, float x, float y)
+      {
+        int column = 0;
+        int row    = 0;
+        return self.cellAt(x, y, column, row) ? self.get(column, row) : std::uint16_t{ 0 };
+      },
+      py::arg("x"),
+      py::arg("y"),
+      R"(
+      Returns the id of the tile under a world position.
+
+      :returns: The tile's id, or 0 if the cell is empty or outside of the map.
+      :type: int
+    )")
+
+    .def(
+      "cell_at",
+      [](const pyasge::TileMap& self, float x, float y) -> std::optional<Cell>
+      {
+        int column = 0;
+        int row    = 0;
+        return self.cellAt(x, y, column, row) ? std::optional<Cell>({ column, row }) : std::nullopt;
+      },
+      py::arg("x"),
+      py::arg("y"),
+      R"(
+      Returns the (column, row) of the cell under a world position.
+
+      :returns: The cell, or None if the position is outside of the map.
+      :type: tuple[int, int]
+    )")
+
+    .def(
+      "__setitem__",
+      [](pyasge::TileMap& self, const Cell& cell, std::uint16_t id)
+      {
+        checkCell(self, cell);
+        if (!self.set(cell.first, cell.second, id))
+        {
+          throw py::value_error("tile id " + std::to_string(id) + " is not registered");
+        }
+      },
+      py::arg("cell"),
+      py::arg("id"),
+      "Sets the id in the cell at (column, row), marking its chunk for rebuilding.")
+
+    .def(
+      "set_tiles",
+      [](pyasge::TileMap& self, const py::array_t<std::uint16_t, py::array::c_style | py::array::forcecast>& ids,
+         int column, int row)
+      {
+        if (ids.ndim() != 2)
+        {
+          throw py::value_error("tile ids must be a 2D array of rows");
+        }
+        if (!self.assign(
+              column, row, static_cast<int>(ids.shape(1)), static_cast<int>(ids.shape(0)), ids.data()))
+        {
+          throw py::value_error("tile ids must be registered with the map");
+        }
+      },
+      py::arg("ids"),
+      py::arg("column") = 0,
+      py::arg("row") = 0,
+      R"(
+      Copies a block of tile ids into the map.
+
+      Only the chunks the block covers are rebuilt, and cells falling
+      outside of the map are ignored.
+
+      :param ids: A 2D array of ids indexed by [row, column].
+      :param column: The column the block's first column is written to.
+      :param row: The row the block's first row is written to.
+    )")
+
+    .def(
+      "get_tiles",
+      [](const pyasge::TileMap& self, int column, int row, int width, int height)
+      {
+        width  = width < 0 ? self.columns() - column : width;
+        height = height < 0 ? self.rows() - row : height;
+        py::array_t<std::uint16_t> ids({ std::max(height, 0), std::max(width, 0) });
+        self.copy(column, row, std::max(width, 0), std::max(height, 0), ids.mutable_data());
+        return ids;
+      },
+      py::arg("column") = 0,
+      py::arg("row") = 0,
+      py::arg("width") = -1,
+      py::arg("height") = -1,
+      R"(
+      Copies a block of tile ids out of the map.
+
+      :param column: The first column to copy.
+      :param row: The first row to copy.
+      :param width: The number of columns to copy, or -1 for the rest of the map.
+      :param height: The number of rows to copy, or -1 for the rest of the map.
+      :returns: A 2D array of ids indexed by [row, column].
+      :type: numpy.ndarray[numpy.uint16]
+    )")
+
+    .def(
+      "is_solid",
+      [](const pyasge::TileMap& self, float x, float y) { return pyasge::TileCollider(self).solidAt(x, y); },
+      py::arg("x"),
+      py::arg("y"),
+      R"(
+      Checks whether a world position lies in a solid tile.
+
+      :returns: True if the cell under the position holds a solid tile.
+      :type: bool
+    )")
+
+    .def(
+      "overlaps_solid",
+      [](const pyasge::TileMap& self, float x, float y, float width, float height)
+      { return pyasge::TileCollider(self).overlaps({ x, y, width, height }); },
+      py::arg("x"),
+      py::arg("y"),
+      py::arg("width"),
+      py::arg("height"),
+      R"(
+      Checks whether a box overlaps any solid tile.
+
+      A box whose edge rests exactly on a tile's edge doesn't overlap it.
+
+      :param x: The left of the box in world units.
+      :param y: The top of the box in world units.
+      :returns: True if any cell the box covers holds a solid tile.
+      :type: bool
+    )")
+
+    .def(
+      "move",
+      [](const pyasge::TileMap& self, float x, float y, float width, float height, float dx, float dy)
+      {
+        pyasge::TileCollider::Box box{ x, y, width, height };
+        const auto contact = pyasge::TileCollider(self).move(box, dx, dy);
+        return py::make_tuple(box.x, box.y, static_cast<int>(contact));
+      },
+      py::arg("x"),
+      py::arg("y"),
+      py::arg("width"),
+      py::arg("height"),
+      py::arg("dx"),
+      py::arg("dy"),
+      R"(
+      Moves a box through the map, stopping it at solid tiles.
+
+      The box moves along x and then along y. On each axis it stops flush
+      against the first solid tile its leading edge would cross, however
+      far it travels, and the rest of its motion on the other axis is kept
+      so that it slides along walls and floors. A box already overlapping
+      solid tiles is free to move out of them.
+
+      :param x: The left of the box in world units.
+      :param y: The top of the box in world units.
+      :param dx: The distance to move along x.
+      :param dy: The distance to move along y.
+      :returns: The new (x, y) of the box and the :class:`TileMap.Contact` flags for the sides that were stopped.
+      :type: tuple[float, float, int]
+
+      Example
+      -------
+      >>> player.x, player.y, contact = self.map.move(
+      >>>   player.x, player.y, player.width, player.height, velocity_x * dt, velocity_y * dt)
+      >>> if contact & pyasge.TileMap.Contact.BOTTOM:
+      >>>   velocity_y = 0
+      >>>   on_ground = True
+    )")
+
+    .def(
+      "is_solid_many",
+      [](const pyasge::TileMap& self, const Floats& points)
+      {
+        const auto count = checkRows(points, 2, "points must be an array of shape (N, 2)");
+        py::array_t<bool> solid(count);
+        auto* out = solid.mutable_data();
+        const auto* xy = points.data();
+
+        pyasge::TileCollider collider(self);
+        for (py::ssize_t i = 0; i < count; ++i)
+        {
+          out[i] = collider.solidAt(xy[i * 2], xy[i * 2 + 1]);
+        }
+        return solid;
+      },
+      py::arg("points"),
+      R"(
+      Checks whether each of an array of world positions lies in a solid tile.
+
+      :param points: A float32 array of shape (N, 2) holding (x, y) positions.
+      :returns: An array of N booleans.
+      :type: numpy.ndarray[bool]
+    )")
+
+    .def(
+      "overlaps_solid_many",
+      [](const pyasge::TileMap& self, const Floats& boxes)
+      {
+        const auto count = checkRows(boxes, 4, "boxes must be an array of shape (N, 4)");
+        py::array_t<bool> solid(count);
+        auto* out = solid.mutable_data();
+        const auto* box = boxes.data();
+
+        pyasge::TileCollider collider(self);
+        for (py::ssize_t i = 0; i < count; ++i, box += 4)
+        {
+          out[i] = collider.overlaps({ box[0], box[1], box[2], box[3] });
+        }
+        return solid;
+      },
+      py::arg("boxes"),
+      R"(
+      Checks whether each of an array of boxes overlaps a solid tile.
+
+      :param boxes: A float32 array of shape (N, 4) holding (x, y, width, height) boxes.
+      :returns: An array of N booleans.
+      :type: numpy.ndarray[bool]
+    )")
+
+    .def(
+      "move_many",
+      [](const pyasge::TileMap& self, const Floats& boxes, const Floats& deltas)
+      {
+        const auto count = checkRows(boxes, 4, "boxes must be an array of shape (N, 4)");
+        if (checkRows(deltas, 2, "deltas must be an array of shape (N, 2)") != count)
+        {
+          throw py::value_error("boxes and deltas must have the same number of rows");
+        }
+
+        py::array_t<float> positions({ count, py::ssize_t{ 2 } });
+        py::array_t<std::uint8_t> contacts(count);
+        auto* xy        = positions.mutable_data();
+        auto* contact   = contacts.mutable_data();
+        const auto* box = boxes.data();
+        const auto* d   = deltas.data();
+
+        pyasge::TileCollider collider(self);
+        for (py::ssize_t i = 0; i < count; ++i, box += 4)
+        {
+          pyasge::TileCollider::Box moved{ box[0], box[1], box[2], box[3] };
+          contact[i]    = collider.move(moved, d[i * 2], d[i * 2 + 1]);
+          xy[i * 2]     = moved.x;
+          xy[i * 2 + 1] = moved.y;
+        }
+        return py::make_tuple(positions, contacts);
+      },
+      py::arg("boxes"),
+      py::arg("deltas"),
+      R"(
+      Moves an array of boxes through the map, as :meth:`move` does for one.
+
+      The boxes are moved independently, so they don't collide with each
+      other.
+
+      :param boxes: A float32 array of shape (N, 4) holding (x, y, width, height) boxes.
+      :param deltas: A float32 array of shape (N, 2) holding the (dx, dy) to move each box.
+      :returns: A float32 array of shape (N, 2) with the new positions and a uint8 array of N :class:`TileMap.Contact` flags.
+      :type: tuple[numpy.ndarray[numpy.float32], numpy.ndarray[numpy.uint8]]
+
+      Example
+      -------
+      >>> deltas = velocities * game_time.fixed_timestep
+      >>> positions, contacts = self.map.move_many(boxes, deltas)
+      >>> boxes[:, :2] = positions
+      >>> velocities[(contacts & int(pyasge.TileMap.Contact.BOTTOM)) != 0, 1] = 0
+    )")
+
+    .def(
+      "render",
+      &pyasge::TileMap::render,
+      R"(
+      Draws the chunks overlapping the current camera view.
+
+      Chunks that have changed since they were last drawn are rebuilt first.
+
+      :returns: The number of draw calls issued.
+      :type: int
+    )")
+
+    .def_property(
+      "position",
+      [](const pyasge::TileMap& self) { return py::make_tuple(self.x(), self.y()); },
+      [](pyasge::TileMap& self, const std::pair<float, float>& position)
+      { self.setPosition(position.first, position.second); },
+      R"(
+      The world position of the map's top left corner.
+
+      Moving the map rebuilds every chunk, so it is not suited to scrolling.
+      Move the camera instead.
+
+      :type: tuple[float, float]
+    )")
+
+    .def_property(
+      "opacity",
+      &pyasge::TileMap::opacity,
+      &pyasge::TileMap::setOpacity,
+      R"(
+      The opacity of the whole map, multiplied with each tile's own.
+
+      Changing it rebuilds every chunk.
+
+      :type: float
+    )")
+
+    .def_property_readonly(
+      "memory",
+      &pyasge::TileMap::memory,
+      R"(
+      The bytes of memory held by the map's cells.
+
+      Only chunks with tiles in them are counted. The tileset is shared, so
+      is not included.
+
+      :type: int
+    )")
+
+    .def_property_readonly("columns", &pyasge::TileMap::columns, "The width of the map in tiles.")
+    .def_property_readonly("rows", &pyasge::TileMap::rows, "The height of the map in tiles.")
+    .def_property_readonly("chunk_size", &pyasge::TileMap::chunkSize, "The width and height of a chunk in tiles.")
+    .def_property_readonly("tile_width", &pyasge::TileMap::tileWidth, "The width of a cell in world units.")
+    .def_property_readonly("tile_height", &pyasge::TileMap::tileHeight, "The height of a cell in world units.")
+    .def_property_readonly(
+      "tile_count", [](const pyasge::TileMap& self) { return self.tileSet()->size(); }, "The number of tiles in the tileset.")
+
+    .def_property_readonly(
+      "chunks_drawn",
+      [](const pyasge::TileMap& self) { return self.statistics().chunks_drawn; },
+      "The number of chunks drawn by the last call to :meth:`render`.")
+
+    .def_property_readonly(
+      "chunks_culled",
+      [](const pyasge::TileMap& self) { return self.statistics().chunks_culled; },
+      "The number of chunks skipped by the last call to :meth:`render` as they were outside of the view.")
+
+    .def_property_readonly(
+      "chunks_rebuilt",
+      [](const pyasge::TileMap& self) { return self.statistics().chunks_rebuilt; },
+      "The number of chunks rebuilt by the last call to :meth:`render`.");
+}
@@ -0,0 +1,166 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include <Engine/OpenGL/GLTexture.hpp>
+#include <memory>
+#include <optional>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <string>
+#include "extensions/TileSet.hpp"
+
+namespace py = pybind11;
+
+void initTileSet(py::module_& module)
+{
+  py::class_<pyasge::TileSet, std::shared_ptr<pyasge::TileSet>>(
+    module, "TileSet", py::is_final(),
+    R"(
+    The distinct tiles a :class:`TileMap` is built from.
+
+    Every :class:`Tile` is a Python object with its own attribute dictionary,
+    which costs hundreds of bytes per cell when a map is built from them. A
+    tileset instead stores each distinct tile once, its texture, source
+    rectangle, size, tint, opacity and rotation, and a map stores a 2 byte
+    id per cell. Ids start at 1, as 0 marks an empty cell, and a set holds
+    up to 65535 tiles. Maps may share a tileset, and changing one of its
+    tiles updates every map using it.
+
+    Example
+    -------
+    >>> tiles = pyasge.TileSet()
+    >>> sheet = self.renderer.loadTexture("/data/terrain.png")
+    >>> grass, count = tiles.add_sheet(sheet, 32, 32)
+    >>> self.ground = pyasge.TileMap(self.renderer, 512, 512, 32, 32, tileset=tiles)
+    >>> self.decals = pyasge.TileMap(self.renderer, 512, 512, 32, 32, tileset=tiles)
+    >>> self.ground.set_tiles(numpy.full((512, 512), grass, dtype=numpy.uint16))
+  )")
+
+    .def(py::init<>(), "Creates an empty tileset.")
+
+    .def(
+      "add",
+      [](pyasge::TileSet& self, const ASGE::Tile& tile)
+      {
+        const auto id = self.add(tile);
+        if (id == 0)
+        {
+          throw py::value_error("a tileset holds at most 65535 tiles");
+        }
+        return id;
+      },
+      py::arg("tile"),
+      R"(
+      Adds a copy of a tile.
+
+      :param tile: The tile to add.
+      :returns: The tile's id.
+      :type: int
+    )")
+
+    .def(
+      "add_sheet",
+      [](pyasge::TileSet& self, ASGE::GLTexture* texture, int tile_width, int tile_height, int margin, int spacing)
+      {
+        std::size_t count = 0;
+        const auto first  = self.addSheet(texture, tile_width, tile_height, margin, spacing, count);
+        if (first == 0)
+        {
+          throw py::value_error("the sheet holds no tiles or they don't fit in the tileset");
+        }
+        return py::make_tuple(first, count);
+      },
+      py::arg("texture"),
+      py::arg("tile_width"),
+      py::arg("tile_height"),
+      py::arg("margin") = 0,
+      py::arg("spacing") = 0,
+      R"(
+      Adds a tile for every cell of a sprite sheet.
+
+      Cells are added row by row, so the cell at (column, row) of the sheet
+      has the id ``first + row * columns + column``.
+
+      :param texture: The sprite sheet.
+      :param tile_width: The width of a cell in pixels.
+      :param tile_height: The height of a cell in pixels.
+      :param margin: The pixels around the edge of the sheet.
+      :param spacing: The pixels between cells.
+      :returns: The id of the first cell and the number of cells added.
+      :type: tuple[int, int]
+    )")
+
+    .def(
+      "__getitem__",
+      [](const pyasge::TileSet& self, std::uint16_t id)
+      {
+        const auto* tile = self.get(id);
+        if (tile == nullptr)
+        {
+          throw py::index_error("tile id " + std::to_string(id) + " is not in the tileset");
+        }
+        return *tile;
+      },
+      py::arg("id"),
+      "Returns a copy of the tile with the given id.")
+
+    .def(
+      "__setitem__",
+      [](pyasge::TileSet& self, std::uint16_t id, const ASGE::Tile& tile)
+      {
+        if (!self.set(id, tile))
+        {
+          throw py::index_error("tile id " + std::to_string(id) + " is not in the tileset");
+        }
+      },
+      py::arg("id"),
+      py::arg("tile"),
+      "Replaces the tile with the given id, rebuilding the maps using it when they are next drawn.")
+
+    .def(
+      "set_solid",
+      [](pyasge::TileSet& self, std::uint16_t id, bool solid)
+      {
+        if (!self.setSolid(id, solid))
+        {
+          throw py::index_error("tile id " + std::to_string(id) + " is not in the tileset");
+        }
+      },
+      py::arg("id"),
+      py::arg("solid") = true,
+      R"(
+      Flags a tile as solid, so that tile maps' collision queries stop at it.
+
+      :param id: The id of the tile.
+      :param solid: Whether the tile is solid.
+    )")
+
+    .def(
+      "is_solid",
+      &pyasge::TileSet::solid,
+      py::arg("id"),
+      "Returns whether the tile with the given id is solid.")
+
+    .def("__len__", &pyasge::TileSet::size)
+
+    .def_property_readonly(
+      "memory",
+      &pyasge::TileSet::memory,
+      R"(
+      The bytes of memory used to store the tiles.
+
+      :type: int
+    )");
+}
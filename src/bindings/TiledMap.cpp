@@ -0,0 +1,236 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include <Engine/OpenGL/GLRenderer.hpp>
+#include <memory>
+#include <optional>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <string>
+#include "extensions/TiledMap.hpp"
+
+namespace py = pybind11;
+
+namespace
+{
+  std::optional<std::size_t> findLayer(const pyasge::TiledMap& self, const std::string& name)
+  {
+    for (std::size_t i = 0; i < self.layerCount(); ++i)
+    {
+      if (self.layerName(i) == name)
+      {
+        return i;
+      }
+    }
+    return std::nullopt;
+  }
+}
+
+void initTiledMap(py::module_& module)
+{
+  py::class_<pyasge::TiledMap>(
+    module, "TiledMap", py::is_final(),
+    R"(
+    A map made in the Tiled editor, streamed in around the camera.
+
+    Loads orthogonal maps saved as JSON (``.tmj`` or ``.json``) or TMX,
+    including external tilesets, group layers and infinite maps. Each tile
+    layer becomes a :class:`TileMap`, so no :class:`Tile` objects are
+    created. Layer data is kept compressed until it is needed: as the
+    camera moves, the chunks around the view are decoded on a worker
+    thread and filled in, while chunks far from the view are evicted. This
+    keeps level loading fast and lets worlds larger than memory be explored.
+
+    Layer data may be stored as CSV or base64, uncompressed or compressed
+    with zlib or gzip. Tiles flipped in the editor are drawn flipped, and
+    layer opacity, visibility and offsets are respected. Tiles are drawn
+    with their top left corner at the top left of their cell, and object
+    and image layers are ignored.
+
+    Example
+    -------
+    >>> self.world = pyasge.TiledMap(self.renderer, "/data/maps/world.tmj")
+    >>> self.world.wait()
+    >>>
+    >>> def render(self, game_time: pyasge.GameTime) -> None:
+    >>>   self.renderer.setProjectionMatrix(self.camera.view)
+    >>>   self.world.render()
+    >>>   self.renderer.render(self.player)
+  )")
+
+    .def(
+      py::init(
+        [](ASGE::GLRenderer& renderer, const std::string& path, int chunk_size, int load_margin, int evict_margin)
+        {
+          auto map = std::make_unique<pyasge::TiledMap>(renderer, path, chunk_size, load_margin, evict_margin);
+          if (!map->valid())
+          {
+            throw py::value_error(map->error());
+          }
+          return map;
+        }),
+      py::arg("renderer"),
+      py::arg("path"),
+      py::arg("chunk_size") = 32,
+      py::arg("load_margin") = 1,
+      py::arg("evict_margin") = 2,
+      py::keep_alive<1, 2>(),
+      R"(
+      Opens a map, without decoding any of its layers yet.
+
+      :param renderer: The renderer used to load the tilesets and draw the map.
+      :param path: The path to the map file.
+      :param chunk_size: The width and height of a chunk in tiles.
+      :param load_margin: How many chunks beyond the view to load.
+      :param evict_margin: How many chunks beyond the view to keep before evicting them.
+      :raises ValueError: If the map can't be read or is not orthogonal.
+    )")
+
+    .def(
+      "update",
+      &pyasge::TiledMap::update,
+      R"(
+      Streams chunks in and out around the current camera view.
+
+      Called by :meth:`render`. Call it directly when rendering the layers
+      yourself. Chunks decoded by the worker since the last update are
+      filled in and the data for newly visible chunks is queued.
+    )")
+
+    .def(
+      "wait",
+      &pyasge::TiledMap::wait,
+      py::call_guard<py::gil_scoped_release>(),
+      R"(
+      Loads every chunk near the current camera view, blocking until it is done.
+
+      Useful on a loading screen or after teleporting the camera, to avoid
+      drawing the map while it fills in.
+    )")
+
+    .def(
+      "render",
+      &pyasge::TiledMap::render,
+      R"(
+      Updates the map and draws each visible layer, in the order they were saved.
+
+      :returns: The number of draw calls issued.
+      :type: int
+    )")
+
+    .def_property_readonly(
+      "tileset",
+      &pyasge::TiledMap::tileSet,
+      R"(
+      The tileset shared by every layer of the map.
+
+      Tiles are added to it as the chunks that use them are loaded. Other
+      tiles can be added to it as well, the map keeps track of the ids its
+      own tiles were given.
+
+      :type: pyasge.TileSet
+    )")
+
+    .def_property_readonly(
+      "layers",
+      [](const py::object& owner)
+      {
+        auto& self = owner.cast<pyasge::TiledMap&>();
+        py::list layers;
+        for (std::size_t i = 0; i < self.layerCount(); ++i)
+        {
+          layers.append(py::make_tuple(
+            self.layerName(i), py::cast(&self.layer(i), py::return_value_policy::reference_internal, owner)));
+        }
+        return layers;
+      },
+      R"(
+      The map's tile layers, with group layers flattened.
+
+      :getter: Returns a list of (name, tile map) tuples in drawing order.
+      :type: list[tuple[str, pyasge.TileMap]]
+    )")
+
+    .def(
+      "layer",
+      [](pyasge::TiledMap& self, const std::string& name) -> pyasge::TileMap*
+      {
+        auto index = findLayer(self, name);
+        return index ? &self.layer(*index) : nullptr;
+      },
+      py::return_value_policy::reference_internal,
+      py::arg("name"),
+      "Returns the tile map for the first layer with the given name, or None.")
+
+    .def(
+      "set_layer_visible",
+      [](pyasge::TiledMap& self, const std::string& name, bool visible)
+      {
+        auto index = findLayer(self, name);
+        if (index)
+        {
+          self.setLayerVisible(*index, visible);
+        }
+        return index.has_value();
+      },
+      py::arg("name"),
+      py::arg("visible"),
+      R"(
+      Shows or hides a layer when the map is rendered.
+
+      Hidden layers are still streamed, so they can be shown again immediately.
+
+      :returns: True if the layer exists.
+      :type: bool
+    )")
+
+    .def_property_readonly("columns", &pyasge::TiledMap::columns, "The width of the map in tiles.")
+    .def_property_readonly("rows", &pyasge::TiledMap::rows, "The height of the map in tiles.")
+    .def_property_readonly("tile_width", &pyasge::TiledMap::tileWidth, "The width of a tile in world units.")
+    .def_property_readonly("tile_height", &pyasge::TiledMap::tileHeight, "The height of a tile in world units.")
+    .def_property_readonly("infinite", &pyasge::TiledMap::infinite, "Whether the map was saved as an infinite map.")
+
+    .def_property_readonly(
+      "origin",
+      [](const pyasge::TiledMap& self) { return py::make_tuple(self.firstColumn(), self.firstRow()); },
+      R"(
+      The Tiled coordinates of the layers' first cell.
+
+      Infinite maps can extend to negative coordinates, so cell (column, row)
+      of a layer is at (origin[0] + column, origin[1] + row) in the editor.
+
+      :type: tuple[int, int]
+    )")
+
+    .def_property_readonly(
+      "chunks_loaded",
+      [](const pyasge::TiledMap& self) { return self.statistics().chunks_loaded; },
+      "The number of chunks currently filled in, across every layer.")
+
+    .def_property_readonly(
+      "chunks_pending",
+      [](const pyasge::TiledMap& self) { return self.statistics().chunks_pending; },
+      "The number of chunks near the view still waiting to be decoded.")
+
+    .def_property_readonly(
+      "chunks_evicted",
+      [](const pyasge::TiledMap& self) { return self.statistics().chunks_evicted; },
+      "The number of chunks evicted since the map was opened.")
+
+    .def_property_readonly(
+      "pieces_decoded",
+      [](const pyasge::TiledMap& self) { return self.statistics().pieces_decoded; },
+      "The number of pieces of layer data decoded since the map was opened.");
+}
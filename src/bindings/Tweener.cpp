@@ -0,0 +1,355 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include <Engine/Camera.hpp>
+#include <Engine/GameTime.hpp>
+#include <Engine/OpenGL/GLSprite.hpp>
+#include <Engine/Text.hpp>
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <pybind11/functional.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "extensions/Tweener.hpp"
+
+namespace py = pybind11;
+
+namespace
+{
+  using pyasge::Ease;
+  using pyasge::Tweener;
+
+  /// Keeps tweened objects and completion callbacks alive until their tweens end.
+  class PyTweener : public Tweener
+  {
+   public:
+    std::unordered_map<Id, py::object> targets;
+    std::unordered_map<Id, py::function> callbacks;
+
+    void release(const std::vector<Id>& ids)
+    {
+      for (auto id : ids)
+      {
+        targets.erase(id);
+        callbacks.erase(id);
+      }
+    }
+  };
+
+  constexpr std::array<std::pair<const char*, Tweener::Property>, 8> PROPERTIES = { {
+    { "x", Tweener::Property::X },
+    { "y", Tweener::Property::Y },
+    { "scale", Tweener::Property::SCALE },
+    { "rotation", Tweener::Property::ROTATION },
+    { "opacity", Tweener::Property::OPACITY },
+    { "width", Tweener::Property::WIDTH },
+    { "height", Tweener::Property::HEIGHT },
+    { "zoom", Tweener::Property::ZOOM },
+  } };
+
+  Tweener::Target targetOf(const py::object& object)
+  {
+    Tweener::Target target;
+    if (py::isinstance<ASGE::GLSprite>(object))
+    {
+      target.sprite = &object.cast<ASGE::GLSprite&>();
+    }
+    else if (py::isinstance<ASGE::Text>(object))
+    {
+      target.text = &object.cast<ASGE::Text&>();
+    }
+    else if (py::isinstance<ASGE::Camera>(object))
+    {
+      target.camera = &object.cast<ASGE::Camera&>();
+    }
+    else
+    {
+      throw py::type_error("only Sprite, Text and Camera properties can be tweened");
+    }
+    return target;
+  }
+
+  Tweener::Property propertyOf(const Tweener::Target& target, const std::string& name)
+  {
+    for (const auto& [key, property] : PROPERTIES)
+    {
+      if (name == key && Tweener::supports(target, property))
+      {
+        return property;
+      }
+    }
+
+    std::string supported;
+    for (const auto& [key, property] : PROPERTIES)
+    {
+      if (Tweener::supports(target, property))
+      {
+        supported += (supported.empty() ? "" : ", ") + std::string(key);
+      }
+    }
+    throw py::value_error("'" + name + "' can't be tweened, the object supports " + supported);
+  }
+
+  void step(PyTweener& self, double seconds)
+  {
+    self.update(seconds);
+
+    // callbacks are collected first, as they may add or cancel tweens
+    std::vector<py::function> completed;
+    for (auto id : self.completed())
+    {
+      auto callback = self.callbacks.find(id);
+      if (callback != self.callbacks.end())
+      {
+        completed.push_back(std::move(callback->second));
+      }
+    }
+    self.release(self.completed());
+
+    for (const auto& callback : completed)
+    {
+      callback();
+    }
+  }
+}
+
+void initTweener(py::module_& module)
+{
+  py::enum_<Ease>(
+    module, "Ease",
+    R"(
+    The easing curves a tween can follow.
+
+    ``IN`` curves start slowly and speed up, ``OUT`` curves start quickly
+    and slow down, and ``IN_OUT`` curves do both. ``BACK`` curves overshoot,
+    ``ELASTIC`` curves spring past the end and settle, and ``BOUNCE``
+    curves bounce off it.
+  )")
+    .value("LINEAR", Ease::LINEAR)
+    .value("SINE_IN", Ease::SINE_IN)
+    .value("SINE_OUT", Ease::SINE_OUT)
+    .value("SINE_IN_OUT", Ease::SINE_IN_OUT)
+    .value("QUAD_IN", Ease::QUAD_IN)
+    .value("QUAD_OUT", Ease::QUAD_OUT)
+    .value("QUAD_IN_OUT", Ease::QUAD_IN_OUT)
+    .value("CUBIC_IN", Ease::CUBIC_IN)
+    .value("CUBIC_OUT", Ease::CUBIC_OUT)
+    .value("CUBIC_IN_OUT", Ease::CUBIC_IN_OUT)
+    .value("QUART_IN", Ease::QUART_IN)
+    .value("QUART_OUT", Ease::QUART_OUT)
+    .value("QUART_IN_OUT", Ease::QUART_IN_OUT)
+    .value("QUINT_IN", Ease::QUINT_IN)
+    .value("QUINT_OUT", Ease::QUINT_OUT)
+    .value("QUINT_IN_OUT", Ease::QUINT_IN_OUT)
+    .value("EXPO_IN", Ease::EXPO_IN)
+    .value("EXPO_OUT", Ease::EXPO_OUT)
+    .value("EXPO_IN_OUT", Ease::EXPO_IN_OUT)
+    .value("CIRC_IN", Ease::CIRC_IN)
+    .value("CIRC_OUT", Ease::CIRC_OUT)
+    .value("CIRC_IN_OUT", Ease::CIRC_IN_OUT)
+    .value("BACK_IN", Ease::BACK_IN)
+    .value("BACK_OUT", Ease::BACK_OUT)
+    .value("BACK_IN_OUT", Ease::BACK_IN_OUT)
+    .value("ELASTIC_IN", Ease::ELASTIC_IN)
+    .value("ELASTIC_OUT", Ease::ELASTIC_OUT)
+    .value("ELASTIC_IN_OUT", Ease::ELASTIC_IN_OUT)
+    .value("BOUNCE_IN", Ease::BOUNCE_IN)
+    .value("BOUNCE_OUT", Ease::BOUNCE_OUT)
+    .value("BOUNCE_IN_OUT", Ease::BOUNCE_IN_OUT);
+
+  module.def(
+    "ease",
+    &pyasge::ease,
+    py::arg("curve"),
+    py::arg("progress"),
+    R"(
+    Maps progress from 0 to 1 along an easing curve.
+
+    :param curve: The :class:`Ease` curve to follow.
+    :param progress: How far through, clamped to [0, 1].
+    :returns: The eased progress, 0 at the start and 1 at the end, which ``BACK`` and ``ELASTIC`` curves overshoot.
+  )");
+
+  py::class_<PyTweener>(
+    module, "Tweener", py::is_final(),
+    R"(
+    Animates properties of sprites, texts and cameras over time.
+
+    A tween moves one property, such as a sprite's ``x`` or a text's
+    ``opacity``, from its value when the tween starts to a target value
+    along an :class:`Ease` curve. Tweens are stepped natively, all in the
+    one :meth:`update` call per frame, instead of lerping and setting
+    properties from Python.
+
+    Tweens can wait for a delay, follow another tween to build sequences,
+    repeat, play back and forth, and call a function when they complete.
+    The tweener holds a reference to each tweened object and callback until
+    its tween ends.
+
+    ============ =============================================================
+    Object       Properties
+    ============ =============================================================
+    Sprite       x, y, scale, rotation, opacity, width, height
+    Text         x, y, scale, opacity
+    Camera       x, y, zoom
+    ============ =============================================================
+
+    Example
+    -------
+    >>> self.tweens = pyasge.Tweener()
+    >>> slide = self.tweens.to(self.title, "x", 400, 0.6, ease=pyasge.Ease.BACK_OUT)
+    >>> self.tweens.to(self.title, "opacity", 0.0, 0.3, after=slide, delay=2.0,
+    >>>                on_complete=self.show_menu)
+    >>> self.tweens.to(self.coin, "scale", 1.2, 0.15, repeats=-1, yoyo=True)
+    >>>
+    >>> def update(self, game_time: pyasge.GameTime) -> None:
+    >>>   self.tweens.update(game_time)
+  )")
+
+    .def(py::init<>())
+
+    .def(
+      "to",
+      [](PyTweener& self, const py::object& object, const std::string& property, float value, float duration,
+         Ease ease, float delay, std::optional<Tweener::Id> after, int repeats, bool yoyo, bool relative,
+         std::optional<py::function> on_complete)
+      {
+        const auto target = targetOf(object);
+        Tweener::Options options;
+        options.ease     = ease;
+        options.delay    = delay;
+        options.after    = after.value_or(0);
+        options.repeats  = std::max(repeats, -1);
+        options.yoyo     = yoyo;
+        options.relative = relative;
+
+        const auto id = self.add(target, propertyOf(target, property), value, duration, options);
+        self.targets.emplace(id, object);
+        if (on_complete)
+        {
+          self.callbacks.emplace(id, std::move(*on_complete));
+        }
+        return id;
+      },
+      py::arg("target"),
+      py::arg("property"),
+      py::arg("value"),
+      py::arg("duration"),
+      py::arg("ease")        = Ease::LINEAR,
+      py::arg("delay")       = 0.0F,
+      py::arg("after")       = py::none(),
+      py::arg("repeats")     = 0,
+      py::arg("yoyo")        = false,
+      py::arg("relative")    = false,
+      py::arg("on_complete") = py::none(),
+      R"(
+      Starts a tween moving a property to a value.
+
+      The starting value is read when the tween starts, after its delay
+      and after the tween it follows, so a sequence of tweens on the same
+      property carries on from where the last one finished.
+
+      :param target: The :class:`Sprite`, :class:`Text` or :class:`Camera` to animate.
+      :param property: The name of the property, such as ``"x"`` or ``"opacity"``.
+      :param value: The value to finish at, or the amount to change by when relative.
+      :param duration: The seconds the tween takes.
+      :param ease: The :class:`Ease` curve to follow.
+      :param delay: Seconds to wait before starting, counted from when the tween could start.
+      :param after: The id of a tween to wait for. Tweens that have already ended don't hold it up.
+      :param repeats: How many more times to play after the first, or -1 to repeat until cancelled.
+      :param yoyo: Whether each repeat plays in the opposite direction.
+      :param relative: Whether value is added to the starting value rather than replacing it.
+      :param on_complete: A function called with no arguments once the tween and its repeats finish.
+      :returns: The tween's id, for ``after`` and :meth:`cancel`.
+    )")
+
+    .def(
+      "cancel",
+      [](PyTweener& self, Tweener::Id id)
+      {
+        const auto removed = self.cancel(id);
+        self.release(removed);
+        return !removed.empty();
+      },
+      py::arg("id"),
+      R"(
+      Stops a tween, and every tween waiting on it, where they are.
+
+      Completion callbacks are not called.
+
+      :returns: False if the tween had already ended.
+    )")
+
+    .def(
+      "cancel",
+      [](PyTweener& self, const py::object& object)
+      {
+        const auto removed = self.cancel(targetOf(object).object());
+        self.release(removed);
+        return removed.size();
+      },
+      py::arg("target"),
+      R"(
+      Stops every tween animating an object, and every tween waiting on them.
+
+      Use this before discarding an object that may still be tweening.
+
+      :returns: The number of tweens stopped.
+    )")
+
+    .def(
+      "clear",
+      [](PyTweener& self)
+      {
+        self.clear();
+        self.targets.clear();
+        self.callbacks.clear();
+      },
+      "Stops every tween without calling their callbacks.")
+
+    .def("is_active", &PyTweener::contains, py::arg("id"), "Whether a tween is still running or waiting to start.")
+
+    .def(
+      "update",
+      [](PyTweener& self, const ASGE::GameTime& game_time) { step(self, game_time.deltaInSecs()); },
+      py::arg("game_time"),
+      R"(
+      Advances every tween by the frame time, then calls the callbacks of those that completed.
+
+      :param game_time: The game time passed to ``update``.
+    )")
+
+    .def(
+      "update",
+      [](PyTweener& self, double seconds) { step(self, seconds); },
+      py::arg("seconds"),
+      "Advances every tween by a number of seconds.")
+
+    .def_property_readonly(
+      "completed",
+      [](const PyTweener& self) { return self.completed(); },
+      R"(
+      The ids of the tweens that completed during the last :meth:`update`.
+
+      :type: list[int]
+    )")
+
+    .def("__len__", &PyTweener::size);
+}
@@ -0,0 +1,102 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include "extensions/UniformBlocks.hpp"
+
+namespace py = pybind11;
+
+void initUniformBlock(py::module_& module)
+{
+  py::class_<pyasge::UniformBlock, std::shared_ptr<pyasge::UniformBlock>>(
+    module, "UniformBlock", py::is_final(),
+    R"(
+    A user defined uniform block shared by every shader that declares it.
+
+    Uniform blocks allow a group of values to be written once and read by
+    any number of shaders, rather than setting the same uniform on each
+    shader individually. Once registered with the renderer the block's
+    contents are uploaded once per frame and any pixel shader that declares
+    a block with the same name is connected to it automatically.
+
+    Blocks use the std140 layout rules. The simplest way to satisfy these is
+    to only declare ``vec4`` and ``mat4`` members. The renderer also manages
+    its own ``FrameData`` block, which can be used by any shader without
+    registering anything.
+
+    Example
+    -------
+
+    .. code-block:: c
+
+      layout (std140) uniform FrameData
+      {
+          vec4 time;        // elapsed, frame delta, fixed step, frame count
+          vec4 resolution;  // window width & height, base width & height
+          vec4 view;        // camera min_x, max_x, min_y, max_y
+          vec4 viewport;    // viewport x, y, width & height
+          vec4 mouse;       // cursor xy in pixels, cursor xy normalised
+      };
+
+      layout (std140) uniform Lighting
+      {
+          vec4 ambient;
+          vec4 sun_direction;
+      };
+
+    >>> self.lighting = pyasge.UniformBlock("Lighting", 32)
+    >>> self.lighting.data[0:4] = [0.2, 0.2, 0.3, 1.0]
+    >>> self.renderer.add_uniform_block(self.lighting)
+    >>> self.shader = self.renderer.loadPixelShader("/data/shaders/lit.frag")
+  )")
+
+    .def(
+      py::init<std::string, std::size_t>(),
+      py::arg("name"),
+      py::arg("size"),
+      R"(
+      Creates a uniform block.
+
+      :param name: The block's name, as declared in the shader.
+      :param size: The size of the block in bytes. This is rounded up to a multiple of 16.
+    )")
+
+    .def_property_readonly(
+      "name", &pyasge::UniformBlock::name, "The name of the block as declared in the shaders.")
+
+    .def_property_readonly(
+      "size", &pyasge::UniformBlock::size, "The size of the block in bytes.")
+
+    .def_property_readonly(
+      "data",
+      [](py::object self) {
+        auto& block = self.cast<pyasge::UniformBlock&>();
+        return py::array_t<float>(
+          { static_cast<py::ssize_t>(block.size() / sizeof(float)) },
+          { static_cast<py::ssize_t>(sizeof(float)) },
+          block.data(),
+          self);
+      },
+      R"(
+      The block's contents.
+
+      The data is exposed as a flat array of 32-bit floats that shares memory
+      with the block, so any writes are picked up by the next frame's upload.
+      Integer members can be written by taking a view of the array, for example
+      ``block.data.view(numpy.int32)``.
+
+      :type: numpy.ndarray[numpy.float32]
+    )");
+}
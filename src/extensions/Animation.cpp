@@ -0,0 +1,397 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/Animation.hpp"
+#include "extensions/Markup.hpp"
+
+#include <Engine/Sprite.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <filesystem>
+#include <utility>
+
+namespace
+{
+  using pyasge::AnimationClip;
+  using pyasge::markup::Node;
+
+  constexpr double NEVER = std::numeric_limits<double>::infinity();
+
+  bool contains(std::string text, std::string_view word)
+  {
+    std::transform(
+      text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text.find(word) != std::string::npos;
+  }
+
+  std::string resolve(const std::string& file, const std::string& relative)
+  {
+    const std::filesystem::path path(relative);
+    if (relative.empty() || path.is_absolute())
+    {
+      return relative;
+    }
+    return (std::filesystem::path(file).parent_path() / path).lexically_normal().generic_string();
+  }
+
+  /// Strips the extension and any trailing frame number from a frame's name, so "walk_03.png" becomes "walk".
+  std::string stem(const std::string& name)
+  {
+    auto base = std::filesystem::path(name).replace_extension().generic_string();
+    const auto numbered = base.find_last_not_of("0123456789");
+    if (numbered != std::string::npos && numbered + 1 < base.size())
+    {
+      base.erase(numbered + 1);
+      while (!base.empty() && (base.back() == '_' || base.back() == '-' || base.back() == ' ' || base.back() == '.'))
+      {
+        base.pop_back();
+      }
+    }
+    return base.empty() ? name : base;
+  }
+
+  struct NamedFrame
+  {
+    std::string name;
+    AnimationClip::Frame frame;
+  };
+
+  /// Reads the frames of either the hash or the array layout.
+  std::vector<NamedFrame> readFrames(const Node& frames, float frame_duration, bool& rotated)
+  {
+    std::vector<NamedFrame> found;
+    for (const auto& item : frames.items)
+    {
+      const auto* rect = item.child("frame");
+      if (rect == nullptr)
+      {
+        continue;
+      }
+
+      NamedFrame named;
+      named.name           = frames.type == Node::Type::OBJECT ? item.name : item.text("filename");
+      named.frame.rect     = { static_cast<float>(rect->number("x")),
+                               static_cast<float>(rect->number("y")),
+                               static_cast<float>(rect->number("w")),
+                               static_cast<float>(rect->number("h")) };
+      named.frame.duration = static_cast<float>(item.number("duration", frame_duration * 1000.0) / 1000.0);
+      rotated              = rotated || item.flag("rotated", false);
+      found.push_back(std::move(named));
+    }
+    return found;
+  }
+
+  AnimationClip::Loop loopFor(const std::string& direction)
+  {
+    return direction.rfind("pingpong", 0) == 0 ? AnimationClip::Loop::PING_PONG : AnimationClip::Loop::LOOP;
+  }
+
+  /// A clip per Aseprite tag, playing frames from and to inclusive.
+  void readTags(const Node& tags, const std::vector<NamedFrame>& frames, std::vector<AnimationClip>& clips)
+  {
+    for (const auto& tag : tags.items)
+    {
+      const auto from = std::max(tag.integer("from"), 0);
+      const auto to   = std::min(tag.integer("to"), static_cast<int>(frames.size()) - 1);
+      std::vector<AnimationClip::Frame> run;
+      for (int i = from; i <= to; ++i)
+      {
+        run.push_back(frames[i].frame);
+      }
+
+      const auto direction = tag.text("direction", "forward");
+      if (direction == "reverse" || direction == "pingpong_reverse")
+      {
+        std::reverse(run.begin(), run.end());
+      }
+      clips.emplace_back(tag.text("name"), std::move(run), loopFor(direction));
+    }
+  }
+
+  /// A clip per TexturePacker animation, listing frames by name.
+  void readAnimations(const Node& animations, const std::vector<NamedFrame>& frames, std::vector<AnimationClip>& clips)
+  {
+    for (const auto& animation : animations.items)
+    {
+      std::vector<AnimationClip::Frame> run;
+      for (const auto& entry : animation.items)
+      {
+        auto iter = std::find_if(
+          frames.begin(), frames.end(), [&](const NamedFrame& frame) { return frame.name == entry.value; });
+        if (iter != frames.end())
+        {
+          run.push_back(iter->frame);
+        }
+      }
+      clips.emplace_back(animation.name, std::move(run), AnimationClip::Loop::LOOP);
+    }
+  }
+
+  /// A clip per run of frames named alike, in the order each name first appears.
+  void groupFrames(const std::vector<NamedFrame>& frames, std::vector<AnimationClip>& clips)
+  {
+    std::vector<std::pair<std::string, std::vector<AnimationClip::Frame>>> groups;
+    for (const auto& frame : frames)
+    {
+      const auto name = stem(frame.name);
+      auto iter = std::find_if(groups.begin(), groups.end(), [&](const auto& group) { return group.first == name; });
+      if (iter == groups.end())
+      {
+        iter = groups.insert(groups.end(), { name, {} });
+      }
+      iter->second.push_back(frame.frame);
+    }
+
+    for (auto& [name, run] : groups)
+    {
+      clips.emplace_back(name, std::move(run), AnimationClip::Loop::LOOP);
+    }
+  }
+}
+
+pyasge::AnimationClip::AnimationClip(std::string name, std::vector<Frame> frames, Loop loop) :
+  clip_name(std::move(name)), frame_list(std::move(frames)), mode(loop)
+{
+  const auto count = static_cast<std::uint32_t>(frame_list.size());
+  for (std::uint32_t i = 0; i < count; ++i)
+  {
+    sequence.push_back(i);
+  }
+  if (mode == Loop::PING_PONG)
+  {
+    for (std::uint32_t i = count > 1 ? count - 2 : 0; i > 0; --i)
+    {
+      sequence.push_back(i);
+    }
+  }
+
+  double time = 0;
+  for (auto step : sequence)
+  {
+    const double duration = frame_list[step].duration;
+    time += std::isfinite(duration) && duration > 0 ? duration : 0.0;
+    ends.push_back(time);
+  }
+}
+
+std::size_t pyasge::AnimationClip::frameAt(double time, double& until, bool& finished) const
+{
+  finished           = false;
+  const double cycle = duration();
+  if (cycle <= 0)
+  {
+    until    = NEVER;
+    finished = mode == Loop::ONCE;
+    return sequence.front();
+  }
+
+  double start = 0;
+  if (time >= cycle)
+  {
+    if (mode == Loop::ONCE)
+    {
+      until    = NEVER;
+      finished = true;
+      return sequence.back();
+    }
+    start = time - std::fmod(time, cycle);
+  }
+
+  // zero length steps end where they start and are never shown
+  const auto found = std::upper_bound(ends.begin(), ends.end(), time - start) - ends.begin();
+  const auto step  = std::min<std::size_t>(static_cast<std::size_t>(found), ends.size() - 1);
+  until            = start + ends[step];
+  return sequence[step];
+}
+
+std::optional<std::vector<pyasge::AnimationClip>>
+pyasge::AnimationClip::loadSheet(const std::string& path, float frame_duration, std::string& error)
+{
+  const auto content = markup::readFile(path);
+  if (!content)
+  {
+    error = "unable to open " + path;
+    return std::nullopt;
+  }
+
+  const auto root    = markup::parse(*content);
+  const auto* frames = root && root->type == Node::Type::OBJECT ? root->child("frames") : nullptr;
+  if (frames == nullptr || (frames->type != Node::Type::OBJECT && frames->type != Node::Type::ARRAY))
+  {
+    error = path + " is not a JSON sprite sheet";
+    return std::nullopt;
+  }
+
+  bool rotated     = false;
+  const auto named = readFrames(*frames, frame_duration, rotated);
+  if (rotated)
+  {
+    error = path + " packs frames rotated, which source rectangles can't show; disable rotation when exporting";
+    return std::nullopt;
+  }
+
+  std::vector<AnimationClip> clips;
+  const auto* meta       = root->child("meta");
+  const auto* tags       = meta != nullptr ? meta->child("frameTags") : nullptr;
+  const auto* animations = root->child("animations");
+  if (tags != nullptr && !tags->items.empty())
+  {
+    readTags(*tags, named, clips);
+  }
+  else if (animations != nullptr && !animations->items.empty())
+  {
+    readAnimations(*animations, named, clips);
+  }
+  else if (meta != nullptr && contains(meta->text("app"), "aseprite"))
+  {
+    // an untagged Aseprite file is one animation
+    std::vector<Frame> run;
+    for (const auto& frame : named)
+    {
+      run.push_back(frame.frame);
+    }
+    clips.emplace_back(std::filesystem::path(path).stem().string(), std::move(run), Loop::LOOP);
+  }
+  else
+  {
+    groupFrames(named, clips);
+  }
+
+  const auto image = meta != nullptr ? resolve(path, meta->text("image")) : std::string();
+  for (auto& clip : clips)
+  {
+    clip.image(image);
+  }
+  return clips;
+}
+
+void pyasge::Animator::play(ASGE::Sprite& sprite, std::shared_ptr<const AnimationClip> clip, float speed, bool restart)
+{
+  if (clip == nullptr || clip->frames().empty())
+  {
+    stop(sprite);
+    return;
+  }
+
+  auto [iter, added] = index.try_emplace(&sprite, tracks.size());
+  if (added)
+  {
+    tracks.emplace_back();
+  }
+
+  auto& track = tracks[iter->second];
+  track.speed = std::max(speed, 0.0F);
+  if (!added && !restart && track.clip == clip)
+  {
+    return;
+  }
+
+  track.sprite   = &sprite;
+  track.clip     = std::move(clip);
+  track.time     = 0;
+  track.frame    = NO_FRAME;
+  track.paused   = false;
+  track.finished = false;
+  show(track);
+}
+
+bool pyasge::Animator::stop(const ASGE::Sprite& sprite)
+{
+  auto iter = index.find(&sprite);
+  if (iter == index.end())
+  {
+    return false;
+  }
+
+  // the last track fills the gap, keeping the array packed
+  const auto slot = iter->second;
+  index.erase(iter);
+  if (slot + 1 != tracks.size())
+  {
+    tracks[slot]               = std::move(tracks.back());
+    index[tracks[slot].sprite] = slot;
+  }
+  tracks.pop_back();
+  return true;
+}
+
+void pyasge::Animator::clear()
+{
+  tracks.clear();
+  index.clear();
+  ended.clear();
+}
+
+void pyasge::Animator::update(double seconds)
+{
+  ended.clear();
+  if (!(seconds > 0))
+  {
+    return;
+  }
+
+  for (auto& track : tracks)
+  {
+    if (track.paused || track.finished)
+    {
+      continue;
+    }
+
+    track.time += seconds * track.speed;
+    if (track.time < track.until)
+    {
+      continue;
+    }
+
+    show(track);
+    if (track.finished)
+    {
+      ended.push_back(track.sprite);
+    }
+  }
+}
+
+pyasge::Animator::Track* pyasge::Animator::find(const ASGE::Sprite& sprite)
+{
+  auto iter = index.find(&sprite);
+  return iter != index.end() ? &tracks[iter->second] : nullptr;
+}
+
+const pyasge::Animator::Track* pyasge::Animator::find(const ASGE::Sprite& sprite) const
+{
+  auto iter = index.find(&sprite);
+  return iter != index.end() ? &tracks[iter->second] : nullptr;
+}
+
+void pyasge::Animator::show(Track& track)
+{
+  // looping clips wind their time back a whole cycle at a time so it never grows large enough to lose precision
+  const double cycle = track.clip->duration();
+  if (track.clip->loop() != AnimationClip::Loop::ONCE && cycle > 0 && track.time >= cycle)
+  {
+    track.time = std::fmod(track.time, cycle);
+  }
+
+  const auto frame = static_cast<std::uint32_t>(track.clip->frameAt(track.time, track.until, track.finished));
+  if (frame == track.frame)
+  {
+    return;
+  }
+
+  track.frame      = frame;
+  const auto& rect = track.clip->frames()[frame].rect;
+  std::copy(rect.begin(), rect.end(), track.sprite->srcRect());
+}
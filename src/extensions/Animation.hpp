@@ -0,0 +1,145 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ASGE
+{
+  class Sprite;
+}
+
+namespace pyasge
+{
+  /// \brief   A named run of source rectangles, each shown for a time.
+  /// \details The order frames are played in is expanded once, when the
+  ///          clip is made, into a sequence with the time each step ends,
+  ///          so finding the frame for a time is a binary search.
+  ///          Ping-pong clips play their frames forwards then back,
+  ///          without repeating the first and last frames.
+  class AnimationClip
+  {
+   public:
+    enum class Loop : std::uint8_t
+    {
+      ONCE,
+      LOOP,
+      PING_PONG
+    };
+
+    struct Frame
+    {
+      std::array<float, 4> rect{}; ///< x, y, width and height in the texture, in pixels
+      float duration = 0;          ///< seconds
+    };
+
+    AnimationClip(std::string name, std::vector<Frame> frames, Loop loop);
+
+    /// \brief   Reads the clips in an Aseprite or TexturePacker JSON sheet.
+    /// \details Aseprite sheets give a clip per tag, or one of every frame
+    ///          if there are none, with the durations and directions set
+    ///          in Aseprite. TexturePacker sheets give a clip per entry in
+    ///          their animations, or otherwise group frames whose names
+    ///          only differ by a trailing number. Frames without a duration
+    ///          use frame_duration.
+    /// \returns The clips, each naming the sheet's image, or nullopt with
+    ///          error describing why the sheet was rejected.
+    static std::optional<std::vector<AnimationClip>> loadSheet(const std::string& path, float frame_duration, std::string& error);
+
+    [[nodiscard]] const std::string& name() const noexcept { return clip_name; }
+    [[nodiscard]] const std::vector<Frame>& frames() const noexcept { return frame_list; }
+    [[nodiscard]] Loop loop() const noexcept { return mode; }
+
+    /// \brief   The path of the image the frames were cut from, if known.
+    [[nodiscard]] const std::string& image() const noexcept { return image_path; }
+    void image(std::string path) { image_path = std::move(path); }
+
+    /// \brief   The length of one pass, or for ping-pong clips of one there and back.
+    [[nodiscard]] double duration() const noexcept { return ends.empty() ? 0.0 : ends.back(); }
+
+    /// \brief   Finds the frame shown at a time since the clip started.
+    /// \param   until    Set to the time the frame changes, or infinity if it never will.
+    /// \param   finished Set when a clip that plays once has reached its end.
+    /// \returns The index of the frame, which must not be called on a clip without frames.
+    std::size_t frameAt(double time, double& until, bool& finished) const;
+
+   private:
+    std::string clip_name;
+    std::string image_path;
+    std::vector<Frame> frame_list;
+    Loop mode = Loop::LOOP;
+    std::vector<std::uint32_t> sequence; ///< the frame played at each step
+    std::vector<double> ends;            ///< the time each step ends
+  };
+
+  /// \brief   Plays animation clips on many sprites at once.
+  /// \details Each sprite plays one clip. Tracks are kept in a contiguous
+  ///          array and remember when their frame next changes, so an
+  ///          update only does work for the sprites whose frame changes,
+  ///          and then only writes their source rectangle.
+  class Animator
+  {
+   public:
+    static constexpr std::uint32_t NO_FRAME = std::numeric_limits<std::uint32_t>::max();
+
+    struct Track
+    {
+      ASGE::Sprite* sprite = nullptr;
+      std::shared_ptr<const AnimationClip> clip;
+      double time         = 0;
+      double until        = 0; ///< when the frame shown next changes
+      float speed         = 1;
+      std::uint32_t frame = NO_FRAME;
+      bool paused         = false;
+      bool finished       = false;
+    };
+
+    /// \brief   Starts a clip on a sprite, replacing anything it was playing.
+    /// \details The sprite's source rectangle is set to the clip's first
+    ///          frame straight away. When restart is false and the sprite is
+    ///          already playing this clip it carries on undisturbed.
+    void play(ASGE::Sprite& sprite, std::shared_ptr<const AnimationClip> clip, float speed, bool restart);
+
+    /// \returns False if the sprite was not playing anything.
+    bool stop(const ASGE::Sprite& sprite);
+    void clear();
+
+    /// \brief   Advances every playing clip and updates their sprites' source rectangles.
+    void update(double seconds);
+
+    [[nodiscard]] Track* find(const ASGE::Sprite& sprite);
+    [[nodiscard]] const Track* find(const ASGE::Sprite& sprite) const;
+    [[nodiscard]] std::size_t size() const noexcept { return tracks.size(); }
+
+    /// \brief   The sprites whose clips played to their end during the last update.
+    [[nodiscard]] const std::vector<ASGE::Sprite*>& finished() const noexcept { return ended; }
+
+   private:
+    static void show(Track& track);
+
+    std::vector<Track> tracks;
+    std::unordered_map<const ASGE::Sprite*, std::size_t> index;
+    std::vector<ASGE::Sprite*> ended;
+  };
+}
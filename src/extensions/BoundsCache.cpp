@@ -0,0 +1,166 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/BoundsCache.hpp"
+#include "extensions/SpriteVertices.hpp"
+
+#include <Engine/Sprite.hpp>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace
+{
+  /// Entries not read for this many queries may be dropped.
+  constexpr std::uint32_t STALE_QUERIES = 60;
+
+  void box(const float* corners, float* out) noexcept
+  {
+    const float min_x = std::min({ corners[0], corners[2], corners[4], corners[6] });
+    const float min_y = std::min({ corners[1], corners[3], corners[5], corners[7] });
+    const float max_x = std::max({ corners[0], corners[2], corners[4], corners[6] });
+    const float max_y = std::max({ corners[1], corners[3], corners[5], corners[7] });
+    out[0] = min_x;
+    out[1] = min_y;
+    out[2] = max_x - min_x;
+    out[3] = max_y - min_y;
+  }
+}
+
+pyasge::BoundsCache& pyasge::BoundsCache::instance()
+{
+  static BoundsCache cache;
+  return cache;
+}
+
+const float* pyasge::BoundsCache::lookup(const ASGE::Sprite& sprite, std::size_t index)
+{
+  const float transform[6] = { sprite.xPos(),  sprite.yPos(),  sprite.width(),
+                               sprite.height(), sprite.scale(), sprite.rotationInRadians() };
+
+  // entries are nodes, so the pointers held by the slots survive rehashing
+  if (index >= slots.size())
+  {
+    slots.resize(index + 1, { nullptr, nullptr });
+  }
+  auto& slot = slots[index];
+  if (slot.sprite != &sprite)
+  {
+    slot = { &sprite, &entries[&sprite] };
+  }
+
+  auto& entry = *slot.entry;
+  entry.used  = query;
+  if (std::memcmp(entry.transform, transform, sizeof(transform)) == 0)
+  {
+    ++stats.hits;
+    if (entry.pending == NOT_PENDING)
+    {
+      return entry.corners;
+    }
+
+    // listed earlier in the same query, and waiting on the same computation
+    waiting.push_back({ index, entry.pending });
+    return nullptr;
+  }
+
+  std::memcpy(entry.transform, transform, sizeof(transform));
+  entry.pending = static_cast<std::uint32_t>(missed_sprites.size());
+  missed_sprites.push_back(&sprite);
+  missed_entries.push_back(&entry);
+  missed_transforms.insert(missed_transforms.end(), std::begin(transform), std::end(transform));
+  waiting.push_back({ index, entry.pending });
+  ++stats.misses;
+  return nullptr;
+}
+
+void pyasge::BoundsCache::resolve()
+{
+  if (missed_sprites.empty())
+  {
+    return;
+  }
+
+  missed_corners.resize(missed_sprites.size() * 8);
+  spriteCorners(missed_sprites.data(), missed_transforms.data(), missed_sprites.size(), missed_corners.data());
+  for (std::size_t i = 0; i < missed_entries.size(); ++i)
+  {
+    auto& entry = *missed_entries[i];
+    std::memcpy(entry.corners, &missed_corners[i * 8], sizeof(entry.corners));
+    entry.pending = NOT_PENDING;
+  }
+}
+
+void pyasge::BoundsCache::begin()
+{
+  ++query;
+  stats = {};
+  waiting.clear();
+  missed_sprites.clear();
+  missed_entries.clear();
+  missed_transforms.clear();
+}
+
+void pyasge::BoundsCache::end(std::size_t count)
+{
+  if (entries.size() <= std::max<std::size_t>(count, 1024) * 2)
+  {
+    return;
+  }
+
+  for (auto iter = entries.begin(); iter != entries.end();)
+  {
+    iter = query - iter->second.used > STALE_QUERIES ? entries.erase(iter) : std::next(iter);
+  }
+  slots.clear();
+}
+
+void pyasge::BoundsCache::corners(const ASGE::Sprite* const* sprites, std::size_t count, float* out)
+{
+  begin();
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    if (const auto* found = lookup(*sprites[i], i); found != nullptr)
+    {
+      std::memcpy(out + i * 8, found, sizeof(float) * 8);
+    }
+  }
+
+  resolve();
+  for (const auto& wait : waiting)
+  {
+    std::memcpy(out + wait.index * 8, &missed_corners[wait.miss * 8], sizeof(float) * 8);
+  }
+  end(count);
+}
+
+void pyasge::BoundsCache::boxes(const ASGE::Sprite* const* sprites, std::size_t count, float* out)
+{
+  begin();
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    if (const auto* found = lookup(*sprites[i], i); found != nullptr)
+    {
+      box(found, out + i * 4);
+    }
+  }
+
+  resolve();
+  for (const auto& wait : waiting)
+  {
+    box(&missed_corners[wait.miss * 8], out + wait.index * 4);
+  }
+  end(count);
+}
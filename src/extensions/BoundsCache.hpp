@@ -0,0 +1,114 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace ASGE
+{
+  class Sprite;
+}
+
+namespace pyasge
+{
+  /// \brief   Caches the world bounds of sprites between queries.
+  /// \details Each sprite's corners are stored with the transform they were
+  ///          computed from: its position, size, scale and rotation. A later
+  ///          query compares the transform and only recomputes the corners
+  ///          if it has changed, however it was changed. The sprites a query
+  ///          misses are gathered and their corners computed together by
+  ///          the sprite vertex kernels, several at a time, so they match
+  ///          the quads the sprites are drawn with and getWorldBounds to
+  ///          within the last bits of the sine and cosine.
+  ///
+  ///          Games query the same list in the same order frame after frame,
+  ///          so the entry each position of the last query used is kept, and
+  ///          a sprite found at the same position again skips the hash table
+  ///          lookup. That leaves reading and comparing the transform as the
+  ///          whole cost of an unchanged sprite. Entries for sprites that
+  ///          stop being queried are dropped once they outnumber the live
+  ///          ones.
+  class BoundsCache
+  {
+   public:
+    struct Statistics
+    {
+      std::size_t hits   = 0; ///< sprites answered from the cache by the last query
+      std::size_t misses = 0; ///< sprites recomputed by the last query
+    };
+
+    static BoundsCache& instance();
+
+    /// \brief   Writes the 4 world space corners of each sprite, as 8 floats.
+    void corners(const ASGE::Sprite* const* sprites, std::size_t count, float* out);
+
+    /// \brief   Writes the axis aligned box around each sprite as (x, y, width, height).
+    void boxes(const ASGE::Sprite* const* sprites, std::size_t count, float* out);
+
+    void clear()
+    {
+      entries.clear();
+      slots.clear();
+    }
+    [[nodiscard]] std::size_t size() const noexcept { return entries.size(); }
+    [[nodiscard]] const Statistics& statistics() const noexcept { return stats; }
+
+   private:
+    static constexpr float NOT_SET             = std::numeric_limits<float>::quiet_NaN();
+    static constexpr std::uint32_t NOT_PENDING = std::numeric_limits<std::uint32_t>::max();
+
+    struct Entry
+    {
+      /// x, y, width, height, scale and rotation, starting as NaN so a new entry never matches
+      float transform[6] = { NOT_SET, NOT_SET, NOT_SET, NOT_SET, NOT_SET, NOT_SET };
+      float corners[8];
+      std::uint32_t used    = 0;           ///< the query that last read the entry
+      std::uint32_t pending = NOT_PENDING; ///< the entry's place among the query's misses, until computed
+    };
+
+    /// A position of the current query, written from its miss once the misses are computed.
+    struct Waiting
+    {
+      std::size_t index;
+      std::size_t miss;
+    };
+
+    struct Slot
+    {
+      const ASGE::Sprite* sprite;
+      Entry* entry;
+    };
+
+    const float* lookup(const ASGE::Sprite& sprite, std::size_t index);
+    void resolve();
+    void begin();
+    void end(std::size_t count);
+
+    std::unordered_map<const ASGE::Sprite*, Entry> entries;
+    std::vector<Slot> slots;          ///< the entry used at each position of the last query
+    std::vector<Waiting> waiting;
+    std::vector<const ASGE::Sprite*> missed_sprites;
+    std::vector<Entry*> missed_entries;
+    std::vector<float> missed_transforms;
+    std::vector<float> missed_corners;
+    std::uint32_t query = 0;
+    Statistics stats;
+  };
+}
@@ -0,0 +1,426 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/CollisionMask.hpp"
+#include "extensions/Quads.hpp"
+
+#include <Engine/Sprite.hpp>
+#include <Engine/Texture.hpp>
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace
+{
+  using Word              = pyasge::CollisionMask::Word;
+  constexpr int WORD_BITS = pyasge::CollisionMask::WORD_BITS;
+
+  /// How far a texel step may be from exactly one to still read words directly.
+  constexpr double UNIT_TOLERANCE = 1e-5;
+
+  std::size_t wordsFor(int bits) noexcept
+  {
+    return (static_cast<std::size_t>(bits) + WORD_BITS - 1) / WORD_BITS;
+  }
+
+  /// The 64 bits of a row starting at any column, with columns past either end empty.
+  Word window(const Word* row, std::size_t words, long long start) noexcept
+  {
+    if (start <= -WORD_BITS || start >= static_cast<long long>(words) * WORD_BITS)
+    {
+      return 0;
+    }
+    if (start < 0)
+    {
+      return row[0] << -start;
+    }
+
+    const auto index = static_cast<std::size_t>(start / WORD_BITS);
+    const auto shift = static_cast<int>(start % WORD_BITS);
+    Word bits        = row[index] >> shift;
+    if (shift != 0 && index + 1 < words)
+    {
+      bits |= row[index + 1] << (WORD_BITS - shift);
+    }
+    return bits;
+  }
+
+  /// Clears the bits of out outside [low, high).
+  void keep(Word* out, int count, int low, int high) noexcept
+  {
+    low  = std::max(low, 0);
+    high = std::min(high, count);
+    for (int first = 0; first < count; first += WORD_BITS, ++out)
+    {
+      Word kept = ~Word{ 0 };
+      if (low > first)
+      {
+        kept = low - first >= WORD_BITS ? 0 : kept & (~Word{ 0 } << (low - first));
+      }
+      if (high < first + WORD_BITS)
+      {
+        kept = high <= first ? 0 : kept & (~Word{ 0 } >> (WORD_BITS - (high - first)));
+      }
+      *out &= kept;
+    }
+  }
+
+  bool near(double value, double target) noexcept
+  {
+    return std::abs(value - target) < UNIT_TOLERANCE;
+  }
+
+  /// Samples a sprite's mask at world unit spacing, one row of words at a time.
+  class Sampler
+  {
+   public:
+    Sampler(const pyasge::Quad& quad, const pyasge::CollisionMask& collision_mask, int x0, int y0) :
+      mask(collision_mask)
+    {
+      // the quad is a parallelogram, so the corner parameters (s, t) and
+      // from them the texel position change by a fixed step per sample
+      const double e1_x = quad[1].x - quad[0].x;
+      const double e1_y = quad[1].y - quad[0].y;
+      const double e2_x = quad[3].x - quad[0].x;
+      const double e2_y = quad[3].y - quad[0].y;
+      const double det  = e1_x * e2_y - e1_y * e2_x;
+      if (std::abs(det) < 1e-9 || !std::isfinite(det))
+      {
+        return;
+      }
+
+      const double d_x = x0 + 0.5 - quad[0].x;
+      const double d_y = y0 + 0.5 - quad[0].y;
+      s                = (d_x * e2_y - d_y * e2_x) / det;
+      t                = (e1_x * d_y - e1_y * d_x) / det;
+      s_dx             = e2_y / det;
+      s_dy             = -e2_x / det;
+      t_dx             = -e1_y / det;
+      t_dy             = e1_x / det;
+
+      const double width  = mask.width();
+      const double height = mask.height();
+      const double u_s    = (quad[1].u - quad[0].u) * width;
+      const double u_t    = (quad[3].u - quad[0].u) * width;
+      const double v_s    = (quad[1].v - quad[0].v) * height;
+      const double v_t    = (quad[3].v - quad[0].v) * height;
+      tx                  = quad[0].u * width + s * u_s + t * u_t;
+      ty                  = quad[0].v * height + s * v_s + t * v_t;
+      tx_dx               = s_dx * u_s + t_dx * u_t;
+      tx_dy               = s_dy * u_s + t_dy * u_t;
+      ty_dx               = s_dx * v_s + t_dx * v_t;
+      ty_dy               = s_dy * v_s + t_dy * v_t;
+
+      // the source rectangle, which stops atlas neighbours being sampled
+      const auto texel = [](double uv, double size)
+      { return static_cast<int>(std::clamp(std::round(uv * size), 0.0, size)); };
+      const auto [u_min, u_max] = std::minmax({ quad[0].u, quad[1].u, quad[2].u, quad[3].u });
+      const auto [v_min, v_max] = std::minmax({ quad[0].v, quad[1].v, quad[2].v, quad[3].v });
+      left                      = texel(u_min, width);
+      right                     = texel(u_max, width);
+      top                       = texel(v_min, height);
+      bottom                    = texel(v_max, height);
+
+      aligned = near(std::abs(tx_dx), 1.0) && near(std::abs(ty_dy), 1.0) && near(tx_dy, 0.0) && near(ty_dx, 0.0);
+      usable  = left < right && top < bottom;
+    }
+
+    [[nodiscard]] bool valid() const noexcept { return usable; }
+
+    /// Writes the samples of row j into out and returns whether any were solid.
+    bool row(int j, int count, Word* out) const noexcept
+    {
+      const std::size_t words = wordsFor(count);
+      std::fill(out, out + words, Word{ 0 });
+
+      if (aligned)
+      {
+        readAligned(j, count, out);
+      }
+      else
+      {
+        sample(j, count, out);
+      }
+      return std::any_of(out, out + words, [](Word bits) { return bits != 0; });
+    }
+
+   private:
+    /// One texel per sample along the row, so whole words are shifted out of the mask.
+    void readAligned(int j, int count, Word* out) const noexcept
+    {
+      const auto y = static_cast<int>(std::floor(ty + j * ty_dy));
+      if (y < top || y >= bottom)
+      {
+        return;
+      }
+
+      const auto x = static_cast<int>(std::floor(tx + j * tx_dy));
+      if (tx_dx > 0)
+      {
+        mask.extract(y, x, count, false, out);
+        keep(out, count, left - x, right - x);
+      }
+      else
+      {
+        mask.extract(y, x, count, true, out);
+        keep(out, count, x - right + 1, x - left + 1);
+      }
+    }
+
+    /// Any other transform steps through the texels one sample at a time.
+    void sample(int j, int count, Word* out) const noexcept
+    {
+      double sample_s = s + j * s_dy;
+      double sample_t = t + j * t_dy;
+      double x        = tx + j * tx_dy;
+      double y        = ty + j * ty_dy;
+      for (int i = 0; i < count; ++i)
+      {
+        if (sample_s >= 0.0 && sample_s < 1.0 && sample_t >= 0.0 && sample_t < 1.0)
+        {
+          const int column = std::clamp(static_cast<int>(std::floor(x)), left, right - 1);
+          const int line   = std::clamp(static_cast<int>(std::floor(y)), top, bottom - 1);
+          if (mask.test(column, line))
+          {
+            out[i / WORD_BITS] |= Word{ 1 } << (i % WORD_BITS);
+          }
+        }
+        sample_s += s_dx;
+        sample_t += t_dx;
+        x += tx_dx;
+        y += ty_dx;
+      }
+    }
+
+    const pyasge::CollisionMask& mask;
+    double s     = 0;
+    double t     = 0;
+    double s_dx  = 0;
+    double s_dy  = 0;
+    double t_dx  = 0;
+    double t_dy  = 0;
+    double tx    = 0;
+    double ty    = 0;
+    double tx_dx = 0;
+    double tx_dy = 0;
+    double ty_dx = 0;
+    double ty_dy = 0;
+    int left     = 0;
+    int right    = 0;
+    int top      = 0;
+    int bottom   = 0;
+    bool aligned = false;
+    bool usable  = false;
+  };
+
+  void bounds(const pyasge::Quad& quad, float& min_x, float& min_y, float& max_x, float& max_y)
+  {
+    min_x = max_x = quad[0].x;
+    min_y = max_y = quad[0].y;
+    for (const auto& vertex : quad)
+    {
+      min_x = std::min(min_x, vertex.x);
+      min_y = std::min(min_y, vertex.y);
+      max_x = std::max(max_x, vertex.x);
+      max_y = std::max(max_y, vertex.y);
+    }
+  }
+
+  /// Masks registered per texture. Only touched while the interpreter lock is held.
+  std::unordered_map<const ASGE::Texture2D*, std::shared_ptr<const pyasge::CollisionMask>>& registry()
+  {
+    static std::unordered_map<const ASGE::Texture2D*, std::shared_ptr<const pyasge::CollisionMask>> masks;
+    return masks;
+  }
+}
+
+pyasge::CollisionMask::CollisionMask(int width, int height) :
+  columns(std::max(width, 0)),
+  rows(std::max(height, 0)),
+  words_per_row(wordsFor(columns)),
+  bits(words_per_row * rows, 0),
+  mirror(words_per_row * rows, 0)
+{
+}
+
+pyasge::CollisionMask pyasge::CollisionMask::fromPixels(
+  const std::uint8_t* pixels, int width, int height, int channels, int alpha, std::uint8_t threshold)
+{
+  CollisionMask mask(width, height);
+  const bool has_alpha = alpha >= 0 && alpha < channels;
+  for (int y = 0; y < mask.rows; ++y)
+  {
+    const std::uint8_t* value = pixels + static_cast<std::size_t>(y) * mask.columns * channels + std::max(alpha, 0);
+    for (int x = 0; x < mask.columns; ++x, value += channels)
+    {
+      if (!has_alpha || *value >= threshold)
+      {
+        mask.set(x, y, true);
+      }
+    }
+  }
+  return mask;
+}
+
+bool pyasge::CollisionMask::test(int x, int y) const noexcept
+{
+  if (x < 0 || y < 0 || x >= columns || y >= rows)
+  {
+    return false;
+  }
+  return ((row(y)[x / WORD_BITS] >> (x % WORD_BITS)) & 1U) != 0;
+}
+
+std::size_t pyasge::CollisionMask::count() const noexcept
+{
+  std::size_t solid = 0;
+  for (auto word : bits)
+  {
+    for (; word != 0; word &= word - 1)
+    {
+      ++solid;
+    }
+  }
+  return solid;
+}
+
+std::size_t pyasge::CollisionMask::memory() const noexcept
+{
+  return sizeof(CollisionMask) + (bits.capacity() + mirror.capacity()) * sizeof(Word);
+}
+
+void pyasge::CollisionMask::set(int x, int y, bool solid)
+{
+  if (x < 0 || y < 0 || x >= columns || y >= rows)
+  {
+    return;
+  }
+
+  const int flipped     = columns - 1 - x;
+  const std::size_t row = words_per_row * y;
+  Word& word            = bits[row + x / WORD_BITS];
+  Word& mirrored        = mirror[row + flipped / WORD_BITS];
+  const Word bit        = Word{ 1 } << (x % WORD_BITS);
+  const Word mirror_bit = Word{ 1 } << (flipped % WORD_BITS);
+  word                  = solid ? word | bit : word & ~bit;
+  mirrored              = solid ? mirrored | mirror_bit : mirrored & ~mirror_bit;
+}
+
+void pyasge::CollisionMask::extract(int y, int column, int count, bool mirrored, Word* out) const noexcept
+{
+  const std::size_t words = wordsFor(count);
+  if (y < 0 || y >= rows)
+  {
+    std::fill(out, out + words, Word{ 0 });
+    return;
+  }
+
+  // reading leftwards from a column is reading rightwards from its mirror image
+  const Word* source    = (mirrored ? mirror : bits).data() + words_per_row * y;
+  const long long start = mirrored ? columns - 1LL - column : column;
+  for (std::size_t i = 0; i < words; ++i)
+  {
+    out[i] = window(source, words_per_row, start + static_cast<long long>(i) * WORD_BITS);
+  }
+  if (count % WORD_BITS != 0)
+  {
+    out[words - 1] &= ~Word{ 0 } >> (WORD_BITS - count % WORD_BITS);
+  }
+}
+
+void pyasge::CollisionMask::assign(const ASGE::Texture2D& texture, std::shared_ptr<const CollisionMask> mask)
+{
+  registry()[&texture] = std::move(mask);
+}
+
+std::shared_ptr<const pyasge::CollisionMask> pyasge::CollisionMask::find(const ASGE::Texture2D& texture)
+{
+  auto& masks = registry();
+  auto iter   = masks.find(&texture);
+  if (iter == masks.end())
+  {
+    return nullptr;
+  }
+
+  // destroyed textures forget their masks, this only catches one resized in place
+  if (iter->second->width() != static_cast<int>(texture.getWidth()) ||
+      iter->second->height() != static_cast<int>(texture.getHeight()))
+  {
+    masks.erase(iter);
+    return nullptr;
+  }
+  return iter->second;
+}
+
+void pyasge::CollisionMask::forget(const ASGE::Texture2D& texture)
+{
+  registry().erase(&texture);
+}
+
+bool pyasge::spriteMasksOverlap(
+  const ASGE::Sprite& a, const CollisionMask& mask_a, const ASGE::Sprite& b, const CollisionMask& mask_b)
+{
+  Quad quad_a{};
+  Quad quad_b{};
+  if (!spriteQuad(a, quad_a) || !spriteQuad(b, quad_b))
+  {
+    return false;
+  }
+
+  float a_min_x, a_min_y, a_max_x, a_max_y; // NOLINT
+  float b_min_x, b_min_y, b_max_x, b_max_y; // NOLINT
+  bounds(quad_a, a_min_x, a_min_y, a_max_x, a_max_y);
+  bounds(quad_b, b_min_x, b_min_y, b_max_x, b_max_y);
+
+  const double x0 = std::floor(std::max(a_min_x, b_min_x));
+  const double y0 = std::floor(std::max(a_min_y, b_min_y));
+  const double x1 = std::ceil(std::min(a_max_x, b_max_x));
+  const double y1 = std::ceil(std::min(a_max_y, b_max_y));
+  if (!(x1 > x0 && y1 > y0) || !std::isfinite(x1 - x0) || !std::isfinite(y1 - y0))
+  {
+    return false;
+  }
+
+  const auto columns = static_cast<int>(x1 - x0);
+  const auto rows    = static_cast<int>(y1 - y0);
+  const Sampler sampler_a(quad_a, mask_a, static_cast<int>(x0), static_cast<int>(y0));
+  const Sampler sampler_b(quad_b, mask_b, static_cast<int>(x0), static_cast<int>(y0));
+  if (!sampler_a.valid() || !sampler_b.valid())
+  {
+    return false;
+  }
+
+  thread_local std::vector<Word> row_a;
+  thread_local std::vector<Word> row_b;
+  const std::size_t words = wordsFor(columns);
+  row_a.resize(words);
+  row_b.resize(words);
+
+  for (int j = 0; j < rows; ++j)
+  {
+    if (!sampler_a.row(j, columns, row_a.data()) || !sampler_b.row(j, columns, row_b.data()))
+    {
+      continue;
+    }
+    for (std::size_t i = 0; i < words; ++i)
+    {
+      if ((row_a[i] & row_b[i]) != 0)
+      {
+        return true;
+      }
+    }
+  }
+  return false;
+}
@@ -0,0 +1,99 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ASGE
+{
+  class Sprite;
+  class Texture2D;
+}
+
+namespace pyasge
+{
+  /// \brief   A 1 bit per pixel mask of the solid pixels in an image.
+  /// \details Each row is packed into 64 bit words, least significant bit
+  ///          first, so column x of a row is bit x % 64 of word x / 64. A
+  ///          mirrored copy of every row is kept alongside, which lets
+  ///          horizontally flipped sprites be read a word at a time too.
+  ///
+  ///          Masks are built once, usually when a texture is loaded, and
+  ///          can be registered against the texture so that sprites using
+  ///          it find their mask without a download from the GPU.
+  class CollisionMask
+  {
+   public:
+    using Word                     = std::uint64_t;
+    static constexpr int WORD_BITS = 64;
+
+    CollisionMask(int width, int height);
+
+    /// \brief   Builds a mask from 8 bit interleaved pixels, top row first.
+    /// \details Pixels whose alpha reaches the threshold are solid. An alpha
+    ///          channel of -1 means the image has none and is solid everywhere.
+    static CollisionMask fromPixels(
+      const std::uint8_t* pixels, int width, int height, int channels, int alpha, std::uint8_t threshold);
+
+    [[nodiscard]] int width() const noexcept { return columns; }
+    [[nodiscard]] int height() const noexcept { return rows; }
+    [[nodiscard]] std::size_t stride() const noexcept { return words_per_row; }
+    [[nodiscard]] const Word* row(int y) const noexcept { return bits.data() + words_per_row * y; }
+    [[nodiscard]] bool test(int x, int y) const noexcept;
+    [[nodiscard]] std::size_t count() const noexcept;
+    [[nodiscard]] std::size_t memory() const noexcept;
+    void set(int x, int y, bool solid);
+
+    /// \brief   Copies count bits of row y, starting at column, into out.
+    /// \details Reads leftwards from column when mirrored, so bit i of the
+    ///          result is column - i rather than column + i. Columns
+    ///          outside the mask read as empty.
+    void extract(int y, int column, int count, bool mirrored, Word* out) const noexcept;
+
+    /// \brief   Registers the mask used for sprites drawn with a texture.
+    static void assign(const ASGE::Texture2D& texture, std::shared_ptr<const CollisionMask> mask);
+
+    /// \brief   The mask registered for a texture, if any and still the texture's size.
+    static std::shared_ptr<const CollisionMask> find(const ASGE::Texture2D& texture);
+
+    /// \brief   Drops the mask registered for a texture.
+    /// \details Masks are keyed by the texture's address, so this must be
+    ///          called before a texture is destroyed. Textures owned by
+    ///          Python and the resolved textures of render targets do so.
+    static void forget(const ASGE::Texture2D& texture);
+
+   private:
+    int columns               = 0;
+    int rows                  = 0;
+    std::size_t words_per_row = 0;
+    std::vector<Word> bits;
+    std::vector<Word> mirror;
+  };
+
+  /// \brief   Tests whether any solid pixels of two sprites overlap in the world.
+  /// \details Uses the quads the sprites are drawn with, so the position,
+  ///          size, scale, rotation, source rectangle and flip flags all
+  ///          match what is on screen. Both sprites are sampled once per
+  ///          world unit over the overlap of their bounding boxes, a row
+  ///          of words at a time, and rows are ANDed together until one
+  ///          shares a pixel. Axis aligned sprites drawn one texel per unit
+  ///          are read straight from the masks with shifts.
+  bool spriteMasksOverlap(
+    const ASGE::Sprite& a, const CollisionMask& mask_a, const ASGE::Sprite& b, const CollisionMask& mask_b);
+}
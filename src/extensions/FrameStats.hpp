@@ -0,0 +1,42 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace pyasge
+{
+  /// \brief   Counters gathered by the extensions over a single frame.
+  struct FrameStats
+  {
+    std::uint64_t frame               = 0;
+    std::size_t state_changes_issued  = 0; ///< renderer state changes forwarded to the engine
+    std::size_t state_changes_skipped = 0; ///< renderer state changes dropped as redundant
+    std::size_t queued                = 0; ///< draws submitted through the render queue
+    std::size_t queue_batches         = 0; ///< runs of queued draws sharing a shader and texture
+    std::size_t queue_repaired        = 0; ///< draws moved when repairing the previous frame's order
+    double queue_sort_time            = 0; ///< seconds spent sorting the render queue
+    std::size_t resolves_issued       = 0; ///< render target attachments resolved
+    std::size_t resolves_skipped      = 0; ///< resolves skipped as nothing was drawn since the last
+    std::size_t native_draws          = 0; ///< draw calls issued by the extensions directly
+    std::size_t native_quads          = 0; ///< quads drawn by those calls
+    std::size_t instanced_draws       = 0; ///< instanced draw calls issued for sprites
+    std::size_t instances             = 0; ///< sprites drawn by those calls
+    std::size_t stream_bytes          = 0; ///< bytes written to the stream buffer for native draws
+    std::size_t stream_waits          = 0; ///< times writing to the stream buffer waited on the GPU
+    double stream_wait_time           = 0; ///< seconds spent in those waits
+  };
+}
@@ -0,0 +1,68 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "extensions/GLStateCache.hpp"
+
+bool pyasge::GLStateCache::shader(const void* shader)
+{
+  return change(current_shader, shader);
+}
+
+bool pyasge::GLStateCache::target(const void* target)
+{
+  if (!change(current_target, target))
+  {
+    return false;
+  }
+
+  // switching targets may reset the view, so the next request must go through
+  current_viewport.reset();
+  current_projection.reset();
+  return true;
+}
+
+bool pyasge::GLStateCache::viewport(const Rect& viewport)
+{
+  return change(current_viewport, viewport);
+}
+
+bool pyasge::GLStateCache::projection(const Rect& view)
+{
+  return change(current_projection, view);
+}
+
+bool pyasge::GLStateCache::magFilter(GLuint texture, int filter)
+{
+  auto iter = mag_filters.find(texture);
+  if (iter != mag_filters.end() && iter->second == filter)
+  {
+    ++stats.state_changes_skipped;
+    return false;
+  }
+
+  mag_filters[texture] = filter;
+  ++stats.state_changes_issued;
+  return true;
+}
+
+void pyasge::GLStateCache::invalidate()
+{
+  current_shader.reset();
+  current_target.reset();
+  current_viewport.reset();
+  current_projection.reset();
+
+  // texture names are recycled once freed, so filters are only trusted for a frame
+  mag_filters.clear();
+}
@@ -0,0 +1,74 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include "extensions/FrameStats.hpp"
+#include "extensions/GL.hpp"
+
+#include <array>
+#include <optional>
+#include <unordered_map>
+
+namespace pyasge
+{
+  /// \brief   Filters out state changes that would not change anything.
+  /// \details The renderer's state setters are cheap to call from python, so
+  ///          games tend to call them defensively, i.e. setting the same
+  ///          shader, target or viewport before every draw, or the same
+  ///          magnification filter for every sprite sharing a texture. Each
+  ///          of those can cost a bind, or split the renderer's batches. The
+  ///          cache remembers what was last requested this frame and only
+  ///          forwards requests that differ. Everything is forgotten at the
+  ///          start of a frame, as the engine resets its own state there.
+  class GLStateCache
+  {
+   public:
+    using Rect = std::array<float, 4>;
+
+    explicit GLStateCache(FrameStats& frame_stats) : stats(frame_stats) {}
+
+    bool shader(const void* shader);
+    bool target(const void* target);
+    bool viewport(const Rect& viewport);
+    bool projection(const Rect& view);
+    bool magFilter(GLuint texture, int filter);
+
+    [[nodiscard]] const void* currentTarget() const noexcept { return current_target.value_or(nullptr); }
+
+    void invalidate();
+
+   private:
+    template <typename T>
+    bool change(std::optional<T>& state, const T& value)
+    {
+      if (state && *state == value)
+      {
+        ++stats.state_changes_skipped;
+        return false;
+      }
+
+      state = value;
+      ++stats.state_changes_issued;
+      return true;
+    }
+
+    std::optional<const void*> current_shader;
+    std::optional<const void*> current_target;
+    std::optional<Rect> current_viewport;
+    std::optional<Rect> current_projection;
+    std::unordered_map<GLuint, int> mag_filters;
+    FrameStats& stats;
+  };
+}
@@ -0,0 +1,70 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/GLStateGuard.hpp"
+
+namespace
+{
+  int depth = 0;
+}
+
+pyasge::GLStateGuard::GLStateGuard() : outermost(depth++ == 0)
+{
+  if (!outermost)
+  {
+    return;
+  }
+
+  glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+  glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vertex_array);
+  glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &array_buffer);
+  glGetIntegerv(GL_ACTIVE_TEXTURE, &active_texture);
+  glActiveTexture(GL_TEXTURE0);
+  glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture);
+  blend = glIsEnabled(GL_BLEND);
+  glGetIntegerv(GL_BLEND_SRC_RGB, &blend_func[0]);
+  glGetIntegerv(GL_BLEND_DST_RGB, &blend_func[1]);
+  glGetIntegerv(GL_BLEND_SRC_ALPHA, &blend_func[2]);
+  glGetIntegerv(GL_BLEND_DST_ALPHA, &blend_func[3]);
+  glGetIntegerv(GL_VIEWPORT, viewport.data());
+}
+
+pyasge::GLStateGuard::~GLStateGuard()
+{
+  --depth;
+  if (!outermost)
+  {
+    return;
+  }
+
+  glUseProgram(static_cast<GLuint>(program));
+  glBindVertexArray(static_cast<GLuint>(vertex_array));
+  glBindBuffer(GL_ARRAY_BUFFER, static_cast<GLuint>(array_buffer));
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(texture));
+  glActiveTexture(static_cast<GLenum>(active_texture));
+  if (blend == GL_TRUE)
+  {
+    glEnable(GL_BLEND);
+  }
+  else
+  {
+    glDisable(GL_BLEND);
+  }
+  glBlendFuncSeparate(
+    static_cast<GLenum>(blend_func[0]), static_cast<GLenum>(blend_func[1]),
+    static_cast<GLenum>(blend_func[2]), static_cast<GLenum>(blend_func[3]));
+  glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
@@ -0,0 +1,54 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "extensions/GL.hpp"
+
+#include <array>
+
+namespace pyasge
+{
+  /// \brief   Restores the GL state touched by a native draw.
+  /// \details The engine tracks what it has bound and skips binds it thinks
+  ///          are redundant, so anything drawn by the extensions directly
+  ///          must leave the program, vertex array, buffers, texture unit,
+  ///          blending and viewport exactly as it found them.
+  ///
+  ///          The state is queried from GL, as the engine binds things
+  ///          behind the extensions' back in more places than could be
+  ///          tracked. Guards nested inside another do nothing, as the
+  ///          outermost one restores everything, so a batch of native draws
+  ///          queries once.
+  class GLStateGuard
+  {
+   public:
+    GLStateGuard();
+    ~GLStateGuard();
+    GLStateGuard(const GLStateGuard&) = delete;
+    GLStateGuard& operator=(const GLStateGuard&) = delete;
+
+   private:
+    bool outermost        = false;
+    GLint program         = 0;
+    GLint vertex_array    = 0;
+    GLint array_buffer    = 0;
+    GLint active_texture  = GL_TEXTURE0;
+    GLint texture         = 0;
+    GLboolean blend       = GL_FALSE;
+    std::array<GLint, 4> blend_func{};
+    std::array<GLint, 4> viewport{};
+  };
+}
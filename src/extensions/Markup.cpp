@@ -0,0 +1,564 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/Markup.hpp"
+
+#include <Engine/FileIO.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+  using pyasge::markup::Node;
+
+  constexpr int MAX_DEPTH = 256;
+
+  class Parser
+  {
+   public:
+    explicit Parser(std::string_view source) : text(source) {}
+
+   protected:
+    [[nodiscard]] bool atEnd() const noexcept { return pos >= text.size(); }
+    [[nodiscard]] char peek() const noexcept { return atEnd() ? '\0' : text[pos]; }
+    [[nodiscard]] bool startsWith(std::string_view prefix) const noexcept
+    {
+      return text.substr(pos, prefix.size()) == prefix;
+    }
+
+    void skipSpace() noexcept
+    {
+      while (!atEnd() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r' || text[pos] == '\n'))
+      {
+        ++pos;
+      }
+    }
+
+    static void appendUTF8(std::string& out, std::uint32_t code)
+    {
+      if (code < 0x80)
+      {
+        out += static_cast<char>(code);
+      }
+      else if (code < 0x800)
+      {
+        out += static_cast<char>(0xC0 | (code >> 6));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+      }
+      else if (code < 0x10000)
+      {
+        out += static_cast<char>(0xE0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+      }
+      else
+      {
+        out += static_cast<char>(0xF0 | (code >> 18));
+        out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+      }
+    }
+
+    std::string_view text;
+    std::size_t pos = 0;
+  };
+
+  class JSONParser : public Parser
+  {
+   public:
+    using Parser::Parser;
+
+    bool parse(Node& root)
+    {
+      skipSpace();
+      if (!value(root, 0))
+      {
+        return false;
+      }
+      skipSpace();
+      return atEnd();
+    }
+
+   private:
+    bool value(Node& node, int depth)
+    {
+      if (depth > MAX_DEPTH)
+      {
+        return false;
+      }
+
+      switch (peek())
+      {
+        case '{':
+          return object(node, depth);
+        case '[':
+          return array(node, depth);
+        case '"':
+          node.type = Node::Type::STRING;
+          return string(node.value);
+        case 't':
+          node.type = Node::Type::BOOLEAN;
+          return literal("true", node.value);
+        case 'f':
+          node.type = Node::Type::BOOLEAN;
+          return literal("false", node.value);
+        case 'n':
+          node.type = Node::Type::NONE;
+          return literal("null", node.value);
+        default:
+          node.type = Node::Type::NUMBER;
+          return number(node.value);
+      }
+    }
+
+    bool object(Node& node, int depth)
+    {
+      node.type = Node::Type::OBJECT;
+      ++pos;
+      skipSpace();
+      if (peek() == '}')
+      {
+        ++pos;
+        return true;
+      }
+
+      while (true)
+      {
+        skipSpace();
+        Node member;
+        if (peek() != '"' || !string(member.name))
+        {
+          return false;
+        }
+
+        skipSpace();
+        if (peek() != ':')
+        {
+          return false;
+        }
+        ++pos;
+        skipSpace();
+
+        if (!value(member, depth + 1))
+        {
+          return false;
+        }
+        node.items.push_back(std::move(member));
+
+        skipSpace();
+        if (peek() == ',')
+        {
+          ++pos;
+          continue;
+        }
+        if (peek() == '}')
+        {
+          ++pos;
+          return true;
+        }
+        return false;
+      }
+    }
+
+    bool array(Node& node, int depth)
+    {
+      ++pos;
+      skipSpace();
+
+      // layer data is a long run of numbers, which is kept as text and
+      // decoded later rather than becoming a node per tile
+      if (peek() == '-' || (peek() >= '0' && peek() <= '9'))
+      {
+        const auto end = text.find(']', pos);
+        if (end != std::string_view::npos)
+        {
+          const auto numbers = text.substr(pos, end - pos);
+          if (numbers.find_first_of("\"{[") == std::string_view::npos)
+          {
+            node.type  = Node::Type::RAW;
+            node.value = std::string(numbers);
+            pos        = end + 1;
+            return true;
+          }
+        }
+      }
+
+      node.type = Node::Type::ARRAY;
+      if (peek() == ']')
+      {
+        ++pos;
+        return true;
+      }
+
+      while (true)
+      {
+        skipSpace();
+        Node item;
+        if (!value(item, depth + 1))
+        {
+          return false;
+        }
+        node.items.push_back(std::move(item));
+
+        skipSpace();
+        if (peek() == ',')
+        {
+          ++pos;
+          continue;
+        }
+        if (peek() == ']')
+        {
+          ++pos;
+          return true;
+        }
+        return false;
+      }
+    }
+
+    bool string(std::string& out)
+    {
+      ++pos;
+      while (!atEnd())
+      {
+        const char c = text[pos++];
+        if (c == '"')
+        {
+          return true;
+        }
+        if (c != '\\')
+        {
+          out += c;
+          continue;
+        }
+
+        if (atEnd())
+        {
+          return false;
+        }
+        switch (text[pos++])
+        {
+          case '"': out += '"'; break;
+          case '\\': out += '\\'; break;
+          case '/': out += '/'; break;
+          case 'b': out += '\b'; break;
+          case 'f': out += '\f'; break;
+          case 'n': out += '\n'; break;
+          case 'r': out += '\r'; break;
+          case 't': out += '\t'; break;
+          case 'u':
+          {
+            std::uint32_t code = 0;
+            if (!hex(code))
+            {
+              return false;
+            }
+            // a high surrogate is followed by the low half of the pair
+            if (code >= 0xD800 && code < 0xDC00 && startsWith("\\u"))
+            {
+              pos += 2;
+              std::uint32_t low = 0;
+              if (!hex(low))
+              {
+                return false;
+              }
+              code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            }
+            appendUTF8(out, code);
+            break;
+          }
+          default:
+            return false;
+        }
+      }
+      return false;
+    }
+
+    bool hex(std::uint32_t& code)
+    {
+      if (pos + 4 > text.size())
+      {
+        return false;
+      }
+
+      for (int i = 0; i < 4; ++i)
+      {
+        const char c = text[pos++];
+        code <<= 4;
+        if (c >= '0' && c <= '9')
+        {
+          code |= static_cast<std::uint32_t>(c - '0');
+        }
+        else if (c >= 'a' && c <= 'f')
+        {
+          code |= static_cast<std::uint32_t>(c - 'a' + 10);
+        }
+        else if (c >= 'A' && c <= 'F')
+        {
+          code |= static_cast<std::uint32_t>(c - 'A' + 10);
+        }
+        else
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    bool literal(std::string_view word, std::string& out)
+    {
+      if (!startsWith(word))
+      {
+        return false;
+      }
+      out = std::string(word == "null" ? "" : word);
+      pos += word.size();
+      return true;
+    }
+
+    bool number(std::string& out)
+    {
+      const auto start = pos;
+      while (!atEnd() && std::string_view("+-.0123456789eE").find(text[pos]) != std::string_view::npos)
+      {
+        ++pos;
+      }
+      out = std::string(text.substr(start, pos - start));
+      return pos != start;
+    }
+  };
+
+  /// Reads the subset of XML used by TMX and TSX files: elements,
+  /// attributes and text, skipping the prolog, comments and doctype.
+  class XMLParser : public Parser
+  {
+   public:
+    using Parser::Parser;
+
+    bool parse(Node& root)
+    {
+      while (true)
+      {
+        skipSpace();
+        if (startsWith("<?"))
+        {
+          if (!skipPast("?>"))
+          {
+            return false;
+          }
+        }
+        else if (startsWith("<!--"))
+        {
+          if (!skipPast("-->"))
+          {
+            return false;
+          }
+        }
+        else if (startsWith("<!"))
+        {
+          if (!skipPast(">"))
+          {
+            return false;
+          }
+        }
+        else
+        {
+          break;
+        }
+      }
+      return peek() == '<' && element(root, 0);
+    }
+
+   private:
+    bool skipPast(std::string_view marker)
+    {
+      const auto end = text.find(marker, pos);
+      if (end == std::string_view::npos)
+      {
+        return false;
+      }
+      pos = end + marker.size();
+      return true;
+    }
+
+    std::string_view name()
+    {
+      const auto start = pos;
+      while (!atEnd() && std::string_view(" \t\r\n/>=").find(text[pos]) == std::string_view::npos)
+      {
+        ++pos;
+      }
+      return text.substr(start, pos - start);
+    }
+
+    bool element(Node& node, int depth)
+    {
+      if (depth > MAX_DEPTH)
+      {
+        return false;
+      }
+
+      node.type = Node::Type::ELEMENT;
+      ++pos;
+      node.name = std::string(name());
+      if (node.name.empty())
+      {
+        return false;
+      }
+
+      while (true)
+      {
+        skipSpace();
+        if (startsWith("/>"))
+        {
+          pos += 2;
+          return true;
+        }
+        if (peek() == '>')
+        {
+          ++pos;
+          break;
+        }
+
+        const auto attribute = name();
+        skipSpace();
+        if (attribute.empty() || peek() != '=')
+        {
+          return false;
+        }
+        ++pos;
+        skipSpace();
+
+        const char quote = peek();
+        const auto end   = text.find(quote, pos + 1);
+        if ((quote != '"' && quote != '\'') || end == std::string_view::npos)
+        {
+          return false;
+        }
+        node.attributes.emplace_back(std::string(attribute), unescape(text.substr(pos + 1, end - pos - 1)));
+        pos = end + 1;
+      }
+
+      while (!atEnd())
+      {
+        if (startsWith("</"))
+        {
+          pos += 2;
+          return name() == node.name && skipPast(">");
+        }
+        if (startsWith("<!--"))
+        {
+          if (!skipPast("-->"))
+          {
+            return false;
+          }
+        }
+        else if (startsWith("<![CDATA["))
+        {
+          const auto start = pos + 9;
+          if (!skipPast("]]>"))
+          {
+            return false;
+          }
+          node.value.append(text.substr(start, pos - 3 - start));
+        }
+        else if (peek() == '<')
+        {
+          node.items.emplace_back();
+          if (!element(node.items.back(), depth + 1))
+          {
+            return false;
+          }
+        }
+        else
+        {
+          const auto end = std::min(text.find('<', pos), text.size());
+          node.value += unescape(text.substr(pos, end - pos));
+          pos = end;
+        }
+      }
+      return false;
+    }
+
+    static std::string unescape(std::string_view raw)
+    {
+      std::string out;
+      out.reserve(raw.size());
+      for (std::size_t i = 0; i < raw.size(); ++i)
+      {
+        const auto end = raw[i] == '&' ? raw.find(';', i) : std::string_view::npos;
+        if (end == std::string_view::npos)
+        {
+          out += raw[i];
+          continue;
+        }
+
+        const auto entity = raw.substr(i + 1, end - i - 1);
+        if (entity == "lt") { out += '<'; }
+        else if (entity == "gt") { out += '>'; }
+        else if (entity == "amp") { out += '&'; }
+        else if (entity == "quot") { out += '"'; }
+        else if (entity == "apos") { out += '\''; }
+        else if (!entity.empty() && entity[0] == '#')
+        {
+          const bool hexadecimal = entity.size() > 1 && (entity[1] == 'x' || entity[1] == 'X');
+          const auto digits      = std::string(entity.substr(hexadecimal ? 2 : 1));
+          appendUTF8(out, static_cast<std::uint32_t>(std::strtoul(digits.c_str(), nullptr, hexadecimal ? 16 : 10)));
+        }
+        else
+        {
+          out.append(raw.substr(i, end - i + 1));
+        }
+        i = end;
+      }
+      return out;
+    }
+  };
+}
+
+std::optional<pyasge::markup::Node> pyasge::markup::parse(std::string_view text)
+{
+  // skip a byte order mark and any leading whitespace to tell the formats apart
+  const auto start = text.find_first_not_of(" \t\r\n\xEF\xBB\xBF");
+  if (start == std::string_view::npos)
+  {
+    return std::nullopt;
+  }
+
+  Node root;
+  const auto body = text.substr(start);
+  const bool ok   = body.front() == '{' ? JSONParser(body).parse(root) : XMLParser(body).parse(root);
+  return ok ? std::optional<Node>(std::move(root)) : std::nullopt;
+}
+
+std::optional<std::string> pyasge::markup::readFile(const std::string& path)
+{
+  const std::filesystem::path FS_PATH(path);
+  if (std::filesystem::exists(FS_PATH))
+  {
+    std::ifstream file(FS_PATH, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+
+  // try asge IO now
+  ASGE::FILEIO::File file;
+  if (file.open(path))
+  {
+    ASGE::FILEIO::IOBuffer buffer = file.read();
+    return std::string(reinterpret_cast<const char*>(buffer.as_unsigned_char()), buffer.length);
+  }
+  return std::nullopt;
+}
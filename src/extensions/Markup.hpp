@@ -0,0 +1,125 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace pyasge::markup
+{
+  /// \brief   A JSON value or XML element.
+  /// \details Object members and child elements are both stored as named
+  ///          items, so most of a document can be read the same way
+  ///          whichever format it was saved in. Arrays of plain numbers are
+  ///          kept as their text, in a RAW node, rather than a node each.
+  struct Node
+  {
+    enum class Type
+    {
+      NONE,
+      BOOLEAN,
+      NUMBER,
+      STRING,
+      RAW, ///< an array of numbers, kept as text
+      ARRAY,
+      OBJECT,
+      ELEMENT
+    };
+
+    Type type = Type::NONE;
+    std::string name;
+    std::string value;
+    std::vector<std::pair<std::string, std::string>> attributes;
+    std::vector<Node> items;
+
+    [[nodiscard]] const Node* child(std::string_view key) const
+    {
+      auto iter = std::find_if(items.begin(), items.end(), [key](const Node& item) { return item.name == key; });
+      return iter != items.end() ? &*iter : nullptr;
+    }
+
+    [[nodiscard]] std::vector<const Node*> children(std::string_view key) const
+    {
+      std::vector<const Node*> found;
+      for (const auto& item : items)
+      {
+        if (item.name == key)
+        {
+          found.push_back(&item);
+        }
+      }
+      return found;
+    }
+
+    /// Returns an attribute, or the value of a scalar member.
+    [[nodiscard]] std::optional<std::string_view> get(std::string_view key) const
+    {
+      if (type == Type::ELEMENT)
+      {
+        for (const auto& [attribute, text] : attributes)
+        {
+          if (attribute == key)
+          {
+            return text;
+          }
+        }
+        return std::nullopt;
+      }
+
+      const auto* member = child(key);
+      if (member == nullptr || member->type == Type::ARRAY || member->type == Type::OBJECT)
+      {
+        return std::nullopt;
+      }
+      return member->value;
+    }
+
+    [[nodiscard]] std::string text(std::string_view key, std::string_view fallback = {}) const
+    {
+      return std::string(get(key).value_or(fallback));
+    }
+
+    [[nodiscard]] double number(std::string_view key, double fallback = 0) const
+    {
+      auto found = get(key);
+      return found && !found->empty() ? std::strtod(std::string(*found).c_str(), nullptr) : fallback;
+    }
+
+    [[nodiscard]] int integer(std::string_view key, int fallback = 0) const
+    {
+      return static_cast<int>(number(key, fallback));
+    }
+
+    [[nodiscard]] bool flag(std::string_view key, bool fallback) const
+    {
+      auto found = get(key);
+      return found ? *found == "true" || *found == "1" : fallback;
+    }
+  };
+
+  /// \brief   Parses a JSON or XML document, telling them apart by the first character.
+  /// \returns The root value or element, or nullopt if the text is malformed.
+  std::optional<Node> parse(std::string_view text);
+
+  /// \brief   Reads a file from disk, or failing that from the ASGE virtual file system.
+  std::optional<std::string> readFile(const std::string& path);
+}
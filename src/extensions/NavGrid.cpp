@@ -0,0 +1,559 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/NavGrid.hpp"
+#include "extensions/TileMap.hpp"
+#include "extensions/TileSet.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <mutex>
+
+namespace
+{
+  constexpr float SQRT2    = 1.41421356F;
+  constexpr float INFINITE = std::numeric_limits<float>::infinity();
+
+  /// The 4 straight steps, followed by the 4 diagonal ones.
+  constexpr int STEPS[8][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 }, { 1, 1 }, { -1, 1 }, { 1, -1 }, { -1, -1 } };
+
+  bool passable(float cost) noexcept
+  {
+    return cost > 0 && cost <= std::numeric_limits<float>::max();
+  }
+
+  int sign(int value) noexcept
+  {
+    return (value > 0) - (value < 0);
+  }
+
+  using Entry = std::pair<float, std::int32_t>;
+}
+
+pyasge::NavGrid::NavGrid(int columns, int rows, const float* cell_costs, bool diagonal) :
+  costs(static_cast<std::size_t>(std::max(columns, 0)) * static_cast<std::size_t>(std::max(rows, 0)), 0.0F),
+  grid_columns(std::max(columns, 0)),
+  grid_rows(std::max(rows, 0)),
+  diagonal_moves(diagonal)
+{
+  if (cell_costs != nullptr)
+  {
+    std::copy(cell_costs, cell_costs + costs.size(), costs.begin());
+  }
+  measure();
+}
+
+pyasge::NavGrid::NavGrid(const TileMap& map, bool diagonal) :
+  NavGrid(map.columns(), map.rows(), nullptr, diagonal)
+{
+  const auto& tiles = *map.tileSet();
+  for (int row = 0; row < grid_rows; ++row)
+  {
+    for (int column = 0; column < grid_columns; ++column)
+    {
+      costs[index(column, row)] = tiles.solid(map.get(column, row)) ? 0.0F : 1.0F;
+    }
+  }
+  measure();
+}
+
+bool pyasge::NavGrid::contains(int column, int row) const noexcept
+{
+  return column >= 0 && row >= 0 && column < grid_columns && row < grid_rows;
+}
+
+bool pyasge::NavGrid::open(int cell) const noexcept
+{
+  return passable(costs[cell]);
+}
+
+bool pyasge::NavGrid::openAt(int column, int row) const noexcept
+{
+  return contains(column, row) && open(index(column, row));
+}
+
+bool pyasge::NavGrid::open(int column, int row) const noexcept
+{
+  std::shared_lock reading(lock);
+  return openAt(column, row);
+}
+
+float pyasge::NavGrid::cost(int column, int row) const
+{
+  std::shared_lock reading(lock);
+  return contains(column, row) ? costs[index(column, row)] : 0.0F;
+}
+
+void pyasge::NavGrid::setCost(int column, int row, float cost)
+{
+  std::unique_lock writing(lock);
+  if (contains(column, row))
+  {
+    costs[index(column, row)] = cost;
+    include(cost);
+    regions_stale = true;
+  }
+}
+
+void pyasge::NavGrid::assign(const float* source)
+{
+  std::unique_lock writing(lock);
+  std::copy(source, source + costs.size(), costs.begin());
+  measure();
+  regions_stale = true;
+}
+
+void pyasge::NavGrid::copy(float* target) const
+{
+  std::shared_lock reading(lock);
+  std::copy(costs.begin(), costs.end(), target);
+}
+
+void pyasge::NavGrid::measure()
+{
+  uniform      = true;
+  uniform_cost = 0;
+  lowest_cost  = 0;
+  for (const auto cost : costs)
+  {
+    include(cost);
+  }
+}
+
+void pyasge::NavGrid::label() const
+{
+  // called with the grid locked for reading, so only other queries can race
+  std::lock_guard guard(labelling);
+  if (!regions_stale)
+  {
+    return;
+  }
+
+  // a diagonal step never cuts a corner, so it can always be made as two
+  // straight steps and 4 way flood fills find the same regions
+  regions.assign(costs.size(), -1);
+  std::vector<int> pending;
+  std::int32_t region = 0;
+  for (int first = 0; first < static_cast<int>(costs.size()); ++first)
+  {
+    if (regions[first] >= 0 || !open(first))
+    {
+      continue;
+    }
+
+    regions[first] = region;
+    pending.push_back(first);
+    while (!pending.empty())
+    {
+      const int cell = pending.back();
+      pending.pop_back();
+      const int column = cell % grid_columns;
+      const int row    = cell / grid_columns;
+      for (int i = 0; i < 4; ++i)
+      {
+        const int next_column = column + STEPS[i][0];
+        const int next_row    = row + STEPS[i][1];
+        if (openAt(next_column, next_row) && regions[index(next_column, next_row)] < 0)
+        {
+          regions[index(next_column, next_row)] = region;
+          pending.push_back(index(next_column, next_row));
+        }
+      }
+    }
+    ++region;
+  }
+  regions_stale = false;
+}
+
+void pyasge::NavGrid::include(float cost) noexcept
+{
+  // only ever tightens, so a single cell changing never needs a full pass;
+  // overwriting the one cell that broke uniformity just leaves A* in use
+  if (!passable(cost))
+  {
+    return;
+  }
+
+  if (uniform_cost == 0)
+  {
+    uniform_cost = cost;
+    lowest_cost  = cost;
+    return;
+  }
+
+  uniform     = uniform && cost == uniform_cost;
+  lowest_cost = std::min(lowest_cost, cost);
+}
+
+float pyasge::NavGrid::heuristic(int from, int to) const noexcept
+{
+  const auto dx = static_cast<float>(std::abs(from % grid_columns - to % grid_columns));
+  const auto dy = static_cast<float>(std::abs(from / grid_columns - to / grid_columns));
+  const auto steps = diagonal_moves ? std::max(dx, dy) + (SQRT2 - 1) * std::min(dx, dy) : dx + dy;
+  return steps * lowest_cost;
+}
+
+void pyasge::NavGrid::prepare(Search& search) const
+{
+  const auto cells = costs.size();
+  if (search.stamp.size() != cells)
+  {
+    search.cost.assign(cells, 0);
+    search.parent.assign(cells, -1);
+    search.stamp.assign(cells, 0);
+    search.closed.assign(cells, 0);
+    search.generation = 0;
+  }
+
+  // stamps avoid clearing the scratch arrays between searches
+  if (++search.generation == 0)
+  {
+    std::fill(search.stamp.begin(), search.stamp.end(), 0);
+    std::fill(search.closed.begin(), search.closed.end(), 0);
+    search.generation = 1;
+  }
+  search.open.clear();
+}
+
+void pyasge::NavGrid::push(Search& search, int cell, float cost, float estimate, int parent)
+{
+  search.cost[cell]   = cost;
+  search.parent[cell] = parent;
+  search.stamp[cell]  = search.generation;
+  search.open.emplace_back(cost + estimate, cell);
+  std::push_heap(search.open.begin(), search.open.end(), std::greater<Entry>());
+}
+
+bool pyasge::NavGrid::aStar(int start, int goal, Search& search) const
+{
+  const int directions = diagonal_moves ? 8 : 4;
+  push(search, start, 0, heuristic(start, goal), -1);
+
+  while (!search.open.empty())
+  {
+    std::pop_heap(search.open.begin(), search.open.end(), std::greater<Entry>());
+    const int cell = search.open.back().second;
+    search.open.pop_back();
+
+    // the heap keeps stale entries for cells that were later reached more cheaply
+    if (search.closed[cell] == search.generation)
+    {
+      continue;
+    }
+    search.closed[cell] = search.generation;
+    if (cell == goal)
+    {
+      return true;
+    }
+
+    const int column = cell % grid_columns;
+    const int row    = cell / grid_columns;
+    for (int i = 0; i < directions; ++i)
+    {
+      const int dx = STEPS[i][0];
+      const int dy = STEPS[i][1];
+      if (!openAt(column + dx, row + dy))
+      {
+        continue;
+      }
+
+      const bool diagonal_step = dx != 0 && dy != 0;
+      if (diagonal_step && !(openAt(column + dx, row) && openAt(column, row + dy)))
+      {
+        continue;
+      }
+
+      const int next = index(column + dx, row + dy);
+      if (search.closed[next] == search.generation)
+      {
+        continue;
+      }
+
+      const float cost = search.cost[cell] + costs[next] * (diagonal_step ? SQRT2 : 1.0F);
+      if (search.stamp[next] != search.generation || cost < search.cost[next])
+      {
+        push(search, next, cost, heuristic(next, goal), cell);
+      }
+    }
+  }
+  return false;
+}
+
+int pyasge::NavGrid::jump(int column, int row, int dx, int dy, int goal) const
+{
+  for (;; column += dx, row += dy)
+  {
+    if (!openAt(column, row))
+    {
+      return -1;
+    }
+
+    const int cell = index(column, row);
+    if (cell == goal)
+    {
+      return cell;
+    }
+
+    if (dx != 0 && dy != 0)
+    {
+      // a diagonal run stops wherever one of its straight runs finds something
+      if (jump(column + dx, row, dx, 0, goal) >= 0 || jump(column, row + dy, 0, dy, goal) >= 0)
+      {
+        return cell;
+      }
+      if (!(openAt(column + dx, row) && openAt(column, row + dy)))
+      {
+        return -1;
+      }
+    }
+    else if (dx != 0)
+    {
+      // a cell beside the run opens up past a wall, so can't be reached more directly
+      if (
+        (openAt(column, row - 1) && !openAt(column - dx, row - 1)) ||
+        (openAt(column, row + 1) && !openAt(column - dx, row + 1)))
+      {
+        return cell;
+      }
+    }
+    else
+    {
+      if (
+        (openAt(column - 1, row) && !openAt(column - 1, row - dy)) ||
+        (openAt(column + 1, row) && !openAt(column + 1, row - dy)))
+      {
+        return cell;
+      }
+    }
+  }
+}
+
+bool pyasge::NavGrid::jumpPoints(int start, int goal, Search& search) const
+{
+  push(search, start, 0, heuristic(start, goal), -1);
+
+  int candidates[8][2];
+  while (!search.open.empty())
+  {
+    std::pop_heap(search.open.begin(), search.open.end(), std::greater<Entry>());
+    const int cell = search.open.back().second;
+    search.open.pop_back();
+
+    if (search.closed[cell] == search.generation)
+    {
+      continue;
+    }
+    search.closed[cell] = search.generation;
+    if (cell == goal)
+    {
+      return true;
+    }
+
+    const int column = cell % grid_columns;
+    const int row    = cell / grid_columns;
+
+    // prune to the natural and forced neighbours for the direction of travel
+    int count = 0;
+    const auto add = [&](int dx, int dy)
+    {
+      candidates[count][0] = dx;
+      candidates[count][1] = dy;
+      ++count;
+    };
+
+    const int parent = search.parent[cell];
+    if (parent < 0)
+    {
+      for (const auto& step : STEPS)
+      {
+        add(step[0], step[1]);
+      }
+    }
+    else
+    {
+      const int dx = sign(column - parent % grid_columns);
+      const int dy = sign(row - parent / grid_columns);
+      if (dx != 0 && dy != 0)
+      {
+        add(dx, 0);
+        add(0, dy);
+        add(dx, dy);
+      }
+      else if (dx != 0)
+      {
+        add(dx, 0);
+        add(dx, 1);
+        add(dx, -1);
+        add(0, 1);
+        add(0, -1);
+      }
+      else
+      {
+        add(0, dy);
+        add(1, dy);
+        add(-1, dy);
+        add(1, 0);
+        add(-1, 0);
+      }
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+      const int dx = candidates[i][0];
+      const int dy = candidates[i][1];
+      if (!openAt(column + dx, row + dy))
+      {
+        continue;
+      }
+      if (dx != 0 && dy != 0 && !(openAt(column + dx, row) && openAt(column, row + dy)))
+      {
+        continue;
+      }
+
+      const int point = jump(column + dx, row + dy, dx, dy, goal);
+      if (point < 0 || search.closed[point] == search.generation)
+      {
+        continue;
+      }
+
+      // open cells all cost the same, so a run costs exactly its estimate
+      const float cost = search.cost[cell] + heuristic(cell, point);
+      if (search.stamp[point] != search.generation || cost < search.cost[point])
+      {
+        push(search, point, cost, heuristic(point, goal), cell);
+      }
+    }
+  }
+  return false;
+}
+
+bool pyasge::NavGrid::findPath(Cell start, Cell goal, std::vector<Cell>& path, Search& search) const
+{
+  path.clear();
+
+  std::shared_lock reading(lock);
+  if (!openAt(start.first, start.second) || !openAt(goal.first, goal.second))
+  {
+    return false;
+  }
+
+  const int from = index(start.first, start.second);
+  const int to   = index(goal.first, goal.second);
+  if (regions_stale)
+  {
+    label();
+  }
+  if (regions[from] != regions[to])
+  {
+    return false;
+  }
+  prepare(search);
+
+  const bool jumping = diagonal_moves && uniform;
+  if (!(jumping ? jumpPoints(from, to, search) : aStar(from, to, search)))
+  {
+    return false;
+  }
+
+  // walk back from the goal, filling in the straight runs between jump points
+  for (int cell = to; cell >= 0; cell = search.parent[cell])
+  {
+    int column = cell % grid_columns;
+    int row    = cell / grid_columns;
+    path.emplace_back(column, row);
+
+    const int parent = search.parent[cell];
+    if (parent < 0)
+    {
+      break;
+    }
+
+    const int target_column = parent % grid_columns;
+    const int target_row    = parent / grid_columns;
+    const int dx            = sign(target_column - column);
+    const int dy            = sign(target_row - row);
+    for (column += dx, row += dy; column != target_column || row != target_row; column += dx, row += dy)
+    {
+      path.emplace_back(column, row);
+    }
+  }
+  std::reverse(path.begin(), path.end());
+  return true;
+}
+
+void pyasge::NavGrid::flowField(const std::vector<Cell>& goals, float* distances, float* directions) const
+{
+  std::shared_lock reading(lock);
+  const int cells      = static_cast<int>(costs.size());
+  const int neighbours = diagonal_moves ? 8 : 4;
+  std::fill(distances, distances + cells, INFINITE);
+  std::fill(directions, directions + static_cast<std::size_t>(cells) * 2, 0.0F);
+
+  std::vector<Entry> open;
+  for (const auto& [column, row] : goals)
+  {
+    if (openAt(column, row))
+    {
+      distances[index(column, row)] = 0;
+      open.emplace_back(0.0F, index(column, row));
+    }
+  }
+  std::make_heap(open.begin(), open.end(), std::greater<Entry>());
+
+  // Dijkstra outwards from the goals: each cell reached learns the step back
+  // towards the cell it was reached from
+  while (!open.empty())
+  {
+    std::pop_heap(open.begin(), open.end(), std::greater<Entry>());
+    const auto [distance, cell] = open.back();
+    open.pop_back();
+    if (distance > distances[cell])
+    {
+      continue;
+    }
+
+    const int column = cell % grid_columns;
+    const int row    = cell / grid_columns;
+    for (int i = 0; i < neighbours; ++i)
+    {
+      const int dx = STEPS[i][0];
+      const int dy = STEPS[i][1];
+      if (!openAt(column + dx, row + dy))
+      {
+        continue;
+      }
+
+      const bool diagonal_step = dx != 0 && dy != 0;
+      if (diagonal_step && !(openAt(column + dx, row) && openAt(column, row + dy)))
+      {
+        continue;
+      }
+
+      const float length = diagonal_step ? SQRT2 : 1.0F;
+      const int next     = index(column + dx, row + dy);
+      const float reach  = distance + costs[cell] * length;
+      if (reach < distances[next])
+      {
+        distances[next]          = reach;
+        directions[next * 2]     = static_cast<float>(-dx) / length;
+        directions[next * 2 + 1] = static_cast<float>(-dy) / length;
+        open.emplace_back(reach, next);
+        std::push_heap(open.begin(), open.end(), std::greater<Entry>());
+      }
+    }
+  }
+}
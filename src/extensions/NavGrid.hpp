@@ -0,0 +1,118 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+
+namespace pyasge
+{
+  class TileMap;
+
+  /// \brief   A grid of movement costs to find paths and flow fields over.
+  /// \details Each cell holds the cost of stepping into it, with costs of 0
+  ///          or less, or that aren't finite, marking the cell as blocked.
+  ///          Units move between the 4 neighbouring cells, or the 8 when
+  ///          diagonal movement is allowed, in which case a diagonal step
+  ///          costs sqrt(2) times as much and may not cut the corner of a
+  ///          blocked cell.
+  ///
+  ///          Single paths are found using A*, switching to jump point
+  ///          search when diagonal movement is allowed and every open cell
+  ///          costs the same, as jump points skip the long runs of equal
+  ///          cells that A* would otherwise push through its open list.
+  ///          Both return every cell along the path. Open cells are
+  ///          labelled by the region they connect to, so a query between
+  ///          regions fails at once instead of flooding the whole region.
+  ///
+  ///          Queries only read the grid, so any number can run at once on
+  ///          different threads, each with its own Search. Writes wait for
+  ///          running queries to finish.
+  class NavGrid
+  {
+   public:
+    using Cell = std::pair<int, int>;
+
+    /// \brief   Scratch space reused between searches on one thread.
+    struct Search
+    {
+      std::vector<float> cost;
+      std::vector<std::int32_t> parent;
+      std::vector<std::uint32_t> stamp; ///< the search a cell's cost and parent belong to
+      std::vector<std::uint32_t> closed;
+      std::vector<std::pair<float, std::int32_t>> open;
+      std::uint32_t generation = 0;
+    };
+
+    NavGrid(int columns, int rows, const float* cell_costs, bool diagonal);
+
+    /// \brief   Builds a grid blocking a tile map's solid cells and costing 1 elsewhere.
+    NavGrid(const TileMap& map, bool diagonal);
+
+    [[nodiscard]] int columns() const noexcept { return grid_columns; }
+    [[nodiscard]] int rows() const noexcept { return grid_rows; }
+    [[nodiscard]] bool diagonal() const noexcept { return diagonal_moves; }
+    [[nodiscard]] bool contains(int column, int row) const noexcept;
+    [[nodiscard]] bool open(int column, int row) const noexcept;
+    [[nodiscard]] float cost(int column, int row) const;
+    void setCost(int column, int row, float cost);
+    void assign(const float* costs);
+    void copy(float* costs) const;
+
+    /// \brief   Finds the cheapest path between two cells.
+    /// \returns False if either cell is blocked or no path joins them,
+    ///          otherwise path holds every cell from start to goal.
+    bool findPath(Cell start, Cell goal, std::vector<Cell>& path, Search& search) const;
+
+    /// \brief   Builds a flow field leading every cell to the nearest goal.
+    /// \details Writes the cost of reaching a goal from each cell, infinite
+    ///          when none can be reached, and the unit direction of the
+    ///          cheapest first step, zero at goals and unreachable cells.
+    void flowField(const std::vector<Cell>& goals, float* distances, float* directions) const;
+
+   private:
+    [[nodiscard]] int index(int column, int row) const noexcept { return row * grid_columns + column; }
+    [[nodiscard]] bool open(int cell) const noexcept;
+    [[nodiscard]] bool openAt(int column, int row) const noexcept;
+    [[nodiscard]] float heuristic(int from, int to) const noexcept;
+    void measure();
+    void label() const;
+    void include(float cost) noexcept;
+    void prepare(Search& search) const;
+
+    bool aStar(int start, int goal, Search& search) const;
+    bool jumpPoints(int start, int goal, Search& search) const;
+    [[nodiscard]] int jump(int column, int row, int dx, int dy, int goal) const;
+    static void push(Search& search, int cell, float cost, float estimate, int parent);
+
+    std::vector<float> costs;
+    int grid_columns;
+    int grid_rows;
+    bool diagonal_moves;
+    bool uniform       = true; ///< every open cell costs uniform_cost
+    float uniform_cost = 0;    ///< 0 until a cell is open
+    float lowest_cost  = 0;    ///< keeps the heuristic admissible
+    mutable std::shared_mutex lock;
+
+    mutable std::vector<std::int32_t> regions; ///< the connected region of each open cell, -1 when blocked
+    mutable std::atomic<bool> regions_stale{ true };
+    mutable std::mutex labelling; ///< the first query after a write relabels the regions
+  };
+}
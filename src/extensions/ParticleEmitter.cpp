@@ -0,0 +1,310 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/ParticleEmitter.hpp"
+#include "extensions/GLStateGuard.hpp"
+#include "extensions/RenderContext.hpp"
+#include "extensions/SpriteVertices.hpp"
+#include "extensions/TargetTracker.hpp"
+#include "extensions/ThreadPool.hpp"
+
+#include <Engine/Texture.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+  /// Emitters smaller than this update on the calling thread, as handing out work costs more.
+  constexpr std::size_t PARALLEL_MIN = 32768;
+  constexpr std::size_t BLOCK        = 8192;
+
+  /// Particles whose sizes and colours are worked out before their quads are built.
+  constexpr std::size_t CHUNK = 256;
+
+  float lerp(float from, float to, float t) noexcept
+  {
+    return from + (to - from) * t;
+  }
+}
+
+pyasge::ParticleEmitter::ParticleEmitter(ASGE::GLRenderer& renderer, std::size_t capacity) :
+  context(RenderContext::get(renderer)), buffer(context), max_particles(capacity)
+{
+  for (auto* array : { &pos_x, &pos_y, &vel_x, &vel_y, &age, &ageing, &angle, &spin })
+  {
+    array->resize(capacity);
+  }
+  quads.reserve(capacity);
+}
+
+pyasge::ParticleEmitter::~ParticleEmitter()
+{
+  if (blank != 0 && !context.expired())
+  {
+    glDeleteTextures(1, &blank);
+  }
+}
+
+float pyasge::ParticleEmitter::pick(const Range& range)
+{
+  return lerp(range.min, range.max, unit(random));
+}
+
+std::size_t pyasge::ParticleEmitter::emit(std::size_t particles)
+{
+  const auto spawned = std::min(particles, max_particles - live);
+  for (std::size_t i = live; i < live + spawned; ++i)
+  {
+    float offset_x = 0;
+    float offset_y = 0;
+    switch (config.shape)
+    {
+      case Shape::CIRCLE:
+      case Shape::RING:
+      {
+        // the square root spreads particles evenly over the circle's area
+        const float around = unit(random) * 6.2831853F;
+        const float radius = config.extent[0] * (config.shape == Shape::RING ? 1.0F : std::sqrt(unit(random)));
+        offset_x           = std::cos(around) * radius;
+        offset_y           = std::sin(around) * radius;
+        break;
+      }
+      case Shape::RECTANGLE:
+        offset_x = (unit(random) - 0.5F) * config.extent[0];
+        offset_y = (unit(random) - 0.5F) * config.extent[1];
+        break;
+      case Shape::LINE:
+        offset_x = (unit(random) - 0.5F) * config.extent[0];
+        break;
+      case Shape::POINT:
+        break;
+    }
+
+    const float heading = config.direction + (unit(random) - 0.5F) * config.spread;
+    const float speed   = pick(config.speed);
+    pos_x[i]            = x + offset_x;
+    pos_y[i]            = y + offset_y;
+    vel_x[i]            = std::cos(heading) * speed;
+    vel_y[i]            = std::sin(heading) * speed;
+    age[i]              = 0;
+    ageing[i]           = 1.0F / std::max(pick(config.lifetime), 1e-4F);
+    angle[i]            = pick(config.rotation);
+    spin[i]             = pick(config.spin);
+  }
+
+  live += spawned;
+  return spawned;
+}
+
+void pyasge::ParticleEmitter::simulate(std::size_t begin, std::size_t end, float seconds) noexcept
+{
+  const float gravity_x = config.gravity[0] * seconds;
+  const float gravity_y = config.gravity[1] * seconds;
+  const float damping   = std::max(1.0F - config.drag * seconds, 0.0F);
+
+  float* __restrict px       = pos_x.data();
+  float* __restrict py       = pos_y.data();
+  float* __restrict vx       = vel_x.data();
+  float* __restrict vy       = vel_y.data();
+  float* __restrict ages     = age.data();
+  float* __restrict angles   = angle.data();
+  const float* __restrict ar = ageing.data();
+  const float* __restrict sp = spin.data();
+
+  // kept free of branches and calls so each loop vectorises
+  for (std::size_t i = begin; i < end; ++i)
+  {
+    vx[i] = (vx[i] + gravity_x) * damping;
+    vy[i] = (vy[i] + gravity_y) * damping;
+    px[i] += vx[i] * seconds;
+    py[i] += vy[i] * seconds;
+  }
+  for (std::size_t i = begin; i < end; ++i)
+  {
+    ages[i] += ar[i] * seconds;
+    angles[i] += sp[i] * seconds;
+  }
+}
+
+void pyasge::ParticleEmitter::retire() noexcept
+{
+  // dead particles are replaced by the last live one, so order is not kept
+  std::size_t i = 0;
+  while (i < live)
+  {
+    if (age[i] < 1.0F)
+    {
+      ++i;
+      continue;
+    }
+
+    --live;
+    for (auto* array : { &pos_x, &pos_y, &vel_x, &vel_y, &age, &ageing, &angle, &spin })
+    {
+      (*array)[i] = (*array)[live];
+    }
+  }
+}
+
+void pyasge::ParticleEmitter::update(float seconds)
+{
+  if (seconds <= 0)
+  {
+    return;
+  }
+
+  if (threaded && live >= PARALLEL_MIN)
+  {
+    ThreadPool::instance().parallelFor(
+      live, BLOCK,
+      [this, seconds](std::size_t begin, std::size_t end, std::size_t /*slot*/) { simulate(begin, end, seconds); });
+  }
+  else
+  {
+    simulate(0, live, seconds);
+  }
+  retire();
+
+  if (emitting && config.rate > 0)
+  {
+    pending += config.rate * seconds;
+    const auto due = static_cast<std::size_t>(pending);
+    pending -= static_cast<float>(due);
+    emit(due);
+  }
+}
+
+void pyasge::ParticleEmitter::vertices(
+  std::size_t begin, std::size_t end, const std::array<float, 4>& uvs, float aspect) noexcept
+{
+  const auto& start = config.colour_start;
+  const auto& stop  = config.colour_end;
+  const bool turning = config.rotation.min != 0 || config.rotation.max != 0 || config.spin.min != 0 ||
+                       config.spin.max != 0;
+  const auto kernel = bestVertexKernel();
+
+  // sizes and colours over life are worked out a chunk at a time, then
+  // turned into quads by the sprite vertex kernels several at once
+  std::array<float, CHUNK> half_w;
+  std::array<float, CHUNK> half_h;
+  std::array<float, CHUNK> r;
+  std::array<float, CHUNK> g;
+  std::array<float, CHUNK> b;
+  std::array<float, CHUNK> a;
+  for (std::size_t first = begin; first < end; first += CHUNK)
+  {
+    const auto count = std::min(CHUNK, end - first);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      const float t = std::min(age[first + i], 1.0F);
+      half_w[i]     = lerp(config.size[0], config.size[1], t) * 0.5F;
+      half_h[i]     = half_w[i] * aspect;
+      r[i]          = lerp(start[0], stop[0], t);
+      g[i]          = lerp(start[1], stop[1], t);
+      b[i]          = lerp(start[2], stop[2], t);
+      a[i]          = lerp(start[3], stop[3], t);
+    }
+
+    const CentredQuads source = { pos_x.data() + first,
+                                  pos_y.data() + first,
+                                  half_w.data(),
+                                  half_h.data(),
+                                  turning ? angle.data() + first : nullptr,
+                                  r.data(),
+                                  g.data(),
+                                  b.data(),
+                                  a.data(),
+                                  uvs };
+    centredQuads(source, count, quads.data() + first, kernel);
+  }
+}
+
+GLuint pyasge::ParticleEmitter::textureID()
+{
+  if (texture != nullptr)
+  {
+    return QuadBuffer::textureID(texture);
+  }
+
+  if (blank == 0)
+  {
+    constexpr std::array<std::uint8_t, 4> WHITE = { 255, 255, 255, 255 };
+    GLStateGuard guard;
+    glGenTextures(1, &blank);
+    glBindTexture(GL_TEXTURE_2D, blank);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, WHITE.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  }
+  return blank;
+}
+
+bool pyasge::ParticleEmitter::render()
+{
+  auto ctx      = context.lock();
+  auto* program = ctx ? ctx->spriteProgram() : nullptr;
+  const auto id = program != nullptr && live != 0 ? textureID() : 0;
+  if (id == 0)
+  {
+    return false;
+  }
+
+  // particles are as tall as the region they draw is in proportion to its width
+  std::array<float, 4> uvs = { 0, 0, 1, 1 };
+  float aspect             = 1.0F;
+  if (texture != nullptr && src_rect[2] > 0 && src_rect[3] > 0)
+  {
+    const auto width  = static_cast<float>(texture->getWidth());
+    const auto height = static_cast<float>(texture->getHeight());
+    uvs = { src_rect[0] / width, src_rect[1] / height, (src_rect[0] + src_rect[2]) / width,
+            (src_rect[1] + src_rect[3]) / height };
+    aspect = src_rect[3] / src_rect[2];
+  }
+  else if (texture != nullptr && texture->getWidth() > 0)
+  {
+    aspect = static_cast<float>(texture->getHeight()) / static_cast<float>(texture->getWidth());
+  }
+
+  quads.resize(live);
+  if (threaded && live >= PARALLEL_MIN)
+  {
+    ThreadPool::instance().parallelFor(
+      live, BLOCK, [this, &uvs, aspect](std::size_t begin, std::size_t end, std::size_t /*slot*/)
+      { vertices(begin, end, uvs, aspect); });
+  }
+  else
+  {
+    vertices(0, live, uvs, aspect);
+  }
+
+  // streamed through the context's ring buffer rather than overwriting storage the GPU may still be reading
+  buffer.upload(quads, { { id, 0, live } }, GL_STREAM_DRAW);
+
+  GLStateGuard guard;
+  program->begin(ctx->renderer());
+  if (additive)
+  {
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+  }
+  buffer.draw(ctx->stats());
+  TargetTracker::instance().drawn();
+  return true;
+}
+
+void pyasge::ParticleEmitter::clear() noexcept
+{
+  live    = 0;
+  pending = 0;
+}
@@ -0,0 +1,148 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "extensions/QuadBuffer.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace ASGE
+{
+  class GLRenderer;
+  class Texture2D;
+}
+
+namespace pyasge
+{
+  class RenderContext;
+
+  /// \brief   A fixed size pool of particles simulated and drawn natively.
+  /// \details Particles are stored as a structure of arrays, one array per
+  ///          attribute, so the update loops run branch free over contiguous
+  ///          floats. Quads are built from them by the sprite vertex kernels,
+  ///          eight or four particles at a time with the widest instruction
+  ///          set the processor has. Large emitters can split their update
+  ///          and vertex generation across the thread pool. Ages are
+  ///          normalised, running from 0 at birth to 1 at death, so colour
+  ///          and size over life are a lerp of the start and end values
+  ///          without a division per particle.
+  ///
+  ///          Every live particle is written into a streamed vertex buffer
+  ///          and drawn with a single call, immediately, in the same way as a
+  ///          static batch. Particles live in world space; moving the emitter
+  ///          only moves where new particles are spawned.
+  class ParticleEmitter
+  {
+   public:
+    enum class Shape
+    {
+      POINT,     ///< at the emitter's position
+      CIRCLE,    ///< anywhere inside a circle of radius extent[0]
+      RING,      ///< on the edge of a circle of radius extent[0]
+      RECTANGLE, ///< anywhere inside an extent[0] by extent[1] rectangle centred on the emitter
+      LINE       ///< along a horizontal line extent[0] long centred on the emitter
+    };
+
+    /// \brief   A range that values are picked from uniformly for each new particle.
+    struct Range
+    {
+      float min;
+      float max;
+    };
+
+    /// \brief   How particles are spawned and how they change over their lifetime.
+    struct Settings
+    {
+      Shape shape                         = Shape::POINT;
+      std::array<float, 2> extent         = { 0, 0 };
+      float rate                          = 0;            ///< particles spawned per second while emitting
+      Range lifetime                      = { 1, 1 };     ///< seconds
+      Range speed                         = { 0, 0 };     ///< units per second
+      float direction                     = 0;            ///< radians clockwise from +x
+      float spread                        = 6.2831853F;   ///< arc of directions centred on direction
+      Range rotation                      = { 0, 0 };     ///< radians at birth
+      Range spin                          = { 0, 0 };     ///< radians per second
+      std::array<float, 2> gravity        = { 0, 0 };     ///< units per second squared
+      float drag                          = 0;            ///< fraction of velocity lost per second
+      std::array<float, 2> size           = { 8, 8 };     ///< width at birth and death
+      std::array<float, 4> colour_start   = { 1, 1, 1, 1 };
+      std::array<float, 4> colour_end     = { 1, 1, 1, 0 };
+    };
+
+    ParticleEmitter(ASGE::GLRenderer& renderer, std::size_t capacity);
+    ~ParticleEmitter();
+    ParticleEmitter(const ParticleEmitter&) = delete;
+    ParticleEmitter& operator=(const ParticleEmitter&) = delete;
+
+    [[nodiscard]] Settings& settings() noexcept { return config; }
+    [[nodiscard]] const Settings& settings() const noexcept { return config; }
+
+    /// \brief   Spawns particles at the emitter straight away.
+    /// \returns The number spawned, fewer than asked for if the pool fills.
+    std::size_t emit(std::size_t particles);
+
+    /// \brief   Ages, moves and retires particles, then spawns those due at the emission rate.
+    /// \details The GIL stays held while the pool works, as emit and the
+    ///          settings could otherwise change under it from another thread.
+    void update(float seconds);
+
+    /// \brief   Draws every live particle with one call.
+    /// \returns False if there was nothing to draw.
+    bool render();
+
+    void clear() noexcept;
+    void seed(std::uint32_t value) { random.seed(value); }
+    void setTexture(const ASGE::Texture2D* image) noexcept { texture = image; }
+    [[nodiscard]] const ASGE::Texture2D* getTexture() const noexcept { return texture; }
+
+    [[nodiscard]] std::size_t size() const noexcept { return live; }
+    [[nodiscard]] std::size_t capacity() const noexcept { return max_particles; }
+
+    float x        = 0;
+    float y        = 0;
+    bool emitting  = true;
+    bool additive  = false; ///< adds particles onto what is beneath rather than blending
+    bool threaded  = true;  ///< splits large emitters across the thread pool
+    std::array<float, 4> src_rect = { 0, 0, 0, 0 }; ///< atlas region in pixels, or empty for the whole texture
+
+   private:
+    void simulate(std::size_t begin, std::size_t end, float seconds) noexcept;
+    void retire() noexcept;
+    void vertices(std::size_t begin, std::size_t end, const std::array<float, 4>& uvs, float aspect) noexcept;
+    GLuint textureID();
+    float pick(const Range& range);
+
+    std::weak_ptr<RenderContext> context;
+    QuadBuffer buffer;
+    Settings config;
+    std::size_t max_particles = 0;
+    std::size_t live          = 0;
+    float pending             = 0; ///< fractional particles owed by the emission rate
+    std::mt19937 random{ std::random_device{}() };
+    std::uniform_real_distribution<float> unit{ 0.0F, 1.0F };
+    const ASGE::Texture2D* texture = nullptr;
+    GLuint blank                   = 0; ///< a white texel for untextured particles
+
+    // one array per attribute, each holding capacity entries
+    std::vector<float> pos_x, pos_y, vel_x, vel_y, age, ageing, angle, spin;
+    std::vector<Quad> quads;
+  };
+}
@@ -0,0 +1,210 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/PostProcessChain.hpp"
+#include "extensions/RenderContext.hpp"
+#include "extensions/TargetTracker.hpp"
+
+#include <Engine/Logger.hpp>
+#include <Engine/OpenGL/GLRenderTarget.hpp>
+#include <Engine/OpenGL/GLRenderer.hpp>
+#include <Engine/OpenGL/GLShader.hpp>
+#include <Engine/OpenGL/GLTexture.hpp>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+pyasge::PostProcessChain::PostProcessChain(ASGE::GLRenderer& gl_renderer, ASGE::Texture2D::Format target_format) :
+  renderer(&gl_renderer), context(RenderContext::get(gl_renderer)), format(target_format)
+{
+}
+
+bool pyasge::PostProcessChain::add(ASGE::SHADER_LIB::GLShader* shader, float scale)
+{
+  if (!(scale >= MIN_SCALE && scale <= MAX_SCALE))
+  {
+    return false;
+  }
+
+  pass_list.push_back({ shader, scale });
+  return true;
+}
+
+bool pyasge::PostProcessChain::begin()
+{
+  auto ctx = lock();
+  if (!ctx)
+  {
+    return false;
+  }
+
+  if (input != nullptr)
+  {
+    Logging::ERRORS("PostProcessChain.begin called twice without end");
+    return false;
+  }
+
+  // draws queued before the chain belong to the current target, not the chain's input
+  ctx->flushQueue();
+
+  // render the scene as it would appear in the current viewport
+  input_state       = save();
+  const auto width  = std::max(1, input_state.viewport.w);
+  const auto height = std::max(1, input_state.viewport.h);
+  input             = ctx->targetPool().acquire(*renderer, width, height, format, ctx->frameCount());
+  bind(*ctx, input, width, height);
+  renderer->setProjectionMatrix(input_state.view);
+  ctx->refreshView();
+  return true;
+}
+
+bool pyasge::PostProcessChain::end(ASGE::GLRenderTarget* output)
+{
+  auto ctx = lock();
+  if (!ctx)
+  {
+    return false;
+  }
+
+  if (input == nullptr)
+  {
+    Logging::ERRORS("PostProcessChain.end called without begin");
+    return false;
+  }
+
+  // draws queued since begin belong to the chain's input, so land them before switching back
+  ctx->flushQueue();
+  auto* target = std::exchange(input, nullptr);
+  restore(*ctx, input_state);
+
+  auto* scene = TargetTracker::instance().resolve(*target, 0);
+  const bool ran = scene != nullptr && run(*scene, output);
+  ctx->targetPool().release(target, ctx->frameCount());
+  return ran;
+}
+
+bool pyasge::PostProcessChain::run(ASGE::GLTexture& source, ASGE::GLRenderTarget* output)
+{
+  auto ctx = lock();
+  if (!ctx || pass_list.empty())
+  {
+    return false;
+  }
+
+  ctx->flushQueue();
+  const auto state    = save();
+  auto& pool          = ctx->targetPool();
+  auto& tracker       = TargetTracker::instance();
+  const auto source_w = static_cast<float>(source.getWidth());
+  const auto source_h = static_cast<float>(source.getHeight());
+
+  ASGE::GLTexture* previous             = &source;
+  ASGE::GLRenderTarget* previous_target = nullptr;
+  for (std::size_t i = 0; i + 1 < pass_list.size(); ++i)
+  {
+    const auto width  = std::max(1, static_cast<int>(std::lround(source_w * pass_list[i].scale)));
+    const auto height = std::max(1, static_cast<int>(std::lround(source_h * pass_list[i].scale)));
+    auto* target      = pool.acquire(*renderer, width, height, format, ctx->frameCount());
+
+    bind(*ctx, target, width, height);
+    draw(*previous, pass_list[i].shader, 0, 0, static_cast<float>(width), static_cast<float>(height));
+    renderer->setRenderTarget(nullptr);
+    tracker.bind(nullptr);
+
+    // the previous target has been drawn, so the next pass of the same size may reuse it
+    if (previous_target != nullptr)
+    {
+      pool.release(previous_target, ctx->frameCount());
+    }
+    previous        = tracker.resolve(*target, 0);
+    previous_target = target;
+  }
+
+  if (output == nullptr)
+  {
+    // the last pass covers the camera view on screen
+    restore(*ctx, state);
+    renderer->setRenderTarget(nullptr);
+    tracker.bind(nullptr);
+    draw(
+      *previous, pass_list.back().shader, state.view.min_x, state.view.min_y,
+      state.view.max_x - state.view.min_x, state.view.max_y - state.view.min_y);
+  }
+  else
+  {
+    const auto& buffers = output->getResolved();
+    const auto width    = buffers.empty() ? static_cast<int>(source_w) : static_cast<int>(buffers[0]->getWidth());
+    const auto height   = buffers.empty() ? static_cast<int>(source_h) : static_cast<int>(buffers[0]->getHeight());
+    bind(*ctx, output, width, height);
+    draw(*previous, pass_list.back().shader, 0, 0, static_cast<float>(width), static_cast<float>(height));
+  }
+
+  if (previous_target != nullptr)
+  {
+    pool.release(previous_target, ctx->frameCount());
+  }
+
+  restore(*ctx, state);
+  return true;
+}
+
+std::shared_ptr<pyasge::RenderContext> pyasge::PostProcessChain::lock() const
+{
+  return context.lock();
+}
+
+pyasge::PostProcessChain::SavedState pyasge::PostProcessChain::save() const
+{
+  const auto& resolution = renderer->getResolutionInfo();
+  return { TargetTracker::instance().bound(), resolution.viewport, resolution.view };
+}
+
+void pyasge::PostProcessChain::restore(RenderContext& ctx, const SavedState& state)
+{
+  auto* target = const_cast<ASGE::GLRenderTarget*>(state.target);
+  renderer->setRenderTarget(target);
+  renderer->setViewport(state.viewport);
+  renderer->setProjectionMatrix(state.view);
+  TargetTracker::instance().bind(target);
+  ctx.stateCache().invalidate();
+  ctx.refreshView();
+}
+
+void pyasge::PostProcessChain::bind(RenderContext& ctx, ASGE::GLRenderTarget* target, int width, int height)
+{
+  renderer->setRenderTarget(target);
+  renderer->setViewport({ 0, 0, width, height });
+  renderer->setProjectionMatrix(0, 0, static_cast<float>(width), static_cast<float>(height));
+  TargetTracker::instance().bind(target);
+  ctx.stateCache().invalidate();
+  ctx.refreshView();
+}
+
+void pyasge::PostProcessChain::draw(
+  ASGE::GLTexture& texture, ASGE::SHADER_LIB::GLShader* shader, float x, float y, float w, float h)
+{
+  quad.attach(&texture, ASGE::Sprite::AttachMode::DEFAULT);
+  quad.setPixelShader(shader);
+  quad.xPos(x);
+  quad.yPos(y);
+  quad.width(w);
+  quad.height(h);
+  renderer->render(quad);
+  TargetTracker::instance().drawn();
+  if (auto* ctx = RenderContext::active())
+  {
+    ctx->engineDrew();
+  }
+}
@@ -0,0 +1,101 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <Engine/Camera.hpp>
+#include <Engine/OpenGL/GLSprite.hpp>
+#include <Engine/Texture.hpp>
+#include <Engine/Viewport.hpp>
+#include <memory>
+#include <vector>
+
+namespace ASGE
+{
+  class GLRenderer;
+  class GLRenderTarget;
+  class GLTexture;
+
+  namespace SHADER_LIB
+  {
+    class GLShader;
+  }
+}
+
+namespace pyasge
+{
+  class RenderContext;
+
+  /// \brief   Runs a sequence of full screen shader passes over a texture.
+  /// \details Each pass draws the previous pass's output through its shader
+  ///          into an intermediate target sized by the pass's scale factor,
+  ///          relative to the chain's input. Intermediate targets come from
+  ///          the renderer's target pool and are released as soon as the
+  ///          following pass has drawn them, so passes of the same size
+  ///          ping-pong between two targets. The final pass draws straight
+  ///          into the output, which is either a render target or the screen.
+  ///
+  ///          The chain changes the render target, viewport and projection,
+  ///          so any queued draws are flushed first, and the previous state
+  ///          is restored once the chain has run. Between begin and end,
+  ///          queued draws are flushed on both sides so that they land in
+  ///          the chain's input rather than the target around it.
+  class PostProcessChain
+  {
+   public:
+    struct Pass
+    {
+      ASGE::SHADER_LIB::GLShader* shader;
+      float scale;
+    };
+
+    static constexpr float MIN_SCALE = 1.0F / 64.0F;
+    static constexpr float MAX_SCALE = 4.0F;
+
+    PostProcessChain(ASGE::GLRenderer& gl_renderer, ASGE::Texture2D::Format target_format);
+
+    /// \brief   Appends a pass.
+    /// \returns False, adding nothing, if the scale lies outside [MIN_SCALE, MAX_SCALE].
+    bool add(ASGE::SHADER_LIB::GLShader* shader, float scale);
+    void clear() noexcept { pass_list.clear(); }
+    [[nodiscard]] const std::vector<Pass>& passes() const noexcept { return pass_list; }
+
+    bool begin();
+    bool end(ASGE::GLRenderTarget* output);
+    bool run(ASGE::GLTexture& source, ASGE::GLRenderTarget* output);
+
+   private:
+    struct SavedState
+    {
+      const ASGE::GLRenderTarget* target;
+      ASGE::Viewport viewport;
+      ASGE::Camera::CameraView view;
+    };
+
+    std::shared_ptr<RenderContext> lock() const;
+    SavedState save() const;
+    void restore(RenderContext& context, const SavedState& state);
+    void bind(RenderContext& context, ASGE::GLRenderTarget* target, int width, int height);
+    void draw(ASGE::GLTexture& texture, ASGE::SHADER_LIB::GLShader* shader, float x, float y, float w, float h);
+
+    ASGE::GLRenderer* renderer;
+    std::weak_ptr<RenderContext> context;
+    ASGE::Texture2D::Format format;
+    std::vector<Pass> pass_list;
+    ASGE::GLSprite quad;
+    ASGE::GLRenderTarget* input = nullptr;
+    SavedState input_state{};
+  };
+}
@@ -0,0 +1,144 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/QuadBuffer.hpp"
+#include "extensions/FrameStats.hpp"
+#include "extensions/GLStateGuard.hpp"
+#include "extensions/RenderContext.hpp"
+
+#include <Engine/OpenGL/GLTexture.hpp>
+#include <array>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+pyasge::QuadBuffer::QuadBuffer(std::weak_ptr<RenderContext> owner) : context(std::move(owner)) {}
+
+pyasge::QuadBuffer::~QuadBuffer()
+{
+  // the buffers went with the GL context if the renderer has been released
+  if (context.expired() || vertex_array == 0)
+  {
+    return;
+  }
+
+  glDeleteVertexArrays(1, &vertex_array);
+  if (vertex_buffer != 0)
+  {
+    glDeleteBuffers(1, &vertex_buffer);
+  }
+}
+
+void pyasge::QuadBuffer::upload(const std::vector<Quad>& quads, std::vector<Run> quad_runs, GLenum usage)
+{
+  auto ctx      = context.lock();
+  auto* program = ctx ? ctx->spriteProgram() : nullptr;
+  if (program == nullptr)
+  {
+    return;
+  }
+
+  GLStateGuard guard;
+  if (vertex_array == 0)
+  {
+    glGenVertexArrays(1, &vertex_array);
+  }
+  glBindVertexArray(vertex_array);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, program->indices(quads.size()));
+
+  // streamed quads are drawn once from the context's ring, so packing them costs more than it saves
+  streamed = usage == GL_STREAM_DRAW;
+  packQuads(quads, ctx->compactVertices() && !streamed, packed);
+  if (streamed)
+  {
+    const auto base = ctx->streamBuffer().write(quads.data(), quads.size() * sizeof(Quad));
+    SpriteProgram::attributes(packed.format, base);
+    runs       = std::move(quad_runs);
+    quad_count = quads.size();
+    return;
+  }
+
+  const auto* data =
+    packed.format == VertexFormat::FULL ? static_cast<const void*>(quads.data()) : packed.bytes.data();
+  const auto size = quads.size() * vertexSize(packed.format) * std::tuple_size_v<Quad>;
+  if (vertex_buffer == 0)
+  {
+    glGenBuffers(1, &vertex_buffer);
+  }
+
+  glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+  glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(size), data, usage);
+  SpriteProgram::attributes(packed.format);
+
+  // later writes only need the format and origin
+  packed.bytes = {};
+
+  runs       = std::move(quad_runs);
+  quad_count = quads.size();
+}
+
+bool pyasge::QuadBuffer::write(std::size_t slot, const Quad& quad)
+{
+  if (slot >= quad_count || streamed || context.expired())
+  {
+    return false;
+  }
+
+  std::array<std::uint8_t, sizeof(Quad)> bytes{};
+  if (!packQuad(quad, packed.format, packed.origin_x, packed.origin_y, bytes.data()))
+  {
+    return false;
+  }
+
+  const auto size = vertexSize(packed.format) * quad.size();
+  GLStateGuard guard;
+  glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+  glBufferSubData(
+    GL_ARRAY_BUFFER, static_cast<GLintptr>(slot * size), static_cast<GLsizeiptr>(size), bytes.data());
+  return true;
+}
+
+std::size_t pyasge::QuadBuffer::draw(FrameStats& stats) const
+{
+  if (runs.empty())
+  {
+    return 0;
+  }
+
+  // the sprite program is already in use, so only the origin of half float positions is set
+  if (auto ctx = context.lock(); ctx && ctx->spriteProgram() != nullptr)
+  {
+    ctx->spriteProgram()->origin(packed.origin_x, packed.origin_y);
+  }
+
+  glBindVertexArray(vertex_array);
+  for (const auto& run : runs)
+  {
+    glBindTexture(GL_TEXTURE_2D, run.texture);
+    glDrawElements(
+      GL_TRIANGLES, static_cast<GLsizei>(run.count * QUAD_INDICES.size()), GL_UNSIGNED_INT,
+      reinterpret_cast<const void*>(run.first * QUAD_INDICES.size() * sizeof(std::uint32_t)));
+  }
+
+  stats.native_draws += runs.size();
+  stats.native_quads += quad_count;
+  return runs.size();
+}
+
+GLuint pyasge::QuadBuffer::textureID(const ASGE::Texture2D* texture)
+{
+  const auto* gl_texture = dynamic_cast<const ASGE::GLTexture*>(texture);
+  return gl_texture != nullptr ? gl_texture->getID() : 0;
+}
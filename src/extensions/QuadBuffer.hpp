@@ -0,0 +1,94 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "extensions/GL.hpp"
+#include "extensions/Quads.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace ASGE
+{
+  class Texture2D;
+}
+
+namespace pyasge
+{
+  class RenderContext;
+  struct FrameStats;
+
+  /// \brief   Quads held in a GPU buffer, drawn in runs sharing a texture.
+  /// \details The storage behind the extensions' retained draws. The owner
+  ///          orders its quads so those sharing a texture are contiguous,
+  ///          uploads them along with the runs they form, and draws them
+  ///          after preparing the sprite program. The buffer's GL objects
+  ///          are only freed while the render context that made them is
+  ///          still alive.
+  ///
+  ///          Unless the render context has compact vertices turned off, the
+  ///          quads of retained uploads are packed into the smallest
+  ///          VertexFormat they fit, which a later write must fit as well.
+  ///
+  ///          Uploads with the GL_STREAM_DRAW hint are instead written to the
+  ///          render context's StreamBuffer at full precision, and must be
+  ///          drawn in the same frame. They can't be written to afterwards.
+  class QuadBuffer
+  {
+   public:
+    struct Run
+    {
+      GLuint texture;
+      std::size_t first;
+      std::size_t count;
+    };
+
+    explicit QuadBuffer(std::weak_ptr<RenderContext> owner);
+    ~QuadBuffer();
+    QuadBuffer(const QuadBuffer&) = delete;
+    QuadBuffer& operator=(const QuadBuffer&) = delete;
+
+    /// \brief   Replaces the buffer's contents.
+    /// \details Quads are expected to be ordered by run, with each run
+    ///          covering the quads that sample its texture.
+    void upload(const std::vector<Quad>& quads, std::vector<Run> quad_runs, GLenum usage = GL_STATIC_DRAW);
+
+    /// \brief   Rewrites a single quad without changing the runs.
+    /// \returns False if the quad doesn't fit the buffer's format, and must be uploaded with the rest.
+    bool write(std::size_t slot, const Quad& quad);
+
+    /// \brief   Draws every run, assuming the sprite program is in use.
+    /// \returns The number of draw calls issued.
+    std::size_t draw(FrameStats& stats) const;
+
+    [[nodiscard]] std::size_t quads() const noexcept { return quad_count; }
+    [[nodiscard]] std::size_t draws() const noexcept { return runs.size(); }
+    [[nodiscard]] VertexFormat format() const noexcept { return packed.format; }
+
+    /// \brief   The GL name of a texture, or 0 if it has none.
+    static GLuint textureID(const ASGE::Texture2D* texture);
+
+   private:
+    std::weak_ptr<RenderContext> context;
+    std::vector<Run> runs;
+    PackedQuads packed;
+    std::size_t quad_count = 0;
+    bool streamed          = false;
+    GLuint vertex_array    = 0;
+    GLuint vertex_buffer   = 0;
+  };
+}
@@ -0,0 +1,306 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/Quads.hpp"
+
+#include <Engine/Sprite.hpp>
+#include <Engine/SpriteBounds.hpp>
+#include <Engine/Texture.hpp>
+#include <Tile.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <tuple>
+#include <utility>
+
+namespace
+{
+  using UVs = std::array<std::array<float, 2>, 4>;
+
+  UVs sourceUVs(const ASGE::Texture2D& texture, const float* src_rect)
+  {
+    const auto width  = static_cast<float>(texture.getWidth());
+    const auto height = static_cast<float>(texture.getHeight());
+    const float u0    = src_rect[0] / width;
+    const float v0    = src_rect[1] / height;
+    const float u1    = (src_rect[0] + src_rect[2]) / width;
+    const float v1    = (src_rect[1] + src_rect[3]) / height;
+    return { { { u0, v0 }, { u1, v0 }, { u1, v1 }, { u0, v1 } } };
+  }
+
+  std::uint8_t unorm8(float value) { return static_cast<std::uint8_t>(value * 255.0F + 0.5F); }
+  std::uint16_t unorm16(float value) { return static_cast<std::uint16_t>(value * 65535.0F + 0.5F); }
+  bool normalised(float value) { return value >= 0.0F && value <= 1.0F; }
+
+  /// \brief   Converts a float well within the half float range, rounding to nearest even.
+  std::uint16_t toHalf(float value)
+  {
+    std::uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const auto sign      = static_cast<std::uint16_t>((bits >> 16U) & 0x8000U);
+    const auto magnitude = bits & 0x7FFFFFFFU;
+
+    // below 2^-14 halves are subnormal, counting in steps of 2^-24
+    if (magnitude < 0x38800000U)
+    {
+      return static_cast<std::uint16_t>(sign | static_cast<std::uint16_t>(std::nearbyint(std::fabs(value) * 16777216.0F)));
+    }
+
+    // otherwise rebias the exponent and drop 13 bits of the mantissa, adding just under half before
+    // truncating and the last kept bit to break ties towards even
+    const auto half = (magnitude - 0x38000000U + 0x0FFFU + ((magnitude >> 13U) & 1U)) >> 13U;
+    return static_cast<std::uint16_t>(sign | half);
+  }
+
+  bool compactable(const pyasge::QuadVertex& vertex)
+  {
+    return normalised(vertex.u) & normalised(vertex.v) & normalised(vertex.r) & normalised(vertex.g) &
+           normalised(vertex.b) & normalised(vertex.a);
+  }
+
+  pyasge::CompactVertex compactVertex(const pyasge::QuadVertex& vertex)
+  {
+    return { vertex.x,
+             vertex.y,
+             { unorm16(vertex.u), unorm16(vertex.v) },
+             { unorm8(vertex.r), unorm8(vertex.g), unorm8(vertex.b), unorm8(vertex.a) } };
+  }
+
+  pyasge::HalfVertex halfVertex(const pyasge::QuadVertex& vertex, float origin_x, float origin_y)
+  {
+    return { { toHalf(vertex.x - origin_x), toHalf(vertex.y - origin_y) },
+             { unorm16(vertex.u), unorm16(vertex.v) },
+             { unorm8(vertex.r), unorm8(vertex.g), unorm8(vertex.b), unorm8(vertex.a) } };
+  }
+
+  void assign(
+    pyasge::Quad& quad, const std::array<ASGE::Point2D, 4>& corners, const UVs& uvs, const ASGE::Colour& tint,
+    float opacity)
+  {
+    for (std::size_t i = 0; i < quad.size(); ++i)
+    {
+      quad[i] = { corners[i].x, corners[i].y, uvs[i][0], uvs[i][1], tint.r, tint.g, tint.b, opacity };
+    }
+  }
+}
+
+bool pyasge::spriteQuad(const ASGE::Sprite& sprite, Quad& quad)
+{
+  const auto* texture = sprite.getTexture();
+  if (texture == nullptr)
+  {
+    return false;
+  }
+
+  auto uvs         = sourceUVs(*texture, sprite.srcRect());
+  const auto flags = static_cast<unsigned int>(sprite.flipFlags());
+  if ((flags & static_cast<unsigned int>(ASGE::Sprite::FLIP_X)) != 0)
+  {
+    std::swap(uvs[0], uvs[1]);
+    std::swap(uvs[3], uvs[2]);
+  }
+  if ((flags & static_cast<unsigned int>(ASGE::Sprite::FLIP_Y)) != 0)
+  {
+    std::swap(uvs[0], uvs[3]);
+    std::swap(uvs[1], uvs[2]);
+  }
+  if ((flags & static_cast<unsigned int>(ASGE::Sprite::FLIP_XY)) != 0)
+  {
+    std::swap(uvs[1], uvs[3]);
+  }
+
+  const auto bounds = sprite.getWorldBounds();
+  assign(quad, { bounds.v1, bounds.v2, bounds.v3, bounds.v4 }, uvs, sprite.colour(), sprite.opacity());
+  return true;
+}
+
+bool pyasge::spriteInstance(const ASGE::Sprite& sprite, SpriteInstance& instance)
+{
+  const auto* texture = sprite.getTexture();
+  if (texture == nullptr)
+  {
+    return false;
+  }
+
+  const auto uvs   = sourceUVs(*texture, sprite.srcRect());
+  auto& rect       = instance.uvs;
+  rect             = { uvs[0][0], uvs[0][1], uvs[2][0], uvs[2][1] };
+  const auto flags = static_cast<unsigned int>(sprite.flipFlags());
+  if ((flags & static_cast<unsigned int>(ASGE::Sprite::FLIP_X)) != 0)
+  {
+    std::swap(rect[0], rect[2]);
+  }
+  if ((flags & static_cast<unsigned int>(ASGE::Sprite::FLIP_Y)) != 0)
+  {
+    std::swap(rect[1], rect[3]);
+  }
+
+  // the corners, halved, relative to the centre of the quad
+  const auto bounds = sprite.getWorldBounds();
+  instance.x        = (bounds.v1.x + bounds.v3.x) * 0.5F;
+  instance.y        = (bounds.v1.y + bounds.v3.y) * 0.5F;
+  instance.axes     = { (bounds.v2.x - bounds.v1.x) * 0.5F, (bounds.v2.y - bounds.v1.y) * 0.5F,
+                        (bounds.v4.x - bounds.v1.x) * 0.5F, (bounds.v4.y - bounds.v1.y) * 0.5F };
+
+  // a diagonal flip transposes the texture, which is the same as swapping the axes
+  if ((flags & static_cast<unsigned int>(ASGE::Sprite::FLIP_XY)) != 0)
+  {
+    std::swap(instance.axes[0], instance.axes[2]);
+    std::swap(instance.axes[1], instance.axes[3]);
+  }
+
+  const auto unorm = [](float value)
+  { return static_cast<std::uint8_t>(std::clamp(value, 0.0F, 1.0F) * 255.0F + 0.5F); };
+  const auto tint = sprite.colour();
+  instance.rgba   = { unorm(tint.r), unorm(tint.g), unorm(tint.b), unorm(sprite.opacity()) };
+  return true;
+}
+
+bool pyasge::tileQuad(const ASGE::Tile& tile, float x, float y, Quad& quad)
+{
+  if (tile.texture == nullptr)
+  {
+    return false;
+  }
+
+  // tiles rotate about their centre, as sprites do
+  const float half_w = static_cast<float>(tile.width) * 0.5F;
+  const float half_h = static_cast<float>(tile.height) * 0.5F;
+  const float cos_r  = std::cos(tile.rotation);
+  const float sin_r  = std::sin(tile.rotation);
+  const auto corner  = [&](float dx, float dy)
+  {
+    return ASGE::Point2D{ x + half_w + dx * cos_r - dy * sin_r, y + half_h + dx * sin_r + dy * cos_r };
+  };
+
+  assign(
+    quad,
+    { corner(-half_w, -half_h), corner(half_w, -half_h), corner(half_w, half_h), corner(-half_w, half_h) },
+    sourceUVs(*tile.texture, tile.src_rect), tile.tint, tile.opacity);
+  return true;
+}
+
+std::size_t pyasge::vertexSize(VertexFormat format) noexcept
+{
+  switch (format)
+  {
+    case VertexFormat::COMPACT:
+      return sizeof(CompactVertex);
+    case VertexFormat::HALF:
+      return sizeof(HalfVertex);
+    default:
+      return sizeof(QuadVertex);
+  }
+}
+
+void pyasge::packQuads(const std::vector<Quad>& quads, bool compact, PackedQuads& packed)
+{
+  packed.format   = VertexFormat::FULL;
+  packed.origin_x = 0;
+  packed.origin_y = 0;
+  packed.bytes.clear();
+  if (!compact || quads.empty())
+  {
+    return;
+  }
+
+  // a single branch free pass checks every vertex fits and measures the bounds of the positions
+  bool fits   = true;
+  float min_x = std::numeric_limits<float>::infinity();
+  float min_y = min_x;
+  float max_x = -min_x;
+  float max_y = -min_x;
+  for (const auto& quad : quads)
+  {
+    for (const auto& vertex : quad)
+    {
+      fits  = fits & compactable(vertex) & (vertex.x - vertex.x == 0.0F) & (vertex.y - vertex.y == 0.0F);
+      min_x = vertex.x < min_x ? vertex.x : min_x;
+      max_x = vertex.x > max_x ? vertex.x : max_x;
+      min_y = vertex.y < min_y ? vertex.y : min_y;
+      max_y = vertex.y > max_y ? vertex.y : max_y;
+    }
+  }
+
+  if (!fits)
+  {
+    return;
+  }
+
+  const float origin_x = (min_x + max_x) * 0.5F;
+  const float origin_y = (min_y + max_y) * 0.5F;
+  const bool half      = max_x - origin_x < HALF_RANGE && origin_x - min_x < HALF_RANGE &&
+                    max_y - origin_y < HALF_RANGE && origin_y - min_y < HALF_RANGE;
+  packed.format        = half ? VertexFormat::HALF : VertexFormat::COMPACT;
+  packed.origin_x      = half ? origin_x : 0.0F;
+  packed.origin_y      = half ? origin_y : 0.0F;
+
+  const auto vertices = quads.size() * std::tuple_size_v<Quad>;
+  const auto* in      = quads.data()->data();
+  packed.bytes.resize(vertices * vertexSize(packed.format));
+  if (half)
+  {
+    auto* out = reinterpret_cast<HalfVertex*>(packed.bytes.data());
+    for (std::size_t i = 0; i < vertices; ++i)
+    {
+      out[i] = halfVertex(in[i], origin_x, origin_y);
+    }
+    return;
+  }
+
+  auto* out = reinterpret_cast<CompactVertex*>(packed.bytes.data());
+  for (std::size_t i = 0; i < vertices; ++i)
+  {
+    out[i] = compactVertex(in[i]);
+  }
+}
+
+bool pyasge::packQuad(const Quad& quad, VertexFormat format, float origin_x, float origin_y, std::uint8_t* out)
+{
+  if (format == VertexFormat::FULL)
+  {
+    std::memcpy(out, quad.data(), sizeof(Quad));
+    return true;
+  }
+
+  for (const auto& vertex : quad)
+  {
+    const float x = vertex.x - origin_x;
+    const float y = vertex.y - origin_y;
+    if (!compactable(vertex) ||
+        (format == VertexFormat::HALF && !(std::fabs(x) < HALF_RANGE && std::fabs(y) < HALF_RANGE)))
+    {
+      return false;
+    }
+  }
+
+  for (const auto& vertex : quad)
+  {
+    if (format == VertexFormat::HALF)
+    {
+      const auto packed = halfVertex(vertex, origin_x, origin_y);
+      std::memcpy(out, &packed, sizeof(packed));
+      out += sizeof(packed);
+    }
+    else
+    {
+      const auto packed = compactVertex(vertex);
+      std::memcpy(out, &packed, sizeof(packed));
+      out += sizeof(packed);
+    }
+  }
+  return true;
+}
@@ -0,0 +1,131 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ASGE
+{
+  class Sprite;
+  struct Tile;
+}
+
+namespace pyasge
+{
+  /// \brief   A vertex of a textured, tinted quad drawn by the extensions.
+  struct QuadVertex
+  {
+    float x, y;       ///< world position
+    float u, v;       ///< texture coordinates
+    float r, g, b, a; ///< tint and opacity
+  };
+
+  /// \brief   The four corners of a quad: top left, top right, bottom right, bottom left.
+  using Quad = std::array<QuadVertex, 4>;
+
+  /// \brief   The layouts quads can be uploaded to the GPU in.
+  enum class VertexFormat
+  {
+    FULL,    ///< QuadVertex, 32 bytes
+    COMPACT, ///< CompactVertex, 16 bytes
+    HALF,    ///< HalfVertex, 12 bytes
+  };
+
+  /// \brief   A vertex with a full precision position and normalised texture coordinates and tint.
+  /// \details Texture coordinates are stored as unorm16 and the tint as
+  ///          RGBA8, so both must lie within [0, 1]. The vertex fetch turns
+  ///          them back into floats, so shaders see the same inputs.
+  struct CompactVertex
+  {
+    float x, y;                       ///< world position
+    std::array<std::uint16_t, 2> uvs; ///< texture coordinates, normalised by the vertex fetch
+    std::array<std::uint8_t, 4> rgba; ///< tint and opacity, normalised by the vertex fetch
+  };
+  static_assert(sizeof(CompactVertex) == 16, "compact vertices are uploaded as they are laid out");
+
+  /// \brief   A CompactVertex positioned by half floats, relative to an origin shared by its buffer.
+  struct HalfVertex
+  {
+    std::array<std::uint16_t, 2> position; ///< half float offset from the buffer's origin
+    std::array<std::uint16_t, 2> uvs;      ///< texture coordinates, normalised by the vertex fetch
+    std::array<std::uint8_t, 4> rgba;      ///< tint and opacity, normalised by the vertex fetch
+  };
+  static_assert(sizeof(HalfVertex) == 12, "half vertices are uploaded as they are laid out");
+
+  /// \brief   Quads packed into one of the vertex formats, ready to upload.
+  struct PackedQuads
+  {
+    VertexFormat format = VertexFormat::FULL;
+    float origin_x      = 0; ///< added to half float positions by the vertex shader
+    float origin_y      = 0;
+    std::vector<std::uint8_t> bytes; ///< empty when FULL, as the quads upload as they are
+  };
+
+  /// \brief   The distance from the origin half float positions are allowed to reach.
+  constexpr float HALF_RANGE = 256.0F;
+
+  /// \brief   The number of bytes a vertex takes in a format.
+  std::size_t vertexSize(VertexFormat format) noexcept;
+
+  /// \brief   Packs quads into the smallest format they fit.
+  /// \details Quads whose texture coordinates or tint stray outside [0, 1]
+  ///          are kept at full precision. Otherwise positions are stored as
+  ///          half floats if every corner lies within HALF_RANGE of the
+  ///          centre of their bounds, which keeps them within a sixteenth
+  ///          of a pixel, and as floats if not. Nothing is packed when
+  ///          compact is false.
+  void packQuads(const std::vector<Quad>& quads, bool compact, PackedQuads& packed);
+
+  /// \brief   Packs a single quad into an existing format and origin.
+  /// \returns False if the quad doesn't fit the format.
+  bool packQuad(const Quad& quad, VertexFormat format, float origin_x, float origin_y, std::uint8_t* out);
+
+  /// \brief   The six indices making up a quad's two triangles.
+  constexpr std::array<std::uint32_t, 6> QUAD_INDICES = { 0, 1, 2, 2, 3, 0 };
+
+  /// \brief   A quad described by its centre, axes, texture rectangle and tint.
+  /// \details The compact form read by the instanced sprite program. The
+  ///          axes run from the centre to the middle of the right and bottom
+  ///          edges, carrying the quad's scale and rotation, and the corners
+  ///          are found from them in the vertex shader. Flipping swaps the
+  ///          texture rectangle's edges, or the axes for a diagonal flip.
+  struct SpriteInstance
+  {
+    float x, y;                      ///< world position of the centre
+    std::array<float, 4> axes;       ///< half width axis, then half height axis
+    std::array<float, 4> uvs;        ///< texture coordinates of the top left and bottom right corners
+    std::array<std::uint8_t, 4> rgba; ///< tint and opacity, normalised by the vertex fetch
+  };
+  static_assert(sizeof(SpriteInstance) == 44, "instance records are uploaded as they are laid out");
+
+  /// \brief   Builds the quad the engine would draw for a sprite.
+  /// \details Uses the sprite's world bounds, so scaling and rotation match
+  ///          the engine exactly, and applies the source rectangle and flip
+  ///          flags to the texture coordinates.
+  /// \returns False if the sprite has no texture to sample.
+  bool spriteQuad(const ASGE::Sprite& sprite, Quad& quad);
+
+  /// \brief   Builds the instance record for the quad spriteQuad would build.
+  /// \returns False if the sprite has no texture to sample.
+  bool spriteInstance(const ASGE::Sprite& sprite, SpriteInstance& instance);
+
+  /// \brief   Builds the quad for a tile drawn with its top left corner at x, y.
+  /// \returns False if the tile has no texture to sample.
+  bool tileQuad(const ASGE::Tile& tile, float x, float y, Quad& quad);
+}
@@ -0,0 +1,187 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "extensions/RenderContext.hpp"
+
+#include <Engine/GameTime.hpp>
+#include <Engine/Input.hpp>
+#include <Engine/OpenGL/GLRenderer.hpp>
+#include <Engine/Resolution.hpp>
+#include <chrono>
+#include <unordered_map>
+
+namespace
+{
+  std::unordered_map<const ASGE::GLRenderer*, std::shared_ptr<pyasge::RenderContext>>& contexts()
+  {
+    static std::unordered_map<const ASGE::GLRenderer*, std::shared_ptr<pyasge::RenderContext>> map;
+    return map;
+  }
+
+  // the context currently between beginFrame and endFrame, if any
+  pyasge::RenderContext* active_context = nullptr;
+
+  void applyView(const ASGE::Resolution& resolution, pyasge::FrameData& frame_data)
+  {
+    frame_data.view = { resolution.view.min_x, resolution.view.max_x,
+                        resolution.view.min_y, resolution.view.max_y };
+
+    frame_data.viewport = {
+      static_cast<float>(resolution.viewport.x), static_cast<float>(resolution.viewport.y),
+      static_cast<float>(resolution.viewport.w), static_cast<float>(resolution.viewport.h) };
+  }
+}
+
+std::shared_ptr<pyasge::RenderContext> pyasge::RenderContext::get(ASGE::GLRenderer& renderer)
+{
+  auto& map = contexts();
+  auto iter = map.find(&renderer);
+  if (iter == map.end())
+  {
+    iter = map.emplace(&renderer, std::make_shared<RenderContext>(renderer)).first;
+  }
+  return iter->second;
+}
+
+void pyasge::RenderContext::release(const ASGE::GLRenderer* renderer)
+{
+  if (active_context != nullptr && active_context->gl_renderer == renderer)
+  {
+    active_context = nullptr;
+  }
+
+  contexts().erase(renderer);
+}
+
+pyasge::RenderContext* pyasge::RenderContext::active() noexcept
+{
+  return active_context;
+}
+
+pyasge::RenderContext::RenderContext(ASGE::GLRenderer& renderer) : gl_renderer(&renderer) {}
+
+void pyasge::RenderContext::beginFrame(const ASGE::GameTime& game_time, const ASGE::Input* input)
+{
+  // python may call render explicitly from inside its own render function
+  if (frame_depth++ > 0)
+  {
+    return;
+  }
+
+  active_context = this;
+  state_cache.invalidate();
+  render_queue.beginFrame();
+  current_stats       = FrameStats{};
+  current_stats.frame = frame_count;
+
+  const auto& resolution = gl_renderer->getResolutionInfo();
+  FrameData frame_data;
+  frame_data.time = {
+    std::chrono::duration<float>(game_time.elapsed).count(),
+    static_cast<float>(game_time.deltaInSecs()),
+    static_cast<float>(game_time.fixedTsInSecs()),
+    static_cast<float>(frame_count) };
+
+  frame_data.resolution = {
+    static_cast<float>(resolution.window[0]), static_cast<float>(resolution.window[1]),
+    static_cast<float>(resolution.base[0]),   static_cast<float>(resolution.base[1]) };
+
+  applyView(resolution, frame_data);
+
+  if (input != nullptr)
+  {
+    double cursor_x = 0;
+    double cursor_y = 0;
+    input->getCursorPos(cursor_x, cursor_y);
+    frame_data.mouse = {
+      static_cast<float>(cursor_x), static_cast<float>(cursor_y),
+      frame_data.resolution[0] > 0 ? static_cast<float>(cursor_x) / frame_data.resolution[0] : 0.0F,
+      frame_data.resolution[1] > 0 ? static_cast<float>(cursor_y) / frame_data.resolution[1] : 0.0F };
+  }
+
+  uniform_blocks.update(frame_data);
+}
+
+void pyasge::RenderContext::refreshView()
+{
+  auto frame_data = uniform_blocks.frameData();
+  applyView(gl_renderer->getResolutionInfo(), frame_data);
+  const auto& applied = uniform_blocks.frameData();
+  if (frame_data.view != applied.view || frame_data.viewport != applied.viewport)
+  {
+    uniform_blocks.updateFrameData(frame_data);
+  }
+}
+
+void pyasge::RenderContext::endFrame()
+{
+  if (--frame_depth > 0)
+  {
+    return;
+  }
+
+  flushQueue();
+  if (stream_buffer)
+  {
+    stream_buffer->endFrame();
+  }
+  target_pool.trim(frame_count);
+  frame_depth    = 0;
+  active_context = nullptr;
+  previous_stats = current_stats;
+  ++frame_count;
+}
+
+void pyasge::RenderContext::setDeferred(bool enable)
+{
+  if (!enable)
+  {
+    flushQueue();
+  }
+  deferred_rendering = enable;
+}
+
+std::size_t pyasge::RenderContext::flushQueue()
+{
+  return render_queue.flush(*gl_renderer, current_stats, spriteInstancer());
+}
+
+pyasge::SpriteProgram* pyasge::RenderContext::spriteProgram()
+{
+  // created on first use, as it needs the shader cache and a current context
+  if (!sprite_program)
+  {
+    sprite_program = std::make_unique<SpriteProgram>(shader_cache, uniform_blocks);
+  }
+  return sprite_program->valid() ? sprite_program.get() : nullptr;
+}
+
+pyasge::SpriteInstancer* pyasge::RenderContext::spriteInstancer()
+{
+  if (!sprite_instancer)
+  {
+    sprite_instancer = std::make_unique<SpriteInstancer>(get(*gl_renderer));
+  }
+  return sprite_instancer.get();
+}
+
+pyasge::StreamBuffer& pyasge::RenderContext::streamBuffer()
+{
+  // created on first use, as it needs a current context to query the GL version
+  if (!stream_buffer)
+  {
+    stream_buffer = std::make_unique<StreamBuffer>(current_stats);
+  }
+  return *stream_buffer;
+}
@@ -0,0 +1,111 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include "extensions/FrameStats.hpp"
+#include "extensions/GLStateCache.hpp"
+#include "extensions/RenderQueue.hpp"
+#include "extensions/RenderTargetPool.hpp"
+#include "extensions/ShaderCache.hpp"
+#include "extensions/SpriteInstancer.hpp"
+#include "extensions/SpriteProgram.hpp"
+#include "extensions/StreamBuffer.hpp"
+#include "extensions/UniformBlocks.hpp"
+
+#include <cstdint>
+#include <memory>
+
+namespace ASGE
+{
+  class GLRenderer;
+  class Input;
+  struct GameTime;
+}
+
+namespace pyasge
+{
+  /// \brief   Per-renderer state layered on top of ASGE by the bindings.
+  /// \details ASGE's GLRenderer is bound as a final class, so anything the
+  ///          bindings need to keep alongside it lives here instead. A context
+  ///          is created on first use and released by the game before the
+  ///          window (and with it the GL context) is destroyed. Objects that
+  ///          own GL resources should hold a weak reference to the context,
+  ///          so they can tell whether it is still safe to free them.
+  class RenderContext
+  {
+   public:
+    static std::shared_ptr<RenderContext> get(ASGE::GLRenderer& renderer);
+    static void release(const ASGE::GLRenderer* renderer);
+
+    /// \brief   The context currently rendering a frame, or nullptr.
+    /// \details Used by bindings that have no renderer to hand, such as
+    ///          Sprite and Texture, to reach the frame's state cache.
+    static RenderContext* active() noexcept;
+
+    explicit RenderContext(ASGE::GLRenderer& renderer);
+    ~RenderContext() = default;
+    RenderContext(const RenderContext&) = delete;
+    RenderContext& operator=(const RenderContext&) = delete;
+
+    void beginFrame(const ASGE::GameTime& game_time, const ASGE::Input* input);
+    void endFrame();
+
+    /// \brief   Copies the renderer's current view and viewport into FrameData.
+    /// \details Called whenever either is changed, so shaders see the camera
+    ///          they are drawn with rather than the one set as the frame began.
+    void refreshView();
+
+    [[nodiscard]] ASGE::GLRenderer& renderer() noexcept { return *gl_renderer; }
+    [[nodiscard]] UniformBlocks& uniformBlocks() noexcept { return uniform_blocks; }
+    [[nodiscard]] ShaderCache& shaderCache() noexcept { return shader_cache; }
+    [[nodiscard]] GLStateCache& stateCache() noexcept { return state_cache; }
+    [[nodiscard]] RenderQueue& renderQueue() noexcept { return render_queue; }
+    [[nodiscard]] RenderTargetPool& targetPool() noexcept { return target_pool; }
+    [[nodiscard]] SpriteProgram* spriteProgram();
+    [[nodiscard]] SpriteInstancer* spriteInstancer();
+    [[nodiscard]] StreamBuffer& streamBuffer();
+    [[nodiscard]] bool deferred() const noexcept { return deferred_rendering; }
+    void setDeferred(bool enable);
+    [[nodiscard]] bool compactVertices() const noexcept { return compact_vertices; }
+    void setCompactVertices(bool enable) noexcept { compact_vertices = enable; }
+    std::size_t flushQueue();
+
+    /// \brief   Records a draw made by the engine outside of the queue.
+    /// \details The engine may still hold it in a batch, so queued sprites
+    ///          are no longer instanced for the rest of the frame, as they
+    ///          would be drawn ahead of it.
+    void engineDrew() noexcept { render_queue.engineDrew(); }
+    [[nodiscard]] FrameStats& stats() noexcept { return current_stats; }
+    [[nodiscard]] const FrameStats& lastFrameStats() const noexcept { return previous_stats; }
+    [[nodiscard]] std::uint64_t frameCount() const noexcept { return frame_count; }
+
+   private:
+    ASGE::GLRenderer* gl_renderer = nullptr;
+    UniformBlocks uniform_blocks;
+    ShaderCache shader_cache;
+    FrameStats current_stats;
+    FrameStats previous_stats;
+    GLStateCache state_cache{ current_stats };
+    RenderQueue render_queue;
+    RenderTargetPool target_pool;
+    std::unique_ptr<SpriteProgram> sprite_program;
+    std::unique_ptr<SpriteInstancer> sprite_instancer;
+    std::unique_ptr<StreamBuffer> stream_buffer;
+    bool deferred_rendering = false;
+    bool compact_vertices   = true;
+    std::uint64_t frame_count = 0;
+    int frame_depth = 0;
+  };
+}
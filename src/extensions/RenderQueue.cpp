@@ -0,0 +1,362 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/RenderQueue.hpp"
+#include "extensions/SpriteInstancer.hpp"
+
+#include <Engine/OpenGL/GLRenderer.hpp>
+#include <Engine/OpenGL/GLSprite.hpp>
+#include <Engine/OpenGL/GLTexture.hpp>
+#include <Engine/Point2D.hpp>
+#include <Engine/Text.hpp>
+#include <Tile.hpp>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <utility>
+
+namespace
+{
+  constexpr std::uint64_t STATE_MASK = 0xFFFFFFFFULL;
+  constexpr int RADIX_BITS           = 8;
+  constexpr int RADIX_PASSES         = 64 / RADIX_BITS;
+  constexpr std::size_t RADIX_SIZE   = 1U << RADIX_BITS;
+
+  // repairing is abandoned once more than 1/REPAIR_LIMIT of the draws moved
+  constexpr std::size_t REPAIR_LIMIT = 8;
+
+  // shaders and textures not queued for this many frames give up their numbers
+  constexpr std::uint64_t STALE_FRAMES = 120;
+
+  template <typename Entry>
+  bool before(const Entry& lhs, const Entry& rhs) noexcept
+  {
+    return lhs.key < rhs.key || (lhs.key == rhs.key && lhs.index < rhs.index);
+  }
+}
+
+void pyasge::RenderQueue::push(const ASGE::GLSprite& sprite, pybind11::object anchor)
+{
+  const void* shader = sprite.hasPixelShader() ? sprite.getPixelShader() : nullptr;
+  push(
+    { Kind::SPRITE, &sprite, {}, {}, sprite.getGlobalZOrder() }, shader, sprite.getTexture(),
+    std::move(anchor));
+}
+
+void pyasge::RenderQueue::push(const ASGE::Text& text, pybind11::object anchor)
+{
+  push({ Kind::TEXT, &text, {}, {}, text.getZOrder() }, nullptr, &text.getFont(), std::move(anchor));
+}
+
+void pyasge::RenderQueue::push(const ASGE::Tile& tile, float x, float y, pybind11::object anchor)
+{
+  push({ Kind::TILE, &tile, {}, { x, y, 0, 0 }, tile.z }, nullptr, tile.texture, std::move(anchor));
+}
+
+void pyasge::RenderQueue::push(
+  ASGE::GLTexture& texture, const std::array<float, 4>& src, const std::array<float, 4>& dst,
+  std::int16_t z, pybind11::object anchor)
+{
+  push({ Kind::TEXTURE, &texture, src, dst, z }, nullptr, &texture, std::move(anchor));
+}
+
+void pyasge::RenderQueue::push(
+  const Command& command, const void* shader, const void* texture, pybind11::object anchor)
+{
+  entries.push_back({ key(command.z, shader, texture), static_cast<std::uint32_t>(commands.size()) });
+  commands.push_back(command);
+  anchors.push_back(std::move(anchor));
+}
+
+std::uint64_t pyasge::RenderQueue::key(std::int16_t z, const void* shader, const void* texture)
+{
+  // bias the z-order so that negative values sort before positive ones
+  const auto layer = static_cast<std::uint64_t>(static_cast<std::int32_t>(z) + 32768);
+  return (layer << 32U) | (static_cast<std::uint64_t>(slot(shader_slots, shader)) << 16U) |
+         slot(texture_slots, texture);
+}
+
+std::uint16_t pyasge::RenderQueue::slot(StateSlots& states, const void* state)
+{
+  // slot zero is reserved for "no state", i.e. the renderer's active shader
+  if (state == nullptr)
+  {
+    return 0;
+  }
+
+  auto [iter, inserted] = states.slots.try_emplace(state, StateSlot{ 0, frame });
+  auto& slot            = iter->second;
+  slot.used             = frame;
+  if (inserted)
+  {
+    // past the last number every new state shares it, which only costs batching
+    constexpr auto LAST = std::numeric_limits<std::uint16_t>::max();
+    if (!states.unused.empty())
+    {
+      slot.id = states.unused.back();
+      states.unused.pop_back();
+    }
+    else
+    {
+      slot.id = states.next != LAST ? states.next++ : LAST;
+    }
+  }
+  return slot.id;
+}
+
+void pyasge::RenderQueue::trim(StateSlots& states)
+{
+  for (auto iter = states.slots.begin(); iter != states.slots.end();)
+  {
+    if (frame - iter->second.used <= STALE_FRAMES)
+    {
+      ++iter;
+      continue;
+    }
+
+    if (iter->second.id != std::numeric_limits<std::uint16_t>::max())
+    {
+      states.unused.push_back(iter->second.id);
+    }
+    iter = states.slots.erase(iter);
+  }
+}
+
+void pyasge::RenderQueue::sort()
+{
+  // one pass over the keys builds the histogram for every digit
+  std::array<std::array<std::size_t, RADIX_SIZE>, RADIX_PASSES> counts{};
+  for (const auto& entry : entries)
+  {
+    for (int pass = 0; pass < RADIX_PASSES; ++pass)
+    {
+      ++counts[pass][(entry.key >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1)];
+    }
+  }
+
+  scratch.resize(entries.size());
+  for (int pass = 0; pass < RADIX_PASSES; ++pass)
+  {
+    auto& count = counts[pass];
+    const auto shift = pass * RADIX_BITS;
+
+    // a digit shared by every key would leave the order unchanged
+    if (count[(entries.front().key >> shift) & (RADIX_SIZE - 1)] == entries.size())
+    {
+      continue;
+    }
+
+    std::size_t offset = 0;
+    for (auto& bucket : count)
+    {
+      offset += std::exchange(bucket, offset);
+    }
+
+    for (const auto& entry : entries)
+    {
+      scratch[count[(entry.key >> shift) & (RADIX_SIZE - 1)]++] = entry;
+    }
+    entries.swap(scratch);
+  }
+}
+
+bool pyasge::RenderQueue::repair(const std::vector<std::uint32_t>& order)
+{
+  // replay last frame's order, lifting out any draw that breaks it. When a
+  // draw is smaller than the last one kept, both are lifted out, so a single
+  // draw that moved far forward cannot displace everything that follows it
+  scratch.clear();
+  displaced.clear();
+  const auto limit = entries.size() / REPAIR_LIMIT;
+  for (auto index : order)
+  {
+    const auto& entry = entries[index];
+    if (!scratch.empty() && before(entry, scratch.back()))
+    {
+      displaced.push_back(scratch.back());
+      displaced.push_back(entry);
+      scratch.pop_back();
+
+      if (displaced.size() > limit)
+      {
+        return false;
+      }
+      continue;
+    }
+    scratch.push_back(entry);
+  }
+
+  std::sort(displaced.begin(), displaced.end(), before<SortEntry>);
+  std::merge(
+    scratch.begin(), scratch.end(), displaced.begin(), displaced.end(), entries.begin(),
+    before<SortEntry>);
+  return true;
+}
+
+void pyasge::RenderQueue::beginFrame()
+{
+  flushes       = 0;
+  engine_called = false;
+  if (++frame % STALE_FRAMES == 0)
+  {
+    trim(shader_slots);
+    trim(texture_slots);
+  }
+}
+
+std::vector<std::uint32_t>
+pyasge::RenderQueue::order(const std::vector<std::uint64_t>& keys, const std::vector<std::uint32_t>& previous)
+{
+  RenderQueue queue;
+  queue.entries.reserve(keys.size());
+  for (const auto key : keys)
+  {
+    queue.entries.push_back({ key, static_cast<std::uint32_t>(queue.entries.size()) });
+  }
+
+  if (!queue.entries.empty() && (previous.size() != keys.size() || !queue.repair(previous)))
+  {
+    queue.sort();
+  }
+
+  std::vector<std::uint32_t> sorted(queue.entries.size());
+  std::transform(
+    queue.entries.begin(), queue.entries.end(), sorted.begin(), [](const auto& entry) { return entry.index; });
+  return sorted;
+}
+
+void pyasge::RenderQueue::setIncremental(bool enable)
+{
+  incremental_sort = enable;
+  orders.clear();
+}
+
+std::size_t pyasge::RenderQueue::instance(std::size_t position, SpriteInstancer& instancer)
+{
+  // the run ends at the next change of state or at anything that isn't a sprite
+  const auto state = entries[position].key & STATE_MASK;
+  auto end         = position;
+  while (end < entries.size() && (entries[end].key & STATE_MASK) == state &&
+         commands[entries[end].index].kind == Kind::SPRITE)
+  {
+    ++end;
+  }
+
+  if (end - position < instancing_threshold)
+  {
+    return 0;
+  }
+
+  run.clear();
+  for (auto i = position; i < end; ++i)
+  {
+    run.push_back(static_cast<const ASGE::GLSprite*>(commands[entries[i].index].item));
+  }
+  // should nothing be drawn, the run falls through to the renderer as normal
+  return instancer.draw(run.data(), run.size()) != 0 ? run.size() : 0;
+}
+
+std::size_t pyasge::RenderQueue::flush(ASGE::GLRenderer& renderer, FrameStats& stats, SpriteInstancer* instancer)
+{
+  if (commands.empty())
+  {
+    return 0;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  if (incremental_sort)
+  {
+    if (orders.size() <= flushes)
+    {
+      orders.resize(flushes + 1);
+    }
+
+    // the previous order only applies if the same number of draws were made
+    auto& order = orders[flushes++];
+    if (order.size() == entries.size() && repair(order))
+    {
+      stats.queue_repaired += displaced.size();
+    }
+    else
+    {
+      sort();
+    }
+
+    order.resize(entries.size());
+    std::transform(
+      entries.begin(), entries.end(), order.begin(), [](const auto& entry) { return entry.index; });
+  }
+  else
+  {
+    sort();
+  }
+  stats.queue_sort_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::uint64_t state = ~0ULL;
+  for (std::size_t position = 0; position < entries.size(); ++position)
+  {
+    const auto& entry = entries[position];
+    if ((entry.key & STATE_MASK) != state)
+    {
+      state = entry.key & STATE_MASK;
+      ++stats.queue_batches;
+
+      // only textured sprites using the renderer's own shader, shader slot zero, can be instanced
+      const bool plain = ((state >> 16U) & 0xFFFFU) == 0 && (state & 0xFFFFU) != 0;
+      if (instancer != nullptr && instancing_threshold != 0 && !engine_called && plain)
+      {
+        if (const auto instanced = instance(position, *instancer); instanced != 0)
+        {
+          position += instanced - 1;
+          continue;
+        }
+      }
+    }
+
+    engine_called       = true;
+    const auto& command = commands[entry.index];
+    switch (command.kind)
+    {
+      case Kind::SPRITE:
+        renderer.render(*static_cast<const ASGE::GLSprite*>(command.item));
+        break;
+      case Kind::TEXT:
+        renderer.render(*static_cast<const ASGE::Text*>(command.item));
+        break;
+      case Kind::TILE:
+        renderer.render(
+          *static_cast<const ASGE::Tile*>(command.item), ASGE::Point2D{ command.dst[0], command.dst[1] });
+        break;
+      case Kind::TEXTURE:
+        renderer.render(
+          *const_cast<ASGE::GLTexture*>(static_cast<const ASGE::GLTexture*>(command.item)), command.src,
+          ASGE::Point2D{ command.dst[0], command.dst[1] }, static_cast<int>(command.dst[2]),
+          static_cast<int>(command.dst[3]), command.z);
+        break;
+    }
+  }
+
+  const auto submitted = commands.size();
+  stats.queued += submitted;
+  clear();
+  return submitted;
+}
+
+void pyasge::RenderQueue::clear()
+{
+  commands.clear();
+  anchors.clear();
+  entries.clear();
+}
@@ -0,0 +1,167 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include "extensions/FrameStats.hpp"
+
+#include <array>
+#include <cstdint>
+#include <pybind11/pybind11.h>
+#include <unordered_map>
+#include <vector>
+
+namespace ASGE
+{
+  class GLRenderer;
+  class GLSprite;
+  class GLTexture;
+  class Sprite;
+  class Text;
+  struct Tile;
+}
+
+namespace pyasge
+{
+  class SpriteInstancer;
+
+  /// \brief   Collects a frame's draws so they can be submitted in state order.
+  /// \details The engine starts a new batch whenever two consecutive draws use
+  ///          a different texture or shader, so the number of draw calls made
+  ///          depends on the order python submits them in. The queue instead
+  ///          records each draw with a packed 64-bit key (z-order, shader,
+  ///          texture), sorts the keys with an LSD radix sort and submits the
+  ///          draws in key order. Within a z-order the draw order is therefore
+  ///          decided by state rather than by python, and the engine sees one
+  ///          run of draws per unique state. The sort is stable, so draws that
+  ///          share a key keep their submission order.
+  ///
+  ///          Shaders and textures are numbered the first time they are
+  ///          queued and keep their number for as long as they are drawn, so
+  ///          the same states sort the same way every frame, whichever of
+  ///          them python happened to submit first. Numbers unused for
+  ///          STALE_FRAMES frames are handed out again.
+  ///
+  ///          Most scenes submit largely the same draws in the same order
+  ///          every frame. In incremental mode the queue remembers the order
+  ///          each flush produced and starts the next frame's sort from it.
+  ///          Draws that are out of order are lifted out, sorted on their own
+  ///          and merged back in, which is close to linear when only a few
+  ///          draws changed. Heavily reordered frames fall back to the radix
+  ///          sort, so the result is the same in either mode.
+  ///
+  ///          Draws are only recorded, so a sprite is drawn as it is when the
+  ///          queue is flushed. Anything that changes how later draws are
+  ///          interpreted, such as a new render target or projection, must
+  ///          flush the queue first.
+  ///
+  ///          A run of at least instancingThreshold() sprites sharing a
+  ///          texture, without a pixel shader, is drawn with instancing
+  ///          rather than sprite by sprite. Native draws can't be ordered
+  ///          against draws the engine is still holding, so this only
+  ///          happens until the first draw of the frame goes to the engine.
+  class RenderQueue
+  {
+   public:
+    void push(const ASGE::GLSprite& sprite, pybind11::object anchor);
+    void push(const ASGE::Text& text, pybind11::object anchor);
+    void push(const ASGE::Tile& tile, float x, float y, pybind11::object anchor);
+    void push(
+      ASGE::GLTexture& texture, const std::array<float, 4>& src, const std::array<float, 4>& dst,
+      std::int16_t z, pybind11::object anchor);
+
+    std::size_t flush(ASGE::GLRenderer& renderer, FrameStats& stats, SpriteInstancer* instancer = nullptr);
+    void clear();
+    void beginFrame();
+    void engineDrew() noexcept { engine_called = true; }
+
+    [[nodiscard]] std::size_t instancingThreshold() const noexcept { return instancing_threshold; }
+    void setInstancingThreshold(std::size_t sprites) noexcept { instancing_threshold = sprites; }
+
+    [[nodiscard]] bool incremental() const noexcept { return incremental_sort; }
+    void setIncremental(bool enable);
+
+    [[nodiscard]] bool empty() const noexcept { return commands.empty(); }
+    [[nodiscard]] std::size_t size() const noexcept { return commands.size(); }
+
+    /// \brief   Orders a list of packed keys as a flush would submit them.
+    /// \details Given the order of a previous flush with as many keys, that
+    ///          order is repaired as in incremental mode, otherwise the keys
+    ///          are radix sorted. The previous order must hold every index
+    ///          exactly once. Lets the ordering be checked without GL.
+    static std::vector<std::uint32_t>
+    order(const std::vector<std::uint64_t>& keys, const std::vector<std::uint32_t>& previous);
+
+   private:
+    enum class Kind : std::uint8_t
+    {
+      SPRITE,
+      TEXT,
+      TILE,
+      TEXTURE
+    };
+
+    struct Command
+    {
+      Kind kind;
+      const void* item;
+      std::array<float, 4> src;
+      std::array<float, 4> dst;
+      std::int16_t z;
+    };
+
+    struct SortEntry
+    {
+      std::uint64_t key;
+      std::uint32_t index;
+    };
+
+    struct StateSlot
+    {
+      std::uint16_t id;
+      std::uint64_t used; ///< the frame the state was last queued in
+    };
+
+    /// Numbers given to shaders or textures, starting from one as zero means no state.
+    struct StateSlots
+    {
+      std::unordered_map<const void*, StateSlot> slots;
+      std::vector<std::uint16_t> unused;
+      std::uint16_t next = 1;
+    };
+
+    void push(const Command& command, const void* shader, const void* texture, pybind11::object anchor);
+    std::uint64_t key(std::int16_t z, const void* shader, const void* texture);
+    std::uint16_t slot(StateSlots& states, const void* state);
+    void trim(StateSlots& states);
+    void sort();
+    bool repair(const std::vector<std::uint32_t>& order);
+    std::size_t instance(std::size_t position, SpriteInstancer& instancer);
+
+    std::vector<Command> commands;
+    std::vector<pybind11::object> anchors;
+    std::vector<SortEntry> entries;
+    std::vector<SortEntry> scratch;
+    std::vector<SortEntry> displaced;
+    std::vector<std::vector<std::uint32_t>> orders;
+    std::vector<const ASGE::Sprite*> run;
+    std::size_t flushes              = 0;
+    std::size_t instancing_threshold = 1024;
+    bool incremental_sort            = true;
+    bool engine_called               = false; ///< whether a draw has gone to the engine this frame
+    std::uint64_t frame              = 0;
+    StateSlots shader_slots;
+    StateSlots texture_slots;
+  };
+}
@@ -0,0 +1,143 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/RenderTargetPool.hpp"
+#include "extensions/TargetTracker.hpp"
+
+#include <Engine/OpenGL/GLRenderer.hpp>
+#include <algorithm>
+
+pyasge::RenderTargetPool::~RenderTargetPool()
+{
+  // targets python still refers to are left to the driver along with the
+  // context, so their wrappers never point at freed memory
+  for (auto& entry : entries)
+  {
+    TargetTracker::instance().forget(entry.target.get());
+    if (pinned(entry))
+    {
+      static_cast<void>(entry.target.release());
+    }
+  }
+}
+
+ASGE::GLRenderTarget* pyasge::RenderTargetPool::acquire(
+  ASGE::GLRenderer& renderer, int width, int height, ASGE::Texture2D::Format format, std::uint64_t frame)
+{
+  for (auto& entry : entries)
+  {
+    if (!entry.in_use && entry.width == width && entry.height == height && entry.format == format)
+    {
+      entry.in_use    = true;
+      entry.last_used = frame;
+      ++stats.hits;
+      ++stats.in_use;
+      return entry.target.get();
+    }
+  }
+
+  auto target = std::make_unique<ASGE::GLRenderTarget>(
+    &renderer, static_cast<float>(width), static_cast<float>(height), format, 1);
+  auto& entry = entries.emplace_back(Entry{ std::move(target), width, height, format, frame, true });
+
+  ++stats.misses;
+  ++stats.in_use;
+  ++stats.targets;
+  stats.bytes += bytes(entry);
+  return entry.target.get();
+}
+
+bool pyasge::RenderTargetPool::release(const ASGE::GLRenderTarget* target, std::uint64_t frame)
+{
+  auto iter = std::find_if(
+    entries.begin(), entries.end(), [target](const Entry& entry) { return entry.target.get() == target; });
+
+  if (iter == entries.end() || !iter->in_use)
+  {
+    return false;
+  }
+
+  // unused frames are counted from when the target was last drawn with, not acquired
+  iter->in_use    = false;
+  iter->last_used = frame;
+  --stats.in_use;
+  return true;
+}
+
+std::size_t pyasge::RenderTargetPool::trim(std::uint64_t frame)
+{
+  return erase(frame, false);
+}
+
+std::size_t pyasge::RenderTargetPool::clear()
+{
+  return erase(0, true);
+}
+
+bool pyasge::RenderTargetPool::owns(const ASGE::GLRenderTarget* target) const noexcept
+{
+  return std::any_of(
+    entries.begin(), entries.end(), [target](const Entry& entry) { return entry.target.get() == target; });
+}
+
+std::size_t pyasge::RenderTargetPool::bytes(const Entry& entry) noexcept
+{
+  // drivers store three channel textures padded out to four bytes
+  std::size_t pixel = 4;
+  switch (entry.format)
+  {
+    case ASGE::Texture2D::Format::MONOCHROME:
+      pixel = 1;
+      break;
+    case ASGE::Texture2D::Format::MONOCHROME_ALPHA:
+      pixel = 2;
+      break;
+    case ASGE::Texture2D::Format::RGB:
+    case ASGE::Texture2D::Format::RGBA:
+      pixel = 4;
+      break;
+  }
+
+  // a multisampled colour attachment plus the texture it resolves into. The
+  // driver decides the sample count, so the attachment is counted only once
+  return 2 * static_cast<std::size_t>(entry.width) * static_cast<std::size_t>(entry.height) * pixel;
+}
+
+bool pyasge::RenderTargetPool::pinned(const Entry& entry) const
+{
+  return entry.target != nullptr && referenced != nullptr && referenced(entry.target.get());
+}
+
+std::size_t pyasge::RenderTargetPool::erase(std::uint64_t frame, bool all)
+{
+  const auto expired = [&](const Entry& entry)
+  { return !entry.in_use && (all || frame - entry.last_used > trim_frames) && !pinned(entry); };
+
+  std::size_t removed = 0;
+  for (const auto& entry : entries)
+  {
+    if (expired(entry))
+    {
+      TargetTracker::instance().forget(entry.target.get());
+      stats.bytes -= bytes(entry);
+      ++removed;
+    }
+  }
+
+  entries.erase(std::remove_if(entries.begin(), entries.end(), expired), entries.end());
+  stats.targets -= removed;
+  stats.trimmed += removed;
+  return removed;
+}
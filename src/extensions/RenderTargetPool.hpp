@@ -0,0 +1,99 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <Engine/OpenGL/GLRenderTarget.hpp>
+#include <Engine/Texture.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ASGE
+{
+  class GLRenderer;
+}
+
+namespace pyasge
+{
+  /// \brief   Reuses render targets between passes and across frames.
+  /// \details Creating a render target allocates a framebuffer along with its
+  ///          multisampled and resolved textures, so effects that create and
+  ///          drop intermediate targets every frame cause allocation spikes.
+  ///          The pool hands out a released target whose size and format
+  ///          match the request and only creates one when none is free. A
+  ///          released target that has not been reused for a number of frames
+  ///          is destroyed, which lets the pool shrink again after a change of
+  ///          resolution.
+  ///
+  ///          Targets handed to python may be held on to after being
+  ///          released. The bindings install a check for a live python
+  ///          reference, and the pool keeps any target that has one rather
+  ///          than destroying it underneath its wrapper.
+  class RenderTargetPool
+  {
+   public:
+    struct Statistics
+    {
+      std::size_t hits      = 0; ///< requests served by a pooled target
+      std::size_t misses    = 0; ///< requests that created a new target
+      std::size_t trimmed   = 0; ///< targets destroyed after going unused
+      std::size_t targets   = 0; ///< targets currently owned by the pool
+      std::size_t in_use    = 0; ///< targets currently acquired
+      std::size_t bytes     = 0; ///< estimated memory held by the pool's targets
+    };
+
+    /// \brief   Tells whether anything outside the pool still refers to a target.
+    using Referenced = bool (*)(const ASGE::GLRenderTarget* target);
+
+    RenderTargetPool() = default;
+    ~RenderTargetPool();
+    RenderTargetPool(const RenderTargetPool&) = delete;
+    RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+    ASGE::GLRenderTarget* acquire(
+      ASGE::GLRenderer& renderer, int width, int height, ASGE::Texture2D::Format format,
+      std::uint64_t frame);
+    bool release(const ASGE::GLRenderTarget* target, std::uint64_t frame);
+    std::size_t trim(std::uint64_t frame);
+    std::size_t clear();
+
+    [[nodiscard]] bool owns(const ASGE::GLRenderTarget* target) const noexcept;
+    [[nodiscard]] const Statistics& statistics() const noexcept { return stats; }
+    [[nodiscard]] std::uint64_t trimFrames() const noexcept { return trim_frames; }
+    void setTrimFrames(std::uint64_t frames) noexcept { trim_frames = frames; }
+    void setReferenced(Referenced check) noexcept { referenced = check; }
+
+   private:
+    struct Entry
+    {
+      std::unique_ptr<ASGE::GLRenderTarget> target;
+      int width;
+      int height;
+      ASGE::Texture2D::Format format;
+      std::uint64_t last_used;
+      bool in_use;
+    };
+
+    static std::size_t bytes(const Entry& entry) noexcept;
+    [[nodiscard]] bool pinned(const Entry& entry) const;
+    std::size_t erase(std::uint64_t frame, bool all);
+
+    std::vector<Entry> entries;
+    std::uint64_t trim_frames = 60;
+    Referenced referenced     = nullptr;
+    Statistics stats;
+  };
+}
@@ -0,0 +1,448 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "extensions/ShaderCache.hpp"
+
+#include <Engine/Logger.hpp>
+#include <Engine/OpenGL/GLShader.hpp>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+  constexpr std::array<char, 4> MAGIC{ 'P', 'Y', 'S', 'C' };
+  constexpr std::uint32_t FILE_VERSION = 2;
+
+#define PYASGE_STRINGIFY(x) #x
+#define PYASGE_MACRO_STRINGIFY(x) PYASGE_STRINGIFY(x)
+
+  // pixel shaders are linked against the engine's vertex stage, so their
+  // binaries are only trusted by the engine they were built with. Without
+  // knowing which that is, they are compiled every run instead
+#if defined(PYASGE_ENGINE_REVISION)
+  constexpr const char* ENGINE_VERSION = PYASGE_MACRO_STRINGIFY(PYASGE_ENGINE_REVISION);
+#elif defined(VERSION_INFO)
+  constexpr const char* ENGINE_VERSION = PYASGE_MACRO_STRINGIFY(VERSION_INFO);
+#else
+  constexpr const char* ENGINE_VERSION = nullptr;
+#endif
+
+  /// Followed by the binary, then a (block index, binding) pair for each of
+  /// the program's uniform blocks, as glProgramBinary resets their bindings.
+  struct BinaryHeader
+  {
+    std::array<char, 4> magic{};
+    std::uint32_t version  = 0;
+    std::uint32_t format   = 0;
+    std::uint32_t length   = 0;
+    std::uint64_t key      = 0;
+    std::uint32_t blocks   = 0;
+    std::uint32_t reserved = 0;
+  };
+
+  struct Settings
+  {
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "pyasge" / "shaders";
+    bool enabled = true;
+  };
+
+  Settings& settings()
+  {
+    static Settings instance;
+    return instance;
+  }
+
+  void exportDriverCache(const std::filesystem::path& path)
+  {
+    // drivers only read these when a context is created, so this only helps
+    // if the directory is set before the game is constructed
+    const auto driver_path = (path / "driver").string();
+    for (const auto* name : { "MESA_SHADER_CACHE_DIR", "__GL_SHADER_DISK_CACHE_PATH" })
+    {
+      if (std::getenv(name) != nullptr)
+      {
+        continue;
+      }
+#if defined(_WIN32)
+      _putenv_s(name, driver_path.c_str());
+#else
+      setenv(name, driver_path.c_str(), 0);
+#endif
+    }
+  }
+
+  GLuint compile(GLenum type, const std::string& source)
+  {
+    GLuint shader    = glCreateShader(type);
+    const char* text = source.c_str();
+    glShaderSource(shader, 1, &text, nullptr);
+    glCompileShader(shader);
+
+    GLint status = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status == GL_FALSE)
+    {
+      std::array<char, 1024> log{};
+      glGetShaderInfoLog(shader, static_cast<GLsizei>(log.size()), nullptr, log.data());
+      Logging::ERRORS(std::string("Shader compilation failed: ") + log.data());
+      glDeleteShader(shader);
+      return 0;
+    }
+    return shader;
+  }
+}
+
+pyasge::ShaderCache::~ShaderCache()
+{
+  for (auto& [key, program] : programs)
+  {
+    glDeleteProgram(program);
+  }
+}
+
+const std::filesystem::path& pyasge::ShaderCache::directory()
+{
+  return settings().directory;
+}
+
+void pyasge::ShaderCache::setDirectory(const std::filesystem::path& path)
+{
+  settings().directory = path;
+  exportDriverCache(path);
+}
+
+bool pyasge::ShaderCache::enabled()
+{
+  return settings().enabled;
+}
+
+void pyasge::ShaderCache::setEnabled(bool enable)
+{
+  settings().enabled = enable;
+}
+
+std::uint64_t pyasge::ShaderCache::hash(const std::string& source, std::uint64_t seed)
+{
+  // FNV-1a, stable across runs and platforms unlike std::hash
+  std::uint64_t value = seed;
+  for (auto character : source)
+  {
+    value ^= static_cast<unsigned char>(character);
+    value *= 1099511628211ULL;
+  }
+  return value;
+}
+
+ASGE::SHADER_LIB::GLShader*
+pyasge::ShaderCache::pixelShader(const std::string& source, const ShaderFactory& factory, bool shared)
+{
+  // the hash only narrows the search, as two sources may share one
+  const auto key = hash(source);
+  if (shared)
+  {
+    auto [first, last] = shared_shaders.equal_range(key);
+    for (auto iter = first; iter != last; ++iter)
+    {
+      const auto* compiled = this->source(iter->second->getShaderID());
+      if (compiled != nullptr && *compiled == source)
+      {
+        ++stats.source_hits;
+        return iter->second;
+      }
+    }
+  }
+
+  ASGE::SHADER_LIB::GLShader* shader = nullptr;
+  if (ENGINE_VERSION == nullptr)
+  {
+    shader = factory(source);
+  }
+  else
+  {
+    const auto binary_key = hash(source, hash(ENGINE_VERSION, driverHash()));
+    if (auto program = loadBinary(binary_key); program != 0)
+    {
+      ++stats.binary_hits;
+      shader = restored.emplace_back(std::make_unique<ASGE::SHADER_LIB::GLShader>(program)).get();
+    }
+    else if ((shader = factory(source)) != nullptr)
+    {
+      ++stats.binary_misses;
+      saveBinary(binary_key, shader->getShaderID());
+    }
+  }
+
+  if (shader == nullptr)
+  {
+    return nullptr;
+  }
+
+  sources[shader->getShaderID()] = source;
+  if (shared)
+  {
+    shared_shaders.emplace(key, shader);
+  }
+  return shader;
+}
+
+GLuint pyasge::ShaderCache::link(const std::string& vertex_source, const std::string& fragment_source)
+{
+  const auto key = hash(fragment_source, hash(vertex_source, driverHash()));
+  if (auto iter = programs.find(key); iter != programs.end())
+  {
+    return iter->second;
+  }
+
+  if (auto program = loadBinary(key); program != 0)
+  {
+    ++stats.binary_hits;
+    programs.emplace(key, program);
+    sources.emplace(program, fragment_source);
+    return program;
+  }
+
+  ++stats.binary_misses;
+  GLuint vertex   = compile(GL_VERTEX_SHADER, vertex_source);
+  GLuint fragment = compile(GL_FRAGMENT_SHADER, fragment_source);
+  if (vertex == 0 || fragment == 0)
+  {
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+    return 0;
+  }
+
+  GLuint program = glCreateProgram();
+  if (programBinaries())
+  {
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+  }
+  glAttachShader(program, vertex);
+  glAttachShader(program, fragment);
+  glLinkProgram(program);
+  glDetachShader(program, vertex);
+  glDetachShader(program, fragment);
+  glDeleteShader(vertex);
+  glDeleteShader(fragment);
+
+  GLint status = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &status);
+  if (status == GL_FALSE)
+  {
+    std::array<char, 1024> log{};
+    glGetProgramInfoLog(program, static_cast<GLsizei>(log.size()), nullptr, log.data());
+    Logging::ERRORS(std::string("Shader program failed to link: ") + log.data());
+    glDeleteProgram(program);
+    return 0;
+  }
+
+  saveBinary(key, program);
+  programs.emplace(key, program);
+  sources.emplace(program, fragment_source);
+  return program;
+}
+
+const std::string* pyasge::ShaderCache::source(GLuint program) const
+{
+  auto iter = sources.find(program);
+  return iter != sources.end() ? &iter->second : nullptr;
+}
+
+std::size_t pyasge::ShaderCache::clear()
+{
+  std::size_t removed = 0;
+  std::error_code error;
+  for (const auto& entry : std::filesystem::directory_iterator(directory(), error))
+  {
+    if (entry.path().extension() == ".bin" && std::filesystem::remove(entry.path(), error))
+    {
+      ++removed;
+    }
+  }
+  return removed;
+}
+
+std::uint64_t pyasge::ShaderCache::driverHash()
+{
+  if (driver_hash == 0)
+  {
+    std::stringstream driver;
+    for (auto name : { GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION })
+    {
+      const auto* value = glGetString(name);
+      driver << (value != nullptr ? reinterpret_cast<const char*>(value) : "") << '|';
+    }
+    driver_hash = hash(driver.str());
+  }
+  return driver_hash;
+}
+
+bool pyasge::ShaderCache::programBinaries()
+{
+  if (!binary_support)
+  {
+    // core from 4.1, the renderer's 3.3 context only has them through the extension
+    GLint major = 0;
+    GLint minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    bool supported = major > 4 || (major == 4 && minor >= 1);
+
+    GLint extensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+    for (GLint i = 0; !supported && i < extensions; ++i)
+    {
+      const auto* name = glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i));
+      supported = name != nullptr && std::strcmp(reinterpret_cast<const char*>(name), "GL_ARB_get_program_binary") == 0;
+    }
+
+    GLint formats = 0;
+    if (supported)
+    {
+      glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    }
+    binary_support = formats > 0;
+  }
+  return *binary_support;
+}
+
+std::filesystem::path pyasge::ShaderCache::binaryPath(std::uint64_t key) const
+{
+  std::stringstream name;
+  name << std::hex << key << ".bin";
+  return directory() / name.str();
+}
+
+GLuint pyasge::ShaderCache::loadBinary(std::uint64_t key)
+{
+  if (!enabled() || !programBinaries())
+  {
+    return 0;
+  }
+
+  const auto path = binaryPath(key);
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+  {
+    return 0;
+  }
+
+  // the lengths are checked against the file before anything is allocated for them
+  std::error_code error;
+  const auto size = std::filesystem::file_size(path, error);
+  BinaryHeader header;
+  file.read(reinterpret_cast<char*>(&header), sizeof(header));
+  const auto expected = sizeof(header) + static_cast<std::uintmax_t>(header.length) +
+                        static_cast<std::uintmax_t>(header.blocks) * 2 * sizeof(std::uint32_t);
+  const bool sized = file && !error && header.magic == MAGIC && header.version == FILE_VERSION && size == expected;
+
+  std::vector<char> binary(sized ? header.length : 0);
+  std::vector<std::uint32_t> blocks(sized ? static_cast<std::size_t>(header.blocks) * 2 : 0);
+  file.read(binary.data(), static_cast<std::streamsize>(binary.size()));
+  file.read(reinterpret_cast<char*>(blocks.data()), static_cast<std::streamsize>(blocks.size() * sizeof(std::uint32_t)));
+
+  const bool valid = sized && file && header.key == key && !binary.empty();
+
+  GLuint program = 0;
+  GLint status   = GL_FALSE;
+  if (valid)
+  {
+    program = glCreateProgram();
+    glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+  }
+
+  if (status == GL_TRUE)
+  {
+    for (std::size_t i = 0; i < blocks.size(); i += 2)
+    {
+      glUniformBlockBinding(program, blocks[i], blocks[i + 1]);
+    }
+  }
+
+  if (status == GL_FALSE)
+  {
+    // stale or foreign binaries are normal after a driver update
+    ++stats.binary_rejected;
+    glDeleteProgram(program);
+    file.close();
+    std::filesystem::remove(path, error);
+    return 0;
+  }
+
+  return program;
+}
+
+void pyasge::ShaderCache::saveBinary(std::uint64_t key, GLuint program)
+{
+  if (!enabled() || !programBinaries())
+  {
+    return;
+  }
+
+  // programs linked by the engine may not have asked for their binary, in which case there is none
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0)
+  {
+    return;
+  }
+
+  BinaryHeader header;
+  header.magic   = MAGIC;
+  header.version = FILE_VERSION;
+  header.key     = key;
+
+  std::vector<char> binary(static_cast<std::size_t>(length));
+  GLenum format = 0;
+  glGetProgramBinary(program, length, &length, &format, binary.data());
+  header.format = format;
+  header.length = static_cast<std::uint32_t>(length);
+
+  GLint block_count = 0;
+  glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &block_count);
+  std::vector<std::uint32_t> blocks;
+  for (GLint i = 0; i < block_count; ++i)
+  {
+    GLint binding = 0;
+    glGetActiveUniformBlockiv(program, static_cast<GLuint>(i), GL_UNIFORM_BLOCK_BINDING, &binding);
+    blocks.push_back(static_cast<std::uint32_t>(i));
+    blocks.push_back(static_cast<std::uint32_t>(binding));
+  }
+  header.blocks = static_cast<std::uint32_t>(block_count);
+
+  std::error_code error;
+  std::filesystem::create_directories(directory(), error);
+
+  // write then rename, so a crash never leaves a truncated binary behind
+  const auto path = binaryPath(key);
+  auto staging    = path;
+  staging += ".tmp";
+  {
+    std::ofstream file(staging, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(binary.data(), length);
+    file.write(
+      reinterpret_cast<const char*>(blocks.data()), static_cast<std::streamsize>(blocks.size() * sizeof(std::uint32_t)));
+    if (!file)
+    {
+      Logging::WARN("Unable to write shader binary to " + staging.string());
+      return;
+    }
+  }
+  std::filesystem::rename(staging, path, error);
+}
@@ -0,0 +1,98 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include "extensions/GL.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ASGE::SHADER_LIB
+{
+  class GLShader;
+}
+
+namespace pyasge
+{
+  /// \brief   Avoids recompiling shaders, both within a run and across runs.
+  /// \details Programs are persisted to disk through glProgramBinary, keyed
+  ///          by the hash of their sources and of the driver's vendor,
+  ///          renderer and version strings. This covers the programs linked
+  ///          by the extensions themselves, and pixel shaders, which the
+  ///          engine links against its own vertex stage the first time and
+  ///          which are restored from their binary after that. Their keys
+  ///          also include the engine revision the module was built with,
+  ///          and without one they are not stored at all. A binary the
+  ///          driver rejects is discarded and the program is rebuilt from
+  ///          source. Binaries are only used where the context supports them,
+  ///          i.e. GL 4.1 or ARB_get_program_binary.
+  ///
+  ///          Each request for a pixel shader gets its own shader, as uniform
+  ///          values belong to the shader. Callers that opt into sharing are
+  ///          handed an existing shader compiled from the same source, found
+  ///          by hash and confirmed by comparing the full source.
+  class ShaderCache
+  {
+   public:
+    struct Statistics
+    {
+      std::size_t binary_hits     = 0; ///< programs restored from a cached binary
+      std::size_t binary_misses   = 0; ///< programs compiled from source
+      std::size_t binary_rejected = 0; ///< cached binaries the driver refused
+      std::size_t source_hits     = 0; ///< shared pixel shaders reused rather than recompiled
+    };
+
+    using ShaderFactory = std::function<ASGE::SHADER_LIB::GLShader*(const std::string&)>;
+
+    ShaderCache() = default;
+    ~ShaderCache();
+    ShaderCache(const ShaderCache&) = delete;
+    ShaderCache& operator=(const ShaderCache&) = delete;
+
+    static const std::filesystem::path& directory();
+    static void setDirectory(const std::filesystem::path& path);
+    static bool enabled();
+    static void setEnabled(bool enable);
+    static std::uint64_t hash(const std::string& source, std::uint64_t seed = 14695981039346656037ULL);
+
+    ASGE::SHADER_LIB::GLShader* pixelShader(const std::string& source, const ShaderFactory& factory, bool shared);
+    GLuint link(const std::string& vertex_source, const std::string& fragment_source);
+    [[nodiscard]] const std::string* source(GLuint program) const;
+    std::size_t clear();
+
+    [[nodiscard]] const Statistics& statistics() const noexcept { return stats; }
+
+   private:
+    [[nodiscard]] std::uint64_t driverHash();
+    [[nodiscard]] bool programBinaries();
+    [[nodiscard]] std::filesystem::path binaryPath(std::uint64_t key) const;
+    GLuint loadBinary(std::uint64_t key);
+    void saveBinary(std::uint64_t key, GLuint program);
+
+    std::unordered_multimap<std::uint64_t, ASGE::SHADER_LIB::GLShader*> shared_shaders;
+    std::vector<std::unique_ptr<ASGE::SHADER_LIB::GLShader>> restored; ///< pixel shaders built from binaries
+    std::unordered_map<std::uint64_t, GLuint> programs;
+    std::unordered_map<GLuint, std::string> sources;
+    std::uint64_t driver_hash = 0;
+    std::optional<bool> binary_support;
+    Statistics stats;
+  };
+}
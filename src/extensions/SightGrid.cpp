@@ -0,0 +1,240 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/SightGrid.hpp"
+#include "extensions/TileMap.hpp"
+#include "extensions/TileSet.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace
+{
+  /// Transforms mapping the first octant onto each of the 8.
+  constexpr int OCTANTS[8][4] = { { 1, 0, 0, 1 },  { 0, 1, 1, 0 },  { 0, -1, 1, 0 },  { -1, 0, 0, 1 },
+                                  { -1, 0, 0, -1 }, { 0, -1, -1, 0 }, { 0, 1, -1, 0 },  { 1, 0, 0, -1 } };
+}
+
+pyasge::SightGrid::SightGrid(int columns, int rows, const std::uint8_t* opaque) :
+  cells(static_cast<std::size_t>(std::max(columns, 0)) * static_cast<std::size_t>(std::max(rows, 0)), 0),
+  view(cells.size(), HIDDEN),
+  grid_columns(std::max(columns, 0)),
+  grid_rows(std::max(rows, 0))
+{
+  if (opaque != nullptr)
+  {
+    assign(opaque);
+  }
+}
+
+pyasge::SightGrid::SightGrid(const TileMap& map) : SightGrid(map.columns(), map.rows(), nullptr)
+{
+  const auto& tiles = *map.tileSet();
+  for (int row = 0; row < grid_rows; ++row)
+  {
+    for (int column = 0; column < grid_columns; ++column)
+    {
+      cells[index(column, row)] = tiles.solid(map.get(column, row)) ? 1 : 0;
+    }
+  }
+}
+
+bool pyasge::SightGrid::contains(int column, int row) const noexcept
+{
+  return column >= 0 && row >= 0 && column < grid_columns && row < grid_rows;
+}
+
+bool pyasge::SightGrid::opaque(int column, int row) const noexcept
+{
+  return contains(column, row) && cells[index(column, row)] != 0;
+}
+
+bool pyasge::SightGrid::blocks(int column, int row) const noexcept
+{
+  return !contains(column, row) || cells[index(column, row)] != 0;
+}
+
+void pyasge::SightGrid::setOpaque(int column, int row, bool opaque)
+{
+  if (contains(column, row))
+  {
+    cells[index(column, row)] = opaque ? 1 : 0;
+  }
+}
+
+void pyasge::SightGrid::assign(const std::uint8_t* opaque)
+{
+  std::transform(opaque, opaque + cells.size(), cells.begin(), [](auto value) { return value != 0 ? 1 : 0; });
+}
+
+void pyasge::SightGrid::copy(std::uint8_t* opaque) const
+{
+  std::copy(cells.begin(), cells.end(), opaque);
+}
+
+bool pyasge::SightGrid::lineOfSight(Cell from, Cell to) const noexcept
+{
+  if (!contains(from.first, from.second) || !contains(to.first, to.second))
+  {
+    return false;
+  }
+
+  auto [column, row] = from;
+  const int dx       = std::abs(to.first - column);
+  const int dy       = -std::abs(to.second - row);
+  const int step_x   = column < to.first ? 1 : -1;
+  const int step_y   = row < to.second ? 1 : -1;
+  int error          = dx + dy;
+
+  for (;;)
+  {
+    if (column == to.first && row == to.second)
+    {
+      return true;
+    }
+    if ((column != from.first || row != from.second) && cells[index(column, row)] != 0)
+    {
+      return false;
+    }
+
+    const int doubled = 2 * error;
+    if (doubled >= dy)
+    {
+      error += dy;
+      column += step_x;
+    }
+    if (doubled <= dx)
+    {
+      error += dx;
+      row += step_y;
+    }
+  }
+}
+
+void pyasge::SightGrid::light(int column, int row) noexcept
+{
+  if (contains(column, row))
+  {
+    view[index(column, row)] = VISIBLE;
+  }
+}
+
+void pyasge::SightGrid::fieldOfView(Cell origin, int radius, bool accumulate)
+{
+  if (!accumulate)
+  {
+    std::replace(view.begin(), view.end(), static_cast<std::uint8_t>(VISIBLE), static_cast<std::uint8_t>(EXPLORED));
+  }
+  if (!contains(origin.first, origin.second))
+  {
+    return;
+  }
+
+  radius = radius > 0 ? radius : grid_columns + grid_rows;
+  light(origin.first, origin.second);
+  for (const auto& octant : OCTANTS)
+  {
+    castLight(origin.first, origin.second, 1, 1.0F, 0.0F, radius, octant[0], octant[1], octant[2], octant[3]);
+  }
+}
+
+void pyasge::SightGrid::castLight(
+  int column, int row, int depth, float start, float end, int radius, int xx, int xy, int yx, int yy)
+{
+  if (start < end)
+  {
+    return;
+  }
+
+  const int radius_squared = radius * radius;
+  float next_start         = start;
+  for (int distance = depth; distance <= radius; ++distance)
+  {
+    bool blocked = false;
+    const int dy = -distance;
+    for (int dx = -distance; dx <= 0; ++dx)
+    {
+      // the slopes through the corners of the cell, seen from the viewer
+      const float left_slope  = (static_cast<float>(dx) - 0.5F) / (static_cast<float>(dy) + 0.5F);
+      const float right_slope = (static_cast<float>(dx) + 0.5F) / (static_cast<float>(dy) - 0.5F);
+      if (start < right_slope)
+      {
+        continue;
+      }
+      if (end > left_slope)
+      {
+        break;
+      }
+
+      const int x = column + dx * xx + dy * xy;
+      const int y = row + dx * yx + dy * yy;
+      if (dx * dx + dy * dy <= radius_squared)
+      {
+        light(x, y);
+      }
+
+      if (blocked)
+      {
+        if (blocks(x, y))
+        {
+          next_start = right_slope;
+          continue;
+        }
+        blocked = false;
+        start   = next_start;
+      }
+      else if (blocks(x, y) && distance < radius)
+      {
+        // scan the arc left of the wall beyond it, then carry on right of it
+        blocked = true;
+        castLight(column, row, distance + 1, start, left_slope, radius, xx, xy, yx, yy);
+        next_start = right_slope;
+      }
+    }
+
+    if (blocked)
+    {
+      break;
+    }
+  }
+}
+
+void pyasge::SightGrid::forget()
+{
+  std::fill(view.begin(), view.end(), static_cast<std::uint8_t>(HIDDEN));
+}
+
+void pyasge::SightGrid::writeStates(
+  std::uint8_t* pixels, int width, int height, int format, int channel, const std::uint8_t (&values)[3]) const
+{
+  const int columns = std::min(grid_columns, width);
+  const int rows    = std::min(grid_rows, height);
+  const int first   = channel < 0 ? 0 : channel;
+  const int last    = channel < 0 ? format - 1 : std::min(channel, format - 1);
+
+  for (int row = 0; row < rows; ++row)
+  {
+    const auto* state = view.data() + static_cast<std::size_t>(row) * grid_columns;
+    auto* pixel       = pixels + static_cast<std::size_t>(row) * width * format;
+    for (int column = 0; column < columns; ++column, pixel += format)
+    {
+      const auto value = values[state[column]];
+      for (int byte = first; byte <= last; ++byte)
+      {
+        pixel[byte] = value;
+      }
+    }
+  }
+}
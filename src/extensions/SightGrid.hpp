@@ -0,0 +1,94 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace pyasge
+{
+  class TileMap;
+
+  /// \brief   A grid of cells that block sight, for line of sight and field
+  ///          of view queries.
+  /// \details Fields of view are found by recursive shadowcasting, which
+  ///          scans each of the 8 octants around the viewer row by row,
+  ///          narrowing the visible arc as it meets opaque cells, so every
+  ///          cell is visited at most once. Opaque cells at the edge of the
+  ///          view are lit, so walls can be seen.
+  ///
+  ///          The grid remembers which cells have been visible since it was
+  ///          last reset, so that explored areas can be drawn dimmed, and can
+  ///          write the visible, explored and unseen states of each cell
+  ///          straight into the pixels of a fog texture.
+  class SightGrid
+  {
+   public:
+    using Cell = std::pair<int, int>;
+
+    enum State : std::uint8_t
+    {
+      HIDDEN   = 0,
+      EXPLORED = 1,
+      VISIBLE  = 2,
+    };
+
+    SightGrid(int columns, int rows, const std::uint8_t* opaque);
+
+    /// \brief   Builds a grid where a tile map's solid cells block sight.
+    explicit SightGrid(const TileMap& map);
+
+    [[nodiscard]] int columns() const noexcept { return grid_columns; }
+    [[nodiscard]] int rows() const noexcept { return grid_rows; }
+    [[nodiscard]] bool contains(int column, int row) const noexcept;
+    [[nodiscard]] bool opaque(int column, int row) const noexcept;
+    void setOpaque(int column, int row, bool opaque);
+    void assign(const std::uint8_t* opaque);
+    void copy(std::uint8_t* opaque) const;
+
+    /// \brief   Whether nothing opaque lies on the Bresenham line strictly between two cells.
+    [[nodiscard]] bool lineOfSight(Cell from, Cell to) const noexcept;
+
+    /// \brief   Marks the cells visible from a cell within a radius.
+    /// \details Clears the previous view unless accumulating, which lets
+    ///          several viewers share one view. A radius of 0 or less is
+    ///          unlimited. Visible cells are also marked as explored.
+    void fieldOfView(Cell origin, int radius, bool accumulate);
+
+    /// \brief   The state of every cell, row by row.
+    [[nodiscard]] const std::vector<std::uint8_t>& states() const noexcept { return view; }
+    void forget();
+
+    /// \brief   Writes a value per cell into an image, one pixel per cell.
+    /// \details Pixels hold format bytes each. A channel of -1 writes every
+    ///          byte of the pixel, and cells beyond the image are skipped.
+    void writeStates(
+      std::uint8_t* pixels, int width, int height, int format, int channel, const std::uint8_t (&values)[3]) const;
+
+   private:
+    [[nodiscard]] int index(int column, int row) const noexcept { return row * grid_columns + column; }
+    [[nodiscard]] bool blocks(int column, int row) const noexcept;
+    void light(int column, int row) noexcept;
+    void castLight(
+      int column, int row, int depth, float start, float end, int radius, int xx, int xy, int yx, int yy);
+
+    std::vector<std::uint8_t> cells; ///< non-zero where a cell blocks sight
+    std::vector<std::uint8_t> view;  ///< a State per cell
+    int grid_columns;
+    int grid_rows;
+  };
+}
@@ -0,0 +1,341 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/SpatialGrid.hpp"
+#include "extensions/ThreadPool.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+  /// Builds smaller than this aren't worth waking the thread pool for.
+  constexpr std::size_t PARALLEL_ITEMS = 4096;
+  constexpr std::size_t ITEM_BLOCK     = 1024;
+  constexpr std::uint32_t BUCKET_BLOCK = 2048;
+
+  bool overlaps(const pyasge::SpatialGrid::Box& a, const pyasge::SpatialGrid::Box& b) noexcept
+  {
+    return a.min_x < b.max_x && b.min_x < a.max_x && a.min_y < b.max_y && b.min_y < a.max_y;
+  }
+
+  bool contains(const pyasge::SpatialGrid::Box& box, float x, float y) noexcept
+  {
+    return x >= box.min_x && x < box.max_x && y >= box.min_y && y < box.max_y;
+  }
+
+  /// Runs on the pool for large inputs, and inline otherwise.
+  void forEach(std::size_t count, std::size_t block, const pyasge::ThreadPool::Task& task)
+  {
+    if (count < PARALLEL_ITEMS)
+    {
+      task(0, count, 0);
+      return;
+    }
+    pyasge::ThreadPool::instance().parallelFor(count, block, task);
+  }
+}
+
+pyasge::SpatialGrid::SpatialGrid(float size) : cell_size(size > 0 ? size : 1.0F) {}
+
+void pyasge::SpatialGrid::setCellSize(float size)
+{
+  // entries are keyed by cell, so the contents are rebuilt to match
+  cell_size = size > 0 ? size : 1.0F;
+  build(std::move(items));
+}
+
+pyasge::SpatialGrid::Span pyasge::SpatialGrid::span(const Box& box) const noexcept
+{
+  // clamped so that huge coordinates still land in a cell, which oversized then rejects
+  const auto cell = [this](float value)
+  {
+    const float scaled = value / cell_size;
+    return std::isnan(scaled) ? 0 : static_cast<std::int32_t>(std::floor(std::clamp(scaled, -1e9F, 1e9F)));
+  };
+  return { cell(box.min_x), cell(box.min_y), cell(box.max_x), cell(box.max_y) };
+}
+
+bool pyasge::SpatialGrid::oversized(const Box& box, const Span& span) noexcept
+{
+  const bool finite = std::isfinite(box.min_x) && std::isfinite(box.min_y) && std::isfinite(box.max_x) &&
+                      std::isfinite(box.max_y);
+  const auto cells = static_cast<std::int64_t>(span.last_column - span.first_column + 1) *
+                     static_cast<std::int64_t>(span.last_row - span.first_row + 1);
+  return !finite || cells > MAX_CELLS;
+}
+
+std::uint32_t pyasge::SpatialGrid::bucket(std::int32_t column, std::int32_t row) const noexcept
+{
+  const auto hash = static_cast<std::uint32_t>(column) * 73856093U ^ static_cast<std::uint32_t>(row) * 19349663U;
+  return hash & mask;
+}
+
+void pyasge::SpatialGrid::build(std::vector<Box> boxes)
+{
+  items = std::move(boxes);
+  spans.resize(items.size());
+  is_oversize.assign(items.size(), false);
+
+  // each box's cells, and where its entries start; oversized boxes make none
+  std::vector<std::size_t> offsets(items.size() + 1, 0);
+  forEach(
+    items.size(),
+    ITEM_BLOCK,
+    [this, &offsets](std::size_t begin, std::size_t end, std::size_t /*slot*/)
+    {
+      for (auto i = begin; i < end; ++i)
+      {
+        spans[i] = span(items[i]);
+        if (oversized(items[i], spans[i]))
+        {
+          spans[i] = { 0, 0, -1, -1 };
+          continue;
+        }
+        offsets[i + 1] = static_cast<std::size_t>(spans[i].last_column - spans[i].first_column + 1) *
+                         static_cast<std::size_t>(spans[i].last_row - spans[i].first_row + 1);
+      }
+    });
+
+  oversize.clear();
+  for (std::size_t i = 0; i < items.size(); ++i)
+  {
+    if (spans[i].last_column < spans[i].first_column)
+    {
+      oversize.push_back(static_cast<std::int32_t>(i));
+      is_oversize[i] = true;
+    }
+    offsets[i + 1] += offsets[i];
+  }
+
+  std::uint32_t buckets = 1024;
+  while (buckets < offsets.back() && buckets < (1U << 30U))
+  {
+    buckets *= 2;
+  }
+  mask = buckets - 1;
+
+  std::vector<Entry> unsorted(offsets.back());
+  std::vector<std::uint32_t> keys(offsets.back());
+  forEach(
+    items.size(),
+    ITEM_BLOCK,
+    [this, &offsets, &unsorted, &keys](std::size_t begin, std::size_t end, std::size_t /*slot*/)
+    {
+      for (auto i = begin; i < end; ++i)
+      {
+        auto next = offsets[i];
+        for (auto row = spans[i].first_row; row <= spans[i].last_row; ++row)
+        {
+          for (auto column = spans[i].first_column; column <= spans[i].last_column; ++column, ++next)
+          {
+            unsorted[next] = { static_cast<std::int32_t>(i), column, row };
+            keys[next]     = bucket(column, row);
+          }
+        }
+      }
+    });
+
+  // counting sort into buckets; entries stay in item order within each
+  starts.assign(buckets + 1, 0);
+  for (const auto key : keys)
+  {
+    ++starts[key + 1];
+  }
+  stats.max_entries = 0;
+  for (std::uint32_t i = 0; i < buckets; ++i)
+  {
+    stats.max_entries = std::max<std::size_t>(stats.max_entries, starts[i + 1]);
+    starts[i + 1] += starts[i];
+  }
+
+  entries.resize(unsorted.size());
+  std::vector<std::size_t> cursor(starts.begin(), starts.end() - 1);
+  for (std::size_t i = 0; i < unsorted.size(); ++i)
+  {
+    entries[cursor[keys[i]]++] = unsorted[i];
+  }
+
+  stats.entries  = entries.size();
+  stats.buckets  = buckets;
+  stats.oversize = oversize.size();
+}
+
+void pyasge::SpatialGrid::query(const Box& box, std::vector<std::int32_t>& found) const
+{
+  if (items.empty())
+  {
+    return;
+  }
+
+  const auto area = span(box);
+  if (oversized(box, area))
+  {
+    // walking the cells would take longer than testing every box
+    for (std::size_t i = 0; i < items.size(); ++i)
+    {
+      if (overlaps(box, items[i]))
+      {
+        found.push_back(static_cast<std::int32_t>(i));
+      }
+    }
+    return;
+  }
+
+  for (const auto item : oversize)
+  {
+    if (overlaps(box, items[item]))
+    {
+      found.push_back(item);
+    }
+  }
+
+  for (auto row = area.first_row; row <= area.last_row; ++row)
+  {
+    for (auto column = area.first_column; column <= area.last_column; ++column)
+    {
+      const auto key = bucket(column, row);
+      for (auto i = starts[key]; i < starts[key + 1]; ++i)
+      {
+        const auto& entry = entries[i];
+        if (entry.column != column || entry.row != row || !overlaps(box, items[entry.item]))
+        {
+          continue;
+        }
+
+        // report each box from the first cell it shares with the query
+        const auto& other = spans[entry.item];
+        if (column == std::max(area.first_column, other.first_column) && row == std::max(area.first_row, other.first_row))
+        {
+          found.push_back(entry.item);
+        }
+      }
+    }
+  }
+}
+
+void pyasge::SpatialGrid::query(float x, float y, std::vector<std::int32_t>& found) const
+{
+  if (items.empty())
+  {
+    return;
+  }
+
+  for (const auto item : oversize)
+  {
+    if (contains(items[item], x, y))
+    {
+      found.push_back(item);
+    }
+  }
+
+  const auto cell = span({ x, y, x, y });
+  const auto key  = bucket(cell.first_column, cell.first_row);
+  for (auto i = starts[key]; i < starts[key + 1]; ++i)
+  {
+    const auto& entry = entries[i];
+    if (entry.column == cell.first_column && entry.row == cell.first_row && contains(items[entry.item], x, y))
+    {
+      found.push_back(entry.item);
+    }
+  }
+}
+
+void pyasge::SpatialGrid::bucketPairs(std::uint32_t first, std::uint32_t last, std::vector<std::int32_t>& found) const
+{
+  for (auto key = first; key < last; ++key)
+  {
+    for (auto a = starts[key]; a < starts[key + 1]; ++a)
+    {
+      const auto& entry = entries[a];
+      for (auto b = a + 1; b < starts[key + 1]; ++b)
+      {
+        const auto& other = entries[b];
+        if (
+          other.column != entry.column || other.row != entry.row || other.item == entry.item ||
+          !overlaps(items[entry.item], items[other.item]))
+        {
+          continue;
+        }
+
+        const auto& span_a = spans[entry.item];
+        const auto& span_b = spans[other.item];
+        if (
+          entry.column == std::max(span_a.first_column, span_b.first_column) &&
+          entry.row == std::max(span_a.first_row, span_b.first_row))
+        {
+          // entries are sorted by item within a bucket, so entry.item < other.item
+          found.push_back(entry.item);
+          found.push_back(other.item);
+        }
+      }
+    }
+  }
+}
+
+void pyasge::SpatialGrid::pairs(std::vector<std::int32_t>& found) const
+{
+  if (items.empty())
+  {
+    return;
+  }
+
+  const auto buckets = static_cast<std::uint32_t>(starts.size() - 1);
+  if (items.size() < PARALLEL_ITEMS)
+  {
+    bucketPairs(0, buckets, found);
+    oversizePairs(found);
+    return;
+  }
+
+  // each block of buckets collects its own pairs, joined in block order
+  const auto blocks = (buckets + BUCKET_BLOCK - 1) / BUCKET_BLOCK;
+  std::vector<std::vector<std::int32_t>> results(blocks);
+  ThreadPool::instance().parallelFor(
+    blocks,
+    1,
+    [this, buckets, &results](std::size_t begin, std::size_t end, std::size_t /*slot*/)
+    {
+      for (auto block = begin; block < end; ++block)
+      {
+        const auto first = static_cast<std::uint32_t>(block) * BUCKET_BLOCK;
+        bucketPairs(first, std::min(first + BUCKET_BLOCK, buckets), results[block]);
+      }
+    });
+
+  for (const auto& result : results)
+  {
+    found.insert(found.end(), result.begin(), result.end());
+  }
+  oversizePairs(found);
+}
+
+void pyasge::SpatialGrid::oversizePairs(std::vector<std::int32_t>& found) const
+{
+  // pairs of two oversized boxes are reported once, by the first of them
+  for (const auto item : oversize)
+  {
+    for (std::size_t other = 0; other < items.size(); ++other)
+    {
+      const auto other_item = static_cast<std::int32_t>(other);
+      if (other_item == item || (is_oversize[other] && other_item < item) || !overlaps(items[item], items[other]))
+      {
+        continue;
+      }
+      found.push_back(std::min(item, other_item));
+      found.push_back(std::max(item, other_item));
+    }
+  }
+}
@@ -0,0 +1,121 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace pyasge
+{
+  /// \brief   A uniform hash grid over axis aligned boxes, rebuilt each frame.
+  /// \details Every box is entered into each square cell it touches, and
+  ///          cells are hashed into a table sized to the number of boxes,
+  ///          so the grid covers an unbounded world without a fixed extent.
+  ///          Entries are counting sorted by bucket, leaving each bucket's
+  ///          entries contiguous.
+  ///
+  ///          Two boxes sharing several cells are only reported once, from
+  ///          the cell holding the top left corner of their overlap, which
+  ///          both are always entered into. Boxes overlap when their
+  ///          interiors do, so boxes that only touch are not reported.
+  ///
+  ///          Boxes spanning more than MAX_CELLS cells, including those with
+  ///          infinite or NaN coordinates, aren't entered into cells at all.
+  ///          They are kept in a separate oversize list that every query and
+  ///          pair search checks directly, which keeps the entries bounded
+  ///          however large a box is. Queries spanning more than MAX_CELLS
+  ///          cells test every box instead of walking the cells.
+  ///
+  ///          Large builds and pair searches are split across the shared
+  ///          ThreadPool. Results are ordered the same however many threads
+  ///          produced them.
+  class SpatialGrid
+  {
+   public:
+    struct Box
+    {
+      float min_x;
+      float min_y;
+      float max_x;
+      float max_y;
+    };
+
+    struct Statistics
+    {
+      std::size_t entries     = 0; ///< cell entries made by the last build
+      std::size_t buckets     = 0; ///< buckets in the hash table
+      std::size_t max_entries = 0; ///< entries in the fullest bucket
+      std::size_t oversize    = 0; ///< boxes kept out of the cells
+    };
+
+    /// \brief   The most cells a box is entered into.
+    static constexpr std::int64_t MAX_CELLS = 1024;
+
+    explicit SpatialGrid(float size);
+
+    void setCellSize(float size);
+    [[nodiscard]] float cellSize() const noexcept { return cell_size; }
+
+    /// \brief   Replaces the grid's contents. Boxes are numbered in order.
+    void build(std::vector<Box> boxes);
+    [[nodiscard]] std::size_t size() const noexcept { return items.size(); }
+    [[nodiscard]] const std::vector<Box>& boxes() const noexcept { return items; }
+
+    /// \brief   Appends the numbers of the boxes overlapping a box.
+    void query(const Box& box, std::vector<std::int32_t>& found) const;
+
+    /// \brief   Appends the numbers of the boxes containing a point.
+    void query(float x, float y, std::vector<std::int32_t>& found) const;
+
+    /// \brief   Appends every overlapping pair (i, j), with i < j.
+    void pairs(std::vector<std::int32_t>& found) const;
+
+    [[nodiscard]] const Statistics& statistics() const noexcept { return stats; }
+
+   private:
+    struct Entry
+    {
+      std::int32_t item;
+      std::int32_t column;
+      std::int32_t row;
+    };
+
+    struct Span
+    {
+      std::int32_t first_column;
+      std::int32_t first_row;
+      std::int32_t last_column;
+      std::int32_t last_row;
+    };
+
+    [[nodiscard]] Span span(const Box& box) const noexcept;
+    [[nodiscard]] static bool oversized(const Box& box, const Span& span) noexcept;
+    [[nodiscard]] std::uint32_t bucket(std::int32_t column, std::int32_t row) const noexcept;
+    void bucketPairs(std::uint32_t first, std::uint32_t last, std::vector<std::int32_t>& found) const;
+    void oversizePairs(std::vector<std::int32_t>& found) const;
+
+    float cell_size;
+    std::uint32_t mask = 0;
+    std::vector<Box> items;
+    std::vector<Span> spans;
+    std::vector<std::size_t> starts; ///< the first entry of each bucket, plus one past the end
+    std::vector<Entry> entries;
+    std::vector<std::int32_t> oversize; ///< boxes checked directly rather than through the cells
+    std::vector<bool> is_oversize;
+    Statistics stats;
+  };
+}
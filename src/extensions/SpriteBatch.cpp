@@ -0,0 +1,68 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/SpriteBatch.hpp"
+#include "extensions/RenderContext.hpp"
+
+#include <utility>
+
+pyasge::SpriteBatch::SpriteBatch(ASGE::GLRenderer& renderer) :
+  context(RenderContext::get(renderer)), instancer(context)
+{
+}
+
+bool pyasge::SpriteBatch::add(const ASGE::Sprite& sprite, pybind11::object anchor)
+{
+  if (!slots.emplace(&sprite, sprites.size()).second)
+  {
+    return false;
+  }
+
+  sprites.push_back(&sprite);
+  anchors.push_back(std::move(anchor));
+  return true;
+}
+
+bool pyasge::SpriteBatch::remove(const ASGE::Sprite& sprite)
+{
+  auto iter = slots.find(&sprite);
+  if (iter == slots.end())
+  {
+    return false;
+  }
+
+  // later sprites shift down to keep the draw order
+  const auto slot = iter->second;
+  slots.erase(iter);
+  sprites.erase(sprites.begin() + static_cast<std::ptrdiff_t>(slot));
+  anchors.erase(anchors.begin() + static_cast<std::ptrdiff_t>(slot));
+  for (auto i = slot; i < sprites.size(); ++i)
+  {
+    slots[sprites[i]] = i;
+  }
+  return true;
+}
+
+void pyasge::SpriteBatch::clear()
+{
+  sprites.clear();
+  anchors.clear();
+  slots.clear();
+}
+
+std::size_t pyasge::SpriteBatch::render()
+{
+  return instancer.draw(sprites.data(), sprites.size());
+}
@@ -0,0 +1,67 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "extensions/SpriteInstancer.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <pybind11/pybind11.h>
+#include <unordered_map>
+#include <vector>
+
+namespace ASGE
+{
+  class GLRenderer;
+  class Sprite;
+}
+
+namespace pyasge
+{
+  class RenderContext;
+
+  /// \brief   A list of sprites drawn together with instancing.
+  /// \details Unlike a static batch, nothing is baked: every render reads the
+  ///          sprites as they are and streams one instance record per sprite,
+  ///          so sprites that move every frame cost a record each rather than
+  ///          four vertices. Sprites are drawn in the order they were added,
+  ///          with one call per run sharing a texture.
+  ///
+  ///          The batch keeps a reference to each sprite, holding on to its
+  ///          Python object so it outlives the batch.
+  class SpriteBatch
+  {
+   public:
+    explicit SpriteBatch(ASGE::GLRenderer& renderer);
+
+    bool add(const ASGE::Sprite& sprite, pybind11::object anchor);
+    bool remove(const ASGE::Sprite& sprite);
+    void clear();
+    std::size_t render();
+
+    [[nodiscard]] bool contains(const ASGE::Sprite& sprite) const { return slots.count(&sprite) != 0; }
+    [[nodiscard]] std::size_t size() const noexcept { return sprites.size(); }
+    [[nodiscard]] std::size_t instances() const noexcept { return instancer.instances(); }
+    [[nodiscard]] std::size_t draws() const noexcept { return instancer.draws(); }
+
+   private:
+    std::weak_ptr<RenderContext> context;
+    SpriteInstancer instancer;
+    std::vector<const ASGE::Sprite*> sprites;
+    std::vector<pybind11::object> anchors;
+    std::unordered_map<const ASGE::Sprite*, std::size_t> slots;
+  };
+}
@@ -0,0 +1,173 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/SpriteInstancer.hpp"
+#include "extensions/FrameStats.hpp"
+#include "extensions/GLStateGuard.hpp"
+#include "extensions/RenderContext.hpp"
+#include "extensions/SpriteVertices.hpp"
+#include "extensions/TargetTracker.hpp"
+#include "extensions/ThreadPool.hpp"
+
+#include <Engine/Sprite.hpp>
+#include <utility>
+
+namespace
+{
+  /// Lists shorter than this are built on the calling thread.
+  constexpr std::size_t PARALLEL_MIN = 16384;
+  constexpr std::size_t BLOCK        = 4096;
+
+  /// \brief   Squeezes out untextured entries and groups the rest into runs by texture.
+  template <typename T>
+  void collect(std::vector<T>& data, const std::vector<GLuint>& textures, std::vector<pyasge::QuadBuffer::Run>& runs)
+  {
+    runs.clear();
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < data.size(); ++i)
+    {
+      if (textures[i] == 0)
+      {
+        continue;
+      }
+
+      if (runs.empty() || runs.back().texture != textures[i])
+      {
+        runs.push_back({ textures[i], kept, 0 });
+      }
+      ++runs.back().count;
+      data[kept++] = data[i];
+    }
+    data.resize(kept);
+  }
+}
+
+pyasge::SpriteInstancer::SpriteInstancer(std::weak_ptr<RenderContext> owner) :
+  context(owner), quads(std::move(owner))
+{
+}
+
+pyasge::SpriteInstancer::~SpriteInstancer()
+{
+  // the buffers went with the GL context if the renderer has been released
+  if (context.expired() || vertex_array == 0)
+  {
+    return;
+  }
+
+  glDeleteVertexArrays(1, &vertex_array);
+}
+
+std::size_t pyasge::SpriteInstancer::draw(const ASGE::Sprite* const* sprites, std::size_t count)
+{
+  auto ctx      = context.lock();
+  auto* program = ctx ? ctx->spriteProgram() : nullptr;
+  drawn         = 0;
+  if (program == nullptr || count == 0)
+  {
+    return 0;
+  }
+  if (!program->instancing())
+  {
+    return drawQuads(*ctx, sprites, count);
+  }
+
+  // records are built in place, each noting its texture, then untextured sprites are squeezed out
+  records.resize(count);
+  textures.resize(count);
+  const auto build = [this, sprites](std::size_t begin, std::size_t end, std::size_t /*slot*/)
+  {
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      textures[i] = spriteInstance(*sprites[i], records[i]) ? QuadBuffer::textureID(sprites[i]->getTexture()) : 0;
+    }
+  };
+
+  if (count >= PARALLEL_MIN)
+  {
+    ThreadPool::instance().parallelFor(count, BLOCK, build);
+  }
+  else
+  {
+    build(0, count, 0);
+  }
+
+  collect(records, textures, runs);
+  if (runs.empty())
+  {
+    return 0;
+  }
+
+  GLStateGuard guard;
+  program->begin(ctx->renderer(), true);
+  if (vertex_array == 0)
+  {
+    glGenVertexArrays(1, &vertex_array);
+  }
+
+  glBindVertexArray(vertex_array);
+  const auto base = ctx->streamBuffer().write(records.data(), records.size() * sizeof(SpriteInstance));
+  for (const auto& run : runs)
+  {
+    SpriteProgram::instanceAttributes(run.first, base);
+    glBindTexture(GL_TEXTURE_2D, run.texture);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(run.count));
+  }
+
+  auto& stats = ctx->stats();
+  stats.instanced_draws += runs.size();
+  stats.instances += records.size();
+  drawn = records.size();
+  TargetTracker::instance().drawn();
+  return runs.size();
+}
+
+std::size_t
+pyasge::SpriteInstancer::drawQuads(RenderContext& ctx, const ASGE::Sprite* const* sprites, std::size_t count)
+{
+  vertices.resize(count);
+  textures.resize(count);
+  const auto build = [this, sprites](std::size_t begin, std::size_t end, std::size_t /*slot*/)
+  {
+    spriteQuads(sprites + begin, end - begin, vertices.data() + begin);
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      textures[i] = QuadBuffer::textureID(sprites[i]->getTexture());
+    }
+  };
+
+  if (count >= PARALLEL_MIN)
+  {
+    ThreadPool::instance().parallelFor(count, BLOCK, build);
+  }
+  else
+  {
+    build(0, count, 0);
+  }
+
+  collect(vertices, textures, runs);
+  if (runs.empty())
+  {
+    return 0;
+  }
+
+  GLStateGuard guard;
+  quads.upload(vertices, runs, GL_STREAM_DRAW);
+  ctx.spriteProgram()->begin(ctx.renderer());
+  quads.draw(ctx.stats());
+  drawn = vertices.size();
+  TargetTracker::instance().drawn();
+  return runs.size();
+}
@@ -0,0 +1,80 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "extensions/GL.hpp"
+#include "extensions/QuadBuffer.hpp"
+#include "extensions/Quads.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace ASGE
+{
+  class Sprite;
+}
+
+namespace pyasge
+{
+  class RenderContext;
+
+  /// \brief   Draws sprites as instances of a single quad.
+  /// \details Each sprite becomes one 44 byte SpriteInstance rather than four
+  ///          32 byte vertices, and the instanced sprite program expands it
+  ///          into a quad on the GPU. Consecutive sprites sharing a texture
+  ///          form a run drawn with one instanced call, so sprites are drawn
+  ///          in the order given. Instance data is written to the render
+  ///          context's StreamBuffer, which the runs then draw from.
+  ///
+  ///          Sprites are drawn with the standard sprite shader; any pixel
+  ///          shader they have is not applied, and sprites without a texture
+  ///          are skipped. Like other native draws, instances are drawn
+  ///          straight away into the renderer's viewport and camera view.
+  ///
+  ///          Where the GL context can't draw instances, the sprites are
+  ///          turned into quads on the CPU by the vectorised vertex kernels
+  ///          instead, and drawn in the same runs through a QuadBuffer.
+  class SpriteInstancer
+  {
+   public:
+    explicit SpriteInstancer(std::weak_ptr<RenderContext> owner);
+    ~SpriteInstancer();
+    SpriteInstancer(const SpriteInstancer&) = delete;
+    SpriteInstancer& operator=(const SpriteInstancer&) = delete;
+
+    /// \brief   Builds, uploads and draws the instances of a list of sprites.
+    /// \details Long lists are built on the thread pool, which only reads
+    ///          the sprites and never calls into Python.
+    /// \returns The number of draw calls issued.
+    std::size_t draw(const ASGE::Sprite* const* sprites, std::size_t count);
+
+    [[nodiscard]] std::size_t instances() const noexcept { return drawn; }
+    [[nodiscard]] std::size_t draws() const noexcept { return runs.size(); }
+
+   private:
+    std::size_t drawQuads(RenderContext& ctx, const ASGE::Sprite* const* sprites, std::size_t count);
+
+    std::weak_ptr<RenderContext> context;
+    QuadBuffer quads;
+    std::vector<SpriteInstance> records;
+    std::vector<Quad> vertices;
+    std::vector<GLuint> textures;
+    std::vector<QuadBuffer::Run> runs;
+    GLuint vertex_array = 0;
+    std::size_t drawn   = 0;
+  };
+}
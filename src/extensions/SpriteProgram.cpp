@@ -0,0 +1,250 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/SpriteProgram.hpp"
+#include "extensions/Quads.hpp"
+#include "extensions/ShaderCache.hpp"
+#include "extensions/UniformBlocks.hpp"
+
+#include <Engine/OpenGL/GLRenderer.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  constexpr const char* VERTEX_SHADER = R"(
+#version 330 core
+layout (location = 0) in vec2 position;
+layout (location = 1) in vec2 uvs;
+layout (location = 2) in vec4 rgba;
+
+uniform mat4 projection;
+uniform vec2 origin;
+
+out VertexData
+{
+  vec2 uvs;
+  vec4 rgba;
+} vs_out;
+
+void main()
+{
+  vs_out.uvs  = uvs;
+  vs_out.rgba = rgba;
+  gl_Position = projection * vec4(origin + position, 0.0, 1.0);
+}
+)";
+
+  // expands one instance record into a quad, drawn as a four vertex strip
+  constexpr const char* INSTANCED_VERTEX_SHADER = R"(
+#version 330 core
+layout (location = 0) in vec2 centre;
+layout (location = 1) in vec4 axes;
+layout (location = 2) in vec4 source;
+layout (location = 3) in vec4 rgba;
+
+uniform mat4 projection;
+
+out VertexData
+{
+  vec2 uvs;
+  vec4 rgba;
+} vs_out;
+
+void main()
+{
+  vec2 corner  = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));
+  vec2 offset  = corner * 2.0 - 1.0;
+  vs_out.uvs   = mix(source.xy, source.zw, corner);
+  vs_out.rgba  = rgba;
+  gl_Position  = projection * vec4(centre + axes.xy * offset.x + axes.zw * offset.y, 0.0, 1.0);
+}
+)";
+
+  constexpr const char* FRAGMENT_SHADER = R"(
+#version 330 core
+in VertexData
+{
+  vec2 uvs;
+  vec4 rgba;
+} fs_in;
+
+uniform sampler2D image;
+layout (location = 0) out vec4 frag_colour;
+
+void main()
+{
+  frag_colour = fs_in.rgba * texture(image, fs_in.uvs);
+}
+)";
+}
+
+pyasge::SpriteProgram::SpriteProgram(ShaderCache& shader_cache, UniformBlocks& uniform_blocks) :
+  program(shader_cache.link(VERTEX_SHADER, FRAGMENT_SHADER)),
+  instanced_program(shader_cache.link(INSTANCED_VERTEX_SHADER, FRAGMENT_SHADER))
+{
+  if (program == 0)
+  {
+    return;
+  }
+
+  GLint current = 0;
+  glGetIntegerv(GL_CURRENT_PROGRAM, &current);
+  for (auto [linked, location] : { std::make_pair(program, &projection),
+                                   std::make_pair(instanced_program, &instanced_projection) })
+  {
+    if (linked != 0)
+    {
+      *location = glGetUniformLocation(linked, "projection");
+      uniform_blocks.attach(linked);
+      glUseProgram(linked);
+      glUniform1i(glGetUniformLocation(linked, "image"), 0);
+    }
+  }
+  glUseProgram(static_cast<GLuint>(current));
+  origin_location = glGetUniformLocation(program, "origin");
+
+  glGenBuffers(1, &index_buffer);
+}
+
+pyasge::SpriteProgram::~SpriteProgram()
+{
+  // the program itself belongs to the shader cache
+  glDeleteBuffers(1, &index_buffer);
+}
+
+void pyasge::SpriteProgram::use(const View& view, bool instanced) const
+{
+  // an orthographic projection of the camera view, with y pointing down
+  const float left   = view[0];
+  const float right  = view[1];
+  const float top    = view[2];
+  const float bottom = view[3];
+  const std::array<float, 16> matrix = {
+    2.0F / (right - left), 0.0F, 0.0F, 0.0F,
+    0.0F, 2.0F / (top - bottom), 0.0F, 0.0F,
+    0.0F, 0.0F, -1.0F, 0.0F,
+    -(right + left) / (right - left), -(top + bottom) / (top - bottom), 0.0F, 1.0F };
+
+  glUseProgram(instanced ? instanced_program : program);
+  glUniformMatrix4fv(instanced ? instanced_projection : projection, 1, GL_FALSE, matrix.data());
+  if (!instanced)
+  {
+    origin(0.0F, 0.0F);
+  }
+}
+
+void pyasge::SpriteProgram::origin(float x, float y) const
+{
+  glUniform2f(origin_location, x, y);
+}
+
+pyasge::SpriteProgram::View pyasge::SpriteProgram::begin(const ASGE::GLRenderer& renderer, bool instanced) const
+{
+  const auto& resolution = renderer.getResolutionInfo();
+  const auto& viewport   = resolution.viewport;
+  const View view        = { resolution.view.min_x, resolution.view.max_x, resolution.view.min_y,
+                             resolution.view.max_y };
+
+  glViewport(viewport.x, viewport.y, viewport.w, viewport.h);
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glActiveTexture(GL_TEXTURE0);
+  use(view, instanced);
+  return view;
+}
+
+GLuint pyasge::SpriteProgram::indices(std::size_t quads)
+{
+  if (quads > index_capacity)
+  {
+    // grow geometrically so batches built one after another rarely reallocate
+    index_capacity = std::max(quads, index_capacity * 2);
+    std::vector<std::uint32_t> data(index_capacity * QUAD_INDICES.size());
+    for (std::size_t quad = 0; quad < index_capacity; ++quad)
+    {
+      for (std::size_t i = 0; i < QUAD_INDICES.size(); ++i)
+      {
+        data[quad * QUAD_INDICES.size() + i] = static_cast<std::uint32_t>(quad * 4) + QUAD_INDICES[i];
+      }
+    }
+
+    // the element binding belongs to the vertex array, so use the copy target
+    glBindBuffer(GL_COPY_WRITE_BUFFER, index_buffer);
+    glBufferData(
+      GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(data.size() * sizeof(std::uint32_t)), data.data(),
+      GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  }
+  return index_buffer;
+}
+
+void pyasge::SpriteProgram::attributes(VertexFormat format, std::size_t base)
+{
+  const auto offset = [base](std::size_t member) { return reinterpret_cast<const void*>(base + member); };
+  for (GLuint location = 0; location < 3; ++location)
+  {
+    glEnableVertexAttribArray(location);
+  }
+
+  // the compact formats are normalised by the vertex fetch, so the shader reads the same inputs
+  switch (format)
+  {
+    case VertexFormat::COMPACT:
+    {
+      constexpr auto STRIDE = static_cast<GLsizei>(sizeof(CompactVertex));
+      glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, STRIDE, offset(offsetof(CompactVertex, x)));
+      glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, GL_TRUE, STRIDE, offset(offsetof(CompactVertex, uvs)));
+      glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, STRIDE, offset(offsetof(CompactVertex, rgba)));
+      break;
+    }
+    case VertexFormat::HALF:
+    {
+      constexpr auto STRIDE = static_cast<GLsizei>(sizeof(HalfVertex));
+      glVertexAttribPointer(0, 2, GL_HALF_FLOAT, GL_FALSE, STRIDE, offset(offsetof(HalfVertex, position)));
+      glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, GL_TRUE, STRIDE, offset(offsetof(HalfVertex, uvs)));
+      glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, STRIDE, offset(offsetof(HalfVertex, rgba)));
+      break;
+    }
+    default:
+    {
+      constexpr auto STRIDE = static_cast<GLsizei>(sizeof(QuadVertex));
+      glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, STRIDE, offset(offsetof(QuadVertex, x)));
+      glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, STRIDE, offset(offsetof(QuadVertex, u)));
+      glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, STRIDE, offset(offsetof(QuadVertex, r)));
+      break;
+    }
+  }
+}
+
+void pyasge::SpriteProgram::instanceAttributes(std::size_t first, std::size_t base)
+{
+  constexpr auto STRIDE = static_cast<GLsizei>(sizeof(SpriteInstance));
+  const auto offset     = [first, base](std::size_t member)
+  { return reinterpret_cast<const void*>(base + first * sizeof(SpriteInstance) + member); };
+
+  for (GLuint location = 0; location < 4; ++location)
+  {
+    glEnableVertexAttribArray(location);
+    glVertexAttribDivisor(location, 1);
+  }
+  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, STRIDE, offset(offsetof(SpriteInstance, x)));
+  glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, STRIDE, offset(offsetof(SpriteInstance, axes)));
+  glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, STRIDE, offset(offsetof(SpriteInstance, uvs)));
+  glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, STRIDE, offset(offsetof(SpriteInstance, rgba)));
+}
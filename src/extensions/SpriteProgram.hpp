@@ -0,0 +1,94 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "extensions/GL.hpp"
+#include "extensions/Quads.hpp"
+
+#include <array>
+#include <cstddef>
+
+namespace ASGE
+{
+  class GLRenderer;
+}
+
+namespace pyasge
+{
+  class ShaderCache;
+  class UniformBlocks;
+
+  /// \brief   The shader program and shared buffers used by native quad draws.
+  /// \details The extensions that draw without going through the engine's
+  ///          batch renderer (static batches, tilemaps, particles) all draw
+  ///          QuadVertex data with this program. The fragment stage mirrors
+  ///          the engine's sprite shader, receiving a ``VertexData`` block of
+  ///          uvs and rgba, so draws look the same as sprites. A shared index
+  ///          buffer holding the two triangles of every quad is grown on
+  ///          demand and can be bound into any vertex array.
+  ///
+  ///          Vertices may also be read in the compact formats, with packed
+  ///          texture coordinates and tint and, for half floats, positions
+  ///          relative to an origin uniform. The vertex fetch normalises them
+  ///          so the ``VertexData`` block handed on is unchanged.
+  ///
+  ///          A second, instanced program shares the fragment stage. It reads
+  ///          one SpriteInstance per quad and expands it into the quad's
+  ///          corners in the vertex shader, so sprites can be drawn from a
+  ///          record a third of the size of their four vertices.
+  class SpriteProgram
+  {
+   public:
+    using View = std::array<float, 4>; ///< min_x, max_x, min_y, max_y
+
+    SpriteProgram(ShaderCache& shader_cache, UniformBlocks& uniform_blocks);
+    ~SpriteProgram();
+    SpriteProgram(const SpriteProgram&) = delete;
+    SpriteProgram& operator=(const SpriteProgram&) = delete;
+
+    [[nodiscard]] bool valid() const noexcept { return program != 0; }
+    [[nodiscard]] bool instancing() const noexcept { return instanced_program != 0; }
+    void use(const View& view, bool instanced = false) const;
+
+    /// \brief   Prepares to draw into the renderer's viewport and camera view.
+    /// \details Sets the viewport, alpha blending and texture unit and uses the
+    ///          program, so the caller must hold a GLStateGuard.
+    /// \returns The camera view being drawn, for culling.
+    View begin(const ASGE::GLRenderer& renderer, bool instanced = false) const;
+    GLuint indices(std::size_t quads);
+
+    /// \brief   Sets the point half float positions are relative to, reset by use.
+    void origin(float x, float y) const;
+
+    /// \brief   Points the program's inputs at vertices starting base bytes into the bound buffer.
+    static void attributes(VertexFormat format = VertexFormat::FULL, std::size_t base = 0);
+
+    /// \brief   Points the instanced program's inputs at the bound buffer, starting from an instance.
+    /// \details GL 3.3 has no base instance, so runs after the first are
+    ///          drawn by pointing the attributes further into the buffer.
+    ///          The instances themselves start base bytes into the buffer.
+    static void instanceAttributes(std::size_t first, std::size_t base = 0);
+
+   private:
+    GLuint program             = 0;
+    GLuint instanced_program   = 0;
+    GLint projection           = -1;
+    GLint instanced_projection = -1;
+    GLint origin_location      = -1;
+    GLuint index_buffer        = 0;
+    std::size_t index_capacity = 0;
+  };
+}
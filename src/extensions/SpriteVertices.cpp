@@ -0,0 +1,859 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/SpriteVertices.hpp"
+
+#include <Engine/Logger.hpp>
+#include <Engine/Sprite.hpp>
+#include <Engine/SpriteBounds.hpp>
+#include <Engine/Texture.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#  include <immintrin.h>
+#  define PYASGE_X86
+#  if defined(_MSC_VER) && !defined(__clang__)
+#    include <intrin.h>
+#    define PYASGE_TARGET(isa)
+#  else
+#    define PYASGE_TARGET(isa) __attribute__((target(isa)))
+#  endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  include <arm_neon.h>
+#  define PYASGE_NEON
+#endif
+
+namespace
+{
+  using pyasge::Quad;
+  using pyasge::VertexKernel;
+
+  /// Sprites gathered for each pass of a kernel.
+  constexpr std::size_t LANES = 8;
+
+  /// Sprites with a rotation or scale compared against the engine before the kernels are trusted.
+  constexpr std::size_t CHECKED = 64;
+
+  /// Larger rotations are wrapped first, as the reduction below loses precision past this.
+  constexpr float WRAP_ABOVE = 8192.0F;
+  constexpr double TWO_PI    = 6.28318530717958647692;
+
+  // angles are reduced by the nearest multiple of pi/2, subtracted in three
+  // parts, and the remainder on [-pi/4, pi/4] fed to minimax polynomials
+  constexpr float TWO_OVER_PI = 0.636619772367581343F;
+  constexpr float PIO2_1      = 1.5703125F;
+  constexpr float PIO2_2      = 4.837512969970703125e-4F;
+  constexpr float PIO2_3      = 7.54978995489188216e-8F;
+  constexpr float SIN_1       = -1.6666654611e-1F;
+  constexpr float SIN_2       = 8.3321608736e-3F;
+  constexpr float SIN_3       = -1.9515295891e-4F;
+  constexpr float COS_1       = 4.166664568298827e-2F;
+  constexpr float COS_2       = -1.388731625493765e-3F;
+  constexpr float COS_3       = 2.443315711809948e-5F;
+
+  /// \brief   A group of sprites gathered into lanes, an array per property.
+  /// \details Lanes past the end of the list are padded with empty sprites.
+  ///          Flip flags become all ones or all zeros, ready to select with.
+  struct alignas(32) Lanes
+  {
+    float x[LANES], y[LANES], width[LANES], height[LANES], scale[LANES], rotation[LANES];
+    float src_x[LANES], src_y[LANES], src_w[LANES], src_h[LANES], tex_w[LANES], tex_h[LANES];
+    float r[LANES], g[LANES], b[LANES], a[LANES];
+    std::uint32_t flip_x[LANES], flip_y[LANES], flip_xy[LANES];
+  };
+
+  using Transform = void (*)(const Lanes&, Quad*);
+
+  float wrap(float rotation) noexcept
+  {
+    if (!(std::fabs(rotation) <= WRAP_ABOVE))
+    {
+      rotation = std::isfinite(rotation) ? static_cast<float>(std::fmod(static_cast<double>(rotation), TWO_PI)) : 0.0F;
+    }
+    return rotation;
+  }
+
+  void pad(std::size_t i, Lanes& lanes)
+  {
+    lanes.x[i] = lanes.y[i] = lanes.width[i] = lanes.height[i] = lanes.scale[i] = lanes.rotation[i] = 0.0F;
+    lanes.src_x[i] = lanes.src_y[i] = lanes.src_w[i] = lanes.src_h[i] = 0.0F;
+    lanes.tex_w[i] = lanes.tex_h[i] = 1.0F;
+    lanes.r[i] = lanes.g[i] = lanes.b[i] = lanes.a[i] = 0.0F;
+    lanes.flip_x[i] = lanes.flip_y[i] = lanes.flip_xy[i] = 0U;
+  }
+
+  void gather(const ASGE::Sprite* const* sprites, std::size_t count, Lanes& lanes)
+  {
+    const auto mask = [](unsigned int flags, ASGE::Sprite::FlipFlags flag)
+    { return (flags & static_cast<unsigned int>(flag)) != 0 ? ~0U : 0U; };
+
+    for (std::size_t i = 0; i < LANES; ++i)
+    {
+      if (i >= count)
+      {
+        pad(i, lanes);
+        continue;
+      }
+
+      const auto& sprite = *sprites[i];
+      lanes.x[i]         = sprite.xPos();
+      lanes.y[i]         = sprite.yPos();
+      lanes.width[i]     = sprite.width();
+      lanes.height[i]    = sprite.height();
+      lanes.scale[i]     = sprite.scale();
+      lanes.rotation[i]  = wrap(sprite.rotationInRadians());
+
+      if (const auto* texture = sprite.getTexture(); texture != nullptr)
+      {
+        const auto* rect = sprite.srcRect();
+        lanes.src_x[i]   = rect[0];
+        lanes.src_y[i]   = rect[1];
+        lanes.src_w[i]   = rect[2];
+        lanes.src_h[i]   = rect[3];
+        lanes.tex_w[i]   = static_cast<float>(texture->getWidth());
+        lanes.tex_h[i]   = static_cast<float>(texture->getHeight());
+      }
+      else
+      {
+        lanes.src_x[i] = lanes.src_y[i] = lanes.src_w[i] = lanes.src_h[i] = 0.0F;
+        lanes.tex_w[i] = lanes.tex_h[i] = 1.0F;
+      }
+
+      const auto tint    = sprite.colour();
+      lanes.r[i]         = tint.r;
+      lanes.g[i]         = tint.g;
+      lanes.b[i]         = tint.b;
+      lanes.a[i]         = sprite.opacity();
+      const auto flags   = static_cast<unsigned int>(sprite.flipFlags());
+      lanes.flip_x[i]    = mask(flags, ASGE::Sprite::FLIP_X);
+      lanes.flip_y[i]    = mask(flags, ASGE::Sprite::FLIP_Y);
+      lanes.flip_xy[i]   = mask(flags, ASGE::Sprite::FLIP_XY);
+    }
+  }
+
+  /// Transforms are gathered for corners as six floats each, the rest of each lane having been padded once.
+  void gather(const float* transforms, std::size_t count, Lanes& lanes)
+  {
+    for (std::size_t i = 0; i < count; ++i, transforms += 6)
+    {
+      lanes.x[i]        = transforms[0];
+      lanes.y[i]        = transforms[1];
+      lanes.width[i]    = transforms[2];
+      lanes.height[i]   = transforms[3];
+      lanes.scale[i]    = transforms[4];
+      lanes.rotation[i] = wrap(transforms[5]);
+    }
+    for (std::size_t i = count; i < LANES; ++i)
+    {
+      pad(i, lanes);
+    }
+  }
+
+  /// Centred quads become sprites whose top left is half their size from the centre.
+  void gather(const pyasge::CentredQuads& source, std::size_t first, std::size_t count, Lanes& lanes)
+  {
+    for (std::size_t i = 0; i < LANES; ++i)
+    {
+      if (i >= count)
+      {
+        pad(i, lanes);
+        continue;
+      }
+
+      const auto n      = first + i;
+      lanes.x[i]        = source.x[n] - source.half_w[n];
+      lanes.y[i]        = source.y[n] - source.half_h[n];
+      lanes.width[i]    = source.half_w[n] * 2.0F;
+      lanes.height[i]   = source.half_h[n] * 2.0F;
+      lanes.scale[i]    = 1.0F;
+      lanes.rotation[i] = source.angle != nullptr ? wrap(source.angle[n]) : 0.0F;
+      lanes.src_x[i]    = source.uvs[0];
+      lanes.src_y[i]    = source.uvs[1];
+      lanes.src_w[i]    = source.uvs[2] - source.uvs[0];
+      lanes.src_h[i]    = source.uvs[3] - source.uvs[1];
+      lanes.tex_w[i]    = 1.0F;
+      lanes.tex_h[i]    = 1.0F;
+      lanes.r[i]        = source.r[n];
+      lanes.g[i]        = source.g[n];
+      lanes.b[i]        = source.b[n];
+      lanes.a[i]        = source.a[n];
+      lanes.flip_x[i] = lanes.flip_y[i] = lanes.flip_xy[i] = 0U;
+    }
+  }
+
+  // each kernel below performs exactly these operations in exactly this
+  // order, so any difference between them is a bug rather than rounding
+
+  void sinCos(float angle, float& sine, float& cosine)
+  {
+    const float quadrant = std::nearbyint(angle * TWO_OVER_PI);
+    float r              = angle - quadrant * PIO2_1;
+    r                    = r - quadrant * PIO2_2;
+    r                    = r - quadrant * PIO2_3;
+    const float z        = r * r;
+    const float s        = r + (r * z) * (SIN_1 + z * (SIN_2 + z * SIN_3));
+    const float c        = (1.0F - 0.5F * z) + (z * z) * (COS_1 + z * (COS_2 + z * COS_3));
+
+    // the quadrant swaps the two and decides their signs
+    const auto q = static_cast<std::int32_t>(quadrant);
+    sine         = (q & 1) != 0 ? c : s;
+    cosine       = (q & 1) != 0 ? s : c;
+    sine         = (q & 2) != 0 ? -sine : sine;
+    cosine       = ((q + 1) & 2) != 0 ? -cosine : cosine;
+  }
+
+  void transformScalar(const Lanes& lanes, Quad* quads)
+  {
+    for (std::size_t i = 0; i < LANES; ++i)
+    {
+      float sine   = 0.0F;
+      float cosine = 0.0F;
+      sinCos(lanes.rotation[i], sine, cosine);
+
+      // the scaled quad's top left sits at the sprite's position and it turns about its centre
+      const float half_w = (lanes.width[i] * lanes.scale[i]) * 0.5F;
+      const float half_h = (lanes.height[i] * lanes.scale[i]) * 0.5F;
+      const float cx     = lanes.x[i] + half_w;
+      const float cy     = lanes.y[i] + half_h;
+      const float ax     = half_w * cosine;
+      const float ay     = half_w * sine;
+      const float bx     = half_h * sine;
+      const float by     = half_h * cosine;
+      const float x0     = cx - ax;
+      const float x1     = cx + ax;
+      const float y0     = cy - ay;
+      const float y1     = cy + ay;
+
+      // flipping swaps the rectangle's edges, and a diagonal flip swaps two corners
+      float u0 = lanes.src_x[i] / lanes.tex_w[i];
+      float u1 = (lanes.src_x[i] + lanes.src_w[i]) / lanes.tex_w[i];
+      float v0 = lanes.src_y[i] / lanes.tex_h[i];
+      float v1 = (lanes.src_y[i] + lanes.src_h[i]) / lanes.tex_h[i];
+      if (lanes.flip_x[i] != 0U)
+      {
+        std::swap(u0, u1);
+      }
+      if (lanes.flip_y[i] != 0U)
+      {
+        std::swap(v0, v1);
+      }
+      const bool diagonal = lanes.flip_xy[i] != 0U;
+
+      const float r = lanes.r[i];
+      const float g = lanes.g[i];
+      const float b = lanes.b[i];
+      const float a = lanes.a[i];
+      quads[i]      = { { { x0 + bx, y0 - by, u0, v0, r, g, b, a },
+                          { x1 + bx, y1 - by, diagonal ? u0 : u1, diagonal ? v1 : v0, r, g, b, a },
+                          { x1 - bx, y1 + by, u1, v1, r, g, b, a },
+                          { x0 - bx, y0 + by, diagonal ? u1 : u0, diagonal ? v0 : v1, r, g, b, a } } };
+    }
+  }
+
+#ifdef PYASGE_X86
+  PYASGE_TARGET("sse4.1")
+  inline void sinCos(const __m128& angle, __m128& sine, __m128& cosine)
+  {
+    const __m128 quadrant =
+      _mm_round_ps(_mm_mul_ps(angle, _mm_set1_ps(TWO_OVER_PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m128 r       = _mm_sub_ps(angle, _mm_mul_ps(quadrant, _mm_set1_ps(PIO2_1)));
+    r              = _mm_sub_ps(r, _mm_mul_ps(quadrant, _mm_set1_ps(PIO2_2)));
+    r              = _mm_sub_ps(r, _mm_mul_ps(quadrant, _mm_set1_ps(PIO2_3)));
+    const __m128 z = _mm_mul_ps(r, r);
+
+    __m128 s = _mm_add_ps(_mm_set1_ps(SIN_2), _mm_mul_ps(z, _mm_set1_ps(SIN_3)));
+    s        = _mm_add_ps(_mm_set1_ps(SIN_1), _mm_mul_ps(z, s));
+    s        = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, z), s));
+    __m128 c = _mm_add_ps(_mm_set1_ps(COS_2), _mm_mul_ps(z, _mm_set1_ps(COS_3)));
+    c        = _mm_add_ps(_mm_set1_ps(COS_1), _mm_mul_ps(z, c));
+    c = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.0F), _mm_mul_ps(_mm_set1_ps(0.5F), z)), _mm_mul_ps(_mm_mul_ps(z, z), c));
+
+    const __m128i q    = _mm_cvtps_epi32(quadrant);
+    const __m128i one  = _mm_set1_epi32(1);
+    const __m128i two  = _mm_set1_epi32(2);
+    const __m128 swap  = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, one), one));
+    const __m128 sin_n = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, two), 30));
+    const __m128 cos_n = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, one), two), 30));
+    sine               = _mm_xor_ps(_mm_blendv_ps(s, c, swap), sin_n);
+    cosine             = _mm_xor_ps(_mm_blendv_ps(c, s, swap), cos_n);
+  }
+
+  PYASGE_TARGET("sse4.1")
+  inline void storeCorner(Quad* quads, std::size_t corner, __m128 x, __m128 y, __m128 u, __m128 v, const __m128* tints)
+  {
+    _MM_TRANSPOSE4_PS(x, y, u, v);
+    const __m128 vertices[4] = { x, y, u, v };
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+      auto* out = &quads[i][corner].x;
+      _mm_storeu_ps(out, vertices[i]);
+      _mm_storeu_ps(out + 4, tints[i]);
+    }
+  }
+
+  PYASGE_TARGET("sse4.1")
+  void transformSSE4(const Lanes& lanes, Quad* quads)
+  {
+    const __m128 half = _mm_set1_ps(0.5F);
+    for (std::size_t o = 0; o < LANES; o += 4)
+    {
+      __m128 sine;
+      __m128 cosine;
+      sinCos(_mm_load_ps(lanes.rotation + o), sine, cosine);
+
+      const __m128 scale  = _mm_load_ps(lanes.scale + o);
+      const __m128 half_w = _mm_mul_ps(_mm_mul_ps(_mm_load_ps(lanes.width + o), scale), half);
+      const __m128 half_h = _mm_mul_ps(_mm_mul_ps(_mm_load_ps(lanes.height + o), scale), half);
+      const __m128 cx     = _mm_add_ps(_mm_load_ps(lanes.x + o), half_w);
+      const __m128 cy     = _mm_add_ps(_mm_load_ps(lanes.y + o), half_h);
+      const __m128 ax     = _mm_mul_ps(half_w, cosine);
+      const __m128 ay     = _mm_mul_ps(half_w, sine);
+      const __m128 bx     = _mm_mul_ps(half_h, sine);
+      const __m128 by     = _mm_mul_ps(half_h, cosine);
+      const __m128 x0     = _mm_sub_ps(cx, ax);
+      const __m128 x1     = _mm_add_ps(cx, ax);
+      const __m128 y0     = _mm_sub_ps(cy, ay);
+      const __m128 y1     = _mm_add_ps(cy, ay);
+
+      const __m128 src_x = _mm_load_ps(lanes.src_x + o);
+      const __m128 src_y = _mm_load_ps(lanes.src_y + o);
+      const __m128 tex_w = _mm_load_ps(lanes.tex_w + o);
+      const __m128 tex_h = _mm_load_ps(lanes.tex_h + o);
+      const __m128 left  = _mm_div_ps(src_x, tex_w);
+      const __m128 right = _mm_div_ps(_mm_add_ps(src_x, _mm_load_ps(lanes.src_w + o)), tex_w);
+      const __m128 top   = _mm_div_ps(src_y, tex_h);
+      const __m128 bot   = _mm_div_ps(_mm_add_ps(src_y, _mm_load_ps(lanes.src_h + o)), tex_h);
+      const __m128 fx    = _mm_castsi128_ps(_mm_load_si128(reinterpret_cast<const __m128i*>(lanes.flip_x + o)));
+      const __m128 fy    = _mm_castsi128_ps(_mm_load_si128(reinterpret_cast<const __m128i*>(lanes.flip_y + o)));
+      const __m128 fxy   = _mm_castsi128_ps(_mm_load_si128(reinterpret_cast<const __m128i*>(lanes.flip_xy + o)));
+      const __m128 u0    = _mm_blendv_ps(left, right, fx);
+      const __m128 u1    = _mm_blendv_ps(right, left, fx);
+      const __m128 v0    = _mm_blendv_ps(top, bot, fy);
+      const __m128 v1    = _mm_blendv_ps(bot, top, fy);
+
+      __m128 r = _mm_load_ps(lanes.r + o);
+      __m128 g = _mm_load_ps(lanes.g + o);
+      __m128 b = _mm_load_ps(lanes.b + o);
+      __m128 a = _mm_load_ps(lanes.a + o);
+      _MM_TRANSPOSE4_PS(r, g, b, a);
+      const __m128 tints[4] = { r, g, b, a };
+
+      auto* out = quads + o;
+      storeCorner(out, 0, _mm_add_ps(x0, bx), _mm_sub_ps(y0, by), u0, v0, tints);
+      storeCorner(
+        out, 1, _mm_add_ps(x1, bx), _mm_sub_ps(y1, by), _mm_blendv_ps(u1, u0, fxy), _mm_blendv_ps(v0, v1, fxy),
+        tints);
+      storeCorner(out, 2, _mm_sub_ps(x1, bx), _mm_add_ps(y1, by), u1, v1, tints);
+      storeCorner(
+        out, 3, _mm_sub_ps(x0, bx), _mm_add_ps(y0, by), _mm_blendv_ps(u0, u1, fxy), _mm_blendv_ps(v1, v0, fxy),
+        tints);
+    }
+  }
+
+  PYASGE_TARGET("avx2")
+  inline void sinCos(const __m256& angle, __m256& sine, __m256& cosine)
+  {
+    const __m256 quadrant =
+      _mm256_round_ps(_mm256_mul_ps(angle, _mm256_set1_ps(TWO_OVER_PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256 r       = _mm256_sub_ps(angle, _mm256_mul_ps(quadrant, _mm256_set1_ps(PIO2_1)));
+    r              = _mm256_sub_ps(r, _mm256_mul_ps(quadrant, _mm256_set1_ps(PIO2_2)));
+    r              = _mm256_sub_ps(r, _mm256_mul_ps(quadrant, _mm256_set1_ps(PIO2_3)));
+    const __m256 z = _mm256_mul_ps(r, r);
+
+    __m256 s = _mm256_add_ps(_mm256_set1_ps(SIN_2), _mm256_mul_ps(z, _mm256_set1_ps(SIN_3)));
+    s        = _mm256_add_ps(_mm256_set1_ps(SIN_1), _mm256_mul_ps(z, s));
+    s        = _mm256_add_ps(r, _mm256_mul_ps(_mm256_mul_ps(r, z), s));
+    __m256 c = _mm256_add_ps(_mm256_set1_ps(COS_2), _mm256_mul_ps(z, _mm256_set1_ps(COS_3)));
+    c        = _mm256_add_ps(_mm256_set1_ps(COS_1), _mm256_mul_ps(z, c));
+    c        = _mm256_add_ps(
+      _mm256_sub_ps(_mm256_set1_ps(1.0F), _mm256_mul_ps(_mm256_set1_ps(0.5F), z)),
+      _mm256_mul_ps(_mm256_mul_ps(z, z), c));
+
+    const __m256i q    = _mm256_cvtps_epi32(quadrant);
+    const __m256i one  = _mm256_set1_epi32(1);
+    const __m256i two  = _mm256_set1_epi32(2);
+    const __m256 swap  = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(q, one), one));
+    const __m256 sin_n = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(q, two), 30));
+    const __m256 cos_n =
+      _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(q, one), two), 30));
+    sine   = _mm256_xor_ps(_mm256_blendv_ps(s, c, swap), sin_n);
+    cosine = _mm256_xor_ps(_mm256_blendv_ps(c, s, swap), cos_n);
+  }
+
+  /// Transposes within each half, leaving sprite i in the low half and sprite i + 4 in the high half.
+  PYASGE_TARGET("avx2")
+  inline void transpose(__m256& x, __m256& y, __m256& z, __m256& w)
+  {
+    const __m256 t0 = _mm256_unpacklo_ps(x, y);
+    const __m256 t1 = _mm256_unpackhi_ps(x, y);
+    const __m256 t2 = _mm256_unpacklo_ps(z, w);
+    const __m256 t3 = _mm256_unpackhi_ps(z, w);
+    x               = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    y               = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    z               = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    w               = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+  }
+
+  PYASGE_TARGET("avx2")
+  inline void storeCorner(Quad* quads, std::size_t corner, __m256 x, __m256 y, __m256 u, __m256 v, const __m256* tints)
+  {
+    // each vertex is a single 32 byte store of its position and texture coordinates, then its tint
+    transpose(x, y, u, v);
+    const __m256 vertices[4] = { x, y, u, v };
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+      _mm256_storeu_ps(&quads[i][corner].x, _mm256_permute2f128_ps(vertices[i], tints[i], 0x20));
+      _mm256_storeu_ps(&quads[i + 4][corner].x, _mm256_permute2f128_ps(vertices[i], tints[i], 0x31));
+    }
+  }
+
+  PYASGE_TARGET("avx2")
+  void transformAVX2(const Lanes& lanes, Quad* quads)
+  {
+    __m256 sine;
+    __m256 cosine;
+    sinCos(_mm256_load_ps(lanes.rotation), sine, cosine);
+
+    const __m256 half   = _mm256_set1_ps(0.5F);
+    const __m256 scale  = _mm256_load_ps(lanes.scale);
+    const __m256 half_w = _mm256_mul_ps(_mm256_mul_ps(_mm256_load_ps(lanes.width), scale), half);
+    const __m256 half_h = _mm256_mul_ps(_mm256_mul_ps(_mm256_load_ps(lanes.height), scale), half);
+    const __m256 cx     = _mm256_add_ps(_mm256_load_ps(lanes.x), half_w);
+    const __m256 cy     = _mm256_add_ps(_mm256_load_ps(lanes.y), half_h);
+    const __m256 ax     = _mm256_mul_ps(half_w, cosine);
+    const __m256 ay     = _mm256_mul_ps(half_w, sine);
+    const __m256 bx     = _mm256_mul_ps(half_h, sine);
+    const __m256 by     = _mm256_mul_ps(half_h, cosine);
+    const __m256 x0     = _mm256_sub_ps(cx, ax);
+    const __m256 x1     = _mm256_add_ps(cx, ax);
+    const __m256 y0     = _mm256_sub_ps(cy, ay);
+    const __m256 y1     = _mm256_add_ps(cy, ay);
+
+    const __m256 src_x = _mm256_load_ps(lanes.src_x);
+    const __m256 src_y = _mm256_load_ps(lanes.src_y);
+    const __m256 tex_w = _mm256_load_ps(lanes.tex_w);
+    const __m256 tex_h = _mm256_load_ps(lanes.tex_h);
+    const __m256 left  = _mm256_div_ps(src_x, tex_w);
+    const __m256 right = _mm256_div_ps(_mm256_add_ps(src_x, _mm256_load_ps(lanes.src_w)), tex_w);
+    const __m256 top   = _mm256_div_ps(src_y, tex_h);
+    const __m256 bot   = _mm256_div_ps(_mm256_add_ps(src_y, _mm256_load_ps(lanes.src_h)), tex_h);
+    const __m256 fx    = _mm256_castsi256_ps(_mm256_load_si256(reinterpret_cast<const __m256i*>(lanes.flip_x)));
+    const __m256 fy    = _mm256_castsi256_ps(_mm256_load_si256(reinterpret_cast<const __m256i*>(lanes.flip_y)));
+    const __m256 fxy   = _mm256_castsi256_ps(_mm256_load_si256(reinterpret_cast<const __m256i*>(lanes.flip_xy)));
+    const __m256 u0    = _mm256_blendv_ps(left, right, fx);
+    const __m256 u1    = _mm256_blendv_ps(right, left, fx);
+    const __m256 v0    = _mm256_blendv_ps(top, bot, fy);
+    const __m256 v1    = _mm256_blendv_ps(bot, top, fy);
+
+    __m256 r = _mm256_load_ps(lanes.r);
+    __m256 g = _mm256_load_ps(lanes.g);
+    __m256 b = _mm256_load_ps(lanes.b);
+    __m256 a = _mm256_load_ps(lanes.a);
+    transpose(r, g, b, a);
+    const __m256 tints[4] = { r, g, b, a };
+
+    storeCorner(quads, 0, _mm256_add_ps(x0, bx), _mm256_sub_ps(y0, by), u0, v0, tints);
+    storeCorner(
+      quads, 1, _mm256_add_ps(x1, bx), _mm256_sub_ps(y1, by), _mm256_blendv_ps(u1, u0, fxy),
+      _mm256_blendv_ps(v0, v1, fxy), tints);
+    storeCorner(quads, 2, _mm256_sub_ps(x1, bx), _mm256_add_ps(y1, by), u1, v1, tints);
+    storeCorner(
+      quads, 3, _mm256_sub_ps(x0, bx), _mm256_add_ps(y0, by), _mm256_blendv_ps(u0, u1, fxy),
+      _mm256_blendv_ps(v1, v0, fxy), tints);
+  }
+#endif
+
+#ifdef PYASGE_NEON
+  inline void sinCos(float32x4_t angle, float32x4_t& sine, float32x4_t& cosine)
+  {
+    const float32x4_t quadrant = vrndnq_f32(vmulq_f32(angle, vdupq_n_f32(TWO_OVER_PI)));
+    float32x4_t r              = vsubq_f32(angle, vmulq_f32(quadrant, vdupq_n_f32(PIO2_1)));
+    r                          = vsubq_f32(r, vmulq_f32(quadrant, vdupq_n_f32(PIO2_2)));
+    r                          = vsubq_f32(r, vmulq_f32(quadrant, vdupq_n_f32(PIO2_3)));
+    const float32x4_t z        = vmulq_f32(r, r);
+
+    float32x4_t s = vaddq_f32(vdupq_n_f32(SIN_2), vmulq_f32(z, vdupq_n_f32(SIN_3)));
+    s             = vaddq_f32(vdupq_n_f32(SIN_1), vmulq_f32(z, s));
+    s             = vaddq_f32(r, vmulq_f32(vmulq_f32(r, z), s));
+    float32x4_t c = vaddq_f32(vdupq_n_f32(COS_2), vmulq_f32(z, vdupq_n_f32(COS_3)));
+    c             = vaddq_f32(vdupq_n_f32(COS_1), vmulq_f32(z, c));
+    c = vaddq_f32(vsubq_f32(vdupq_n_f32(1.0F), vmulq_f32(vdupq_n_f32(0.5F), z)), vmulq_f32(vmulq_f32(z, z), c));
+
+    const int32x4_t q        = vcvtq_s32_f32(quadrant);
+    const int32x4_t one      = vdupq_n_s32(1);
+    const int32x4_t two      = vdupq_n_s32(2);
+    const uint32x4_t swap    = vceqq_s32(vandq_s32(q, one), one);
+    const uint32x4_t sin_n   = vshlq_n_u32(vreinterpretq_u32_s32(vandq_s32(q, two)), 30);
+    const uint32x4_t cos_n   = vshlq_n_u32(vreinterpretq_u32_s32(vandq_s32(vaddq_s32(q, one), two)), 30);
+    sine   = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vbslq_f32(swap, c, s)), sin_n));
+    cosine = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vbslq_f32(swap, s, c)), cos_n));
+  }
+
+  inline void transpose(float32x4_t& x, float32x4_t& y, float32x4_t& z, float32x4_t& w)
+  {
+    const float32x4x2_t xy = vtrnq_f32(x, y);
+    const float32x4x2_t zw = vtrnq_f32(z, w);
+    x                      = vcombine_f32(vget_low_f32(xy.val[0]), vget_low_f32(zw.val[0]));
+    y                      = vcombine_f32(vget_low_f32(xy.val[1]), vget_low_f32(zw.val[1]));
+    z                      = vcombine_f32(vget_high_f32(xy.val[0]), vget_high_f32(zw.val[0]));
+    w                      = vcombine_f32(vget_high_f32(xy.val[1]), vget_high_f32(zw.val[1]));
+  }
+
+  inline void storeCorner(
+    Quad* quads, std::size_t corner, float32x4_t x, float32x4_t y, float32x4_t u, float32x4_t v,
+    const float32x4_t* tints)
+  {
+    transpose(x, y, u, v);
+    const float32x4_t vertices[4] = { x, y, u, v };
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+      auto* out = &quads[i][corner].x;
+      vst1q_f32(out, vertices[i]);
+      vst1q_f32(out + 4, tints[i]);
+    }
+  }
+
+  void transformNEON(const Lanes& lanes, Quad* quads)
+  {
+    const float32x4_t half = vdupq_n_f32(0.5F);
+    for (std::size_t o = 0; o < LANES; o += 4)
+    {
+      float32x4_t sine;
+      float32x4_t cosine;
+      sinCos(vld1q_f32(lanes.rotation + o), sine, cosine);
+
+      const float32x4_t scale  = vld1q_f32(lanes.scale + o);
+      const float32x4_t half_w = vmulq_f32(vmulq_f32(vld1q_f32(lanes.width + o), scale), half);
+      const float32x4_t half_h = vmulq_f32(vmulq_f32(vld1q_f32(lanes.height + o), scale), half);
+      const float32x4_t cx     = vaddq_f32(vld1q_f32(lanes.x + o), half_w);
+      const float32x4_t cy     = vaddq_f32(vld1q_f32(lanes.y + o), half_h);
+      const float32x4_t ax     = vmulq_f32(half_w, cosine);
+      const float32x4_t ay     = vmulq_f32(half_w, sine);
+      const float32x4_t bx     = vmulq_f32(half_h, sine);
+      const float32x4_t by     = vmulq_f32(half_h, cosine);
+      const float32x4_t x0     = vsubq_f32(cx, ax);
+      const float32x4_t x1     = vaddq_f32(cx, ax);
+      const float32x4_t y0     = vsubq_f32(cy, ay);
+      const float32x4_t y1     = vaddq_f32(cy, ay);
+
+      const float32x4_t src_x = vld1q_f32(lanes.src_x + o);
+      const float32x4_t src_y = vld1q_f32(lanes.src_y + o);
+      const float32x4_t tex_w = vld1q_f32(lanes.tex_w + o);
+      const float32x4_t tex_h = vld1q_f32(lanes.tex_h + o);
+      const float32x4_t left  = vdivq_f32(src_x, tex_w);
+      const float32x4_t right = vdivq_f32(vaddq_f32(src_x, vld1q_f32(lanes.src_w + o)), tex_w);
+      const float32x4_t top   = vdivq_f32(src_y, tex_h);
+      const float32x4_t bot   = vdivq_f32(vaddq_f32(src_y, vld1q_f32(lanes.src_h + o)), tex_h);
+      const uint32x4_t fx     = vld1q_u32(lanes.flip_x + o);
+      const uint32x4_t fy     = vld1q_u32(lanes.flip_y + o);
+      const uint32x4_t fxy    = vld1q_u32(lanes.flip_xy + o);
+      const float32x4_t u0    = vbslq_f32(fx, right, left);
+      const float32x4_t u1    = vbslq_f32(fx, left, right);
+      const float32x4_t v0    = vbslq_f32(fy, bot, top);
+      const float32x4_t v1    = vbslq_f32(fy, top, bot);
+
+      float32x4_t r = vld1q_f32(lanes.r + o);
+      float32x4_t g = vld1q_f32(lanes.g + o);
+      float32x4_t b = vld1q_f32(lanes.b + o);
+      float32x4_t a = vld1q_f32(lanes.a + o);
+      transpose(r, g, b, a);
+      const float32x4_t tints[4] = { r, g, b, a };
+
+      auto* out = quads + o;
+      storeCorner(out, 0, vaddq_f32(x0, bx), vsubq_f32(y0, by), u0, v0, tints);
+      storeCorner(out, 1, vaddq_f32(x1, bx), vsubq_f32(y1, by), vbslq_f32(fxy, u0, u1), vbslq_f32(fxy, v1, v0), tints);
+      storeCorner(out, 2, vsubq_f32(x1, bx), vaddq_f32(y1, by), u1, v1, tints);
+      storeCorner(out, 3, vsubq_f32(x0, bx), vaddq_f32(y0, by), vbslq_f32(fxy, u1, u0), vbslq_f32(fxy, v0, v1), tints);
+    }
+  }
+#endif
+
+  std::array<bool, 4> detect() noexcept
+  {
+    std::array<bool, 4> supported = { true, false, false, false };
+#if defined(PYASGE_X86) && defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    const int highest = info[0];
+    __cpuid(info, 1);
+    supported[static_cast<std::size_t>(VertexKernel::SSE4)] = (info[2] & (1 << 19)) != 0;
+
+    // AVX also needs the operating system to preserve the wider registers
+    const bool saves_ymm = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+    if (highest >= 7 && saves_ymm)
+    {
+      __cpuidex(info, 7, 0);
+      supported[static_cast<std::size_t>(VertexKernel::AVX2)] = (info[1] & (1 << 5)) != 0;
+    }
+#elif defined(PYASGE_X86)
+    __builtin_cpu_init();
+    supported[static_cast<std::size_t>(VertexKernel::SSE4)] = __builtin_cpu_supports("sse4.1") != 0;
+    supported[static_cast<std::size_t>(VertexKernel::AVX2)] = __builtin_cpu_supports("avx2") != 0;
+#elif defined(PYASGE_NEON)
+    supported[static_cast<std::size_t>(VertexKernel::NEON)] = true;
+#endif
+    return supported;
+  }
+
+  Transform transformFor(VertexKernel kernel) noexcept
+  {
+    if (!pyasge::vertexKernelSupported(kernel))
+    {
+      return transformScalar;
+    }
+
+    switch (kernel)
+    {
+#ifdef PYASGE_X86
+      case VertexKernel::SSE4:
+        return transformSSE4;
+      case VertexKernel::AVX2:
+        return transformAVX2;
+#endif
+#ifdef PYASGE_NEON
+      case VertexKernel::NEON:
+        return transformNEON;
+#endif
+      default:
+        return transformScalar;
+    }
+  }
+
+  std::atomic<std::size_t> checked{ 0 };
+  std::atomic<bool> disagrees{ false };
+
+  bool close(const pyasge::QuadVertex& lhs, const pyasge::QuadVertex& rhs, float extent)
+  {
+    const float tolerance = 1e-4F * (1.0F + std::fabs(rhs.x) + std::fabs(rhs.y) + extent);
+    return std::fabs(lhs.x - rhs.x) <= tolerance && std::fabs(lhs.y - rhs.y) <= tolerance &&
+           std::fabs(lhs.u - rhs.u) <= 1e-6F && std::fabs(lhs.v - rhs.v) <= 1e-6F && lhs.r == rhs.r &&
+           lhs.g == rhs.g && lhs.b == rhs.b && lhs.a == rhs.a;
+  }
+
+  /// \brief   Compares transformed sprites with the quads the engine's bounds give.
+  /// \details Only sprites that are rotated or scaled tell the two apart,
+  ///          and only the first few of those are compared.
+  bool agrees(const ASGE::Sprite* const* sprites, std::size_t count, const Quad* quads)
+  {
+    for (std::size_t i = 0; i < count && checked.load(std::memory_order_relaxed) < CHECKED; ++i)
+    {
+      const auto& sprite = *sprites[i];
+      Quad expected;
+      if ((sprite.rotationInRadians() == 0.0F && sprite.scale() == 1.0F) || !pyasge::spriteQuad(sprite, expected))
+      {
+        continue;
+      }
+
+      checked.fetch_add(1, std::memory_order_relaxed);
+      const float extent = std::fabs(expected[2].x - expected[0].x) + std::fabs(expected[2].y - expected[0].y);
+      for (std::size_t corner = 0; corner < expected.size(); ++corner)
+      {
+        if (!close(quads[i][corner], expected[corner], extent))
+        {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  void worldCorners(const ASGE::Sprite& sprite, float* corners)
+  {
+    const auto bounds = sprite.getWorldBounds();
+    const float world[8] = { bounds.v1.x, bounds.v1.y, bounds.v2.x, bounds.v2.y,
+                             bounds.v3.x, bounds.v3.y, bounds.v4.x, bounds.v4.y };
+    std::copy_n(world, 8, corners);
+  }
+
+  /// Corners are compared with the engine's bounds directly, so sprites without a texture count too.
+  bool cornersAgree(const ASGE::Sprite* const* sprites, std::size_t count, const float* corners)
+  {
+    for (std::size_t i = 0; i < count && checked.load(std::memory_order_relaxed) < CHECKED; ++i)
+    {
+      const auto& sprite = *sprites[i];
+      if (sprite.rotationInRadians() == 0.0F && sprite.scale() == 1.0F)
+      {
+        continue;
+      }
+
+      checked.fetch_add(1, std::memory_order_relaxed);
+      float expected[8];
+      worldCorners(sprite, expected);
+      const float extent = std::fabs(expected[4] - expected[0]) + std::fabs(expected[5] - expected[1]);
+      for (std::size_t n = 0; n < 8; n += 2)
+      {
+        const float tolerance = 1e-4F * (1.0F + std::fabs(expected[n]) + std::fabs(expected[n + 1]) + extent);
+        if (
+          !(std::fabs(corners[i * 8 + n] - expected[n]) <= tolerance) ||
+          !(std::fabs(corners[i * 8 + n + 1] - expected[n + 1]) <= tolerance))
+        {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+}
+
+bool pyasge::vertexKernelSupported(VertexKernel kernel) noexcept
+{
+  static const auto supported = detect();
+  return supported[static_cast<std::size_t>(kernel)];
+}
+
+pyasge::VertexKernel pyasge::bestVertexKernel() noexcept
+{
+  static const auto best = []
+  {
+    for (auto kernel : { VertexKernel::AVX2, VertexKernel::NEON, VertexKernel::SSE4 })
+    {
+      if (vertexKernelSupported(kernel))
+      {
+        return kernel;
+      }
+    }
+    return VertexKernel::SCALAR;
+  }();
+  return best;
+}
+
+const char* pyasge::vertexKernelName(VertexKernel kernel) noexcept
+{
+  switch (kernel)
+  {
+    case VertexKernel::SSE4:
+      return "sse4";
+    case VertexKernel::AVX2:
+      return "avx2";
+    case VertexKernel::NEON:
+      return "neon";
+    default:
+      return "scalar";
+  }
+}
+
+void pyasge::spriteQuads(const ASGE::Sprite* const* sprites, std::size_t count, Quad* quads)
+{
+  if (!disagrees.load(std::memory_order_relaxed))
+  {
+    spriteQuads(sprites, count, quads, bestVertexKernel());
+    if (checked.load(std::memory_order_relaxed) >= CHECKED || agrees(sprites, count, quads))
+    {
+      return;
+    }
+
+    disagrees.store(true, std::memory_order_relaxed);
+    Logging::WARN("Sprite quads differ from the engine's bounds, building them from the bounds instead");
+  }
+
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    quads[i] = {};
+    spriteQuad(*sprites[i], quads[i]);
+  }
+}
+
+void pyasge::spriteQuads(const ASGE::Sprite* const* sprites, std::size_t count, Quad* quads, VertexKernel kernel)
+{
+  const auto transform = transformFor(kernel);
+  Lanes lanes;
+  for (std::size_t first = 0; first < count; first += LANES)
+  {
+    const auto remaining = std::min(LANES, count - first);
+    gather(sprites + first, remaining, lanes);
+    if (remaining == LANES)
+    {
+      transform(lanes, quads + first);
+      continue;
+    }
+
+    std::array<Quad, LANES> tail;
+    transform(lanes, tail.data());
+    std::copy_n(tail.begin(), remaining, quads + first);
+  }
+}
+
+void pyasge::centredQuads(const CentredQuads& source, std::size_t count, Quad* quads, VertexKernel kernel)
+{
+  const auto transform = transformFor(kernel);
+  Lanes lanes;
+  for (std::size_t first = 0; first < count; first += LANES)
+  {
+    const auto remaining = std::min(LANES, count - first);
+    gather(source, first, remaining, lanes);
+    if (remaining == LANES)
+    {
+      transform(lanes, quads + first);
+      continue;
+    }
+
+    std::array<Quad, LANES> tail;
+    transform(lanes, tail.data());
+    std::copy_n(tail.begin(), remaining, quads + first);
+  }
+}
+
+void pyasge::spriteCorners(
+  const ASGE::Sprite* const* sprites, const float* transforms, std::size_t count, float* corners)
+{
+  if (!disagrees.load(std::memory_order_relaxed))
+  {
+    transformCorners(transforms, count, corners, bestVertexKernel());
+    if (checked.load(std::memory_order_relaxed) >= CHECKED || cornersAgree(sprites, count, corners))
+    {
+      return;
+    }
+
+    disagrees.store(true, std::memory_order_relaxed);
+    Logging::WARN("Sprite quads differ from the engine's bounds, building them from the bounds instead");
+  }
+
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    worldCorners(*sprites[i], corners + i * 8);
+  }
+}
+
+void pyasge::transformCorners(const float* transforms, std::size_t count, float* corners, VertexKernel kernel)
+{
+  const auto transform = transformFor(kernel);
+  Lanes lanes;
+  for (std::size_t i = 0; i < LANES; ++i)
+  {
+    pad(i, lanes);
+  }
+
+  std::array<Quad, LANES> quads;
+  for (std::size_t first = 0; first < count; first += LANES)
+  {
+    const auto remaining = std::min(LANES, count - first);
+    gather(transforms + first * 6, remaining, lanes);
+    transform(lanes, quads.data());
+    for (std::size_t i = 0; i < remaining; ++i)
+    {
+      auto* out = corners + (first + i) * 8;
+      for (const auto& vertex : quads[i])
+      {
+        *out++ = vertex.x;
+        *out++ = vertex.y;
+      }
+    }
+  }
+}
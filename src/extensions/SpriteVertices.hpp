@@ -0,0 +1,102 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "extensions/Quads.hpp"
+
+#include <array>
+#include <cstddef>
+
+namespace ASGE
+{
+  class Sprite;
+}
+
+namespace pyasge
+{
+  /// \brief   The instruction sets sprite quads can be generated with.
+  enum class VertexKernel
+  {
+    SCALAR, ///< one sprite at a time, the reference the others must match
+    SSE4,   ///< four sprites at a time using SSE4.1
+    AVX2,   ///< eight sprites at a time using AVX2
+    NEON,   ///< four sprites at a time using NEON
+  };
+
+  /// \brief   Returns true if the processor running the module can use a kernel.
+  bool vertexKernelSupported(VertexKernel kernel) noexcept;
+
+  /// \brief   The widest kernel the processor supports, detected once.
+  VertexKernel bestVertexKernel() noexcept;
+
+  /// \brief   The kernel's lower case name, as used by the Python bindings.
+  const char* vertexKernelName(VertexKernel kernel) noexcept;
+
+  /// \brief   Builds the quads for a list of sprites, several at a time.
+  /// \details Each sprite's position, size, scale, rotation, source
+  ///          rectangle, flip flags and tint are gathered into lanes, and
+  ///          a kernel turns up to eight sprites at once into their four
+  ///          corners. Rotation uses a polynomial sine and cosine evaluated
+  ///          with the same operations, in the same order, by every kernel,
+  ///          so every kernel's output is bit for bit that of the scalar
+  ///          one. Sprites without a texture are given zero texture
+  ///          coordinates; callers skip them as they would for spriteQuad.
+  ///
+  ///          The quads differ from spriteQuad's only in the last bits of
+  ///          the sine and cosine. The first sprites transformed are checked
+  ///          against the engine's own bounds, and should they disagree the
+  ///          quads are built by spriteQuad from then on.
+  void spriteQuads(const ASGE::Sprite* const* sprites, std::size_t count, Quad* quads);
+
+  /// \brief   Builds the quads for a list of sprites with a particular kernel.
+  /// \details Unsupported kernels fall back to the scalar one. Unlike the
+  ///          overload above the quads are never checked against the engine.
+  void spriteQuads(const ASGE::Sprite* const* sprites, std::size_t count, Quad* quads, VertexKernel kernel);
+
+  /// \brief   Builds the 4 world space corners of each sprite, as 8 floats.
+  /// \details The transforms are each sprite's position, size, scale and
+  ///          rotation, 6 floats apiece, as already read by the caller. The
+  ///          kernels turn them into the corners spriteQuads would give, and
+  ///          those are checked against the engine's bounds in the same way,
+  ///          coming from getWorldBounds instead should the two disagree.
+  void spriteCorners(const ASGE::Sprite* const* sprites, const float* transforms, std::size_t count, float* corners);
+
+  /// \brief   Builds corners from transforms with a particular kernel, never checked against the engine.
+  void transformCorners(const float* transforms, std::size_t count, float* corners, VertexKernel kernel);
+
+  /// \brief   Quads turned about their centres, an array per property.
+  /// \details Every array holds a value per quad. Without angles the quads
+  ///          are left unturned. All of them share the same texture
+  ///          coordinates, given as the left, top, right and bottom edges.
+  struct CentredQuads
+  {
+    const float* x;
+    const float* y;
+    const float* half_w;
+    const float* half_h;
+    const float* angle;
+    const float* r;
+    const float* g;
+    const float* b;
+    const float* a;
+    std::array<float, 4> uvs;
+  };
+
+  /// \brief   Builds centred quads with the sprite kernels, several at a time.
+  /// \details The corners come out in the same order as a sprite's, and are
+  ///          turned with the same sine and cosine.
+  void centredQuads(const CentredQuads& source, std::size_t count, Quad* quads, VertexKernel kernel);
+}
@@ -0,0 +1,182 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/StaticBatch.hpp"
+#include "extensions/GLStateGuard.hpp"
+#include "extensions/RenderContext.hpp"
+#include "extensions/SpriteVertices.hpp"
+#include "extensions/TargetTracker.hpp"
+
+#include <Engine/Sprite.hpp>
+#include <algorithm>
+#include <limits>
+#include <tuple>
+#include <utility>
+
+namespace
+{
+  constexpr auto NO_SLOT = std::numeric_limits<std::size_t>::max();
+}
+
+pyasge::StaticBatch::StaticBatch(ASGE::GLRenderer& renderer) :
+  context(RenderContext::get(renderer)), buffer(context)
+{
+}
+
+pyasge::StaticBatch::~StaticBatch() = default;
+
+void pyasge::StaticBatch::add(const ASGE::Sprite& sprite, pybind11::object anchor)
+{
+  sprites.emplace(&sprite, items.size());
+  items.push_back({ &sprite, nullptr, 0, 0, 0, 0, NO_SLOT });
+  anchors.push_back(std::move(anchor));
+}
+
+void pyasge::StaticBatch::add(const ASGE::Tile& tile, float x, float y, pybind11::object anchor)
+{
+  // the anchor keeps the tile alive, so later changes to it are picked up by an update
+  items.push_back({ nullptr, &tile, x, y, 0, 0, NO_SLOT });
+  anchors.push_back(std::move(anchor));
+}
+
+bool pyasge::StaticBatch::refresh(Item& item, Quad& out)
+{
+  if (item.sprite != nullptr)
+  {
+    item.texture = QuadBuffer::textureID(item.sprite->getTexture());
+    item.z       = item.sprite->getGlobalZOrder();
+    return item.texture != 0 && spriteQuad(*item.sprite, out);
+  }
+
+  item.texture = QuadBuffer::textureID(item.tile->texture);
+  item.z       = item.tile->z;
+  return item.texture != 0 && tileQuad(*item.tile, item.x, item.y, out);
+}
+
+void pyasge::StaticBatch::build()
+{
+  // sprite quads are generated together, so the vertex kernels can work on several at once
+  std::vector<const ASGE::Sprite*> batched;
+  for (const auto& item : items)
+  {
+    if (item.sprite != nullptr)
+    {
+      batched.push_back(item.sprite);
+    }
+  }
+  std::vector<Quad> sprite_quads(batched.size());
+  spriteQuads(batched.data(), batched.size(), sprite_quads.data());
+
+  std::vector<Quad> generated(items.size());
+  std::vector<std::size_t> order;
+  order.reserve(items.size());
+  for (std::size_t i = 0, next = 0; i < items.size(); ++i)
+  {
+    auto& item = items[i];
+    item.slot  = NO_SLOT;
+    if (item.sprite == nullptr)
+    {
+      if (refresh(item, generated[i]))
+      {
+        order.push_back(i);
+      }
+      continue;
+    }
+
+    item.texture = QuadBuffer::textureID(item.sprite->getTexture());
+    item.z       = item.sprite->getGlobalZOrder();
+    generated[i] = sprite_quads[next++];
+    if (item.texture != 0)
+    {
+      order.push_back(i);
+    }
+  }
+
+  // group by z-order first, then texture, keeping the order items were added in
+  std::stable_sort(
+    order.begin(), order.end(),
+    [this](std::size_t lhs, std::size_t rhs)
+    {
+      return std::tie(items[lhs].z, items[lhs].texture) < std::tie(items[rhs].z, items[rhs].texture);
+    });
+
+  std::vector<Quad> data;
+  std::vector<QuadBuffer::Run> runs;
+  data.reserve(order.size());
+  for (auto index : order)
+  {
+    auto& item = items[index];
+    item.slot  = data.size();
+    data.push_back(generated[index]);
+
+    if (runs.empty() || runs.back().texture != item.texture)
+    {
+      runs.push_back({ item.texture, item.slot, 0 });
+    }
+    ++runs.back().count;
+  }
+
+  buffer.upload(data, std::move(runs));
+}
+
+bool pyasge::StaticBatch::update(std::size_t index)
+{
+  if (index >= items.size() || context.expired())
+  {
+    return false;
+  }
+
+  auto& item                = items[index];
+  const auto previous_slot  = item.slot;
+  const auto previous_state = std::make_pair(item.texture, item.z);
+
+  Quad data;
+  const bool drawable = refresh(item, data);
+  if (previous_slot == NO_SLOT || !drawable || previous_state != std::make_pair(item.texture, item.z))
+  {
+    // the quad belongs in a different run, or appears or disappears
+    build();
+    return true;
+  }
+
+  if (!buffer.write(previous_slot, data))
+  {
+    // the quad no longer fits the format the batch was packed in
+    build();
+  }
+  return true;
+}
+
+bool pyasge::StaticBatch::update(const ASGE::Sprite& sprite)
+{
+  auto iter = sprites.find(&sprite);
+  return iter != sprites.end() && update(iter->second);
+}
+
+bool pyasge::StaticBatch::render()
+{
+  auto ctx      = context.lock();
+  auto* program = ctx ? ctx->spriteProgram() : nullptr;
+  if (program == nullptr || buffer.draws() == 0)
+  {
+    return false;
+  }
+
+  GLStateGuard guard;
+  program->begin(ctx->renderer());
+  buffer.draw(ctx->stats());
+  TargetTracker::instance().drawn();
+  return true;
+}
@@ -0,0 +1,93 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "extensions/QuadBuffer.hpp"
+
+#include <Tile.hpp>
+#include <cstdint>
+#include <memory>
+#include <pybind11/pybind11.h>
+#include <unordered_map>
+#include <vector>
+
+namespace ASGE
+{
+  class GLRenderer;
+  class Sprite;
+}
+
+namespace pyasge
+{
+  class RenderContext;
+
+  /// \brief   Scenery baked into a GPU buffer once and drawn every frame.
+  /// \details Sprites and tiles added to the batch are turned into quads,
+  ///          ordered by z-order and texture and uploaded to a static vertex
+  ///          buffer when the batch is built. Drawing binds the buffer and
+  ///          issues one draw per run of quads sharing a texture, using the
+  ///          camera view at the time of drawing, so none of the per-frame
+  ///          transform, batching or upload work is repeated.
+  ///
+  ///          The batch keeps a reference to each sprite and tile rather than
+  ///          a copy, holding on to its Python object so it outlives the
+  ///          batch. Changes made to one are not visible until it is updated,
+  ///          which rewrites just its quad, or the batch is rebuilt. An update
+  ///          that changes an item's texture or z-order moves it to another
+  ///          run and so rebuilds the whole batch.
+  ///
+  ///          Batches are drawn immediately rather than being batched by the
+  ///          engine, so they appear beneath any sprite rendered the same frame.
+  class StaticBatch
+  {
+   public:
+    explicit StaticBatch(ASGE::GLRenderer& renderer);
+    ~StaticBatch();
+    StaticBatch(const StaticBatch&) = delete;
+    StaticBatch& operator=(const StaticBatch&) = delete;
+
+    void add(const ASGE::Sprite& sprite, pybind11::object anchor);
+    void add(const ASGE::Tile& tile, float x, float y, pybind11::object anchor);
+    void build();
+    bool update(std::size_t index);
+    bool update(const ASGE::Sprite& sprite);
+    bool render();
+
+    [[nodiscard]] std::size_t size() const noexcept { return items.size(); }
+    [[nodiscard]] std::size_t quads() const noexcept { return buffer.quads(); }
+    [[nodiscard]] std::size_t draws() const noexcept { return buffer.draws(); }
+
+   private:
+    struct Item
+    {
+      const ASGE::Sprite* sprite;
+      const ASGE::Tile* tile;
+      float x;
+      float y;
+      GLuint texture;
+      std::int16_t z;
+      std::size_t slot; ///< position of the item's quad in the buffer
+    };
+
+    static bool refresh(Item& item, Quad& out);
+
+    std::weak_ptr<RenderContext> context;
+    QuadBuffer buffer;
+    std::vector<Item> items;
+    std::vector<pybind11::object> anchors;
+    std::unordered_map<const ASGE::Sprite*, std::size_t> sprites;
+  };
+}
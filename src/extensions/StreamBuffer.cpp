@@ -0,0 +1,197 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/StreamBuffer.hpp"
+
+#include <Engine/Logger.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+  constexpr GLbitfield STORAGE_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+  std::size_t alignUp(std::size_t value, std::size_t alignment)
+  {
+    return (value + alignment - 1) / alignment * alignment;
+  }
+
+  /// \brief   The smallest power of two segment holding a frame's data.
+  std::size_t segmentFor(std::size_t bytes)
+  {
+    auto size = pyasge::StreamBuffer::MIN_SEGMENT;
+    while (size < bytes)
+    {
+      size *= 2;
+    }
+    return size;
+  }
+}
+
+pyasge::StreamBuffer::StreamBuffer(FrameStats& frame_stats) : stats(frame_stats)
+{
+  // buffer storage is core from 4.4, the renderer's legacy 3.3 context orphans instead
+  GLint major = 0;
+  GLint minor = 0;
+  glGetIntegerv(GL_MAJOR_VERSION, &major);
+  glGetIntegerv(GL_MINOR_VERSION, &minor);
+  buffer_storage = major > 4 || (major == 4 && minor >= 4);
+}
+
+pyasge::StreamBuffer::~StreamBuffer()
+{
+  release();
+}
+
+std::size_t pyasge::StreamBuffer::write(const void* data, std::size_t bytes)
+{
+  frame_bytes += bytes;
+  stats.stream_bytes += bytes;
+  if (name == 0 || largest_frame > segment_size || bytes > segment_size)
+  {
+    allocate(segmentFor(std::max(largest_frame, bytes)));
+  }
+
+  glBindBuffer(GL_ARRAY_BUFFER, name);
+  cursor = alignUp(cursor, ALIGNMENT);
+  if (buffer_storage)
+  {
+    // a frame outgrowing its segment moves on early, and may have to wait for the next one
+    if (cursor + bytes > segment_size)
+    {
+      advance();
+    }
+
+    const auto offset = segment * segment_size + cursor;
+    std::memcpy(mapped + offset, data, bytes);
+    cursor += bytes;
+    return offset;
+  }
+
+  // the whole buffer is one ring, given fresh storage each time it wraps
+  if (cursor + bytes > capacity())
+  {
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity()), nullptr, GL_STREAM_DRAW);
+    cursor = 0;
+  }
+
+  const auto offset = cursor;
+  auto* target      = glMapBufferRange(
+    GL_ARRAY_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(bytes),
+    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+  if (target != nullptr)
+  {
+    std::memcpy(target, data, bytes);
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+  }
+  else
+  {
+    glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(bytes), data);
+  }
+
+  cursor += bytes;
+  return offset;
+}
+
+void pyasge::StreamBuffer::endFrame()
+{
+  largest_frame = std::max(largest_frame, frame_bytes);
+  if (buffer_storage && frame_bytes != 0)
+  {
+    advance();
+  }
+  frame_bytes = 0;
+}
+
+void pyasge::StreamBuffer::allocate(std::size_t size)
+{
+  // anything still drawing from the old buffer keeps its storage alive until it's done
+  release();
+  segment_size = size;
+  segment      = 0;
+  cursor       = 0;
+
+  glGenBuffers(1, &name);
+  glBindBuffer(GL_ARRAY_BUFFER, name);
+  if (!buffer_storage)
+  {
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity()), nullptr, GL_STREAM_DRAW);
+    return;
+  }
+
+  glBufferStorage(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity()), nullptr, STORAGE_FLAGS);
+  mapped = static_cast<std::uint8_t*>(
+    glMapBufferRange(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(capacity()), STORAGE_FLAGS));
+  if (mapped == nullptr)
+  {
+    Logging::WARN("Persistently mapping a stream buffer failed, orphaning it instead");
+    buffer_storage = false;
+    allocate(size);
+  }
+}
+
+void pyasge::StreamBuffer::release()
+{
+  for (auto& fence : fences)
+  {
+    if (fence != nullptr)
+    {
+      glDeleteSync(fence);
+      fence = nullptr;
+    }
+  }
+
+  // deleting a buffer unmaps it
+  if (name != 0)
+  {
+    glDeleteBuffers(1, &name);
+    name   = 0;
+    mapped = nullptr;
+  }
+}
+
+void pyasge::StreamBuffer::wait(std::size_t index)
+{
+  auto& fence = fences[index];
+  if (fence == nullptr)
+  {
+    return;
+  }
+
+  // only a fence that hasn't signalled by the time the segment comes round again counts as a wait
+  if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+  {
+    constexpr GLuint64 TIMEOUT = 1'000'000'000;
+    const auto start           = std::chrono::steady_clock::now();
+    while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, TIMEOUT) == GL_TIMEOUT_EXPIRED)
+    {
+    }
+
+    ++stats.stream_waits;
+    stats.stream_wait_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  glDeleteSync(fence);
+  fence = nullptr;
+}
+
+void pyasge::StreamBuffer::advance()
+{
+  fences[segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  segment         = (segment + 1) % SEGMENTS;
+  cursor          = 0;
+  wait(segment);
+}
@@ -0,0 +1,84 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "extensions/FrameStats.hpp"
+#include "extensions/GL.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace pyasge
+{
+  /// \brief   A vertex buffer for data written once and drawn straight away.
+  /// \details Re-uploading into a buffer the GPU may still be reading from
+  ///          forces the driver to either copy the data aside or wait for
+  ///          the earlier draws to finish. Instead, writes are appended to a
+  ///          ring of SEGMENTS frame sized segments, so nothing the GPU could
+  ///          still be reading is overwritten.
+  ///
+  ///          Where GL 4.4 is available the buffer is persistently mapped and
+  ///          each segment is guarded by a fence placed at the end of the
+  ///          frame that wrote it. Writing into a segment whose fence hasn't
+  ///          signalled yet waits for it, which is counted in the frame
+  ///          stats. On GL 3.3 the buffer is mapped unsynchronised for each
+  ///          write instead, and orphaned whenever it fills, letting the
+  ///          driver hand over fresh storage while the old is still in use.
+  ///
+  ///          Data written is only valid until the end of the frame after
+  ///          next, so it must be drawn straight away. A frame writing more
+  ///          than a segment holds grows the buffer for the frames after it.
+  class StreamBuffer
+  {
+   public:
+    static constexpr std::size_t SEGMENTS    = 3;
+    static constexpr std::size_t MIN_SEGMENT = 256 * 1024;
+    static constexpr std::size_t ALIGNMENT   = 64;
+
+    explicit StreamBuffer(FrameStats& frame_stats);
+    ~StreamBuffer();
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    /// \brief   Copies data into the buffer, leaving it bound to GL_ARRAY_BUFFER.
+    /// \returns The offset of the data within the buffer, in bytes.
+    std::size_t write(const void* data, std::size_t bytes);
+
+    /// \brief   Fences the segment written this frame and moves on to the next.
+    void endFrame();
+
+    [[nodiscard]] bool persistent() const noexcept { return buffer_storage; }
+    [[nodiscard]] std::size_t capacity() const noexcept { return segment_size * SEGMENTS; }
+
+   private:
+    void allocate(std::size_t size);
+    void release();
+    void wait(std::size_t index);
+    void advance();
+
+    FrameStats& stats;
+    bool buffer_storage       = false;
+    GLuint name               = 0;
+    std::uint8_t* mapped      = nullptr;
+    std::size_t segment_size  = 0;
+    std::size_t segment       = 0; ///< the segment being written, persistent buffers only
+    std::size_t cursor        = 0; ///< the next free byte, from the start of the segment
+    std::size_t frame_bytes   = 0;
+    std::size_t largest_frame = 0;
+    std::array<GLsync, SEGMENTS> fences{};
+  };
+}
@@ -0,0 +1,193 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/TargetTracker.hpp"
+#include "extensions/CollisionMask.hpp"
+#include "extensions/RenderContext.hpp"
+
+#include <Engine/OpenGL/GLRenderTarget.hpp>
+#include <Engine/OpenGL/GLTexture.hpp>
+
+namespace
+{
+  constexpr std::uint32_t ALL_ATTACHMENTS = ~0U;
+
+  std::uint32_t attachment(unsigned int index) noexcept
+  {
+    return index < 32 ? 1U << index : 0U;
+  }
+
+  /// Draws queued for the target have to be submitted before it is resolved.
+  pyasge::FrameStats* prepareResolve()
+  {
+    auto* context = pyasge::RenderContext::active();
+    if (context == nullptr)
+    {
+      return nullptr;
+    }
+
+    context->flushQueue();
+    return &context->stats();
+  }
+}
+
+pyasge::TargetTracker& pyasge::TargetTracker::instance()
+{
+  static TargetTracker tracker;
+  return tracker;
+}
+
+void pyasge::TargetTracker::bind(const ASGE::GLRenderTarget* target)
+{
+  // binding may clear the target, so count it as drawing into it
+  current = target;
+  drawn();
+}
+
+void pyasge::TargetTracker::drawn()
+{
+  if (current == nullptr)
+  {
+    return;
+  }
+
+  if (auto iter = targets.find(current); iter != targets.end())
+  {
+    iter->second.clean = 0;
+  }
+}
+
+void pyasge::TargetTracker::sampled(const ASGE::Texture2D* texture)
+{
+  if (samplers.empty() || texture == nullptr)
+  {
+    return;
+  }
+
+  if (auto iter = samplers.find(texture); iter != samplers.end())
+  {
+    resolve(*iter->second.first, iter->second.second);
+  }
+}
+
+ASGE::GLTexture* pyasge::TargetTracker::resolve(ASGE::GLRenderTarget& target, unsigned int index)
+{
+  auto* stats    = prepareResolve();
+  auto& resolved = target.getResolved();
+  if (!dirty(&target, index) && index < resolved.size())
+  {
+    if (stats != nullptr)
+    {
+      ++stats->resolves_skipped;
+    }
+    return resolved[index].get();
+  }
+
+  auto* texture = target.resolve(index);
+  auto& state   = targets[&target];
+  state.clean |= attachment(index);
+  if (state.auto_resolve)
+  {
+    registerSamplers(&target);
+  }
+  if (stats != nullptr)
+  {
+    ++stats->resolves_issued;
+  }
+  return texture;
+}
+
+void pyasge::TargetTracker::resolveAll(ASGE::GLRenderTarget& target)
+{
+  auto* stats = prepareResolve();
+  if (auto iter = targets.find(&target); iter != targets.end() && iter->second.clean == ALL_ATTACHMENTS)
+  {
+    if (stats != nullptr)
+    {
+      ++stats->resolves_skipped;
+    }
+    return;
+  }
+
+  target.resolve();
+  auto& state = targets[&target];
+  state.clean = ALL_ATTACHMENTS;
+  if (state.auto_resolve)
+  {
+    registerSamplers(&target);
+  }
+  if (stats != nullptr)
+  {
+    ++stats->resolves_issued;
+  }
+}
+
+bool pyasge::TargetTracker::dirty(const ASGE::GLRenderTarget* target, unsigned int index) const
+{
+  auto iter = targets.find(target);
+  return iter == targets.end() || (iter->second.clean & attachment(index)) == 0;
+}
+
+bool pyasge::TargetTracker::autoResolve(const ASGE::GLRenderTarget* target) const
+{
+  auto iter = targets.find(target);
+  return iter != targets.end() && iter->second.auto_resolve;
+}
+
+void pyasge::TargetTracker::setAutoResolve(ASGE::GLRenderTarget* target, bool enable)
+{
+  targets[target].auto_resolve = enable;
+  for (auto iter = samplers.begin(); iter != samplers.end();)
+  {
+    iter = iter->second.first == target ? samplers.erase(iter) : std::next(iter);
+  }
+
+  if (enable)
+  {
+    registerSamplers(target);
+  }
+}
+
+void pyasge::TargetTracker::forget(const ASGE::GLRenderTarget* target)
+{
+  // the resolved textures are destroyed with the target, and their masks with them
+  if (target != nullptr)
+  {
+    for (const auto& texture : target->getResolved())
+    {
+      CollisionMask::forget(*texture);
+    }
+  }
+
+  targets.erase(target);
+  for (auto iter = samplers.begin(); iter != samplers.end();)
+  {
+    iter = iter->second.first == target ? samplers.erase(iter) : std::next(iter);
+  }
+
+  if (current == target)
+  {
+    current = nullptr;
+  }
+}
+
+void pyasge::TargetTracker::registerSamplers(ASGE::GLRenderTarget* target)
+{
+  const auto& resolved = target->getResolved();
+  for (unsigned int index = 0; index < resolved.size(); ++index)
+  {
+    samplers[resolved[index].get()] = { target, index };
+  }
+}
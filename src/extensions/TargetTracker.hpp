@@ -0,0 +1,74 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+
+namespace ASGE
+{
+  class GLRenderTarget;
+  class GLTexture;
+  class Texture2D;
+}
+
+namespace pyasge
+{
+  /// \brief   Tracks which render target attachments need resolving.
+  /// \details Resolving blits a multisampled attachment into the texture that
+  ///          is sampled from, which is wasted work if nothing was drawn into
+  ///          the target since the previous resolve. An attachment becomes
+  ///          dirty when its target is bound or drawn into while bound, and
+  ///          clean when it is resolved. Targets the tracker has not seen are
+  ///          treated as dirty, so forgetting a target is always safe.
+  ///
+  ///          Targets can also be resolved automatically: when a texture that
+  ///          belongs to a dirty, auto-resolving target is about to be drawn,
+  ///          its attachment is resolved first.
+  class TargetTracker
+  {
+   public:
+    static TargetTracker& instance();
+
+    void bind(const ASGE::GLRenderTarget* target);
+    void drawn();
+    void sampled(const ASGE::Texture2D* texture);
+
+    ASGE::GLTexture* resolve(ASGE::GLRenderTarget& target, unsigned int index);
+    void resolveAll(ASGE::GLRenderTarget& target);
+    [[nodiscard]] bool dirty(const ASGE::GLRenderTarget* target, unsigned int index) const;
+
+    [[nodiscard]] bool autoResolve(const ASGE::GLRenderTarget* target) const;
+    void setAutoResolve(ASGE::GLRenderTarget* target, bool enable);
+    void forget(const ASGE::GLRenderTarget* target);
+
+    [[nodiscard]] const ASGE::GLRenderTarget* bound() const noexcept { return current; }
+
+   private:
+    struct State
+    {
+      std::uint32_t clean = 0; ///< bit per attachment resolved since it was last drawn
+      bool auto_resolve   = false;
+    };
+
+    void registerSamplers(ASGE::GLRenderTarget* target);
+
+    std::unordered_map<const ASGE::GLRenderTarget*, State> targets;
+    std::unordered_map<const ASGE::Texture2D*, std::pair<ASGE::GLRenderTarget*, unsigned int>> samplers;
+    const ASGE::GLRenderTarget* current = nullptr;
+  };
+}
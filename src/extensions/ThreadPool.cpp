@@ -0,0 +1,129 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/ThreadPool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+pyasge::ThreadPool& pyasge::ThreadPool::instance()
+{
+  static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 1U) - 1);
+  return pool;
+}
+
+pyasge::ThreadPool::ThreadPool(std::size_t worker_count)
+{
+  workers.reserve(worker_count);
+  for (std::size_t i = 0; i < worker_count; ++i)
+  {
+    workers.emplace_back(&ThreadPool::work, this, i + 1);
+  }
+}
+
+pyasge::ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (auto& worker : workers)
+  {
+    worker.join();
+  }
+}
+
+void pyasge::ThreadPool::parallelFor(std::size_t items, std::size_t block, const Task& body)
+{
+  block = std::max<std::size_t>(block, 1);
+  if (items == 0)
+  {
+    return;
+  }
+  if (workers.empty() || items <= block)
+  {
+    body(0, items, 0);
+    return;
+  }
+
+  std::lock_guard loop(submit);
+  {
+    std::lock_guard lock(mutex);
+    task    = &body;
+    count   = items;
+    grain   = block;
+    next    = 0;
+    pending = workers.size();
+    error   = nullptr;
+    ++generation;
+  }
+  wake.notify_all();
+
+  run(0);
+
+  std::unique_lock lock(mutex);
+  done.wait(lock, [this] { return pending == 0; });
+  task = nullptr;
+  if (error)
+  {
+    std::rethrow_exception(std::exchange(error, nullptr));
+  }
+}
+
+void pyasge::ThreadPool::run(std::size_t slot)
+{
+  try
+  {
+    for (auto begin = next.fetch_add(grain); begin < count; begin = next.fetch_add(grain))
+    {
+      (*task)(begin, std::min(begin + grain, count), slot);
+    }
+  }
+  catch (...)
+  {
+    std::lock_guard lock(mutex);
+    if (!error)
+    {
+      error = std::current_exception();
+    }
+    // skip the blocks nobody has started
+    next = count;
+  }
+}
+
+void pyasge::ThreadPool::work(std::size_t slot)
+{
+  std::size_t seen = 0;
+  std::unique_lock lock(mutex);
+  for (;;)
+  {
+    wake.wait(lock, [&] { return stopping || generation != seen; });
+    if (stopping)
+    {
+      return;
+    }
+
+    seen = generation;
+    lock.unlock();
+    run(slot);
+    lock.lock();
+
+    if (--pending == 0)
+    {
+      done.notify_one();
+    }
+  }
+}
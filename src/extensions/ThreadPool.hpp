@@ -0,0 +1,77 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pyasge
+{
+  /// \brief   A fixed set of worker threads for splitting loops over items.
+  /// \details parallelFor hands out blocks of an index range to the workers
+  ///          and to the calling thread, and returns once every block has
+  ///          run. The work must not call back into Python, so the caller
+  ///          may keep the GIL, and only releases it when nothing Python
+  ///          could change is read by the loop. Only one loop runs at a
+  ///          time; concurrent callers wait their turn, and a loop body must
+  ///          not start a loop of its own.
+  class ThreadPool
+  {
+   public:
+    /// \brief   A block of work, given [begin, end) and the running thread's slot.
+    using Task = std::function<void(std::size_t begin, std::size_t end, std::size_t slot)>;
+
+    /// \brief   The shared pool, with a worker per hardware thread besides the caller's.
+    static ThreadPool& instance();
+
+    explicit ThreadPool(std::size_t worker_count);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// \brief   The number of threads a loop runs on, which bounds the slots passed to tasks.
+    [[nodiscard]] std::size_t slots() const noexcept { return workers.size() + 1; }
+
+    /// \brief   Runs body over [0, items) in blocks of block items.
+    /// \details Rethrows the first exception thrown by a block, once the
+    ///          others have stopped.
+    void parallelFor(std::size_t items, std::size_t block, const Task& body);
+
+   private:
+    void work(std::size_t slot);
+    void run(std::size_t slot);
+
+    std::vector<std::thread> workers;
+    std::mutex submit; ///< held for the length of a loop
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const Task* task        = nullptr;
+    std::size_t count       = 0;
+    std::size_t grain       = 1;
+    std::size_t pending     = 0; ///< workers yet to finish the current loop
+    std::size_t generation  = 0;
+    bool stopping           = false;
+    std::exception_ptr error;
+    std::atomic<std::size_t> next{ 0 };
+  };
+}
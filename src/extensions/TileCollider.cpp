@@ -0,0 +1,196 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/TileCollider.hpp"
+#include "extensions/TileMap.hpp"
+#include "extensions/TileSet.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+  /// Edges within this fraction of a tile of a cell boundary are treated as
+  /// lying on it, so a box placed flush against a tile in float precision
+  /// doesn't read as overlapping it.
+  constexpr double EDGE_TOLERANCE = 1e-3;
+}
+
+pyasge::TileCollider::TileCollider(const TileMap& tile_map) :
+  map(tile_map),
+  solids(tile_map.tileSet()->solidity()),
+  solid_count(tile_map.tileSet()->size() + 1),
+  origin_x(tile_map.x()),
+  origin_y(tile_map.y()),
+  tile_width(tile_map.tileWidth()),
+  tile_height(tile_map.tileHeight()),
+  columns(tile_map.columns()),
+  rows(tile_map.rows()),
+  chunk_size(tile_map.chunkSize())
+{
+}
+
+bool pyasge::TileCollider::solid(int column, int row)
+{
+  const int chunk_column = column / chunk_size;
+  const int chunk_row    = row / chunk_size;
+  if (chunk_column != cached_column || chunk_row != cached_row)
+  {
+    cached_column = chunk_column;
+    cached_row    = chunk_row;
+    cached_cells  = map.chunkCells(chunk_column, chunk_row);
+  }
+
+  if (cached_cells == nullptr)
+  {
+    return false;
+  }
+
+  const auto id = cached_cells[static_cast<std::size_t>(row % chunk_size) * chunk_size + column % chunk_size];
+  return id < solid_count && solids[id] != 0;
+}
+
+bool pyasge::TileCollider::solid(Span span_columns, Span span_rows)
+{
+  const int first_column = std::max(span_columns.first, 0);
+  const int last_column  = std::min(span_columns.last, columns - 1);
+  const int first_row    = std::max(span_rows.first, 0);
+  const int last_row     = std::min(span_rows.last, rows - 1);
+
+  for (int row = first_row; row <= last_row; ++row)
+  {
+    for (int column = first_column; column <= last_column; ++column)
+    {
+      if (solid(column, row))
+      {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+pyasge::TileCollider::Span pyasge::TileCollider::columnsOf(double left, double right) const noexcept
+{
+  return { static_cast<int>(std::floor(left / tile_width + EDGE_TOLERANCE)),
+           static_cast<int>(std::ceil(right / tile_width - EDGE_TOLERANCE)) - 1 };
+}
+
+pyasge::TileCollider::Span pyasge::TileCollider::rowsOf(double top, double bottom) const noexcept
+{
+  return { static_cast<int>(std::floor(top / tile_height + EDGE_TOLERANCE)),
+           static_cast<int>(std::ceil(bottom / tile_height - EDGE_TOLERANCE)) - 1 };
+}
+
+bool pyasge::TileCollider::solidAt(float x, float y)
+{
+  const auto column = static_cast<int>(std::floor((x - origin_x) / tile_width));
+  const auto row    = static_cast<int>(std::floor((y - origin_y) / tile_height));
+  return map.contains(column, row) && solid(column, row);
+}
+
+bool pyasge::TileCollider::overlaps(const Box& box)
+{
+  const double left = box.x - origin_x;
+  const double top  = box.y - origin_y;
+  return solid(columnsOf(left, left + box.width), rowsOf(top, top + box.height));
+}
+
+double pyasge::TileCollider::sweepX(Span span_rows, double left, double right, double dx, std::uint8_t& contact)
+{
+  if (span_rows.last < 0 || span_rows.first >= rows || span_rows.first > span_rows.last)
+  {
+    return dx;
+  }
+
+  if (dx > 0)
+  {
+    // the columns the right edge moves into, nearest first
+    const int first = std::max(static_cast<int>(std::ceil(right / tile_width - EDGE_TOLERANCE)), 0);
+    const int last  = std::min(static_cast<int>(std::ceil((right + dx) / tile_width - EDGE_TOLERANCE)) - 1, columns - 1);
+    for (int column = first; column <= last; ++column)
+    {
+      if (solid({ column, column }, span_rows))
+      {
+        contact |= RIGHT;
+        return column * tile_width - right;
+      }
+    }
+  }
+  else if (dx < 0)
+  {
+    const int first = std::min(static_cast<int>(std::floor(left / tile_width + EDGE_TOLERANCE)) - 1, columns - 1);
+    const int last  = std::max(static_cast<int>(std::floor((left + dx) / tile_width + EDGE_TOLERANCE)), 0);
+    for (int column = first; column >= last; --column)
+    {
+      if (solid({ column, column }, span_rows))
+      {
+        contact |= LEFT;
+        return (column + 1) * tile_width - left;
+      }
+    }
+  }
+  return dx;
+}
+
+double pyasge::TileCollider::sweepY(Span span_columns, double top, double bottom, double dy, std::uint8_t& contact)
+{
+  if (span_columns.last < 0 || span_columns.first >= columns || span_columns.first > span_columns.last)
+  {
+    return dy;
+  }
+
+  if (dy > 0)
+  {
+    const int first = std::max(static_cast<int>(std::ceil(bottom / tile_height - EDGE_TOLERANCE)), 0);
+    const int last  = std::min(static_cast<int>(std::ceil((bottom + dy) / tile_height - EDGE_TOLERANCE)) - 1, rows - 1);
+    for (int row = first; row <= last; ++row)
+    {
+      if (solid(span_columns, { row, row }))
+      {
+        contact |= BOTTOM;
+        return row * tile_height - bottom;
+      }
+    }
+  }
+  else if (dy < 0)
+  {
+    const int first = std::min(static_cast<int>(std::floor(top / tile_height + EDGE_TOLERANCE)) - 1, rows - 1);
+    const int last  = std::max(static_cast<int>(std::floor((top + dy) / tile_height + EDGE_TOLERANCE)), 0);
+    for (int row = first; row >= last; --row)
+    {
+      if (solid(span_columns, { row, row }))
+      {
+        contact |= TOP;
+        return (row + 1) * tile_height - top;
+      }
+    }
+  }
+  return dy;
+}
+
+std::uint8_t pyasge::TileCollider::move(Box& box, float dx, float dy)
+{
+  std::uint8_t contact = NONE;
+  double left          = box.x - origin_x;
+  double top           = box.y - origin_y;
+
+  left += sweepX(rowsOf(top, top + box.height), left, left + box.width, dx, contact);
+  top += sweepY(columnsOf(left, left + box.width), top, top + box.height, dy, contact);
+
+  box.x = static_cast<float>(origin_x + left);
+  box.y = static_cast<float>(origin_y + top);
+  return contact;
+}
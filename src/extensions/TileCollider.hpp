@@ -0,0 +1,102 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace pyasge
+{
+  class TileMap;
+  class TileSet;
+
+  /// \brief   Collision queries against the solid tiles of a TileMap.
+  /// \details A cell is solid when its id is flagged solid in the map's
+  ///          TileSet; empty cells and everything outside of the map are
+  ///          open. Boxes are axis aligned, given by their top left corner
+  ///          and size in world units, and cover the half open range
+  ///          [x, x + width) so a box resting against a tile's edge does
+  ///          not overlap it.
+  ///
+  ///          Movement is swept one axis at a time, x then y, by walking
+  ///          the columns or rows the leading edge crosses. A box stops
+  ///          flush against the first solid cell in its path, however far
+  ///          it moves in a step, and keeps the other axis' motion so that
+  ///          it slides along walls and floors.
+  ///
+  ///          The collider caches the last chunk it read, so build one per
+  ///          batch of queries rather than per query, and don't change the
+  ///          map while it is in use.
+  class TileCollider
+  {
+   public:
+    /// \brief   The sides of a box that came to rest against a solid cell.
+    enum Contact : std::uint8_t
+    {
+      NONE   = 0,
+      LEFT   = 1 << 0,
+      RIGHT  = 1 << 1,
+      TOP    = 1 << 2,
+      BOTTOM = 1 << 3,
+    };
+
+    struct Box
+    {
+      float x;
+      float y;
+      float width;
+      float height;
+    };
+
+    explicit TileCollider(const TileMap& tile_map);
+
+    [[nodiscard]] bool solidAt(float x, float y);
+    [[nodiscard]] bool overlaps(const Box& box);
+
+    /// \brief   Moves a box by (dx, dy), stopping it at solid cells.
+    /// \returns The Contact flags for the sides that were stopped.
+    std::uint8_t move(Box& box, float dx, float dy);
+
+   private:
+    struct Span
+    {
+      int first;
+      int last;
+    };
+
+    [[nodiscard]] bool solid(int column, int row);
+    [[nodiscard]] bool solid(Span columns, Span rows);
+    [[nodiscard]] Span columnsOf(double left, double right) const noexcept;
+    [[nodiscard]] Span rowsOf(double top, double bottom) const noexcept;
+    [[nodiscard]] double sweepX(Span rows, double left, double right, double dx, std::uint8_t& contact);
+    [[nodiscard]] double sweepY(Span columns, double top, double bottom, double dy, std::uint8_t& contact);
+
+    const TileMap& map;
+    const std::uint8_t* solids;
+    std::size_t solid_count;
+    double origin_x;
+    double origin_y;
+    double tile_width;
+    double tile_height;
+    int columns;
+    int rows;
+    int chunk_size;
+
+    int cached_column = -1; ///< the chunk last read, so neighbouring cells skip the lookup
+    int cached_row    = -1;
+    const std::uint16_t* cached_cells = nullptr;
+  };
+}
@@ -0,0 +1,317 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/TileMap.hpp"
+#include "extensions/GLStateGuard.hpp"
+#include "extensions/RenderContext.hpp"
+#include "extensions/TargetTracker.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <utility>
+
+pyasge::TileMap::TileMap(
+  ASGE::GLRenderer& renderer, int columns, int rows, float width, float height, int chunk,
+  std::shared_ptr<TileSet> tile_set) :
+  context(RenderContext::get(renderer)),
+  tiles(tile_set ? std::move(tile_set) : std::make_shared<TileSet>()),
+  map_columns(std::max(columns, 0)),
+  map_rows(std::max(rows, 0)),
+  chunk_size(std::clamp(chunk, 1, 256)),
+  chunk_columns((map_columns + chunk_size - 1) / chunk_size),
+  chunk_rows((map_rows + chunk_size - 1) / chunk_size),
+  tile_width(width),
+  tile_height(height)
+{
+  tiles_revision = tiles->revision();
+}
+
+pyasge::TileMap::~TileMap() = default;
+
+bool pyasge::TileMap::contains(int column, int row) const noexcept
+{
+  return column >= 0 && row >= 0 && column < map_columns && row < map_rows;
+}
+
+std::size_t pyasge::TileMap::chunkIndex(int column, int row) const noexcept
+{
+  return static_cast<std::size_t>(row / chunk_size) * chunk_columns + column / chunk_size;
+}
+
+std::size_t pyasge::TileMap::cellIndex(int column, int row) const noexcept
+{
+  return static_cast<std::size_t>(row % chunk_size) * chunk_size + column % chunk_size;
+}
+
+std::uint16_t pyasge::TileMap::get(int column, int row) const
+{
+  if (!contains(column, row))
+  {
+    return 0;
+  }
+
+  auto iter = chunks.find(chunkIndex(column, row));
+  return iter != chunks.end() ? iter->second.cells[cellIndex(column, row)] : 0;
+}
+
+bool pyasge::TileMap::set(int column, int row, std::uint16_t id)
+{
+  if (!contains(column, row) || id > tiles->size())
+  {
+    return false;
+  }
+
+  auto iter = chunks.find(chunkIndex(column, row));
+  if (iter == chunks.end())
+  {
+    if (id == 0)
+    {
+      return true;
+    }
+    iter = chunks.emplace(chunkIndex(column, row), Chunk{}).first;
+    iter->second.cells.resize(static_cast<std::size_t>(chunk_size) * chunk_size, 0);
+  }
+
+  auto& chunk = iter->second;
+  auto& cell = chunk.cells[cellIndex(column, row)];
+  chunk.dirty |= cell != id;
+  cell = id;
+  return true;
+}
+
+bool pyasge::TileMap::assign(
+  int column, int row, int width, int height, const std::uint16_t* ids, std::size_t stride)
+{
+  stride     = stride != 0 ? stride : static_cast<std::size_t>(width);
+  bool valid = true;
+  for (int y = 0; y < height; ++y)
+  {
+    for (int x = 0; x < width; ++x)
+    {
+      const auto id = ids[static_cast<std::size_t>(y) * stride + x];
+      if (id > tiles->size())
+      {
+        valid = false;
+        continue;
+      }
+      set(column + x, row + y, id);
+    }
+  }
+  return valid;
+}
+
+const std::uint16_t* pyasge::TileMap::chunkCells(int chunk_column, int chunk_row) const noexcept
+{
+  if (chunk_column < 0 || chunk_row < 0 || chunk_column >= chunk_columns || chunk_row >= chunk_rows)
+  {
+    return nullptr;
+  }
+
+  auto iter = chunks.find(static_cast<std::size_t>(chunk_row) * chunk_columns + chunk_column);
+  return iter != chunks.end() ? iter->second.cells.data() : nullptr;
+}
+
+bool pyasge::TileMap::evict(int chunk_column, int chunk_row)
+{
+  if (chunk_column < 0 || chunk_row < 0 || chunk_column >= chunk_columns || chunk_row >= chunk_rows)
+  {
+    return false;
+  }
+  return chunks.erase(static_cast<std::size_t>(chunk_row) * chunk_columns + chunk_column) != 0;
+}
+
+bool pyasge::TileMap::cellAt(float x, float y, int& column, int& row) const noexcept
+{
+  column = static_cast<int>(std::floor((x - origin_x) / tile_width));
+  row    = static_cast<int>(std::floor((y - origin_y) / tile_height));
+  return contains(column, row);
+}
+
+void pyasge::TileMap::copy(int column, int row, int width, int height, std::uint16_t* ids) const
+{
+  for (int y = 0; y < height; ++y)
+  {
+    for (int x = 0; x < width; ++x)
+    {
+      ids[static_cast<std::size_t>(y) * width + x] = get(column + x, row + y);
+    }
+  }
+}
+
+std::size_t pyasge::TileMap::memory() const noexcept
+{
+  // each allocated chunk's cells, plus its entry in the chunk table
+  const auto cells = static_cast<std::size_t>(chunk_size) * static_cast<std::size_t>(chunk_size);
+  return chunks.size() * (cells * sizeof(std::uint16_t) + sizeof(Chunk) + sizeof(std::size_t) + sizeof(void*));
+}
+
+void pyasge::TileMap::setOpacity(float opacity)
+{
+  if (opacity != map_opacity)
+  {
+    map_opacity = opacity;
+    invalidate();
+  }
+}
+
+void pyasge::TileMap::setPosition(float x, float y)
+{
+  if (x != origin_x || y != origin_y)
+  {
+    origin_x = x;
+    origin_y = y;
+    invalidate();
+  }
+}
+
+void pyasge::TileMap::invalidate()
+{
+  for (auto& [index, chunk] : chunks)
+  {
+    chunk.dirty = true;
+  }
+}
+
+void pyasge::TileMap::rebuild(int chunk_column, int chunk_row, Chunk& chunk)
+{
+  struct Cell
+  {
+    std::int16_t z;
+    GLuint texture;
+    Quad quad;
+  };
+
+  std::vector<Cell> cells;
+  cells.reserve(chunk.cells.size());
+  for (int y = 0; y < chunk_size; ++y)
+  {
+    for (int x = 0; x < chunk_size; ++x)
+    {
+      const auto id = chunk.cells[static_cast<std::size_t>(y) * chunk_size + x];
+      if (id == 0)
+      {
+        continue;
+      }
+
+      const auto* type = tiles->get(id);
+      if (type == nullptr)
+      {
+        continue;
+      }
+
+      const float pos_x = origin_x + static_cast<float>(chunk_column * chunk_size + x) * tile_width;
+      const float pos_y = origin_y + static_cast<float>(chunk_row * chunk_size + y) * tile_height;
+      Cell cell{ type->z, QuadBuffer::textureID(type->texture), {} };
+      if (cell.texture != 0 && tileQuad(*type, pos_x, pos_y, cell.quad))
+      {
+        for (auto& vertex : cell.quad)
+        {
+          vertex.a *= map_opacity;
+        }
+        cells.push_back(cell);
+      }
+    }
+  }
+
+  // cells are added row by row, which is kept within each z-order and texture
+  std::stable_sort(
+    cells.begin(), cells.end(),
+    [](const Cell& lhs, const Cell& rhs) { return std::tie(lhs.z, lhs.texture) < std::tie(rhs.z, rhs.texture); });
+
+  std::vector<Quad> quads;
+  std::vector<QuadBuffer::Run> runs;
+  quads.reserve(cells.size());
+  for (const auto& cell : cells)
+  {
+    if (runs.empty() || runs.back().texture != cell.texture)
+    {
+      runs.push_back({ cell.texture, quads.size(), 0 });
+    }
+    ++runs.back().count;
+    quads.push_back(cell.quad);
+  }
+
+  if (!chunk.buffer)
+  {
+    chunk.buffer = std::make_unique<QuadBuffer>(context);
+  }
+  chunk.buffer->upload(quads, std::move(runs));
+  chunk.dirty = false;
+}
+
+std::size_t pyasge::TileMap::render()
+{
+  stats         = {};
+  auto ctx      = context.lock();
+  auto* program = ctx ? ctx->spriteProgram() : nullptr;
+  if (program == nullptr)
+  {
+    return 0;
+  }
+
+  // every chunk may show a tile that has changed in the tileset
+  if (tiles->revision() != tiles_revision)
+  {
+    tiles_revision = tiles->revision();
+    invalidate();
+  }
+
+  GLStateGuard guard;
+  const auto view = program->begin(ctx->renderer());
+
+  // the range of chunks overlapping the view, widened by tiles larger than their cells,
+  // which can reach as far as their diagonal when rotated
+  const float overhang = std::max(tiles->reach() - std::min(tile_width, tile_height), 0.0F);
+  const float chunk_w = tile_width * static_cast<float>(chunk_size);
+  const float chunk_h = tile_height * static_cast<float>(chunk_size);
+  const auto first    = [](float edge, float span) { return static_cast<int>(std::floor(edge / span)); };
+  const int min_x = std::max(first(view[0] - origin_x - overhang, chunk_w), 0);
+  const int max_x = std::min(first(view[1] - origin_x + overhang, chunk_w), chunk_columns - 1);
+  const int min_y = std::max(first(std::min(view[2], view[3]) - origin_y - overhang, chunk_h), 0);
+  const int max_y = std::min(first(std::max(view[2], view[3]) - origin_y + overhang, chunk_h), chunk_rows - 1);
+
+  std::size_t draws = 0;
+  for (int chunk_row = min_y; chunk_row <= max_y; ++chunk_row)
+  {
+    for (int chunk_column = min_x; chunk_column <= max_x; ++chunk_column)
+    {
+      auto iter = chunks.find(static_cast<std::size_t>(chunk_row) * chunk_columns + chunk_column);
+      if (iter == chunks.end())
+      {
+        continue;
+      }
+
+      auto& chunk = iter->second;
+      if (chunk.dirty)
+      {
+        rebuild(chunk_column, chunk_row, chunk);
+        ++stats.chunks_rebuilt;
+      }
+      draws += chunk.buffer->draw(ctx->stats());
+      ++stats.chunks_drawn;
+    }
+  }
+
+  const auto visible = static_cast<std::size_t>(std::max(max_x - min_x + 1, 0)) *
+                       static_cast<std::size_t>(std::max(max_y - min_y + 1, 0));
+  stats.chunks_culled = static_cast<std::size_t>(chunk_columns) * static_cast<std::size_t>(chunk_rows) - visible;
+
+  if (draws != 0)
+  {
+    TargetTracker::instance().drawn();
+  }
+  return draws;
+}
@@ -0,0 +1,143 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "extensions/QuadBuffer.hpp"
+#include "extensions/TileSet.hpp"
+
+#include <Tile.hpp>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace ASGE
+{
+  class GLRenderer;
+}
+
+namespace pyasge
+{
+  class RenderContext;
+
+  /// \brief   A grid of tiles drawn from cached, per-chunk vertex buffers.
+  /// \details The map stores a 2 byte tile id per cell, indexing a TileSet
+  ///          that may be shared with other maps, with 0 leaving the cell
+  ///          empty.
+  ///          Cells are grouped into square chunks. Each chunk bakes the
+  ///          quads for its tiles into its own static vertex buffer the
+  ///          first time it is drawn, and only rebuilds it once a cell in
+  ///          the chunk has changed. Rendering draws just the chunks
+  ///          overlapping the camera view, so the cost of a frame depends
+  ///          on what is on screen rather than the size of the map.
+  ///
+  ///          A chunk's cells are not allocated until one of them is set,
+  ///          so sparse maps only pay for the chunks holding tiles, and a
+  ///          chunk can be evicted to free it again.
+  class TileMap
+  {
+   public:
+    struct Statistics
+    {
+      std::size_t chunks_drawn   = 0; ///< chunks drawn by the last render
+      std::size_t chunks_culled  = 0; ///< chunks outside the view in the last render
+      std::size_t chunks_rebuilt = 0; ///< chunks rebuilt by the last render
+    };
+
+    TileMap(
+      ASGE::GLRenderer& renderer, int columns, int rows, float width, float height, int chunk,
+      std::shared_ptr<TileSet> tile_set = nullptr);
+    ~TileMap();
+    TileMap(const TileMap&) = delete;
+    TileMap& operator=(const TileMap&) = delete;
+
+    [[nodiscard]] const std::shared_ptr<TileSet>& tileSet() const noexcept { return tiles; }
+
+    [[nodiscard]] bool contains(int column, int row) const noexcept;
+    [[nodiscard]] std::uint16_t get(int column, int row) const;
+    bool set(int column, int row, std::uint16_t id);
+
+    /// \brief   Finds the cell under a world position.
+    /// \returns False if the position is outside of the map.
+    bool cellAt(float x, float y, int& column, int& row) const noexcept;
+
+    /// \brief   Copies a block of ids out of the map, row by row.
+    /// \details Cells outside of the map, or in unallocated chunks, read as 0.
+    void copy(int column, int row, int width, int height, std::uint16_t* ids) const;
+
+    /// \brief   Copies a block of ids, stored row by row, into the map.
+    /// \details Cells falling outside of the map are ignored. Rows start
+    ///          stride ids apart, or width apart if stride is 0.
+    /// \returns False if any id is not a registered tile type.
+    bool assign(int column, int row, int width, int height, const std::uint16_t* ids, std::size_t stride = 0);
+
+    /// \brief   The cells of a chunk, row by row, or null if it isn't allocated.
+    [[nodiscard]] const std::uint16_t* chunkCells(int chunk_column, int chunk_row) const noexcept;
+
+    /// \brief   Frees a chunk's cells and vertex buffer, emptying it.
+    bool evict(int chunk_column, int chunk_row);
+    [[nodiscard]] std::size_t chunksAllocated() const noexcept { return chunks.size(); }
+
+    void setPosition(float x, float y);
+    void setOpacity(float opacity);
+    [[nodiscard]] float opacity() const noexcept { return map_opacity; }
+    [[nodiscard]] float x() const noexcept { return origin_x; }
+    [[nodiscard]] float y() const noexcept { return origin_y; }
+
+    std::size_t render();
+
+    [[nodiscard]] int columns() const noexcept { return map_columns; }
+    [[nodiscard]] int rows() const noexcept { return map_rows; }
+    [[nodiscard]] int chunkSize() const noexcept { return chunk_size; }
+    [[nodiscard]] int chunkColumns() const noexcept { return chunk_columns; }
+    [[nodiscard]] int chunkRows() const noexcept { return chunk_rows; }
+    [[nodiscard]] float tileWidth() const noexcept { return tile_width; }
+    [[nodiscard]] float tileHeight() const noexcept { return tile_height; }
+    [[nodiscard]] const Statistics& statistics() const noexcept { return stats; }
+
+    /// \brief   The bytes of memory held by the map's cells, not counting its tileset.
+    [[nodiscard]] std::size_t memory() const noexcept;
+
+   private:
+    struct Chunk
+    {
+      std::vector<std::uint16_t> cells;
+      std::unique_ptr<QuadBuffer> buffer;
+      bool dirty = true;
+    };
+
+    [[nodiscard]] std::size_t chunkIndex(int column, int row) const noexcept;
+    [[nodiscard]] std::size_t cellIndex(int column, int row) const noexcept;
+    void rebuild(int chunk_column, int chunk_row, Chunk& chunk);
+    void invalidate();
+
+    std::weak_ptr<RenderContext> context;
+    std::shared_ptr<TileSet> tiles;
+    std::uint64_t tiles_revision = 0; ///< the tileset revision the chunks were built from
+    std::unordered_map<std::size_t, Chunk> chunks; ///< allocated on first write, by chunk index
+    int map_columns;
+    int map_rows;
+    int chunk_size;
+    int chunk_columns;
+    int chunk_rows;
+    float tile_width;
+    float tile_height;
+    float origin_x  = 0;
+    float origin_y  = 0;
+    float map_opacity = 1.0F;
+    Statistics stats;
+  };
+}
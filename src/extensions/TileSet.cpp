@@ -0,0 +1,108 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/TileSet.hpp"
+
+#include <Engine/Texture.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+std::uint16_t pyasge::TileSet::add(const ASGE::Tile& tile)
+{
+  if (tiles.size() > std::numeric_limits<std::uint16_t>::max())
+  {
+    return 0;
+  }
+
+  // no cell uses the new id yet, so the revision is left alone
+  tiles.push_back(tile);
+  solids.push_back(0);
+  measure(tile);
+  return static_cast<std::uint16_t>(tiles.size() - 1);
+}
+
+std::uint16_t pyasge::TileSet::addSheet(
+  ASGE::Texture2D* texture, int tile_width, int tile_height, int margin, int spacing, std::size_t& count)
+{
+  count = 0;
+  if (texture == nullptr || tile_width <= 0 || tile_height <= 0)
+  {
+    return 0;
+  }
+
+  const int step_x  = tile_width + spacing;
+  const int step_y  = tile_height + spacing;
+  const int columns = std::max((static_cast<int>(texture->getWidth()) - 2 * margin + spacing) / step_x, 0);
+  const int rows    = std::max((static_cast<int>(texture->getHeight()) - 2 * margin + spacing) / step_y, 0);
+  const auto cells  = static_cast<std::size_t>(columns) * static_cast<std::size_t>(rows);
+  if (cells == 0 || tiles.size() + cells - 1 > std::numeric_limits<std::uint16_t>::max())
+  {
+    return 0;
+  }
+
+  const auto first = static_cast<std::uint16_t>(tiles.size());
+  for (int row = 0; row < rows; ++row)
+  {
+    for (int column = 0; column < columns; ++column)
+    {
+      ASGE::Tile tile;
+      tile.texture     = texture;
+      tile.width       = tile_width;
+      tile.height      = tile_height;
+      tile.src_rect[0] = static_cast<float>(margin + column * step_x);
+      tile.src_rect[1] = static_cast<float>(margin + row * step_y);
+      tile.src_rect[2] = static_cast<float>(tile_width);
+      tile.src_rect[3] = static_cast<float>(tile_height);
+      add(tile);
+    }
+  }
+  count = cells;
+  return first;
+}
+
+bool pyasge::TileSet::set(std::uint16_t id, const ASGE::Tile& tile)
+{
+  if (id == 0 || id >= tiles.size())
+  {
+    return false;
+  }
+
+  tiles[id] = tile;
+  measure(tile);
+  ++changes;
+  return true;
+}
+
+bool pyasge::TileSet::setSolid(std::uint16_t id, bool solid)
+{
+  if (id == 0 || id >= tiles.size())
+  {
+    return false;
+  }
+
+  solids[id] = solid ? 1 : 0;
+  return true;
+}
+
+const ASGE::Tile* pyasge::TileSet::get(std::uint16_t id) const noexcept
+{
+  return id != 0 && id < tiles.size() ? &tiles[id] : nullptr;
+}
+
+void pyasge::TileSet::measure(const ASGE::Tile& tile)
+{
+  max_reach = std::max(max_reach, std::hypot(static_cast<float>(tile.width), static_cast<float>(tile.height)));
+}
@@ -0,0 +1,69 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <Tile.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace pyasge
+{
+  /// \brief   The distinct tiles a map is made from, indexed by uint16 id.
+  /// \details A map stores a 2 byte id per cell instead of a tile, and every
+  ///          cell showing the same tile shares the tileset's entry for it:
+  ///          its texture, source rectangle, size, tint, opacity and
+  ///          rotation. Id 0 is reserved for empty cells. Maps sharing a
+  ///          tileset notice when an entry changes through its revision.
+  ///
+  ///          Each entry also carries a solid flag, read by tile collision
+  ///          queries. Solidity doesn't affect drawing, so changing it
+  ///          leaves the revision alone.
+  class TileSet
+  {
+   public:
+    TileSet() = default;
+
+    /// \brief   Adds a tile, returning its id or 0 if the set is full.
+    std::uint16_t add(const ASGE::Tile& tile);
+
+    /// \brief   Adds a tile for every cell of a sprite sheet, row by row.
+    /// \returns The id of the first cell, or 0 if they don't all fit.
+    std::uint16_t addSheet(
+      ASGE::Texture2D* texture, int tile_width, int tile_height, int margin, int spacing, std::size_t& count);
+
+    bool set(std::uint16_t id, const ASGE::Tile& tile);
+    [[nodiscard]] const ASGE::Tile* get(std::uint16_t id) const noexcept;
+
+    bool setSolid(std::uint16_t id, bool solid);
+    [[nodiscard]] bool solid(std::uint16_t id) const noexcept { return id < solids.size() && solids[id] != 0; }
+
+    /// \brief   The solid flag of every id, with entry 0 always clear.
+    [[nodiscard]] const std::uint8_t* solidity() const noexcept { return solids.data(); }
+
+    [[nodiscard]] std::size_t size() const noexcept { return tiles.size() - 1; }
+    [[nodiscard]] std::uint64_t revision() const noexcept { return changes; }
+    [[nodiscard]] float reach() const noexcept { return max_reach; }
+    [[nodiscard]] std::size_t memory() const noexcept { return tiles.capacity() * sizeof(ASGE::Tile) + solids.capacity(); }
+
+   private:
+    void measure(const ASGE::Tile& tile);
+
+    std::vector<ASGE::Tile> tiles{ 1 }; ///< entry 0 stands in for empty cells
+    std::vector<std::uint8_t> solids{ 0 }; ///< a flag per entry in tiles
+    std::uint64_t changes = 0;
+    float max_reach       = 0; ///< the largest diagonal of any tile
+  };
+}
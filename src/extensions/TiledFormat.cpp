@@ -0,0 +1,496 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/TiledFormat.hpp"
+#include "extensions/Markup.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <filesystem>
+
+#ifdef PYASGE_ZLIB
+#  include <zlib.h>
+#endif
+
+namespace
+{
+  using namespace pyasge::tiled;
+  using pyasge::markup::Node;
+  using pyasge::markup::parse;
+
+  std::string resolve(const std::string& file, std::string_view relative)
+  {
+    const std::filesystem::path path(relative);
+    if (relative.empty() || path.is_absolute())
+    {
+      return std::string(relative);
+    }
+    return (std::filesystem::path(file).parent_path() / path).lexically_normal().generic_string();
+  }
+
+  void readTileset(const Node& node, const std::string& file, Tileset& tileset)
+  {
+    const bool xml      = node.type == Node::Type::ELEMENT;
+    tileset.tile_width  = node.integer("tilewidth");
+    tileset.tile_height = node.integer("tileheight");
+    tileset.spacing     = node.integer("spacing");
+    tileset.margin      = node.integer("margin");
+    tileset.columns     = node.integer("columns");
+    tileset.tile_count  = node.integer("tilecount");
+
+    const auto* image = xml ? node.child("image") : &node;
+    if (image != nullptr)
+    {
+      tileset.image = resolve(file, image->text(xml ? "source" : "image"));
+    }
+    if (!tileset.image.empty())
+    {
+      return;
+    }
+
+    // a collection of images, with each tile naming its own
+    std::vector<const Node*> tiles;
+    if (xml)
+    {
+      tiles = node.children("tile");
+    }
+    else if (const auto* list = node.child("tiles"))
+    {
+      for (const auto& tile : list->items)
+      {
+        tiles.push_back(&tile);
+      }
+    }
+
+    for (const auto* tile : tiles)
+    {
+      const auto* source = xml ? tile->child("image") : tile;
+      if (source == nullptr)
+      {
+        continue;
+      }
+
+      Image entry;
+      entry.id     = static_cast<std::uint32_t>(tile->integer("id"));
+      entry.path   = resolve(file, source->text(xml ? "source" : "image"));
+      entry.width  = source->integer(xml ? "width" : "imagewidth");
+      entry.height = source->integer(xml ? "height" : "imageheight");
+      if (!entry.path.empty())
+      {
+        tileset.images.push_back(std::move(entry));
+      }
+    }
+  }
+
+  bool readTilesets(const Node& root, const std::string& file, const FileReader& reader, Map& map, std::string& error)
+  {
+    std::vector<const Node*> nodes;
+    if (root.type == Node::Type::ELEMENT)
+    {
+      nodes = root.children("tileset");
+    }
+    else if (const auto* list = root.child("tilesets"))
+    {
+      for (const auto& node : list->items)
+      {
+        nodes.push_back(&node);
+      }
+    }
+
+    for (const auto* node : nodes)
+    {
+      Tileset tileset;
+      tileset.first_gid = static_cast<std::uint32_t>(node->integer("firstgid", 1));
+
+      const auto source = node->text("source");
+      if (source.empty())
+      {
+        readTileset(*node, file, tileset);
+      }
+      else
+      {
+        const auto path    = resolve(file, source);
+        const auto content = reader(path);
+        const auto parsed  = content ? parse(*content) : std::nullopt;
+        if (!parsed)
+        {
+          error = "unable to read tileset " + path;
+          return false;
+        }
+        readTileset(*parsed, path, tileset);
+      }
+      map.tilesets.push_back(std::move(tileset));
+    }
+
+    std::sort(
+      map.tilesets.begin(), map.tilesets.end(),
+      [](const Tileset& lhs, const Tileset& rhs) { return lhs.first_gid < rhs.first_gid; });
+    return true;
+  }
+
+  bool readFormat(std::string_view encoding, std::string_view compression, Piece& piece, std::string& error)
+  {
+    piece.encoding = encoding == "base64" ? Encoding::BASE64 : Encoding::CSV;
+    if (compression.empty())
+    {
+      piece.compression = Compression::NONE;
+    }
+    else if (compression == "zlib")
+    {
+      piece.compression = Compression::ZLIB;
+    }
+    else if (compression == "gzip")
+    {
+      piece.compression = Compression::GZIP;
+    }
+    else if (compression == "zstd")
+    {
+      piece.compression = Compression::ZSTD;
+    }
+    else
+    {
+      error = "unknown layer compression " + std::string(compression);
+      return false;
+    }
+    return true;
+  }
+
+  /// Reads a piece's data from a JSON value or the text of a TMX element,
+  /// converting the legacy one element per tile format into CSV.
+  void readData(const Node& node, Piece& piece)
+  {
+    if (node.type != Node::Type::ELEMENT || piece.encoding != Encoding::CSV || node.items.empty())
+    {
+      piece.data = node.value;
+      return;
+    }
+
+    for (const auto* tile : node.children("tile"))
+    {
+      piece.data += tile->text("gid", "0");
+      piece.data += ',';
+    }
+  }
+
+  bool readLayer(const Node& node, Layer& layer, std::string& error)
+  {
+    const bool xml   = node.type == Node::Type::ELEMENT;
+    const auto width = node.integer("width");
+    const auto height = node.integer("height");
+
+    const auto* data = node.child("data");
+    if (xml && data == nullptr)
+    {
+      return true;
+    }
+
+    const auto& format = xml ? *data : node;
+    Piece base;
+    if (!readFormat(format.text("encoding", "csv"), format.text("compression"), base, error))
+    {
+      return false;
+    }
+
+    // infinite maps save layers as chunks of data
+    std::vector<const Node*> chunks;
+    if (xml)
+    {
+      chunks = data->children("chunk");
+    }
+    else if (const auto* list = node.child("chunks"))
+    {
+      for (const auto& chunk : list->items)
+      {
+        chunks.push_back(&chunk);
+      }
+    }
+
+    if (chunks.empty())
+    {
+      if (data == nullptr)
+      {
+        return true;
+      }
+
+      Piece piece = base;
+      piece.width  = width;
+      piece.height = height;
+      readData(*data, piece);
+      layer.pieces.push_back(std::move(piece));
+      return true;
+    }
+
+    for (const auto* chunk : chunks)
+    {
+      Piece piece  = base;
+      piece.x      = chunk->integer("x");
+      piece.y      = chunk->integer("y");
+      piece.width  = chunk->integer("width");
+      piece.height = chunk->integer("height");
+      const auto* chunk_data = xml ? chunk : chunk->child("data");
+      if (chunk_data != nullptr)
+      {
+        readData(*chunk_data, piece);
+      }
+      layer.pieces.push_back(std::move(piece));
+    }
+    return true;
+  }
+
+  bool readLayers(const Node& parent, const Layer& group, Map& map, std::string& error)
+  {
+    const bool xml = parent.type == Node::Type::ELEMENT;
+    std::vector<const Node*> nodes;
+    if (xml)
+    {
+      for (const auto& item : parent.items)
+      {
+        nodes.push_back(&item);
+      }
+    }
+    else if (const auto* list = parent.child("layers"))
+    {
+      for (const auto& item : list->items)
+      {
+        nodes.push_back(&item);
+      }
+    }
+
+    for (const auto* node : nodes)
+    {
+      const auto kind = xml ? node->name : node->text("type");
+      if (kind != "layer" && kind != "tilelayer" && kind != "group")
+      {
+        continue;
+      }
+
+      // groups pass their visibility, opacity and offset down to their layers
+      Layer layer;
+      layer.name     = node->text("name");
+      layer.visible  = group.visible && node->flag("visible", true);
+      layer.opacity  = group.opacity * static_cast<float>(node->number("opacity", 1.0));
+      layer.offset_x = group.offset_x + static_cast<float>(node->number("offsetx"));
+      layer.offset_y = group.offset_y + static_cast<float>(node->number("offsety"));
+
+      if (kind == "group")
+      {
+        if (!readLayers(*node, layer, map, error))
+        {
+          return false;
+        }
+        continue;
+      }
+
+      if (!readLayer(*node, layer, error))
+      {
+        return false;
+      }
+      map.layers.push_back(std::move(layer));
+    }
+    return true;
+  }
+
+  bool inflate(std::vector<std::uint8_t>& bytes, std::size_t expected, std::string& error)
+  {
+#ifdef PYASGE_ZLIB
+    std::vector<std::uint8_t> out(expected);
+    z_stream stream{};
+    stream.next_in   = bytes.data();
+    stream.avail_in  = static_cast<uInt>(bytes.size());
+    stream.next_out  = out.data();
+    stream.avail_out = static_cast<uInt>(out.size());
+
+    // a window of 15 bits plus 32 detects zlib and gzip headers
+    if (inflateInit2(&stream, 15 + 32) != Z_OK)
+    {
+      error = "unable to initialise zlib";
+      return false;
+    }
+    const auto result = ::inflate(&stream, Z_FINISH);
+    const auto length = stream.total_out;
+    inflateEnd(&stream);
+
+    if (result != Z_STREAM_END || length != expected)
+    {
+      error = "layer data failed to decompress";
+      return false;
+    }
+    bytes = std::move(out);
+    return true;
+#else
+    (void)bytes;
+    (void)expected;
+    error = "compressed layers need pyasge to be built with zlib";
+    return false;
+#endif
+  }
+
+  bool base64(std::string_view text, std::vector<std::uint8_t>& bytes)
+  {
+    static const auto TABLE = []
+    {
+      std::array<std::int8_t, 256> table{};
+      table.fill(-1);
+      const std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+      for (std::size_t i = 0; i < alphabet.size(); ++i)
+      {
+        table[static_cast<std::uint8_t>(alphabet[i])] = static_cast<std::int8_t>(i);
+      }
+      return table;
+    }();
+
+    bytes.clear();
+    bytes.reserve(text.size() / 4 * 3);
+    std::uint32_t buffer = 0;
+    int bits             = 0;
+    for (const char c : text)
+    {
+      if (c == '=')
+      {
+        break;
+      }
+
+      const auto value = TABLE[static_cast<std::uint8_t>(c)];
+      if (value < 0)
+      {
+        // whitespace is allowed between the characters of TMX data
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+        {
+          continue;
+        }
+        return false;
+      }
+
+      buffer = (buffer << 6) | static_cast<std::uint32_t>(value);
+      bits += 6;
+      if (bits >= 8)
+      {
+        bits -= 8;
+        bytes.push_back(static_cast<std::uint8_t>(buffer >> bits));
+      }
+    }
+    return true;
+  }
+}
+
+std::optional<pyasge::tiled::Map>
+pyasge::tiled::read(const std::string& path, const FileReader& reader, std::string& error)
+{
+  const auto content = reader(path);
+  if (!content)
+  {
+    error = "unable to open " + path;
+    return std::nullopt;
+  }
+
+  const auto root = parse(*content);
+  if (!root)
+  {
+    error = path + " is not a valid JSON or TMX map";
+    return std::nullopt;
+  }
+
+  const auto orientation = root->text("orientation", "orthogonal");
+  if (orientation != "orthogonal")
+  {
+    error = "only orthogonal maps are supported, " + path + " is " + orientation;
+    return std::nullopt;
+  }
+
+  Map map;
+  map.width       = root->integer("width");
+  map.height      = root->integer("height");
+  map.tile_width  = root->integer("tilewidth");
+  map.tile_height = root->integer("tileheight");
+  map.infinite    = root->flag("infinite", false);
+  if (map.tile_width <= 0 || map.tile_height <= 0)
+  {
+    error = path + " does not have a tile size";
+    return std::nullopt;
+  }
+
+  if (!readTilesets(*root, path, reader, map, error) || !readLayers(*root, Layer{}, map, error))
+  {
+    return std::nullopt;
+  }
+  return map;
+}
+
+bool pyasge::tiled::decode(const Piece& piece, std::vector<std::uint32_t>& gids, std::string& error)
+{
+  const auto expected = static_cast<std::size_t>(std::max(piece.width, 0)) *
+                        static_cast<std::size_t>(std::max(piece.height, 0));
+  gids.clear();
+  gids.reserve(expected);
+
+  if (piece.encoding == Encoding::CSV)
+  {
+    std::uint64_t value = 0;
+    bool digits         = false;
+    for (const char c : piece.data)
+    {
+      if (c >= '0' && c <= '9')
+      {
+        value  = value * 10 + static_cast<std::uint64_t>(c - '0');
+        digits = true;
+      }
+      else if (digits)
+      {
+        gids.push_back(static_cast<std::uint32_t>(value));
+        value  = 0;
+        digits = false;
+      }
+    }
+    if (digits)
+    {
+      gids.push_back(static_cast<std::uint32_t>(value));
+    }
+  }
+  else
+  {
+    std::vector<std::uint8_t> bytes;
+    if (!base64(piece.data, bytes))
+    {
+      error = "layer data is not valid base64";
+      return false;
+    }
+
+    if (piece.compression == Compression::ZSTD)
+    {
+      error = "zstd compressed layers are not supported";
+      return false;
+    }
+    if (piece.compression != Compression::NONE && !inflate(bytes, expected * 4, error))
+    {
+      return false;
+    }
+
+    // ids are stored as little endian 32 bit integers
+    for (std::size_t i = 0; i + 3 < bytes.size(); i += 4)
+    {
+      gids.push_back(
+        static_cast<std::uint32_t>(bytes[i]) | static_cast<std::uint32_t>(bytes[i + 1]) << 8 |
+        static_cast<std::uint32_t>(bytes[i + 2]) << 16 | static_cast<std::uint32_t>(bytes[i + 3]) << 24);
+    }
+  }
+
+  if (gids.size() != expected)
+  {
+    error = "layer data holds " + std::to_string(gids.size()) + " tiles rather than " + std::to_string(expected);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,122 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace pyasge::tiled
+{
+  /// \brief   Flags Tiled stores in the top bits of a global tile id.
+  constexpr std::uint32_t FLIPPED_HORIZONTALLY = 0x80000000U;
+  constexpr std::uint32_t FLIPPED_VERTICALLY   = 0x40000000U;
+  constexpr std::uint32_t FLIPPED_DIAGONALLY   = 0x20000000U;
+  constexpr std::uint32_t ROTATED_HEXAGONAL    = 0x10000000U;
+  constexpr std::uint32_t GID_MASK             = 0x0FFFFFFFU;
+
+  enum class Encoding
+  {
+    CSV,
+    BASE64
+  };
+
+  enum class Compression
+  {
+    NONE,
+    ZLIB,
+    GZIP,
+    ZSTD
+  };
+
+  /// \brief   A tile with its own image, in a collection of images.
+  struct Image
+  {
+    std::uint32_t id = 0; ///< the tile's id within its tileset
+    std::string path;
+    int width  = 0;
+    int height = 0;
+  };
+
+  /// \brief   A tileset, either a single sheet or a collection of images.
+  struct Tileset
+  {
+    std::uint32_t first_gid = 1;
+    std::string image; ///< the sheet's path, empty for image collections
+    int tile_width  = 0;
+    int tile_height = 0;
+    int spacing     = 0;
+    int margin      = 0;
+    int columns     = 0;
+    int tile_count  = 0;
+    std::vector<Image> images; ///< for collections
+  };
+
+  /// \brief   A rectangle of still encoded global tile ids.
+  /// \details Finite maps store each layer as one piece, while infinite maps
+  ///          store a piece per chunk saved by Tiled.
+  struct Piece
+  {
+    int x      = 0;
+    int y      = 0;
+    int width  = 0;
+    int height = 0;
+    std::string data;
+    Encoding encoding       = Encoding::CSV;
+    Compression compression = Compression::NONE;
+  };
+
+  struct Layer
+  {
+    std::string name;
+    bool visible   = true;
+    float opacity  = 1.0F;
+    float offset_x = 0.0F;
+    float offset_y = 0.0F;
+    std::vector<Piece> pieces;
+  };
+
+  struct Map
+  {
+    int width       = 0;
+    int height      = 0;
+    int tile_width  = 0;
+    int tile_height = 0;
+    bool infinite   = false;
+    std::vector<Tileset> tilesets;
+    std::vector<Layer> layers; ///< tile layers, with groups flattened
+  };
+
+  /// \brief   Reads a file's contents, or returns nullopt if it can't be opened.
+  using FileReader = std::function<std::optional<std::string>(const std::string&)>;
+
+  /// \brief   Reads a Tiled map saved as JSON or TMX.
+  /// \details Only the map's structure is parsed. Layer data is kept encoded
+  ///          so it can be decoded later, and away from the main thread, by
+  ///          decode(). External tilesets are read using the reader, and
+  ///          paths to images are resolved relative to the file naming them.
+  /// \returns The map, or nullopt with error describing why it was rejected.
+  std::optional<Map> read(const std::string& path, const FileReader& reader, std::string& error);
+
+  /// \brief   Decodes a piece into its width * height global tile ids.
+  /// \returns False with error set if the data is malformed or uses a
+  ///          compression this build does not support.
+  bool decode(const Piece& piece, std::vector<std::uint32_t>& gids, std::string& error);
+}
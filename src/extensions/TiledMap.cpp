@@ -0,0 +1,496 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/TiledMap.hpp"
+#include "extensions/Markup.hpp"
+
+#include <Engine/Logger.hpp>
+#include <Engine/OpenGL/GLRenderer.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+  constexpr float QUARTER_TURN = 1.57079632679F;
+
+  int floorDiv(int value, int divisor)
+  {
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+  }
+}
+
+pyasge::TiledMap::TiledMap(
+  ASGE::GLRenderer& gl_renderer, const std::string& path, int chunk_size, int load, int evict) :
+  renderer(&gl_renderer), load_margin(std::max(load, 0)), evict_margin(std::max(evict, load_margin))
+{
+  auto loaded = tiled::read(path, markup::readFile, error_message);
+  if (!loaded)
+  {
+    Logging::ERRORS("Unable to load Tiled map: " + error_message);
+    return;
+  }
+  map = std::move(*loaded);
+
+  // infinite maps can extend in any direction, so take their extent from the data
+  bounds = { 0, 0, map.width, map.height };
+  if (map.infinite)
+  {
+    bounds = { std::numeric_limits<int>::max(), std::numeric_limits<int>::max(), std::numeric_limits<int>::min(),
+               std::numeric_limits<int>::min() };
+    for (const auto& layer : map.layers)
+    {
+      for (const auto& piece : layer.pieces)
+      {
+        bounds = { std::min(bounds[0], piece.x), std::min(bounds[1], piece.y),
+                   std::max(bounds[2], piece.x + piece.width), std::max(bounds[3], piece.y + piece.height) };
+      }
+    }
+    if (bounds[0] > bounds[2])
+    {
+      bounds = { 0, 0, 0, 0 };
+    }
+  }
+
+  for (const auto& source : map.layers)
+  {
+    LayerState layer;
+    layer.name    = source.name;
+    layer.visible = source.visible;
+    layer.map =
+      std::make_unique<TileMap>(gl_renderer, columns(), rows(), tileWidth(), tileHeight(), chunk_size, tiles);
+    layer.map->setOpacity(source.opacity);
+    layer.map->setPosition(
+      static_cast<float>(bounds[0]) * tileWidth() + source.offset_x,
+      static_cast<float>(bounds[1]) * tileHeight() + source.offset_y);
+
+    // index which pieces cover each chunk, so a chunk knows what to decode
+    const int size = layer.map->chunkSize();
+    layer.pieces.resize(source.pieces.size());
+    for (std::size_t i = 0; i < source.pieces.size(); ++i)
+    {
+      const auto& piece = source.pieces[i];
+      auto& chunks      = layer.pieces[i].chunks;
+      chunks            = { floorDiv(piece.x - bounds[0], size), floorDiv(piece.x - bounds[0] + piece.width - 1, size),
+                            floorDiv(piece.y - bounds[1], size), floorDiv(piece.y - bounds[1] + piece.height - 1, size) };
+      chunks = { std::max(chunks[0], 0), std::min(chunks[1], layer.map->chunkColumns() - 1), std::max(chunks[2], 0),
+                 std::min(chunks[3], layer.map->chunkRows() - 1) };
+
+      for (int row = chunks[2]; row <= chunks[3]; ++row)
+      {
+        for (int column = chunks[0]; column <= chunks[1]; ++column)
+        {
+          layer.coverage[static_cast<std::size_t>(row) * layer.map->chunkColumns() + column].push_back(i);
+        }
+      }
+    }
+    layers.push_back(std::move(layer));
+  }
+
+  worker = std::thread(&TiledMap::work, this);
+}
+
+pyasge::TiledMap::~TiledMap()
+{
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+
+  if (worker.joinable())
+  {
+    worker.join();
+  }
+}
+
+void pyasge::TiledMap::work()
+{
+  while (true)
+  {
+    Job job{};
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex);
+      wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+      if (stopping)
+      {
+        return;
+      }
+      job = jobs.front();
+      jobs.pop_front();
+      busy = true;
+    }
+
+    Result result{ job, {}, {} };
+    std::vector<std::uint32_t> gids;
+    if (tiled::decode(map.layers[job.layer].pieces[job.piece], gids, result.error))
+    {
+      translate(gids, result.ids);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex);
+      results.push_back(std::move(result));
+      busy = false;
+    }
+    idle.notify_all();
+  }
+}
+
+void pyasge::TiledMap::translate(const std::vector<std::uint32_t>& gids, std::vector<std::uint16_t>& ids)
+{
+  std::lock_guard<std::mutex> lock(table_mutex);
+  ids.resize(gids.size());
+  for (std::size_t i = 0; i < gids.size(); ++i)
+  {
+    const auto gid = gids[i];
+    if ((gid & tiled::GID_MASK) == 0)
+    {
+      ids[i] = 0;
+      continue;
+    }
+
+    auto iter = tile_ids.find(gid);
+    if (iter == tile_ids.end())
+    {
+      if (tile_gids.size() >= std::numeric_limits<std::uint16_t>::max())
+      {
+        overflowed = true;
+        ids[i]     = 0;
+        continue;
+      }
+      tile_gids.push_back(gid);
+      iter = tile_ids.emplace(gid, static_cast<std::uint16_t>(tile_gids.size())).first;
+    }
+    ids[i] = iter->second;
+  }
+}
+
+void pyasge::TiledMap::registerTiles()
+{
+  std::vector<std::uint32_t> fresh;
+  {
+    std::lock_guard<std::mutex> lock(table_mutex);
+    fresh.assign(tile_gids.begin() + static_cast<std::ptrdiff_t>(tile_set_ids.size() - 1), tile_gids.end());
+    if (overflowed)
+    {
+      Logging::WARN("Tiled map uses more than 65535 distinct tiles, the rest are left empty");
+      overflowed = false;
+    }
+  }
+
+  // the set is shared with Python, so its ids only match the map's until something else adds to it
+  for (const auto gid : fresh)
+  {
+    const auto id = tiles->add(makeTile(gid));
+    renumbered    = renumbered || id != tile_set_ids.size();
+    tile_set_ids.push_back(id);
+  }
+}
+
+ASGE::Tile pyasge::TiledMap::makeTile(std::uint32_t gid)
+{
+  ASGE::Tile tile;
+  const auto id   = gid & tiled::GID_MASK;
+  const auto iter = std::upper_bound(
+    map.tilesets.begin(), map.tilesets.end(), id,
+    [](std::uint32_t value, const tiled::Tileset& tileset) { return value < tileset.first_gid; });
+  if (iter == map.tilesets.begin())
+  {
+    return tile;
+  }
+
+  // ids without a tileset or image still get a tile, left without a texture
+  const auto& tileset = *std::prev(iter);
+  const auto local    = id - tileset.first_gid;
+  float src_rect[4]   = {};
+  if (!tileset.image.empty())
+  {
+    auto* sheet = texture(tileset.image);
+    if (sheet == nullptr || (tileset.tile_count > 0 && local >= static_cast<std::uint32_t>(tileset.tile_count)))
+    {
+      return tile;
+    }
+
+    const int step_x  = tileset.tile_width + tileset.spacing;
+    const int step_y  = tileset.tile_height + tileset.spacing;
+    const int columns = tileset.columns > 0
+                          ? tileset.columns
+                          : std::max((static_cast<int>(sheet->getWidth()) - 2 * tileset.margin + tileset.spacing) / step_x, 1);
+    tile.texture = sheet;
+    tile.width   = tileset.tile_width;
+    tile.height  = tileset.tile_height;
+    src_rect[0]  = static_cast<float>(tileset.margin + static_cast<int>(local % columns) * step_x);
+    src_rect[1]  = static_cast<float>(tileset.margin + static_cast<int>(local / columns) * step_y);
+    src_rect[2]  = static_cast<float>(tileset.tile_width);
+    src_rect[3]  = static_cast<float>(tileset.tile_height);
+  }
+  else
+  {
+    const auto image = std::find_if(
+      tileset.images.begin(), tileset.images.end(), [local](const tiled::Image& entry) { return entry.id == local; });
+    auto* single = image != tileset.images.end() ? texture(image->path) : nullptr;
+    if (single == nullptr)
+    {
+      return tile;
+    }
+
+    tile.texture = single;
+    tile.width   = image->width > 0 ? image->width : static_cast<int>(single->getWidth());
+    tile.height  = image->height > 0 ? image->height : static_cast<int>(single->getHeight());
+    src_rect[2]  = static_cast<float>(tile.width);
+    src_rect[3]  = static_cast<float>(tile.height);
+  }
+
+  // Tiled flips diagonally first, then horizontally and vertically. Without
+  // a diagonal flip that is a mirror of the source rectangle, and with one it
+  // is a mirror followed by a quarter turn.
+  const bool horizontal = (gid & tiled::FLIPPED_HORIZONTALLY) != 0;
+  const bool vertical   = (gid & tiled::FLIPPED_VERTICALLY) != 0;
+  const bool diagonal   = (gid & tiled::FLIPPED_DIAGONALLY) != 0;
+  const bool mirror_x   = diagonal ? vertical : horizontal;
+  const bool mirror_y   = diagonal ? !horizontal : vertical;
+  if (mirror_x)
+  {
+    src_rect[0] += src_rect[2];
+    src_rect[2] = -src_rect[2];
+  }
+  if (mirror_y)
+  {
+    src_rect[1] += src_rect[3];
+    src_rect[3] = -src_rect[3];
+  }
+  tile.rotation = diagonal ? QUARTER_TURN : 0.0F;
+  std::copy(std::begin(src_rect), std::end(src_rect), std::begin(tile.src_rect));
+  return tile;
+}
+
+ASGE::Texture2D* pyasge::TiledMap::texture(const std::string& path)
+{
+  auto iter = textures.find(path);
+  if (iter == textures.end())
+  {
+    auto* loaded = renderer->createCachedTexture(path);
+    if (loaded == nullptr)
+    {
+      Logging::ERRORS("Unable to load tileset image " + path);
+    }
+    iter = textures.emplace(path, loaded).first;
+  }
+  return iter->second;
+}
+
+std::array<int, 4> pyasge::TiledMap::chunkRange(const LayerState& layer, int margin) const
+{
+  const auto& view    = renderer->getResolutionInfo().view;
+  const auto& grid    = *layer.map;
+  const float chunk_w = grid.tileWidth() * static_cast<float>(grid.chunkSize());
+  const float chunk_h = grid.tileHeight() * static_cast<float>(grid.chunkSize());
+  const auto index    = [](float offset, float span) { return static_cast<int>(std::floor(offset / span)); };
+
+  return { std::max(index(view.min_x - grid.x(), chunk_w) - margin, 0),
+           std::min(index(view.max_x - grid.x(), chunk_w) + margin, grid.chunkColumns() - 1),
+           std::max(index(std::min(view.min_y, view.max_y) - grid.y(), chunk_h) - margin, 0),
+           std::min(index(std::max(view.min_y, view.max_y) - grid.y(), chunk_h) + margin, grid.chunkRows() - 1) };
+}
+
+bool pyasge::TiledMap::place(LayerState& layer, std::size_t chunk)
+{
+  const auto iter = layer.coverage.find(chunk);
+  if (iter == layer.coverage.end())
+  {
+    return true;
+  }
+
+  // queue whatever still needs decoding, and wait for it before filling the chunk
+  bool ready       = true;
+  const auto index = static_cast<std::size_t>(&layer - layers.data());
+  for (const auto piece : iter->second)
+  {
+    auto& state = layer.pieces[piece];
+    if (state.status == Status::IDLE)
+    {
+      {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        jobs.push_back({ index, piece });
+      }
+      wake.notify_one();
+      state.status = Status::QUEUED;
+    }
+    ready &= state.status == Status::READY || state.status == Status::FAILED;
+  }
+  if (!ready)
+  {
+    return false;
+  }
+
+  auto& grid       = *layer.map;
+  const int size   = grid.chunkSize();
+  const int column = static_cast<int>(chunk % grid.chunkColumns()) * size;
+  const int row    = static_cast<int>(chunk / grid.chunkColumns()) * size;
+  for (const auto piece : iter->second)
+  {
+    const auto& state = layer.pieces[piece];
+    if (state.status != Status::READY)
+    {
+      continue;
+    }
+
+    // the part of the piece inside the chunk, in the tile map's cells
+    const auto& source = map.layers[index].pieces[piece];
+    const int piece_x  = source.x - bounds[0];
+    const int piece_y  = source.y - bounds[1];
+    const int left     = std::max(column, piece_x);
+    const int top      = std::max(row, piece_y);
+    const int right    = std::min(column + size, piece_x + source.width);
+    const int bottom   = std::min(row + size, piece_y + source.height);
+    if (left < right && top < bottom)
+    {
+      grid.assign(
+        left, top, right - left, bottom - top,
+        state.ids.data() + static_cast<std::size_t>(top - piece_y) * source.width + (left - piece_x),
+        static_cast<std::size_t>(source.width));
+    }
+  }
+  return true;
+}
+
+void pyasge::TiledMap::update()
+{
+  if (!valid())
+  {
+    return;
+  }
+
+  std::vector<Result> finished;
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    finished.swap(results);
+  }
+
+  // the ids in finished pieces must exist in the layers before they are placed
+  registerTiles();
+  for (auto& result : finished)
+  {
+    auto& state = layers[result.job.layer].pieces[result.job.piece];
+    if (!result.error.empty())
+    {
+      Logging::ERRORS("Unable to decode Tiled layer " + layers[result.job.layer].name + ": " + result.error);
+      state.status = Status::FAILED;
+      continue;
+    }
+    if (renumbered)
+    {
+      for (auto& id : result.ids)
+      {
+        id = tile_set_ids[id];
+      }
+    }
+    state.status = Status::READY;
+    state.ids    = std::move(result.ids);
+    ++stats.pieces_decoded;
+  }
+
+  stats.chunks_loaded  = 0;
+  stats.chunks_pending = 0;
+  stats.pieces_cached  = 0;
+  for (auto& layer : layers)
+  {
+    const auto need    = chunkRange(layer, load_margin);
+    const auto keep    = chunkRange(layer, evict_margin);
+    const auto outside = [](const std::array<int, 4>& range, int column, int row)
+    { return column < range[0] || column > range[1] || row < range[2] || row > range[3]; };
+    const auto columns = static_cast<std::size_t>(layer.map->chunkColumns());
+
+    for (auto iter = layer.loaded.begin(); iter != layer.loaded.end();)
+    {
+      const auto column = static_cast<int>(*iter % columns);
+      const auto row    = static_cast<int>(*iter / columns);
+      if (outside(keep, column, row))
+      {
+        layer.map->evict(column, row);
+        iter = layer.loaded.erase(iter);
+        ++stats.chunks_evicted;
+        continue;
+      }
+      ++iter;
+    }
+
+    for (int row = need[2]; row <= need[3]; ++row)
+    {
+      for (int column = need[0]; column <= need[1]; ++column)
+      {
+        const auto chunk = static_cast<std::size_t>(row) * columns + column;
+        if (layer.loaded.count(chunk) != 0)
+        {
+          continue;
+        }
+
+        if (place(layer, chunk))
+        {
+          layer.loaded.insert(chunk);
+          continue;
+        }
+        ++stats.chunks_pending;
+      }
+    }
+
+    // decoded data no longer near the view is decoded again if it is needed
+    for (auto& piece : layer.pieces)
+    {
+      if (piece.status != Status::READY)
+      {
+        continue;
+      }
+      if (piece.chunks[1] < keep[0] || piece.chunks[0] > keep[1] || piece.chunks[3] < keep[2] ||
+          piece.chunks[2] > keep[3])
+      {
+        piece.status = Status::IDLE;
+        std::vector<std::uint16_t>().swap(piece.ids);
+        continue;
+      }
+      ++stats.pieces_cached;
+    }
+    stats.chunks_loaded += layer.loaded.size();
+  }
+}
+
+void pyasge::TiledMap::wait()
+{
+  update();
+  while (stats.chunks_pending != 0)
+  {
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex);
+      idle.wait(lock, [this] { return jobs.empty() && !busy; });
+    }
+    update();
+  }
+}
+
+std::size_t pyasge::TiledMap::render()
+{
+  update();
+
+  std::size_t draws = 0;
+  for (auto& layer : layers)
+  {
+    if (layer.visible)
+    {
+      draws += layer.map->render();
+    }
+  }
+  return draws;
+}
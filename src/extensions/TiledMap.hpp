@@ -0,0 +1,178 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "extensions/TiledFormat.hpp"
+#include "extensions/TileMap.hpp"
+
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace ASGE
+{
+  class GLRenderer;
+  class Texture2D;
+}
+
+namespace pyasge
+{
+  /// \brief   A Tiled map streamed into tile maps around the camera.
+  /// \details Opening a map parses its structure and tilesets but leaves
+  ///          the layer data encoded. Each tile layer becomes a TileMap, and
+  ///          as the camera moves the chunks near the view are filled in
+  ///          while those far from it are evicted. The layer data covering
+  ///          a chunk is decoded (csv, base64, zlib and gzip) and its global
+  ///          ids translated into map ids on a worker thread, so the main
+  ///          thread only renumbers finished ids into the maps. Decoded data
+  ///          is dropped again once nothing near the view uses it, so an
+  ///          infinite map only ever holds its compressed data plus the
+  ///          area around the camera.
+  ///
+  ///          Every distinct global id, including its flip flags, gets a map
+  ///          id in the order the worker first meets it, and becomes a tile
+  ///          in a TileSet shared by every layer. Tiles are created on the
+  ///          main thread, where their textures can be loaded, and each map
+  ///          id is mapped to the id the TileSet returned for it. Tiles added
+  ///          to the set from elsewhere therefore never shift the map's.
+  class TiledMap
+  {
+   public:
+    struct Statistics
+    {
+      std::size_t chunks_loaded  = 0; ///< chunks filled in across every layer
+      std::size_t chunks_pending = 0; ///< chunks near the view waiting on the worker
+      std::size_t chunks_evicted = 0; ///< chunks evicted since the map was opened
+      std::size_t pieces_decoded = 0; ///< pieces of layer data decoded since the map was opened
+      std::size_t pieces_cached  = 0; ///< decoded pieces currently held
+    };
+
+    TiledMap(ASGE::GLRenderer& gl_renderer, const std::string& path, int chunk_size, int load, int evict);
+    ~TiledMap();
+    TiledMap(const TiledMap&) = delete;
+    TiledMap& operator=(const TiledMap&) = delete;
+
+    [[nodiscard]] bool valid() const noexcept { return error_message.empty(); }
+    [[nodiscard]] const std::string& error() const noexcept { return error_message; }
+
+    /// \brief   Streams chunks in and out around the current camera view.
+    void update();
+
+    /// \brief   Updates the map, waiting until every chunk near the view is loaded.
+    void wait();
+
+    /// \brief   Updates the map and draws its visible layers in order.
+    std::size_t render();
+
+    [[nodiscard]] std::size_t layerCount() const noexcept { return layers.size(); }
+    [[nodiscard]] TileMap& layer(std::size_t index) { return *layers[index].map; }
+    [[nodiscard]] const std::string& layerName(std::size_t index) const { return layers[index].name; }
+    [[nodiscard]] bool layerVisible(std::size_t index) const { return layers[index].visible; }
+    void setLayerVisible(std::size_t index, bool visible) { layers[index].visible = visible; }
+
+    [[nodiscard]] int columns() const noexcept { return bounds[2] - bounds[0]; }
+    [[nodiscard]] int rows() const noexcept { return bounds[3] - bounds[1]; }
+    [[nodiscard]] int firstColumn() const noexcept { return bounds[0]; }
+    [[nodiscard]] int firstRow() const noexcept { return bounds[1]; }
+    [[nodiscard]] float tileWidth() const noexcept { return static_cast<float>(map.tile_width); }
+    [[nodiscard]] float tileHeight() const noexcept { return static_cast<float>(map.tile_height); }
+    [[nodiscard]] bool infinite() const noexcept { return map.infinite; }
+    [[nodiscard]] const std::shared_ptr<TileSet>& tileSet() const noexcept { return tiles; }
+    [[nodiscard]] const Statistics& statistics() const noexcept { return stats; }
+
+   private:
+    enum class Status
+    {
+      IDLE,
+      QUEUED,
+      READY,
+      FAILED
+    };
+
+    struct PieceState
+    {
+      Status status = Status::IDLE;
+      std::vector<std::uint16_t> ids;
+      std::array<int, 4> chunks{}; ///< first and last chunk column and row covered
+    };
+
+    struct LayerState
+    {
+      std::string name;
+      bool visible = true;
+      std::unique_ptr<TileMap> map;
+      std::vector<PieceState> pieces;
+      std::unordered_map<std::size_t, std::vector<std::size_t>> coverage; ///< chunk index to pieces
+      std::unordered_set<std::size_t> loaded;
+    };
+
+    struct Job
+    {
+      std::size_t layer;
+      std::size_t piece;
+    };
+
+    struct Result
+    {
+      Job job;
+      std::vector<std::uint16_t> ids;
+      std::string error;
+    };
+
+    void work();
+    void translate(const std::vector<std::uint32_t>& gids, std::vector<std::uint16_t>& ids);
+    void registerTiles();
+    ASGE::Tile makeTile(std::uint32_t gid);
+    ASGE::Texture2D* texture(const std::string& path);
+    bool place(LayerState& layer, std::size_t chunk);
+    [[nodiscard]] std::array<int, 4> chunkRange(const LayerState& layer, int margin) const;
+
+    ASGE::GLRenderer* renderer;
+    tiled::Map map;
+    std::string error_message;
+    std::array<int, 4> bounds{}; ///< first column and row, and one past the last, in Tiled's coordinates
+    int load_margin;
+    int evict_margin;
+    std::vector<LayerState> layers;
+    std::unordered_map<std::string, ASGE::Texture2D*> textures;
+    std::shared_ptr<TileSet> tiles = std::make_shared<TileSet>();
+    std::vector<std::uint16_t> tile_set_ids = { 0 }; ///< the tileset's id for each map id
+    bool renumbered = false;                         ///< whether any map id differs from its tileset id
+    Statistics stats;
+
+    // shared with the worker
+    std::mutex table_mutex;
+    std::unordered_map<std::uint32_t, std::uint16_t> tile_ids;
+    std::vector<std::uint32_t> tile_gids; ///< the global id behind each map id, less one
+    bool overflowed = false;
+
+    std::mutex queue_mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::deque<Job> jobs;
+    std::vector<Result> results;
+    bool busy     = false;
+    bool stopping = false;
+    std::thread worker;
+  };
+}
@@ -0,0 +1,420 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include "extensions/Tweener.hpp"
+
+#include <Engine/Camera.hpp>
+#include <Engine/Sprite.hpp>
+#include <Engine/Text.hpp>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace
+{
+  using pyasge::Tweener;
+
+  constexpr float PI = 3.14159265358979F;
+
+  float bounceOut(float t) noexcept
+  {
+    constexpr float N1 = 7.5625F;
+    constexpr float D1 = 2.75F;
+    if (t < 1.0F / D1)
+    {
+      return N1 * t * t;
+    }
+    if (t < 2.0F / D1)
+    {
+      t -= 1.5F / D1;
+      return N1 * t * t + 0.75F;
+    }
+    if (t < 2.5F / D1)
+    {
+      t -= 2.25F / D1;
+      return N1 * t * t + 0.9375F;
+    }
+    t -= 2.625F / D1;
+    return N1 * t * t + 0.984375F;
+  }
+
+  /// The IN curve of each family, in the order the families appear in Ease.
+  float easeIn(int family, float t) noexcept
+  {
+    switch (family)
+    {
+      case 0:
+        return 1.0F - std::cos(t * PI * 0.5F);
+      case 1:
+        return t * t;
+      case 2:
+        return t * t * t;
+      case 3:
+        return t * t * t * t;
+      case 4:
+        return t * t * t * t * t;
+      case 5:
+        return t <= 0.0F ? 0.0F : std::pow(2.0F, 10.0F * t - 10.0F);
+      case 6:
+        return 1.0F - std::sqrt(std::max(1.0F - t * t, 0.0F));
+      case 7:
+      {
+        constexpr float OVERSHOOT = 1.70158F;
+        return (OVERSHOOT + 1.0F) * t * t * t - OVERSHOOT * t * t;
+      }
+      case 8:
+        return t <= 0.0F || t >= 1.0F
+                 ? t
+                 : -std::pow(2.0F, 10.0F * t - 10.0F) * std::sin((t * 10.0F - 10.75F) * (2.0F * PI / 3.0F));
+      default:
+        return 1.0F - bounceOut(1.0F - t);
+    }
+  }
+
+  float read(const Tweener::Target& target, Tweener::Property property)
+  {
+    using Property = Tweener::Property;
+    if (target.sprite != nullptr)
+    {
+      const auto& sprite = *target.sprite;
+      switch (property)
+      {
+        case Property::X: return sprite.xPos();
+        case Property::Y: return sprite.yPos();
+        case Property::SCALE: return sprite.scale();
+        case Property::ROTATION: return sprite.rotationInRadians();
+        case Property::OPACITY: return sprite.opacity();
+        case Property::WIDTH: return sprite.width();
+        case Property::HEIGHT: return sprite.height();
+        default: return 0.0F;
+      }
+    }
+    if (target.text != nullptr)
+    {
+      const auto& text = *target.text;
+      switch (property)
+      {
+        case Property::X: return text.getPosition().x;
+        case Property::Y: return text.getPosition().y;
+        case Property::SCALE: return text.getScale();
+        case Property::OPACITY: return text.getOpacity();
+        default: return 0.0F;
+      }
+    }
+
+    const auto& camera = *target.camera;
+    switch (property)
+    {
+      case Property::X: return camera.position().x;
+      case Property::Y: return camera.position().y;
+      case Property::ZOOM: return camera.getZoom();
+      default: return 0.0F;
+    }
+  }
+
+  void write(const Tweener::Target& target, Tweener::Property property, float value)
+  {
+    using Property = Tweener::Property;
+    if (target.sprite != nullptr)
+    {
+      auto& sprite = *target.sprite;
+      switch (property)
+      {
+        case Property::X: sprite.xPos(value); break;
+        case Property::Y: sprite.yPos(value); break;
+        case Property::SCALE: sprite.scale(value); break;
+        case Property::ROTATION: sprite.rotationInRadians(value); break;
+        case Property::OPACITY: sprite.opacity(value); break;
+        case Property::WIDTH: sprite.width(value); break;
+        case Property::HEIGHT: sprite.height(value); break;
+        default: break;
+      }
+      return;
+    }
+    if (target.text != nullptr)
+    {
+      auto& text = *target.text;
+      switch (property)
+      {
+        case Property::X: text.setPositionX(value); break;
+        case Property::Y: text.setPositionY(value); break;
+        case Property::SCALE: text.setScale(value); break;
+        case Property::OPACITY: text.setOpacity(value); break;
+        default: break;
+      }
+      return;
+    }
+
+    auto& camera = *target.camera;
+    switch (property)
+    {
+      case Property::X: camera.translateX(value); break;
+      case Property::Y: camera.translateY(value); break;
+      case Property::ZOOM: camera.setZoom(value); break;
+      default: break;
+    }
+  }
+}
+
+float pyasge::ease(Ease curve, float progress) noexcept
+{
+  const float t = std::clamp(progress, 0.0F, 1.0F);
+  if (curve == Ease::LINEAR)
+  {
+    return t;
+  }
+
+  const int index  = static_cast<int>(curve) - 1;
+  const int family = index / 3;
+  switch (index % 3)
+  {
+    case 0:
+      return easeIn(family, t);
+    case 1:
+      return 1.0F - easeIn(family, 1.0F - t);
+    default:
+      return t < 0.5F ? easeIn(family, t * 2.0F) * 0.5F : 1.0F - easeIn(family, 2.0F - t * 2.0F) * 0.5F;
+  }
+}
+
+const void* pyasge::Tweener::Target::object() const noexcept
+{
+  if (sprite != nullptr)
+  {
+    return sprite;
+  }
+  return text != nullptr ? static_cast<const void*>(text) : static_cast<const void*>(camera);
+}
+
+bool pyasge::Tweener::supports(const Target& target, Property property) noexcept
+{
+  if (target.sprite != nullptr)
+  {
+    return property != Property::ZOOM;
+  }
+  if (target.text != nullptr)
+  {
+    return property == Property::X || property == Property::Y || property == Property::SCALE ||
+           property == Property::OPACITY;
+  }
+  return target.camera != nullptr && (property == Property::X || property == Property::Y || property == Property::ZOOM);
+}
+
+pyasge::Tweener::Id
+pyasge::Tweener::add(const Target& target, Property property, float value, float duration, const Options& options)
+{
+  Tween tween;
+  tween.target   = target;
+  tween.property = property;
+  tween.options  = options;
+  tween.value    = value;
+  tween.duration = std::isfinite(duration) ? std::max(duration, 0.0F) : 0.0F;
+  tween.id       = next_id++;
+  if (next_id == 0)
+  {
+    next_id = 1;
+  }
+
+  // a tween without length can't repeat, or it would repeat forever within one update
+  if (tween.duration <= 0.0F)
+  {
+    tween.options.repeats = 0;
+  }
+
+  if (options.after != 0 && contains(options.after))
+  {
+    tween.waiting = true;
+    followers.emplace(options.after, tween.id);
+  }
+
+  slots[tween.id] = tweens.size();
+  tweens.push_back(tween);
+  return tween.id;
+}
+
+std::vector<pyasge::Tweener::Id> pyasge::Tweener::cancel(Id id)
+{
+  std::vector<Id> removed;
+  if (!contains(id))
+  {
+    return removed;
+  }
+
+  std::vector<Id> pending{ id };
+  while (!pending.empty())
+  {
+    const auto current = pending.back();
+    pending.pop_back();
+    auto [first, last] = followers.equal_range(current);
+    for (auto iter = first; iter != last; ++iter)
+    {
+      pending.push_back(iter->second);
+    }
+    followers.erase(current);
+
+    // a waiting tween is also listed under the tween it follows
+    const auto& tween = tweens[slots.at(current)];
+    if (tween.waiting)
+    {
+      auto [waited_first, waited_last] = followers.equal_range(tween.options.after);
+      for (auto iter = waited_first; iter != waited_last; ++iter)
+      {
+        if (iter->second == current)
+        {
+          followers.erase(iter);
+          break;
+        }
+      }
+    }
+
+    remove(current);
+    removed.push_back(current);
+  }
+  return removed;
+}
+
+std::vector<pyasge::Tweener::Id> pyasge::Tweener::cancel(const void* object)
+{
+  std::vector<Id> targeted;
+  for (const auto& tween : tweens)
+  {
+    if (tween.target.object() == object)
+    {
+      targeted.push_back(tween.id);
+    }
+  }
+
+  std::vector<Id> removed;
+  for (auto id : targeted)
+  {
+    auto cancelled = cancel(id);
+    removed.insert(removed.end(), cancelled.begin(), cancelled.end());
+  }
+  return removed;
+}
+
+void pyasge::Tweener::clear()
+{
+  tweens.clear();
+  slots.clear();
+  followers.clear();
+  finished.clear();
+}
+
+void pyasge::Tweener::update(double seconds)
+{
+  finished.clear();
+  if (!(seconds > 0))
+  {
+    return;
+  }
+
+  std::vector<std::pair<Id, double>> done;
+  for (auto& tween : tweens)
+  {
+    if (!tween.waiting)
+    {
+      const double left = advance(tween, seconds);
+      if (left >= 0)
+      {
+        done.emplace_back(tween.id, left);
+      }
+    }
+  }
+
+  // completions start their followers with the time left over, which may complete them in turn
+  for (std::size_t i = 0; i < done.size(); ++i)
+  {
+    const auto [id, left] = done[i];
+    finished.push_back(id);
+
+    auto [first, last] = followers.equal_range(id);
+    for (auto iter = first; iter != last; ++iter)
+    {
+      auto& follower   = tweens[slots.at(iter->second)];
+      follower.waiting = false;
+      const double remaining = advance(follower, left);
+      if (remaining >= 0)
+      {
+        done.emplace_back(follower.id, remaining);
+      }
+    }
+    followers.erase(id);
+  }
+
+  for (auto id : finished)
+  {
+    remove(id);
+  }
+}
+
+double pyasge::Tweener::advance(Tween& tween, double seconds)
+{
+  tween.elapsed += seconds;
+  const double delay = tween.options.delay;
+  if (tween.elapsed < delay)
+  {
+    return -1.0;
+  }
+
+  if (!tween.started)
+  {
+    tween.started = true;
+    tween.from    = read(tween.target, tween.property);
+    tween.to      = tween.options.relative ? tween.from + tween.value : tween.value;
+  }
+
+  // wind back a play at a time while repeats remain, keeping the clock small
+  double played = tween.elapsed - delay;
+  while (played >= tween.duration && tween.options.repeats != 0)
+  {
+    played -= tween.duration;
+    tween.options.repeats -= tween.options.repeats > 0 ? 1 : 0;
+    if (tween.options.yoyo)
+    {
+      std::swap(tween.from, tween.to);
+    }
+  }
+  tween.elapsed = delay + played;
+
+  if (played >= tween.duration)
+  {
+    write(tween.target, tween.property, tween.to);
+    return played - tween.duration;
+  }
+
+  const float progress = ease(tween.options.ease, static_cast<float>(played / tween.duration));
+  write(tween.target, tween.property, tween.from + (tween.to - tween.from) * progress);
+  return -1.0;
+}
+
+void pyasge::Tweener::remove(Id id)
+{
+  auto iter = slots.find(id);
+  if (iter == slots.end())
+  {
+    return;
+  }
+
+  // the last tween fills the gap, keeping the array packed
+  const auto slot = iter->second;
+  slots.erase(iter);
+  if (slot + 1 != tweens.size())
+  {
+    tweens[slot]           = tweens.back();
+    slots[tweens[slot].id] = slot;
+  }
+  tweens.pop_back();
+}
@@ -0,0 +1,173 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ASGE
+{
+  class Camera;
+  class Sprite;
+  class Text;
+}
+
+namespace pyasge
+{
+  /// \brief   The standard easing curves.
+  /// \details Each family has an IN, OUT and IN_OUT variant, in that order.
+  ///          OUT curves are their IN curve turned around, and IN_OUT
+  ///          curves play the IN curve over the first half and the OUT
+  ///          curve over the second.
+  enum class Ease : std::uint8_t
+  {
+    LINEAR,
+    SINE_IN,
+    SINE_OUT,
+    SINE_IN_OUT,
+    QUAD_IN,
+    QUAD_OUT,
+    QUAD_IN_OUT,
+    CUBIC_IN,
+    CUBIC_OUT,
+    CUBIC_IN_OUT,
+    QUART_IN,
+    QUART_OUT,
+    QUART_IN_OUT,
+    QUINT_IN,
+    QUINT_OUT,
+    QUINT_IN_OUT,
+    EXPO_IN,
+    EXPO_OUT,
+    EXPO_IN_OUT,
+    CIRC_IN,
+    CIRC_OUT,
+    CIRC_IN_OUT,
+    BACK_IN,
+    BACK_OUT,
+    BACK_IN_OUT,
+    ELASTIC_IN,
+    ELASTIC_OUT,
+    ELASTIC_IN_OUT,
+    BOUNCE_IN,
+    BOUNCE_OUT,
+    BOUNCE_IN_OUT
+  };
+
+  /// \brief   Maps progress through a tween, from 0 to 1, along a curve.
+  float ease(Ease curve, float progress) noexcept;
+
+  /// \brief   Animates properties of sprites, texts and cameras towards target values.
+  /// \details Tweens are kept in one packed array and stepped together.
+  ///          A tween reads its starting value when it starts, after its
+  ///          delay and after the tween it follows has completed, so chains
+  ///          of tweens on the same property carry on from each other.
+  ///          Time left over when a tween completes is passed on to the
+  ///          tweens following it, so sequences don't drift by a frame at
+  ///          every step.
+  class Tweener
+  {
+   public:
+    using Id = std::uint32_t;
+
+    enum class Property : std::uint8_t
+    {
+      X,
+      Y,
+      SCALE,
+      ROTATION,
+      OPACITY,
+      WIDTH,
+      HEIGHT,
+      ZOOM
+    };
+
+    /// \brief   The object a tween animates. Exactly one pointer is set.
+    struct Target
+    {
+      ASGE::Sprite* sprite = nullptr;
+      ASGE::Text* text     = nullptr;
+      ASGE::Camera* camera = nullptr;
+
+      [[nodiscard]] const void* object() const noexcept;
+    };
+
+    struct Options
+    {
+      Ease ease     = Ease::LINEAR;
+      float delay   = 0;     ///< seconds to wait once the tween could start
+      Id after      = 0;     ///< a tween that must complete first, or 0
+      int repeats   = 0;     ///< extra plays after the first, or -1 forever
+      bool yoyo     = false; ///< repeats alternate direction
+      bool relative = false; ///< the value is added to the starting value
+    };
+
+    /// \brief   Whether a kind of object has a property that can be tweened.
+    static bool supports(const Target& target, Property property) noexcept;
+
+    /// \brief   Adds a tween moving a property to value over duration seconds.
+    /// \details A tween that follows one which no longer exists starts
+    ///          straight away. Unsupported properties must be rejected by
+    ///          the caller using supports().
+    Id add(const Target& target, Property property, float value, float duration, const Options& options);
+
+    /// \brief   Removes a tween and every tween that follows it.
+    /// \returns The ids removed, empty if the tween did not exist.
+    std::vector<Id> cancel(Id id);
+
+    /// \brief   Removes every tween animating an object, and those following them.
+    std::vector<Id> cancel(const void* object);
+
+    void clear();
+
+    /// \brief   Advances every running tween and writes their properties.
+    void update(double seconds);
+
+    /// \brief   The tweens that completed during the last update, in the order they did.
+    [[nodiscard]] const std::vector<Id>& completed() const noexcept { return finished; }
+
+    [[nodiscard]] bool contains(Id id) const { return slots.count(id) != 0; }
+    [[nodiscard]] std::size_t size() const noexcept { return tweens.size(); }
+
+   private:
+    struct Tween
+    {
+      Target target;
+      Property property = Property::X;
+      Options options;
+      float value    = 0; ///< as given, before being made relative
+      float from     = 0;
+      float to       = 0;
+      float duration = 0;
+      double elapsed = 0;
+      Id id          = 0;
+      bool waiting   = false; ///< still waiting on the tween it follows
+      bool started   = false;
+    };
+
+    /// \returns The seconds left over if the tween completed, otherwise a negative number.
+    static double advance(Tween& tween, double seconds);
+    void remove(Id id);
+
+    std::vector<Tween> tweens;
+    std::unordered_map<Id, std::size_t> slots;
+    std::unordered_multimap<Id, Id> followers; ///< keyed by the tween being waited on
+    std::vector<Id> finished;
+    Id next_id = 1;
+  };
+}
@@ -0,0 +1,186 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "extensions/UniformBlocks.hpp"
+
+#include <Engine/Logger.hpp>
+#include <algorithm>
+#include <cstring>
+
+pyasge::UniformBlock::UniformBlock(std::string name, std::size_t size) :
+  block_name(std::move(name)), storage(((size + 15) / 16) * 4, 0.0F)
+{
+}
+
+pyasge::UniformBlocks::UniformBlocks()
+{
+  entries.push_back(
+    Entry{ std::make_shared<UniformBlock>(FRAME_DATA, sizeof(FrameData)), 0, 0 });
+}
+
+pyasge::UniformBlocks::~UniformBlocks()
+{
+  for (auto& entry : entries)
+  {
+    if (entry.buffer != 0)
+    {
+      glDeleteBuffers(1, &entry.buffer);
+    }
+  }
+}
+
+void pyasge::UniformBlocks::add(std::shared_ptr<UniformBlock> block)
+{
+  auto duplicate = std::find_if(
+    entries.begin(), entries.end(),
+    [&](const Entry& entry) { return entry.block->name() == block->name(); });
+
+  if (duplicate != entries.end())
+  {
+    Logging::WARN("Uniform block " + block->name() + " is already registered");
+    return;
+  }
+
+  Entry entry{ std::move(block), 0, 0 };
+  for (auto program : programs)
+  {
+    connect(program, entry);
+  }
+  entries.push_back(std::move(entry));
+}
+
+bool pyasge::UniformBlocks::remove(const UniformBlock* block)
+{
+  // the frame data block is owned by the renderer and is never removed
+  auto iter = std::find_if(
+    entries.begin() + 1, entries.end(),
+    [block](const Entry& entry) { return entry.block.get() == block; });
+
+  if (iter == entries.end())
+  {
+    return false;
+  }
+
+  if (iter->buffer != 0)
+  {
+    glDeleteBuffers(1, &iter->buffer);
+  }
+  entries.erase(iter);
+  return true;
+}
+
+void pyasge::UniformBlocks::attach(GLuint program)
+{
+  if (program == 0 || std::find(programs.begin(), programs.end(), program) != programs.end())
+  {
+    return;
+  }
+
+  programs.push_back(program);
+  for (auto& entry : entries)
+  {
+    connect(program, entry);
+  }
+}
+
+void pyasge::UniformBlocks::update(const FrameData& frame_data)
+{
+  frame = frame_data;
+  std::memcpy(entries.front().block->data(), &frame, sizeof(FrameData));
+
+  for (auto& entry : entries)
+  {
+    upload(entry);
+  }
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void pyasge::UniformBlocks::updateFrameData(const FrameData& frame_data)
+{
+  frame = frame_data;
+  std::memcpy(entries.front().block->data(), &frame, sizeof(FrameData));
+  upload(entries.front());
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+GLuint pyasge::UniformBlocks::binding(Entry& entry) const
+{
+  if (entry.binding != 0)
+  {
+    return entry.binding;
+  }
+
+  if (max_bindings == 0)
+  {
+    glGetIntegerv(GL_MAX_UNIFORM_BUFFER_BINDINGS, &max_bindings);
+  }
+
+  // walk down from the top binding until a free slot is found
+  for (auto candidate = static_cast<GLuint>(max_bindings - 1); candidate > 0; --candidate)
+  {
+    auto used = std::any_of(
+      entries.begin(), entries.end(),
+      [candidate](const Entry& other) { return other.binding == candidate; });
+
+    if (!used)
+    {
+      entry.binding = candidate;
+      return candidate;
+    }
+  }
+
+  Logging::ERRORS("No free uniform buffer binding points remain");
+  return 0;
+}
+
+void pyasge::UniformBlocks::connect(GLuint program, Entry& entry) const
+{
+  auto index = glGetUniformBlockIndex(program, entry.block->name().c_str());
+  if (index == GL_INVALID_INDEX)
+  {
+    return;
+  }
+
+  GLint declared_size = 0;
+  glGetActiveUniformBlockiv(program, index, GL_UNIFORM_BLOCK_DATA_SIZE, &declared_size);
+  if (static_cast<std::size_t>(declared_size) > entry.block->size())
+  {
+    Logging::WARN(
+      "Uniform block " + entry.block->name() + " is declared larger (" +
+      std::to_string(declared_size) + " bytes) than its buffer (" +
+      std::to_string(entry.block->size()) + " bytes)");
+  }
+
+  glUniformBlockBinding(program, index, binding(entry));
+}
+
+void pyasge::UniformBlocks::upload(Entry& entry) const
+{
+  if (binding(entry) == 0)
+  {
+    return;
+  }
+
+  const auto size = static_cast<GLsizeiptr>(entry.block->size());
+  if (entry.buffer == 0)
+  {
+    glGenBuffers(1, &entry.buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, entry.buffer);
+    glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+  }
+
+  glBindBuffer(GL_UNIFORM_BUFFER, entry.buffer);
+  glBufferSubData(GL_UNIFORM_BUFFER, 0, size, entry.block->data());
+  glBindBufferBase(GL_UNIFORM_BUFFER, entry.binding, entry.buffer);
+}
@@ -0,0 +1,102 @@
+/*
+  Copyright (c) 2022 James Huxtable. All rights reserved.
+
+  This work is licensed under the terms of the MIT license.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include "extensions/GL.hpp"
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace pyasge
+{
+  /// \brief   The engine managed per-frame uniform block.
+  /// \details Laid out using std140 rules, so every member is a vec4. Any
+  ///          shader declaring a ``FrameData`` uniform block with the same
+  ///          layout receives these values without setting a single uniform.
+  struct FrameData
+  {
+    std::array<float, 4> time{};       ///< elapsed secs, frame delta secs, fixed step secs, frame count
+    std::array<float, 4> resolution{}; ///< window width & height, base width & height
+    std::array<float, 4> view{};       ///< min_x, max_x, min_y, max_y of the applied camera view
+    std::array<float, 4> viewport{};   ///< x, y, width & height of the applied viewport
+    std::array<float, 4> mouse{};      ///< cursor x & y in window pixels, cursor x & y normalised
+  };
+  static_assert(sizeof(FrameData) == 5 * 4 * sizeof(float), "FrameData must match std140");
+
+  /// \brief   A host side copy of a named std140 uniform block.
+  /// \details The storage is rounded up to a multiple of 16 bytes, which is
+  ///          the std140 base alignment of a block. The contents are uploaded
+  ///          once per frame by the renderer it is registered with.
+  class UniformBlock
+  {
+   public:
+    UniformBlock(std::string name, std::size_t size);
+
+    [[nodiscard]] const std::string& name() const noexcept { return block_name; }
+    [[nodiscard]] std::size_t size() const noexcept { return storage.size() * sizeof(float); }
+    [[nodiscard]] float* data() noexcept { return storage.data(); }
+    [[nodiscard]] const float* data() const noexcept { return storage.data(); }
+
+   private:
+    std::string block_name;
+    std::vector<float> storage;
+  };
+
+  /// \brief   Owns the GL buffers backing every registered uniform block.
+  /// \details Each block is given its own binding point, allocated downwards
+  ///          from the top of GL_MAX_UNIFORM_BUFFER_BINDINGS so they stay
+  ///          clear of anything the engine binds itself. Programs are
+  ///          remembered so blocks registered later still get connected.
+  class UniformBlocks
+  {
+   public:
+    static constexpr const char* FRAME_DATA = "FrameData";
+
+    UniformBlocks();
+    ~UniformBlocks();
+    UniformBlocks(const UniformBlocks&) = delete;
+    UniformBlocks& operator=(const UniformBlocks&) = delete;
+
+    void add(std::shared_ptr<UniformBlock> block);
+    bool remove(const UniformBlock* block);
+    void attach(GLuint program);
+    void update(const FrameData& frame_data);
+
+    /// \brief   Uploads new frame data mid-frame, leaving the other blocks as they are.
+    void updateFrameData(const FrameData& frame_data);
+
+    [[nodiscard]] const FrameData& frameData() const noexcept { return frame; }
+
+   private:
+    struct Entry
+    {
+      std::shared_ptr<UniformBlock> block;
+      GLuint buffer  = 0;
+      GLuint binding = 0;
+    };
+
+    GLuint binding(Entry& entry) const;
+    void connect(GLuint program, Entry& entry) const;
+    void upload(Entry& entry) const;
+
+    std::vector<Entry> entries;
+    std::vector<GLuint> programs;
+    FrameData frame{};
+    mutable GLint max_bindings = 0;
+  };
+}
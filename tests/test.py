@@ -1,5 +1,801 @@
 # -*- coding: utf-8 -*-
+import base64
+import gzip
+import heapq
+import json
+import os
+import tempfile
+import zlib
+
+import numpy as np
 import pyasge as m
 
 # assert m.__version__ == "0.0.1"
 m.INFO("Loaded PyASGE successfully")
+
+# every vertex kernel must match the scalar reference bit for bit
+sprites = []
+for i in range(37):
+    sprite = m.Sprite()
+    sprite.x, sprite.y = i * 13.5 - 200, i * -7.25
+    sprite.width, sprite.height = 16 + i, 48 - i
+    sprite.scale = 0.5 + i / 8
+    sprite.rotation = i * 0.7 - 9 if i % 5 else i * 3000.0
+    sprite.opacity = i / 37
+    sprites.append(sprite)
+
+scalar = m.sprite_vertices(sprites, "scalar")
+assert scalar.shape == (37, 4, 8)
+for kernel in m.vertex_kernels():
+    assert np.array_equal(m.sprite_vertices(sprites, kernel).view(np.uint32), scalar.view(np.uint32)), kernel
+
+# compact vertices unpack to the floats they were packed from, to within their precision
+rng = np.random.default_rng(3)
+quads = np.concatenate([rng.uniform(-200, 200, (50, 4, 2)) + 1000, rng.uniform(0, 1, (50, 4, 6))], axis=2)
+layouts = {
+    "compact": np.dtype([("xy", "<f4", 2), ("uv", "<u2", 2), ("rgba", "u1", 4)]),
+    "half": np.dtype([("xy", "<f2", 2), ("uv", "<u2", 2), ("rgba", "u1", 4)]),
+}
+for expected, spread in (("half", 1), ("compact", 2)):
+    quads[:, :, :2] = (quads[:, :, :2] - 1000) * spread + 1000
+    layout, origin, packed = m.pack_vertices(quads)
+    assert layout == expected and packed.shape == (200, layouts[layout].itemsize)
+    unpacked = packed.view(layouts[layout]).reshape(50, 4)
+    flat = quads.astype(np.float32)
+    positions = unpacked["xy"].astype(np.float32) + origin
+    assert np.allclose(positions, flat[:, :, :2], rtol=0, atol=0.07 if spread == 1 else 0)
+    assert np.allclose(unpacked["uv"] / 65535, flat[:, :, 2:4], rtol=0, atol=0.51 / 65535)
+    assert np.allclose(unpacked["rgba"] / 255, flat[:, :, 4:], rtol=0, atol=0.51 / 255)
+quads[7, 2, 3] = 1.5
+for compact in (True, False):
+    layout, origin, packed = m.pack_vertices(quads, compact)
+    assert layout == "full" and np.array_equal(packed.view(np.float32).reshape(50, 4, 8), quads.astype(np.float32))
+
+
+def engine_bounds(sprite):
+    bounds = sprite.getWorldBounds()
+    return [[point.x, point.y] for point in (bounds.v1, bounds.v2, bounds.v3, bounds.v4)]
+
+
+def check_world_bounds(listed):
+    corners = m.world_bounds(listed)
+    assert np.allclose(corners, [engine_bounds(sprite) for sprite in listed], rtol=1e-4, atol=1e-2)
+    boxes = m.world_aabbs(listed)
+    assert np.allclose(boxes[:, :2], corners.min(axis=1)) and np.allclose(boxes[:, 2:], np.ptp(corners, axis=1))
+
+
+# cached world bounds follow changes to a sprite's transform, and agree with the engine's
+check_world_bounds(sprites)
+for i, sprite in enumerate(sprites[::3]):
+    sprite.x += 5
+    sprite.rotation += 0.25
+    sprite.scale = 1 + i / 4
+    sprite.width += 1
+check_world_bounds(sprites)
+sprites[0].y += 3
+check_world_bounds(sprites[::-1] + sprites[:4])
+
+# boxes with infinite, NaN or huge coordinates are kept out of the cells, and still found
+inf, nan = float("inf"), float("nan")
+boxes = np.array([[0, 0, 10, 10], [5, 5, 10, 10], [0, 0, inf, inf], [nan, 0, 10, 10],
+                  [-1e30, -1e30, 2e30, 2e30], [0, 0, 1e9, 20], [100, 100, 10, 10]], dtype=np.float32)
+grid = m.SpatialGrid(8)
+grid.build(boxes)
+assert grid.oversize == 4
+assert grid.entries < 100
+assert sorted(map(tuple, grid.pairs().tolist())) == [
+    (0, 1), (0, 2), (0, 4), (0, 5), (1, 2), (1, 4), (1, 5), (2, 4), (2, 5), (2, 6), (4, 5), (4, 6)]
+assert grid.query_rect(-1e30, -1e30, 2e30, 2e30).tolist() == [0, 1, 2, 4, 5, 6]
+assert grid.query_point(105, 105).tolist() == [2, 4, 6]
+assert grid.query_rect(nan, 0, 1, 1).tolist() == []
+
+# tilesets keep their own copy of each tile, numbered from 1 as 0 marks an empty cell
+tileset = m.TileSet()
+tile = m.Tile()
+tile.width, tile.height, tile.z = 16, 24, 3
+first, second = tileset.add(tile), tileset.add(tile)
+tile.width = 99
+assert (first, second, len(tileset)) == (1, 2, 2)
+assert (tileset[first].width, tileset[first].height, tileset[first].z) == (16, 24, 3)
+tileset[second] = tile
+assert tileset[second].width == 99 and tileset[first].width == 16
+tileset.set_solid(second)
+assert tileset.is_solid(second) and not tileset.is_solid(first) and not tileset.is_solid(0)
+for id in (0, 3):
+    try:
+        tileset[id]
+    except IndexError:
+        continue
+    raise AssertionError(f"tile id {id} was found")
+
+
+def grid_steps(costs, column, row):
+    # the moves NavGrid allows out of a cell, diagonals never cutting the corner of a blocked cell
+    rows, columns = costs.shape
+    passable = lambda c, r: 0 <= c < columns and 0 <= r < rows and 0 < costs[r, c] < inf
+    for dx, dy in ((1, 0), (-1, 0), (0, 1), (0, -1), (1, 1), (1, -1), (-1, 1), (-1, -1)):
+        corner = dx == 0 or dy == 0 or (passable(column + dx, row) and passable(column, row + dy))
+        if passable(column + dx, row + dy) and corner:
+            yield column + dx, row + dy, 2 ** 0.5 if dx and dy else 1.0
+
+
+def grid_distances(costs, goal):
+    # the cost of the cheapest way from every cell to the goal, paying for each cell entered
+    distances = np.full(costs.shape, inf)
+    distances[goal[1], goal[0]] = 0
+    pending = [(0.0, goal)]
+    while pending:
+        distance, (column, row) = heapq.heappop(pending)
+        if distance > distances[row, column]:
+            continue
+        for next_column, next_row, length in grid_steps(costs, column, row):
+            reach = distance + costs[row, column] * length
+            if reach < distances[next_row, next_column]:
+                distances[next_row, next_column] = reach
+                heapq.heappush(pending, (reach, (next_column, next_row)))
+    return distances
+
+
+def path_cost(costs, path):
+    total = 0.0
+    for (column, row), step in zip(path[:-1].tolist(), path[1:].tolist()):
+        moves = {(c, r): length for c, r, length in grid_steps(costs, column, row)}
+        assert tuple(step) in moves, f"{step} can't be reached from {(column, row)}"
+        total += costs[step[1], step[0]] * moves[tuple(step)]
+    return total
+
+
+# jump point search finds paths as cheap as A*, and flow fields agree with a reference search
+costs = np.ones((16, 24), dtype=np.float32)
+costs[2:14, 8] = 0
+costs[0:6, 15] = inf
+costs[10, 10:22] = 0
+costs[1, 0], costs[0, 1], costs[1, 1] = 0, 0, 0
+jumping = m.NavGrid(costs)
+costs[0, 0] = 3
+searching = m.NavGrid(costs)
+for start, goal in (((2, 8), (20, 3)), ((23, 15), (9, 0)), ((4, 14), (4, 2)), ((12, 12), (23, 0))):
+    expected = grid_distances(costs, goal)[start[1], start[0]]
+    for grid in (jumping, searching):
+        path = grid.find_path(start, goal)
+        assert tuple(path[0]) == start and tuple(path[-1]) == goal
+        assert np.isclose(path_cost(costs, path), expected, rtol=1e-5), (start, goal)
+paths = searching.find_paths([(2, 8), (23, 15), (0, 0)], [(20, 3), (9, 0), (5, 5)])
+assert np.array_equal(paths[0], searching.find_path((2, 8), (20, 3))) and paths[2].shape == (0, 2)
+
+directions, distances = searching.flow_field(np.array([[20, 3], [3, 12]]))
+expected = np.minimum(grid_distances(costs, (20, 3)), grid_distances(costs, (3, 12)))
+assert np.allclose(distances, expected, rtol=1e-5) and np.isinf(distances[0, 0])
+for row, column in zip(*np.nonzero(np.isfinite(distances) & (distances > 0))):
+    step = np.sign(directions[row, column]).astype(int)
+    length = 2 ** 0.5 if step.all() else 1.0
+    following = distances[row + step[1], column + step[0]] + costs[row + step[1], column + step[0]] * length
+    assert np.isclose(distances[row, column], following, rtol=1e-5), (column, row)
+
+# walls cast shadows but are themselves seen, and sight is limited to a circle around the viewer
+opaque = np.zeros((11, 15), dtype=np.uint8)
+opaque[2:9, 9] = 1
+sight = m.SightGrid(opaque)
+view = sight.field_of_view((4, 5))
+assert view.shape == (11, 15) and view[:, :9].all() and view[2:9, 9].all(), "the room or its wall was hidden"
+assert not view[4:7, 11:].any(), "cells behind the wall were seen"
+assert sight.line_of_sight((4, 5), (9, 5)) and not sight.line_of_sight((4, 5), (12, 5))
+assert sight.line_of_sight((12, 5), (12, 5)) and not sight.line_of_sight((4, 5), (15, 5))
+starts = np.array([[4, 5], [4, 5], [0, 0], [14, 10]])
+ends = np.array([[9, 5], [12, 5], [14, 10], [0, 0]])
+assert sight.line_of_sight_many(starts, ends).tolist() == [sight.line_of_sight(*pair) for pair in zip(starts, ends)]
+sight[9, 5] = False
+assert sight.line_of_sight((4, 5), (12, 5)) and not sight[9, 5] and sight[9, 4]
+
+sight.opaque = np.zeros((11, 15), dtype=np.uint8)
+sight.forget()
+columns, rows = np.meshgrid(np.arange(15), np.arange(11))
+circle = (columns - 7) ** 2 + (rows - 5) ** 2 <= 9
+assert np.array_equal(sight.field_of_view((7, 5), 3), circle)
+sight.field_of_view((1, 1), 1)
+assert not sight.visible[5, 7] and sight.explored[5, 7] and sight.visible[1, 1]
+assert np.array_equal(sight.explored, circle | sight.visible)
+sight.forget()
+assert not sight.explored.any() and not sight.visible.any()
+
+# masks pack one bit per pixel at or above the threshold, 64 to a word
+alpha = np.zeros((3, 70), dtype=np.uint8)
+alpha[1, 0], alpha[1, 65], alpha[2, 69], alpha[0, 3] = 255, 2, 1, 0
+mask = m.CollisionMask(alpha, 2)
+assert (mask.width, mask.height, mask.count) == (70, 3, 2)
+assert mask[0, 1] and mask[65, 1] and not mask[69, 2] and not mask[3, 0]
+assert mask.row(1) == 1 | 1 << 65 and mask.row(2) == 0
+assert mask.words.shape == (3, 2) and mask.words[1].tolist() == [1, 2]
+assert m.CollisionMask(alpha).count == 3
+
+# clips show each frame for its duration, then stop, wrap or play back according to their loop mode
+rects = np.array([[0, 0, 8, 8], [8, 0, 8, 8], [16, 0, 8, 8]], dtype=np.float32)
+Loop = m.AnimationClip.Loop
+uneven = [m.AnimationClip(rects, [0.25, 0.5, 0.25], loop) for loop in (Loop.LOOP, Loop.ONCE)]
+ping_pong = m.AnimationClip(rects, 0.25, Loop.PING_PONG)
+grid = m.AnimationClip.from_grid(8, 8, columns=3, count=3, duration=0.25, name="walk")
+assert np.array_equal(grid.rects, rects) and grid.durations.tolist() == [0.25] * 3 and grid.name == "walk"
+animator = m.Animator()
+animated = [m.Sprite() for _ in range(4)]
+for sprite, clip, speed in zip(animated, uneven + [ping_pong, grid], (1, 1, 1, 2)):
+    animator.play(sprite, clip, speed)
+    assert animator.frame(sprite) == 0 and sprite.src_rect.tolist() == rects[0].tolist()
+expected = [[1, 1, 2, 0, 1], [1, 1, 2, 2, 2], [1, 2, 1, 0, 1], [2, 1, 0, 2, 1]]
+for step in range(5):
+    animator.update(0.25)
+    for sprite, frames in zip(animated, expected):
+        assert animator.frame(sprite) == frames[step], (step, frames)
+        assert sprite.src_rect.tolist() == rects[frames[step]].tolist()
+    assert animator.finished == ([animated[1]] if step == 3 else [])
+assert not animator.is_playing(animated[1]) and animator.is_playing(animated[0])
+
+animator.pause(animated[0])
+animator.play(animated[2], ping_pong, restart=False)
+animator.update(0.25)
+assert animator.frame(animated[0]) == 1 and animator.frame(animated[2]) == 2
+assert animator.stop(animated[3]) and animator.frame(animated[3]) == -1 and len(animator) == 3
+skipping = m.AnimationClip(rects, [0.25, 0, 0.25], Loop.ONCE)
+animator.play(animated[3], skipping)
+animator.update(0.25)
+assert animator.frame(animated[3]) == 2, "a zero length frame was shown"
+try:
+    m.AnimationClip(rects, [0.25, 0.25])
+except ValueError:
+    pass
+else:
+    raise AssertionError("a clip took two durations for three frames")
+
+# every curve runs from 0 to 1 and mirrors its counterpart, and tweens chain their leftover time
+for name, curve in m.Ease.__members__.items():
+    assert np.isclose(m.ease(curve, 0), 0, atol=1e-5) and np.isclose(m.ease(curve, 1), 1, atol=1e-5), name
+    assert m.ease(curve, -1) == m.ease(curve, 0) and m.ease(curve, 2) == m.ease(curve, 1), name
+    if name.endswith("_IN"):
+        mirrored = getattr(m.Ease, name[:-3] + "_OUT")
+        for t in (0.1, 0.35, 0.8):
+            assert np.isclose(m.ease(curve, t), 1 - m.ease(mirrored, 1 - t), atol=1e-5), name
+assert [m.ease(m.Ease.LINEAR, 0.25), m.ease(m.Ease.QUAD_IN, 0.5), m.ease(m.Ease.CUBIC_OUT, 0.5)] == [0.25, 0.25, 0.875]
+assert max(m.ease(m.Ease.BACK_OUT, t / 20) for t in range(21)) > 1
+
+tweens = m.Tweener()
+sprite = m.Sprite()
+sprite.opacity = 1
+calls = []
+slide = tweens.to(sprite, "x", 100, 1.0)
+follow = tweens.to(sprite, "x", 50, 0.5, after=slide, relative=True, on_complete=lambda: calls.append("follow"))
+fade = tweens.to(sprite, "opacity", 0.0, 0.5, repeats=1, yoyo=True)
+drop = tweens.to(sprite, "y", 10, 2.0, delay=0.5, ease=m.Ease.QUAD_IN)
+tweens.update(0.25)
+assert (sprite.x, sprite.y, sprite.opacity) == (25, 0, 0.5) and len(tweens) == 4
+tweens.update(0.5)
+assert (sprite.x, sprite.y, sprite.opacity) == (75, 0.15625, 0.5) and tweens.completed == []
+tweens.update(0.5)
+assert sprite.x == 125, "the follower didn't start with the time left over"
+assert tweens.completed == [slide, fade] and sprite.opacity == 1 and not calls
+assert tweens.is_active(follow) and not tweens.is_active(slide)
+tweens.update(0.25)
+assert sprite.x == 150 and tweens.completed == [follow] and calls == ["follow"]
+assert tweens.cancel(drop) and not tweens.cancel(drop) and len(tweens) == 0
+
+first = tweens.to(sprite, "width", 10, 1.0, on_complete=lambda: calls.append("first"))
+tweens.to(sprite, "height", 10, 1.0, after=first)
+assert tweens.cancel(sprite) == 2 and len(tweens) == 0
+tweens.update(1.0)
+assert calls == ["follow"], "a cancelled tween called back"
+for target, property, error in ((sprite, "zoom", ValueError), (object(), "x", TypeError)):
+    try:
+        tweens.to(target, property, 1, 1)
+    except error:
+        continue
+    raise AssertionError(f"tweened {property} of {target}")
+
+# the queue's radix sort and incremental repair both order draws as a stable sort of their keys would
+rng = np.random.default_rng(7)
+layers = rng.integers(-3, 4, 5000) + 32768
+keys = (layers.astype(np.uint64) << np.uint64(32)) | (rng.integers(1, 4, 5000).astype(np.uint64) << np.uint64(16)) \
+    | rng.integers(1, 40, 5000).astype(np.uint64)
+order = m.queue_order(keys)
+assert np.array_equal(order, np.argsort(keys, kind="stable"))
+for changed in (10, 2500):
+    keys[rng.choice(5000, changed, replace=False)] ^= np.uint64(1 << 33)
+    order = m.queue_order(keys, order)
+    assert np.array_equal(order, np.argsort(keys, kind="stable")), changed
+assert m.queue_order(keys[:3], order).tolist() == np.argsort(keys[:3], kind="stable").tolist()
+try:
+    m.queue_order(keys[:3], [0, 0, 1])
+    assert False
+except ValueError:
+    pass
+
+# checks needing a GL context run one after another inside a game, each a generator yielding between frames
+PASS_THROUGH = """
+#version 330 core
+in VertexData
+{
+    vec2 uvs;
+    vec4 rgba;
+} fs_in;
+
+uniform sampler2D image;
+layout (location = 0) out vec4 FragColor;
+
+void main()
+{
+    FragColor = fs_in.rgba * texture(image, fs_in.uvs);
+}
+"""
+
+
+def white_texture(renderer):
+    texture = renderer.createNonCachedTexture(1, 1, m.Texture.Format.RGBA, None)
+    texture.buffer.upload(np.full((1, 4), 255, dtype=np.uint8), 0)
+    return texture
+
+
+def solid_sprite(renderer, colour, x, y, width, height):
+    sprite = m.Sprite()
+    sprite.attach(white_texture(renderer))
+    sprite.colour = colour
+    sprite.x, sprite.y = x, y
+    sprite.width, sprite.height = width, height
+    return sprite
+
+
+def target_pixels(target):
+    texture = target.resolve(0)
+    texture.buffer.download(0)
+    return texture.buffer.data.reshape(texture.height, texture.width, 4)
+
+
+def check_post_process_deferred(renderer):
+    # draws queued between begin and end must land in the chain's input, not the screen
+    renderer.deferred_rendering = True
+    chain = m.PostProcessChain(renderer)
+    chain.add_pass(renderer.initPixelShader(PASS_THROUGH))
+    output = m.RenderTarget(renderer, 64, 64, m.Texture.Format.RGBA, 1)
+    red = solid_sprite(renderer, m.COLOURS.RED, -4096, -4096, 8192, 8192)
+
+    assert chain.begin()
+    renderer.render(red)
+    assert chain.end(output)
+    pixels = target_pixels(output)
+    assert (pixels[..., 0] == 255).all() and (pixels[..., 1] == 0).all(), "queued draws missed the chain"
+    renderer.deferred_rendering = False
+
+    for scale in (0.0, 1 / 128, 8.0, float("nan")):
+        try:
+            chain.add_pass(None, scale)
+        except ValueError:
+            continue
+        raise AssertionError(f"scale {scale} was accepted")
+    yield
+
+
+def check_static_batch_tile_update(renderer):
+    # tiles are read from the Python object, so an update picks up changes made after the build
+    texture = renderer.createNonCachedTexture(1, 1, m.Texture.Format.RGBA, None)
+    texture.buffer.upload(np.full((1, 4), 255, dtype=np.uint8), 0)
+    tile = m.Tile()
+    tile.texture = texture
+    tile.tint = m.COLOURS.RED
+    tile.width, tile.height = 8192, 8192
+    batch = renderer.build_static_batch([(tile, -4096, -4096)])
+    target = m.RenderTarget(renderer, 64, 64, m.Texture.Format.RGBA, 1)
+
+    def draw():
+        renderer.setRenderTarget(target)
+        assert batch.render()
+        renderer.setRenderTarget(None)
+        return target_pixels(target)
+
+    assert (draw()[..., 0] == 255).all(), "tile was not baked"
+    tile.tint = m.COLOURS.BLUE
+    assert batch.update(0)
+    pixels = draw()
+    assert (pixels[..., 2] == 255).all() and (pixels[..., 0] == 0).all(), "update re-baked a stale tile"
+    yield
+
+
+def check_target_pool(renderer):
+    # released targets are kept while python refers to them, and age from their release
+    pool = renderer.target_pool
+    pool.trim_frames = 0
+    before = pool.memory
+    target = renderer.acquire_target(16, 8, m.Texture.Format.MONOCHROME)
+    assert pool.memory - before == 2 * 16 * 8, "a monochrome target is one byte per pixel"
+    assert renderer.release_target(target)
+    yield
+    yield
+    assert pool.targets == 1 and pool.clear() == 0, "a referenced target was destroyed"
+    assert target.resolve(0).width == 16
+    del target
+    assert pool.clear() == 1
+
+    pool.trim_frames = 1
+    target = renderer.acquire_target(16, 8)
+    yield
+    yield
+    yield
+    assert renderer.release_target(target)
+    del target
+    yield
+    assert pool.targets == 1, "the target aged from when it was acquired"
+    pool.trim_frames = 60
+    yield
+
+
+def check_tile_map(renderer):
+    # cells read back what was written, only changed chunks are rebuilt and only visible ones drawn
+    tiles = m.TileMap(renderer, 64, 64, 8, 8, 16)
+    texture = white_texture(renderer)
+    ids = []
+    for colour in (m.COLOURS.RED, m.COLOURS.BLUE):
+        tile = m.Tile()
+        tile.texture = texture
+        tile.tint = colour
+        tile.width, tile.height = 8, 8
+        ids.append(tiles.add_tile(tile))
+    red, blue = ids
+
+    tiles.set_tiles(np.full((64, 64), red, dtype=np.uint16))
+    tiles[3, 4] = blue
+    assert tiles[3, 4] == blue and tiles[4, 3] == red
+    assert tiles.tile_at(3 * 8 + 1, 4 * 8 + 7) == blue and tiles.cell_at(-1, 0) is None
+    block = tiles.get_tiles(2, 4, 3, 1)
+    assert block.shape == (1, 3) and block.tolist() == [[red, blue, red]]
+    assert tiles.memory == 64 * 64 * 2
+    for cell, id, error in (((64, 0), red, IndexError), ((0, -1), red, IndexError), ((0, 0), 3, ValueError)):
+        try:
+            tiles[cell] = id
+        except error:
+            continue
+        raise AssertionError(f"cell {cell} accepted id {id}")
+
+    target = m.RenderTarget(renderer, 64, 64, m.Texture.Format.RGBA, 1)
+
+    def draw():
+        renderer.setRenderTarget(target)
+        renderer.setViewport(m.Viewport(0, 0, 64, 64))
+        renderer.setProjectionMatrix(0, 0, 64, 64)
+        tiles.render()
+        renderer.setRenderTarget(None)
+        return target_pixels(target)
+
+    pixels = draw()
+    assert (tiles.chunks_rebuilt, tiles.chunks_drawn, tiles.chunks_culled) == (1, 1, 15)
+    assert (pixels[..., 2] == 255).sum() == 8 * 8 and (pixels[..., 0] == 255).sum() == 64 * 64 - 8 * 8
+
+    draw()
+    assert tiles.chunks_rebuilt == 0, "an unchanged chunk was rebuilt"
+    tiles[0, 0] = red
+    tiles[63, 63] = blue
+    draw()
+    assert tiles.chunks_rebuilt == 0, "writing a cell's own id, or a culled cell, rebuilt a visible chunk"
+    tiles[0, 0] = blue
+    pixels = draw()
+    assert tiles.chunks_rebuilt == 1 and (pixels[..., 2] == 255).sum() == 2 * 8 * 8
+    yield
+
+
+def check_tile_collision(renderer):
+    # boxes stop flush against solid cells however far they move, and slide along them
+    tiles = m.TileMap(renderer, 16, 16, 8, 8, 4)
+    wall = tiles.add_tile(m.Tile())
+    tiles.tileset.set_solid(wall)
+    cells = np.zeros((16, 16), dtype=np.uint16)
+    cells[10, :] = wall
+    cells[:10, 12] = wall
+    tiles.set_tiles(cells)
+    contact = m.TileMap.Contact
+
+    assert tiles.is_solid(12 * 8 + 1, 0) and not tiles.is_solid(11 * 8 + 7.5, 0)
+    assert not tiles.overlaps_solid(10, 74, 6, 6) and tiles.overlaps_solid(10, 74.5, 6, 6)
+    assert tiles.move(10, 40, 6, 6, 0, 500) == (10, 74, int(contact.BOTTOM)), "the box tunnelled through the floor"
+    assert tiles.move(10, 74, 6, 6, 200, 0) == (90, 74, int(contact.RIGHT))
+    assert tiles.move(10, 40, 6, 6, 200, 100) == (90, 74, int(contact.RIGHT | contact.BOTTOM))
+    assert tiles.move(60, 40, 6, 6, 5, -3) == (65, 37, int(contact.NONE))
+    assert tiles.move(95, 20, 6, 6, 8, 0)[:2] == (103, 20), "a box inside a wall could not leave it"
+
+    boxes = np.array([[10, 40, 6, 6], [10, 74, 6, 6], [60, 40, 6, 6], [110, 20, 6, 6]], dtype=np.float32)
+    deltas = np.array([[0, 500], [200, 0], [5, -3], [-50, 0]], dtype=np.float32)
+    positions, contacts = tiles.move_many(boxes, deltas)
+    for box, delta, position, flags in zip(boxes, deltas, positions, contacts):
+        x, y, touched = tiles.move(*box, *delta)
+        assert (position.tolist(), int(flags)) == ([x, y], touched)
+    assert contacts[3] == int(contact.LEFT) and positions[3, 0] == 104
+    assert tiles.is_solid_many(np.array([[97, 0], [0, 0]], dtype=np.float32)).tolist() == [True, False]
+    assert tiles.overlaps_solid_many(boxes).tolist() == [False, False, False, False]
+    yield
+
+
+def check_collision_mask(renderer):
+    # sprites are compared as drawn, so flipping or cropping the texture moves its solid pixels
+    texture = renderer.createNonCachedTexture(4, 4, m.Texture.Format.RGBA, None)
+    pixels = np.zeros((4, 4, 4), dtype=np.uint8)
+    pixels[:, 0] = 255
+    texture.buffer.upload(pixels, 0)
+    mask = m.CollisionMask(texture)
+    assert mask.count == 4 and mask[0, 3] and not mask[1, 0] and m.CollisionMask.of(texture) is mask
+
+    strip = m.Sprite()
+    strip.attach(texture)
+    strip.width, strip.height = 40, 40
+    block = solid_sprite(renderer, m.COLOURS.WHITE, 20, 0, 4, 40)
+    overlap = lambda: m.sprite_mask_overlap(strip, block)
+    assert not overlap(), "transparent pixels collided"
+    block.x = 5
+    assert overlap()
+    block.x = 32
+    assert not overlap()
+    strip.flip_flags = m.Sprite.FlipFlags.FLIP_X
+    assert overlap(), "the mask was not flipped with the sprite"
+    strip.flip_flags = m.Sprite.FlipFlags.NORMAL
+
+    block.x = 5
+    strip.src_rect = [2, 0, 2, 4]
+    assert not overlap(), "pixels outside of the source rectangle collided"
+    strip.src_rect = [0, 0, 2, 4]
+    block.x = 15
+    assert overlap(), "the source rectangle was not stretched over the sprite"
+    assert m.sprite_mask_overlaps([strip, block, strip], np.array([[0, 1], [1, 2], [0, 2]])).tolist() == [True] * 3
+    block.x = 25
+    assert m.sprite_mask_overlaps([strip, block], np.array([[0, 1], [1, 0]])).tolist() == [False, False]
+    yield
+
+
+def check_tiled_map(renderer):
+    # every encoding of the same layer decodes to the same cells, whichever format the map is saved in
+    gids = np.array([[0, 1, 2, 3, 4, 0], [4, 3, 2, 1, 0, 1], [1, 1, 1, 2, 2, 2], [0, 0, 4, 4, 0, 3]], dtype=np.uint32)
+    packed = gids.astype("<u4").tobytes()
+    encoded = {
+        "csv": ",".join(map(str, gids.flat)),
+        "base64": base64.b64encode(packed).decode(),
+        "zlib": base64.b64encode(zlib.compress(packed)).decode(),
+        "gzip": base64.b64encode(gzip.compress(packed)).decode(),
+    }
+    formats = {"csv": ("csv", ""), "base64": ("base64", ""), "zlib": ("base64", "zlib"), "gzip": ("base64", "gzip")}
+    layers = [{"type": "tilelayer", "name": name, "width": 6, "height": 4, "encoding": encoding,
+               "compression": compression, "data": encoded[name] if encoding == "base64" else gids.flatten().tolist()}
+              for name, (encoding, compression) in formats.items()]
+    tmx_layers = "".join(f'<layer name="{name}" width="6" height="4">'
+                         f'<data encoding="{encoding}" compression="{compression}">\n{encoded[name]}\n</data></layer>'
+                         for name, (encoding, compression) in formats.items())
+    saved = {
+        "map.tmj": json.dumps({"orientation": "orthogonal", "width": 6, "height": 4, "tilewidth": 8, "tileheight": 8,
+                               "tilesets": [{"firstgid": 1, "tilewidth": 8, "tileheight": 8, "tilecount": 4}],
+                               "layers": layers}),
+        "map.tmx": '<?xml version="1.0" encoding="UTF-8"?>'
+                   '<map orientation="orthogonal" width="6" height="4" tilewidth="8" tileheight="8">'
+                   f'<tileset firstgid="1" tilewidth="8" tileheight="8" tilecount="4"/>{tmx_layers}</map>',
+    }
+
+    renderer.setProjectionMatrix(0, 0, 320, 240)
+    with tempfile.TemporaryDirectory() as folder:
+        for file, content in saved.items():
+            path = os.path.join(folder, file)
+            with open(path, "w") as out:
+                out.write(content)
+            tiled = m.TiledMap(renderer, path)
+            tiled.wait()
+            assert (tiled.columns, tiled.rows, tiled.tile_width, tiled.tile_height) == (6, 4, 8, 8)
+            assert [name for name, _ in tiled.layers] == list(encoded), file
+            decoded = [layer.get_tiles() for _, layer in tiled.layers]
+            for ids in decoded:
+                assert np.array_equal(ids, decoded[0]), file
+            ids = decoded[0]
+            assert np.array_equal(ids == 0, gids == 0), file
+            cells = {(gid, id) for gid, id in zip(gids.flat, ids.flat)}
+            assert len(cells) == len({gid for gid, _ in cells}) == len({id for _, id in cells}), file
+
+        with open(os.path.join(folder, "broken.tmj"), "w") as out:
+            out.write(json.dumps({"orientation": "isometric", "tilewidth": 8, "tileheight": 8}))
+        try:
+            m.TiledMap(renderer, os.path.join(folder, "broken.tmj"))
+        except ValueError:
+            pass
+        else:
+            raise AssertionError("an isometric map was opened")
+    yield
+
+
+TINTED = """
+#version 330 core
+layout (std140) uniform Tint
+{
+    vec4 tint;
+};
+
+layout (location = 0) out vec4 FragColor;
+
+void main()
+{
+    FragColor = tint;
+}
+"""
+
+
+def check_frame_data(renderer):
+    # FrameData follows a viewport or camera changed mid-frame, and user blocks reach every shader declaring them
+    renderer.setViewport(m.Viewport(8, 4, 96, 48))
+    renderer.setProjectionMatrix(10, 20, 200, 100)
+    frame = renderer.frame_data
+    assert frame[3].tolist() == [8, 4, 96, 48], "the viewport change was not picked up"
+    assert frame[2, :2].tolist() == [10, 210] and sorted(frame[2, 2:].tolist()) == [20, 120]
+    renderer.setViewport(m.Viewport(0, 0, 320, 240))
+    renderer.setProjectionMatrix(0, 0, 320, 240)
+    assert renderer.frame_data[3].tolist() == [0, 0, 320, 240]
+
+    block = m.UniformBlock("Tint", 12)
+    assert block.size == 16 and block.data.shape == (4,)
+    block.data[:] = [0, 0, 1, 1]
+    renderer.add_uniform_block(block)
+    blue = solid_sprite(renderer, m.COLOURS.WHITE, -4096, -4096, 8192, 8192)
+    blue.shader = renderer.initPixelShader(TINTED)
+    target = m.RenderTarget(renderer, 64, 64, m.Texture.Format.RGBA, 1)
+    yield
+
+    renderer.setRenderTarget(target)
+    renderer.render(blue)
+    renderer.setRenderTarget(None)
+    pixels = target_pixels(target)
+    assert (pixels[..., 2] == 255).all() and (pixels[..., 0] == 0).all(), "the block was not uploaded"
+    assert renderer.remove_uniform_block(block) and not renderer.remove_uniform_block(block)
+    yield
+
+
+def check_shader_cache(renderer):
+    # shared requests return the compiled shader, others restore a new one from the stored binary
+    cache = renderer.shader_cache
+    shared_hits = cache.source_hits
+    shared = renderer.initPixelShader(PASS_THROUGH, shared=True)
+    assert renderer.initPixelShader(PASS_THROUGH, shared=True) is shared
+    assert cache.source_hits == shared_hits + 1
+
+    # a source no earlier run has compiled, so the first request can't be restored
+    source = PASS_THROUGH + f"// {os.urandom(8).hex()}\n"
+    hits, misses = cache.binary_hits, cache.binary_misses
+    first = renderer.initPixelShader(source)
+    assert cache.binary_hits == hits and cache.binary_misses - misses <= 1
+    second = renderer.initPixelShader(source)
+    assert second is not first and second is not renderer.initPixelShader(source, shared=True)
+    assert cache.binary_hits - hits + cache.binary_misses - misses in (0, 3), "each compile is a hit or a miss"
+    assert cache.source_hits == shared_hits + 1
+    yield
+
+
+def check_state_cache(renderer):
+    # requesting state that is already set is skipped, and counted in the next frame's stats
+    shader = renderer.initPixelShader(PASS_THROUGH, shared=True)
+    target = m.RenderTarget(renderer, 16, 16, m.Texture.Format.RGBA, 1)
+    for _ in range(2):
+        renderer.shader = shader
+        renderer.setViewport(m.Viewport(0, 0, 16, 16))
+        renderer.setProjectionMatrix(0, 0, 16, 16)
+        renderer.setRenderTarget(target)
+    yield
+
+    stats = renderer.frame_stats
+    assert stats.state_changes_skipped >= 4, "repeated requests were forwarded"
+    assert stats.state_changes_issued <= 4
+    renderer.setRenderTarget(None)
+    renderer.setViewport(m.Viewport(0, 0, 320, 240))
+    renderer.setProjectionMatrix(0, 0, 320, 240)
+    yield
+
+
+def check_lazy_resolve(renderer):
+    # a target is only blitted again once it has been bound or drawn into since its last resolve
+    target = m.RenderTarget(renderer, 32, 32, m.Texture.Format.RGBA, 1)
+    renderer.setRenderTarget(target)
+    renderer.render(solid_sprite(renderer, m.COLOURS.RED, -4096, -4096, 8192, 8192))
+    renderer.setRenderTarget(None)
+    texture = target.resolve(0)
+    assert target.resolve(0) is texture
+    yield
+
+    stats = renderer.frame_stats
+    assert stats.resolves_issued >= 1 and stats.resolves_skipped >= 1, "an unchanged target was resolved again"
+    pixels = target_pixels(target)
+    assert (pixels[..., 0] == 255).all() and (pixels[..., 2] == 0).all()
+
+    renderer.setRenderTarget(target)
+    renderer.render(solid_sprite(renderer, m.COLOURS.BLUE, -4096, -4096, 8192, 8192))
+    renderer.setRenderTarget(None)
+    pixels = target_pixels(target)
+    assert (pixels[..., 2] == 255).all() and (pixels[..., 0] == 0).all(), "a drawn target was not resolved"
+    yield
+
+
+def check_instancing(renderer):
+    # long runs of queued sprites sharing a texture are drawn instanced, and look the same as sprite by sprite
+    renderer.deferred_rendering = True
+    renderer.instancing_threshold = 16
+    texture = white_texture(renderer)
+    sprites = []
+    for i in range(48):
+        sprite = m.Sprite()
+        sprite.attach(texture)
+        sprite.colour = m.COLOURS.RED if i % 2 else m.COLOURS.BLUE
+        sprite.x, sprite.y = -4096, -4096
+        sprite.width, sprite.height = 8192, 8192
+        sprites.append(sprite)
+    target = m.RenderTarget(renderer, 32, 32, m.Texture.Format.RGBA, 1)
+
+    # nothing has gone to the engine yet this frame, so the run can be instanced
+    yield
+    renderer.setRenderTarget(target)
+    for sprite in sprites:
+        renderer.render(sprite)
+    renderer.setRenderTarget(None)
+    yield
+
+    stats = renderer.frame_stats
+    assert stats.instanced_draws >= 1 and stats.instances >= 48, "the run was drawn sprite by sprite"
+    pixels = target_pixels(target)
+    assert (pixels[..., 0] == 255).all() and (pixels[..., 2] == 0).all(), "instances were drawn out of order"
+    renderer.instancing_threshold = 1024
+    renderer.deferred_rendering = False
+    yield
+
+
+def check_stream_buffer(renderer):
+    # batches stream their records each frame, and a frame never draws another frame's data
+    texture = white_texture(renderer)
+    sprites = []
+    for _ in range(8):
+        sprite = m.Sprite()
+        sprite.attach(texture)
+        sprite.x, sprite.y = -4096, -4096
+        sprite.width, sprite.height = 8192, 8192
+        sprites.append(sprite)
+    batch = m.SpriteBatch(renderer, sprites)
+    target = m.RenderTarget(renderer, 32, 32, m.Texture.Format.RGBA, 1)
+
+    for colour, channel in ((m.COLOURS.RED, 0), (m.COLOURS.BLUE, 2), (m.COLOURS.RED, 0)):
+        for sprite in sprites:
+            sprite.colour = colour
+        renderer.setRenderTarget(target)
+        assert batch.render() == 1 and batch.instances == 8
+        renderer.setRenderTarget(None)
+        pixels = target_pixels(target)
+        assert (pixels[..., channel] == 255).all() and (pixels[..., 2 - channel] == 0).all(), "stale records drawn"
+        yield
+        assert renderer.frame_stats.stream_bytes > 0, "the batch did not stream its records"
+
+
+GL_CHECKS = [
+    check_post_process_deferred,
+    check_static_batch_tile_update,
+    check_target_pool,
+    check_tile_map,
+    check_tiled_map,
+    check_tile_collision,
+    check_collision_mask,
+    check_frame_data,
+    check_shader_cache,
+    check_state_cache,
+    check_lazy_resolve,
+    check_instancing,
+    check_stream_buffer,
+]
+
+
+class GLChecks(m.ASGEGame):
+    def __init__(self, settings):
+        m.ASGEGame.__init__(self, settings)
+        self.checks = [check(self.renderer) for check in GL_CHECKS]
+
+    def update(self, game_time: m.GameTime) -> None:
+        pass
+
+    def render(self, game_time: m.GameTime) -> None:
+        if not self.checks:
+            self.signal_exit()
+        elif next(self.checks[0], StopIteration) is StopIteration:
+            self.checks.pop(0)
+
+
+settings = m.GameSettings()
+settings.window_width = 320
+settings.window_height = 240
+settings.vsync = m.Vsync.DISABLED
+GLChecks(settings).run()